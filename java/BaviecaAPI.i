@@ -34,6 +34,82 @@
   delete [] $1;
 }
 
+# typemaps for direct NIO buffers (zero-copy): the native address of the buffer is handed to the API, 
+# the data starts at the beginning of the buffer (the position is ignored) and multi-byte values are 
+# read in native byte order (ByteBuffer.order(ByteOrder.nativeOrder())), the capacity of the buffer 
+# (CPARAM_capacity, in elements of the buffer) is checked against the size the call needs below
+%define DIRECT_BUFFER(CTYPE, CPARAM, JTYPE)
+%typemap(jni) CTYPE *CPARAM "jobject"
+%typemap(jtype) CTYPE *CPARAM "JTYPE"
+%typemap(jstype) CTYPE *CPARAM "JTYPE"
+%typemap(javain) CTYPE *CPARAM "$javainput"
+%typemap(in,noblock=1) CTYPE *CPARAM {
+  $1 = (CTYPE *)JCALL1(GetDirectBufferAddress, jenv, $input);
+  if ($1 == NULL) {
+    SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "a direct buffer is required");
+    return $null;
+  }
+  jlong CPARAM##_capacity = JCALL1(GetDirectBufferCapacity, jenv, $input);
+}
+%enddef
+
+DIRECT_BUFFER(short, sSamplesBuffer, java.nio.ByteBuffer)
+DIRECT_BUFFER(float, fFeaturesBuffer, java.nio.FloatBuffer)
+DIRECT_BUFFER(int, iFramesBuffer, java.nio.IntBuffer)
+DIRECT_BUFFER(float, fConfidencesBuffer, java.nio.FloatBuffer)
+
+# buffers that are too small throw IllegalArgumentException instead of reading/writing past their end
+# extractFeatures: samples buffer (bytes)
+%typemap(check) (short *sSamplesBuffer, unsigned int iSamples) {
+  if (sSamplesBuffer_capacity < (jlong)($2*sizeof(short))) {
+    SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "insufficient room in the samples buffer");
+    return $null;
+  }
+}
+# extractFeatures: features buffer (iFeaturesBuffer feature vectors)
+%typemap(check) (float *fFeaturesBuffer, unsigned int iFeaturesBuffer) {
+  if (fFeaturesBuffer_capacity < (jlong)$2*(arg1)->getFeatureDim()) {
+    SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "insufficient room in the features buffer");
+    return $null;
+  }
+}
+# decProcessBuffer: features buffer (iFeatures feature vectors)
+%typemap(check) (float *fFeaturesBuffer, unsigned int iFeatures) {
+  if (fFeaturesBuffer_capacity < (jlong)$2*(arg1)->getFeatureDim()) {
+    SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "insufficient room in the features buffer");
+    return $null;
+  }
+}
+# HypothesisI::getFrames: two frames per word
+%typemap(check) int *iFramesBuffer {
+  if (iFramesBuffer_capacity < (jlong)(2*(arg1)->size())) {
+    SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "insufficient room in the frames buffer");
+    return $null;
+  }
+}
+# HypothesisI::getConfidences: one confidence per word
+%typemap(check) float *fConfidencesBuffer {
+  if (fConfidencesBuffer_capacity < (jlong)(arg1)->size()) {
+    SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "insufficient room in the confidences buffer");
+    return $null;
+  }
+}
+
+# feature processing from a direct buffer (decProcess(float*,...) is already bound to float[])
+%extend Bavieca::BaviecaAPI {
+  void decProcessBuffer(float *fFeaturesBuffer, unsigned int iFeatures) {
+    $self->decProcess(fFeaturesBuffer,iFeatures);
+  }
+}
+%extend Bavieca::BaviecaSession {
+  void decProcessBuffer(float *fFeaturesBuffer, unsigned int iFeatures) {
+    $self->decProcess(fFeaturesBuffer,iFeatures);
+  }
+}
+
+# sessions created by the engine are owned by the caller
+%newobject Bavieca::BaviecaEngine::createSession;
+
 %include "BaviecaAPI.h"
 
 //  (jsize)(*arg4*(arg1)->getFeatureDim())
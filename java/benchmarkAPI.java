@@ -0,0 +1,198 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+ 
+import java.lang.*;
+import java.io.*;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.FloatBuffer;
+import java.nio.IntBuffer;
+import blt.bavieca.*;
+
+// micro-benchmark of the Java bindings: array-based calls (the JNI layer copies the arrays in and out) 
+// versus direct buffers (the native code works on the memory of the buffer), in the style of JMH: 
+// warm-up iterations to let the JIT compile the code followed by measured iterations
+public class benchmarkAPI {
+	
+	static {
+		try {
+			System.loadLibrary("baviecaapijni");
+		} catch (UnsatisfiedLinkError e) {
+			System.err.println("Native code library failed to load.\n" + e);
+			System.exit(1);
+		}
+	}
+	
+	static final int iSamplesChunk = 1600;		// one 10th of a second (16KHz)
+	
+	static BaviecaAPI baviecaAPI;
+	static short [][] sChunks;						// audio chunks (array-based)
+	static ByteBuffer [] bbChunks;				// audio chunks (direct buffers)
+	static FloatBuffer fbFeatures;				// feature buffer (direct)
+	static IntBuffer ibFrames;						// word boundaries (direct)
+	static FloatBuffer fbConfidences;			// word confidences (direct)
+	static int iFeatureDim;
+	static int iFeaturesChunk;
+	
+	// decode the audio using arrays (features are returned as a new float[] for each chunk)
+	static long decodeArrays() {
+	
+		long lChecksum = 0;
+		long lFeatures [] = new long[1];
+		baviecaAPI.decBeginUtterance();
+		for(int i=0 ; i < sChunks.length ; ++i) {
+			float [] fFeatures = baviecaAPI.extractFeatures(sChunks[i],(long)sChunks[i].length,lFeatures);
+			if (lFeatures[0] > 0) {
+				baviecaAPI.decProcess(fFeatures,lFeatures[0]);
+			}
+		}
+		// one proxy object per word
+		HypothesisI hypothesis = baviecaAPI.decGetHypothesis();
+		if (hypothesis != null) {
+			for(int i=0 ; i < hypothesis.size() ; ++i) {
+				WordHypothesisI wordHypothesisI = hypothesis.getWordHypothesis(i);
+				lChecksum += wordHypothesisI.getWord().length()+wordHypothesisI.getFrameStart()+wordHypothesisI.getFrameEnd();
+			}
+			hypothesis.delete();
+		}
+		baviecaAPI.decEndUtterance();
+		
+		return lChecksum;
+	}
+	
+	// decode the audio using direct buffers (no copies across the JNI boundary, no garbage)
+	static long decodeBuffers() {
+	
+		long lChecksum = 0;
+		baviecaAPI.decBeginUtterance();
+		for(int i=0 ; i < bbChunks.length ; ++i) {
+			int iFeatures = baviecaAPI.extractFeatures(bbChunks[i],(long)(bbChunks[i].capacity()/2),
+				fbFeatures,(long)iFeaturesChunk);
+			if (iFeatures > 0) {
+				baviecaAPI.decProcessBuffer(fbFeatures,(long)iFeatures);
+			}
+		}
+		// the whole hypothesis is retrieved with three calls
+		HypothesisI hypothesis = baviecaAPI.decGetHypothesis();
+		if (hypothesis != null) {
+			int iWords = (int)hypothesis.size();
+			if (ibFrames.capacity() < 2*iWords) {
+				ibFrames = ByteBuffer.allocateDirect(8*iWords).order(ByteOrder.nativeOrder()).asIntBuffer();
+				fbConfidences = ByteBuffer.allocateDirect(4*iWords).order(ByteOrder.nativeOrder()).asFloatBuffer();
+			}
+			String strText = hypothesis.getText();
+			hypothesis.getFrames(ibFrames);
+			hypothesis.getConfidences(fbConfidences);
+			lChecksum += strText.length()-Math.max(iWords-1,0);
+			for(int i=0 ; i < 2*iWords ; ++i) {
+				lChecksum += ibFrames.get(i);
+			}
+			hypothesis.delete();
+		}
+		baviecaAPI.decEndUtterance();
+		
+		return lChecksum;
+	}
+	
+	// run the given benchmark and report the time per utterance and the real time factor
+	static void run(String strName, boolean bBuffers, int iWarmup, int iIterations, double dSeconds) {
+	
+		long lChecksum = 0;
+		for(int i=0 ; i < iWarmup ; ++i) {
+			lChecksum += bBuffers ? decodeBuffers() : decodeArrays();
+		}
+		long [] lTimes = new long[iIterations];
+		for(int i=0 ; i < iIterations ; ++i) {
+			long lStart = System.nanoTime();
+			lChecksum += bBuffers ? decodeBuffers() : decodeArrays();
+			lTimes[i] = System.nanoTime()-lStart;
+		}
+		java.util.Arrays.sort(lTimes);
+		double dMean = 0.0;
+		for(int i=0 ; i < iIterations ; ++i) {
+			dMean += lTimes[i];
+		}
+		dMean /= iIterations;
+		System.out.format("[java] %-8s mean: %10.3f ms/utt  median: %10.3f ms/utt  min: %10.3f ms/utt  RTF: %.4f  (checksum: %d)%n",
+			strName,dMean/1e6,lTimes[iIterations/2]/1e6,lTimes[0]/1e6,(dMean/1e9)/dSeconds,lChecksum);
+	}
+
+	public static void main(String argv[]) {
+	
+		// check parameters
+		if ((argv.length != 2) && (argv.length != 4)) {
+			System.out.println("usage: benchmarkAPI [configurationFile] [rawAudioFile] ([warmupIterations] [iterations])");
+			return;
+		}
+		int iWarmup = (argv.length == 4) ? Integer.parseInt(argv[2]) : 5;
+		int iIterations = (argv.length == 4) ? Integer.parseInt(argv[3]) : 20;
+		
+		baviecaAPI = new BaviecaAPI(argv[0]);
+		if (baviecaAPI.initialize((short)BaviecaAPI_SWIGConstants.INIT_DECODER) == false) {
+			System.out.println("[java] unable to initialize the library");
+			return;
+		}
+		
+		try {
+		
+			// load the raw audio file (16KHz 16bits little endian)
+			FileInputStream fis = new FileInputStream(argv[1]);
+			byte [] bytes = new byte[fis.available()];
+			int iRead = 0;
+			while(iRead < bytes.length) {
+				iRead += fis.read(bytes,iRead,bytes.length-iRead);
+			}
+			fis.close();
+			int iSamples = bytes.length/2;
+			
+			// audio in both representations, chunks are prepared upfront so only the API calls are measured
+			ByteBuffer bbAudio = ByteBuffer.allocateDirect(iSamples*2).order(ByteOrder.nativeOrder());
+			bbAudio.asShortBuffer().put(ByteBuffer.wrap(bytes).order(ByteOrder.LITTLE_ENDIAN).asShortBuffer());
+			int iChunks = (iSamples+iSamplesChunk-1)/iSamplesChunk;
+			sChunks = new short[iChunks][];
+			bbChunks = new ByteBuffer[iChunks];
+			for(int i=0 ; i < iChunks ; ++i) {
+				int iSamplesThis = Math.min(iSamplesChunk,iSamples-i*iSamplesChunk);
+				bbAudio.limit(2*(i*iSamplesChunk+iSamplesThis));
+				bbAudio.position(2*i*iSamplesChunk);
+				bbChunks[i] = bbAudio.slice().order(ByteOrder.nativeOrder());
+				sChunks[i] = new short[iSamplesThis];
+				bbChunks[i].asShortBuffer().get(sChunks[i]);
+			}
+			
+			// direct buffers for the output (room for a chunk plus the samples carried over from the previous one)
+			iFeatureDim = baviecaAPI.getFeatureDim();
+			iFeaturesChunk = (int)baviecaAPI.getFeatureVectorsMax((long)(2*iSamplesChunk));
+			fbFeatures = ByteBuffer.allocateDirect(4*iFeaturesChunk*iFeatureDim).order(ByteOrder.nativeOrder()).asFloatBuffer();
+			ibFrames = ByteBuffer.allocateDirect(8*64).order(ByteOrder.nativeOrder()).asIntBuffer();
+			fbConfidences = ByteBuffer.allocateDirect(4*64).order(ByteOrder.nativeOrder()).asFloatBuffer();
+			
+			double dSeconds = iSamples/16000.0;
+			System.out.format("[java] audio: %.2f seconds, %d chunks, %d warm-up iterations, %d iterations%n",
+				dSeconds,iChunks,iWarmup,iIterations);
+			run("arrays",false,iWarmup,iIterations,dSeconds);
+			run("buffers",true,iWarmup,iIterations,dSeconds);
+		
+		} catch (IOException ioe) {
+			System.out.println("IO error: " + ioe);
+		}
+		
+		baviecaAPI.uninitialize();
+		baviecaAPI.delete();
+	}
+}
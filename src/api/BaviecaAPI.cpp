@@ -19,60 +19,83 @@
 #include <stdexcept>
 
 #include "ViterbiX.h"
+#include "AcousticLookAhead.h"
 #include "AlignmentFile.h"
 #include "AudioFile.h"
 #include "BaviecaAPI.h"
 #include "BatchFile.h"
 #include "BestPath.h"
+#include "ConfusionNetwork.h"
 #include "ConfigurationBavieca.h"
 #include "ConfigurationFeatures.h"
 #include "DynamicNetworkX.h"
 #include "DynamicDecoderX.h"
 #include "NetworkBuilderX.h"
+#include "EmissionCache.h"
 #include "FeatureExtractor.h"
 #include "FeatureFile.h"
 #include "FillerManager.h"
+#include "GaussianQuantizer.h"
+#include "GaussianSelector.h"
 #include "HMMManager.h"
+#include "HypothesisLattice.h"
 #include "LexiconManager.h"
 #include "LexUnitsFile.h"
 #include "LMManager.h"
 #include "LogMessage.h"
 #include "MatrixStatic.h"
+#include "OnlineFMLLR.h"
+#include "PerformanceProfile.h"
 #include "PhoneSet.h"
 #include "SADModule.h"
 #include "TextAligner.h"
 #include "TextAlignment.h"
+#include "Transform.h"
+#include "Viterbi.h"
 
 namespace Bavieca {
 
+// ENGINE --------------------------------------------------------------------------------------------
+
 // constructor (receives default configuration parameters)
-BaviecaAPI::BaviecaAPI(const char *strFileConfiguration) {
+BaviecaEngine::BaviecaEngine(const char *strFileConfiguration) {
 
 	assert(strFileConfiguration);
 	m_strFileConfiguration = new char[strlen(strFileConfiguration)+1];
 	strcpy(m_strFileConfiguration,strFileConfiguration);
 	
 	m_configuration = NULL;
-	m_featureExtractor = NULL;
+	m_configurationFeatures = NULL;
 	m_phoneSet = NULL;
 	m_lexiconManager = NULL;
-	m_sadModule = NULL;
 	m_lmManager = NULL;
-	m_viterbiX = NULL;	
 	m_hmmManager = NULL;
+	m_gaussianSelector = NULL;
+	m_gaussianQuantizer = NULL;
 	m_network = NULL;
 	m_networkBuilder = NULL;
-	m_dynamicDecoder = NULL;
+	m_acousticLookAhead = NULL;
+	m_bLatticeGeneration = false;
+	m_bConfusionNetwork = false;
 	m_bInitialized = false;
+	
+#if defined __linux__ || defined __APPLE__ || __MINGW32__
+	pthread_mutex_init(&m_mutex,NULL);
+#endif
 }
 
 // destructor
-BaviecaAPI::~BaviecaAPI() {
+BaviecaEngine::~BaviecaEngine() {
+
 	delete [] m_strFileConfiguration;
+	
+#if defined __linux__ || defined __APPLE__ || __MINGW32__
+	pthread_mutex_destroy(&m_mutex);
+#endif
 }
 
-// initialize API (overriding parameters as needed)
-bool BaviecaAPI::initialize(unsigned char iFlags, ParamValuesI *paramValues) {
+// initialize the engine (overriding parameters as needed)
+bool BaviecaEngine::initialize(unsigned char iFlags, ParamValuesI *paramValues) {
 
 	assert(m_bInitialized == false);
 
@@ -107,9 +130,9 @@ bool BaviecaAPI::initialize(unsigned char iFlags, ParamValuesI *paramValues) {
 			m_configuration->getStrParameterValue("feature.cepstralNormalization.mode");
 		const char *m_strCepstralNormalizationMethod =
 			m_configuration->getStrParameterValue("feature.cepstralNormalization.method");
-		int m_iCepstralNormalizationBufferSize = 
+		m_iCepstralNormalizationBufferSize = 
 			m_configuration->getIntParameterValue("feature.cepstralNormalization.bufferSize");
-		float m_fWarpFactor = 1.0;
+		m_fWarpFactor = 1.0;
 		if (m_configuration->isParameterSet("feature.warpFactor")) {
 			m_fWarpFactor = (float)atof(m_configuration->getParameterValue("feature.warpFactor"));
 		}
@@ -123,20 +146,43 @@ bool BaviecaAPI::initialize(unsigned char iFlags, ParamValuesI *paramValues) {
 		m_hmmManager->load(m_strFileAcousticModels);
 		m_hmmManager->initializeDecoding();
 		
-		// load the feature configuration
+		// Gaussian selection
+		if (m_configuration->isParameterSet("acousticModels.gaussianSelection.file")) {
+			m_gaussianSelector = new GaussianSelector(m_hmmManager);
+			m_gaussianSelector->load(m_configuration->getStrParameterValue("acousticModels.gaussianSelection.file"));
+		} else if (m_configuration->isParameterSet("acousticModels.gaussianSelection.codewords")) {
+			m_gaussianSelector = new GaussianSelector(m_hmmManager);
+			m_gaussianSelector->build(m_configuration->getIntParameterValue("acousticModels.gaussianSelection.codewords"),
+				m_configuration->getFloatParameterValue("acousticModels.gaussianSelection.threshold"),
+				m_configuration->getIntParameterValue("acousticModels.gaussianSelection.floor"));
+		}
+		if (m_gaussianSelector) {
+			m_hmmManager->setGaussianSelector(m_gaussianSelector);
+		}
+		
+		// quantization of the Gaussian parameters
+		int iQuantization = GaussianQuantizer::getType(
+			m_configuration->getStrParameterValue("acousticModels.quantization"));
+		if (iQuantization != GAUSSIAN_QUANTIZATION_NONE) {
+			m_gaussianQuantizer = new GaussianQuantizer(m_hmmManager,iQuantization);
+			m_gaussianQuantizer->build();
+			m_hmmManager->setGaussianQuantizer(m_gaussianQuantizer);
+		}
+		
+		// load the feature configuration (each session creates its own feature extractor)
 		const char *m_strFileConfigurationFeatures = m_configuration->getStrParameterValue("feature.configurationFile");
-		ConfigurationFeatures *configurationFeatures = new ConfigurationFeatures(m_strFileConfigurationFeatures);
-		configurationFeatures->load();	
+		m_configurationFeatures = new ConfigurationFeatures(m_strFileConfigurationFeatures);
+		m_configurationFeatures->load();	
 		
 		// get the feature normalization mode and method
-		int m_iCepstralNormalizationMode = FeatureExtractor::getNormalizationMode(m_strCepstralNormalizationMode);
-		int m_iCepstralNormalizationMethod = FeatureExtractor::getNormalizationMethod(m_strCepstralNormalizationMethod);
+		m_iCepstralNormalizationMode = FeatureExtractor::getNormalizationMode(m_strCepstralNormalizationMode);
+		m_iCepstralNormalizationMethod = FeatureExtractor::getNormalizationMethod(m_strCepstralNormalizationMethod);
 		
-		// create the feature extractor
-		m_featureExtractor = new FeatureExtractor(configurationFeatures,m_fWarpFactor,
+		// get the feature dimensionality
+		FeatureExtractor featureExtractor(m_configurationFeatures,m_fWarpFactor,
 			m_iCepstralNormalizationBufferSize,m_iCepstralNormalizationMode,m_iCepstralNormalizationMethod);
-		m_featureExtractor->initialize();
-		delete configurationFeatures;
+		featureExtractor.initialize();
+		m_iFeatureDim = featureExtractor.getFeatureDim();
 		
 		// speech activity detection
 		if (m_iFlags & INIT_SAD) {
@@ -144,17 +190,7 @@ bool BaviecaAPI::initialize(unsigned char iFlags, ParamValuesI *paramValues) {
 			// make sure required configuration parameters are defined
 			if (!m_configuration->areSADParametersSet()) {
 				BVC_ERROR << "wrong configuration parameters: not all the required parameters are set";
-			}	
-		
-			// speech activity detection
-			int m_iMaxGaussianComponentsSilence = m_configuration->getIntParameterValue("sad.maxGaussianSilence");
-			int m_iMaxGaussianComponentsSpeech = m_configuration->getIntParameterValue("sad.maxGaussianSpeech");
-			float m_fPenaltySilenceToSpeech = m_configuration->getFloatParameterValue("sad.speechPenalty");
-			int m_iFramesPadding = m_configuration->getIntParameterValue("sad.speechPadding");
-		
-			m_sadModule = new SADModule(m_phoneSet,m_hmmManager,m_iMaxGaussianComponentsSilence,
-				m_iMaxGaussianComponentsSpeech,m_fPenaltySilenceToSpeech,m_iFramesPadding);
-			m_sadModule->initialize();
+			}
 		}
 		
 		// aligner
@@ -172,9 +208,6 @@ bool BaviecaAPI::initialize(unsigned char iFlags, ParamValuesI *paramValues) {
 			// load the lexicon
 			m_lexiconManager = new LexiconManager(m_strFileLexicon,m_phoneSet); 
 			m_lexiconManager->load();
-			
-			float fBeamWidth = 1000;
-			m_viterbiX = new ViterbiX(m_phoneSet,m_lexiconManager,m_hmmManager,fBeamWidth,2000,true,2000);	
 		}
 		
 		// decoder
@@ -202,10 +235,6 @@ bool BaviecaAPI::initialize(unsigned char iFlags, ParamValuesI *paramValues) {
 				m_configuration->getStrParameterValue("languageModel.format"); 
 			const char *m_strLanguageModelType = 
 				m_configuration->getStrParameterValue("languageModel.type"); 
-			float m_fLanguageModelScalingFactor = 
-				m_configuration->getFloatParameterValue("languageModel.scalingFactor"); 
-			//bool m_bLanguageCrossUtterance = 
-				//m_configuration->getBoolParameterValue("languageModel.crossUtterance");
 					
 			// insertion penalty
 			float m_fInsertionPenaltyStandard = 
@@ -215,22 +244,8 @@ bool BaviecaAPI::initialize(unsigned char iFlags, ParamValuesI *paramValues) {
 			const char *m_strFileInsertionPenaltyFiller = 
 				m_configuration->getStrParameterValue("insertionPenalty.filler.file"); 
 			
-			// pruning parameters
-			int m_iMaxActiveArcs = m_configuration->getIntParameterValue("pruning.maxActiveArcs");
-			int m_iMaxActiveArcsWE = m_configuration->getIntParameterValue("pruning.maxActiveArcsWE");
-			int m_iMaxActiveTokensArc = m_configuration->getIntParameterValue("pruning.maxActiveTokensArc");	
-			float m_fBeamWidthArcs = m_configuration->getFloatParameterValue("pruning.likelihoodBeam");
-			float m_fBeamWidthArcsWE = m_configuration->getFloatParameterValue("pruning.likelihoodBeamWE");
-			float m_fBeamWidthTokensArc = m_configuration->getFloatParameterValue("pruning.likelihoodBeamTokensArc");
-			
 			// output lattice?
-			bool m_bLatticeGeneration = m_configuration->isParameterSet("output.lattice.maxWordSequencesState");	
-			//m_bLatticeGeneration = false;
-			int m_iMaxWordSequencesState = -1;
-			if (m_bLatticeGeneration) {
-				m_iMaxWordSequencesState = 
-					m_configuration->getIntParameterValue("output.lattice.maxWordSequencesState");
-			}
+			m_bLatticeGeneration = m_configuration->isParameterSet("output.lattice.maxWordSequencesState");	
 			
 			// attach insertion penalties to lexical units
 			m_lexiconManager->attachLexUnitPenalties(m_fInsertionPenaltyStandard,m_fInsertionPenaltyFiller);
@@ -253,18 +268,34 @@ bool BaviecaAPI::initialize(unsigned char iFlags, ParamValuesI *paramValues) {
 			if (m_network == NULL) {
 				BVC_ERROR << "unable to build the network";
 			}
-		
-			m_dynamicDecoder = new DynamicDecoderX(m_phoneSet,m_hmmManager,m_lexiconManager,
-					m_lmManager,m_fLanguageModelScalingFactor,m_network,m_iMaxActiveArcs,
-					m_iMaxActiveArcsWE,m_iMaxActiveTokensArc,m_fBeamWidthArcs,m_fBeamWidthArcsWE,m_fBeamWidthTokensArc,
-					m_bLatticeGeneration,m_iMaxWordSequencesState);
-					
-			m_dynamicDecoder->initialize();
+			
+			// acoustic look-ahead (phone models are shared, each session keeps its own scores)
+			int iAcousticLookAheadFrames = m_configuration->getIntParameterValue("acousticLookAhead.frames");
+			if (iAcousticLookAheadFrames > 0) {
+				m_acousticLookAhead = new AcousticLookAhead(m_phoneSet,m_hmmManager,
+					m_configuration->getIntParameterValue("acousticLookAhead.components"),iAcousticLookAheadFrames,
+					m_configuration->getFloatParameterValue("acousticLookAhead.weight"));
+				m_acousticLookAhead->build();
+			}
+			
+			// minimum Bayes risk decoding from a confusion network
+			m_bConfusionNetwork = m_configuration->getBoolParameterValue("output.confusionNetwork");
+			if ((m_bConfusionNetwork) && (m_bLatticeGeneration == false)) {
+				BVC_ERROR << "wrong configuration parameters: confusion networks require lattice generation";
+			}
+			// lattices from the decoder carry no acoustic scores, they are recovered by aligning them with 
+			// context dependent models (otherwise posteriors would only reflect the language model)
+			if ((m_bConfusionNetwork) && (m_hmmManager->getContextSizeHMMCW() == 0)) {
+				BVC_ERROR << "wrong configuration parameters: confusion networks require context dependent acoustic models";
+			}
 		}
 		
 		// speaker adaptation
 		if (m_iFlags & INIT_ADAPTATION) {
-			
+		
+			if (!m_lexiconManager) {
+				BVC_ERROR << "wrong initialization mode: speaker adaptation requires the aligner or the decoder";
+			}
 		}
 			
 	} catch (std::runtime_error) {	
@@ -275,26 +306,28 @@ bool BaviecaAPI::initialize(unsigned char iFlags, ParamValuesI *paramValues) {
 	return true;
 }
 
-// uninitialize the API	
-void BaviecaAPI::uninitialize() {
+// uninitialize the engine (all the sessions need to be destroyed first)
+void BaviecaEngine::uninitialize() {
 
 	assert(m_bInitialized);
 	
 	delete m_configuration;
+	delete m_configurationFeatures;
 	delete m_phoneSet;
-	delete m_lexiconManager;
+	if (m_lexiconManager) {
+		delete m_lexiconManager;
+	}
 	delete m_hmmManager;
-	delete m_featureExtractor;
-	
-	if (m_sadModule) {
-		delete m_sadModule;
+	if (m_gaussianSelector) {
+		delete m_gaussianSelector;
 	}
-	if (m_viterbiX) {
-		delete m_viterbiX;
+	if (m_gaussianQuantizer) {
+		delete m_gaussianQuantizer;
 	}
-	if (m_dynamicDecoder) {
-		m_dynamicDecoder->uninitialize();
-		delete m_dynamicDecoder;
+	if (m_acousticLookAhead) {
+		delete m_acousticLookAhead;
+	}
+	if (m_network) {
 		delete m_network;
 		delete m_networkBuilder;
 	}
@@ -303,102 +336,411 @@ void BaviecaAPI::uninitialize() {
 	}
 	
 	m_configuration = NULL;
-	m_featureExtractor = NULL;
+	m_configurationFeatures = NULL;
 	m_phoneSet = NULL;
 	m_lexiconManager = NULL;
-	m_sadModule = NULL;
 	m_lmManager = NULL;
-	m_viterbiX = NULL;	
 	m_hmmManager = NULL;
+	m_gaussianSelector = NULL;
+	m_gaussianQuantizer = NULL;
 	m_network = NULL;
 	m_networkBuilder = NULL;
-	m_dynamicDecoder = NULL;
+	m_acousticLookAhead = NULL;
+	m_bLatticeGeneration = false;
+	m_bConfusionNetwork = false;
 	m_bInitialized = false;	
 }
 
-// extract features from the audio
-float *BaviecaAPI::extractFeatures(short *sSamples, unsigned int iSamples, unsigned int *iFeatures) {
+// create a new session (NULL if it cannot be created), the caller is responsible for deleting it
+BaviecaSession *BaviecaEngine::createSession() {
 
 	assert(m_bInitialized);
 	
+	BaviecaSession *session = new BaviecaSession(this);
+	try {
+		session->initialize();
+	} catch (std::runtime_error) {
+		delete session;
+		return NULL;
+	}
+	
+	return session;
+}
+
+// return feature dimensionality
+int BaviecaEngine::getFeatureDim() {
+
+	assert(m_bInitialized);
+	return m_iFeatureDim;
+}
+
+// return a word-level assessment given a hypothesis and a reference text
+TextAlignmentI *BaviecaEngine::getAssessment(HypothesisI *hypothesisI, const char *strReference) {
+
+	// get lexical units from reference (there might be out-of-vocabulary words <unk>)
+	VLexUnit vLexUnitRef;
+	bool bAllKnown;
+	if (m_lexiconManager->getLexUnits(strReference,vLexUnitRef,bAllKnown) == false) {
+		return NULL;
+	}
+	
+	// get lexical units from the hypothesis
+	VLexUnit vLexUnitHyp;
+	for(unsigned int i=0 ; i < hypothesisI->size() ; ++i) {
+		LexUnit *lexUnit = m_lexiconManager->getLexUnitPronunciation(hypothesisI->getWordHypothesis(i)->getWord());
+		assert(lexUnit);
+		vLexUnitHyp.push_back(lexUnit);
+	}	
+
+	// perform the actual alignment
+	TextAligner textAligner(m_lexiconManager);
+	TextAlignment *textAlignment = textAligner.align(vLexUnitHyp,vLexUnitRef);
+	VTAElement &vTAElement = textAlignment->getAlignment();
+	int i=0;
+	vector<TextAlignmentElementI*> vElements;
+	int iEvent;
+	for(VTAElement::iterator it = vTAElement.begin() ; it != vTAElement.end() ; ++it,++i) {
+		if ((*it)->iAlignmentEvent == TEXT_ALIGNMENT_EVENT_CORRECT) {
+			iEvent = TAE_CORRECT;
+		} else if ((*it)->iAlignmentEvent == TEXT_ALIGNMENT_EVENT_SUBSTITUTION) {		
+			iEvent = TAE_SUBSTITUTION;
+		} else if ((*it)->iAlignmentEvent == TEXT_ALIGNMENT_EVENT_DELETION) {
+			iEvent = TAE_DELETION;
+		} else {
+			assert((*it)->iAlignmentEvent == TEXT_ALIGNMENT_EVENT_INSERTION);
+			iEvent = TAE_INSERTION;
+		}
+		const char *strWordRef = NULL;
+		const char *strWordHyp = NULL;
+		if ((*it)->iIndexReference != -1) {
+			strWordRef = m_lexiconManager->getStrLexUnit((*it)->iLexUnitReference);
+		}
+		if ((*it)->iIndexHypothesis != -1) {
+			strWordHyp = m_lexiconManager->getStrLexUnit((*it)->iLexUnitHypothesis);
+		}
+		vElements.push_back(new TextAlignmentElementI(iEvent,(*it)->iIndexReference,strWordRef,(*it)->iIndexHypothesis,strWordHyp));
+	}	
+	delete textAlignment;
+	
+	return new TextAlignmentI(vElements);
+}
+
+// SESSION -------------------------------------------------------------------------------------------
+
+// constructor (sessions are created by the engine)
+BaviecaSession::BaviecaSession(BaviecaEngine *engine) {
+
+	m_engine = engine;
+	m_featureExtractor = NULL;
+	m_sadModule = NULL;
+	m_viterbiX = NULL;
+	m_dynamicDecoder = NULL;
+	m_emissionCache = NULL;
+	m_acousticLookAhead = NULL;
+	m_onlineFMLLR = NULL;
+	m_transformUtterance = NULL;
+	m_profile = NULL;
+	m_viterbi = NULL;
+	m_bLockDecoding = false;
+	m_iFrameSpeechStart = -1;
+}
+
+// destructor
+BaviecaSession::~BaviecaSession() {
+
+	if (m_featureExtractor) {
+		delete m_featureExtractor;
+	}
+	if (m_sadModule) {
+		delete m_sadModule;
+	}
+	if (m_viterbiX) {
+		delete m_viterbiX;
+	}
+	if (m_dynamicDecoder) {
+		m_dynamicDecoder->uninitialize();
+		delete m_dynamicDecoder;
+	}
+	if (m_emissionCache) {
+		delete m_emissionCache;
+	}
+	if (m_acousticLookAhead) {
+		delete m_acousticLookAhead;
+	}
+	if (m_profile) {
+		delete m_profile;
+	}
+	if (m_viterbi) {
+		delete m_viterbi;
+	}
+	if (m_onlineFMLLR) {
+		m_onlineFMLLR->uninitialize();
+		delete m_onlineFMLLR;
+	}
+}
+
+// create the per-stream objects
+void BaviecaSession::initialize() {
+
+	ConfigurationBavieca *configuration = m_engine->m_configuration;
+	PhoneSet *phoneSet = m_engine->m_phoneSet;
+	HMMManager *hmmManager = m_engine->m_hmmManager;
+	LexiconManager *lexiconManager = m_engine->m_lexiconManager;
+
+	// create the feature extractor
+	m_featureExtractor = new FeatureExtractor(m_engine->m_configurationFeatures,m_engine->m_fWarpFactor,
+		m_engine->m_iCepstralNormalizationBufferSize,m_engine->m_iCepstralNormalizationMode,
+		m_engine->m_iCepstralNormalizationMethod);
+	m_featureExtractor->initialize();
+	
+	// speech activity detection (the SAD module keeps its own HMM-states)
+	if (m_engine->m_iFlags & INIT_SAD) {
+	
+		int m_iMaxGaussianComponentsSilence = configuration->getIntParameterValue("sad.maxGaussianSilence");
+		int m_iMaxGaussianComponentsSpeech = configuration->getIntParameterValue("sad.maxGaussianSpeech");
+		float m_fPenaltySilenceToSpeech = configuration->getFloatParameterValue("sad.speechPenalty");
+		int m_iFramesPadding = configuration->getIntParameterValue("sad.speechPadding");
+		int iFramesLatency = configuration->getIntParameterValue("sad.maxLatency");
+	
+		m_sadModule = new SADModule(phoneSet,hmmManager,m_iMaxGaussianComponentsSilence,
+			m_iMaxGaussianComponentsSpeech,m_fPenaltySilenceToSpeech,m_iFramesPadding,iFramesLatency);
+		m_sadModule->initialize();
+	}
+	
+	// aligner
+	if (m_engine->m_iFlags & INIT_ALIGNER) {
+	
+		float fBeamWidth = 1000;
+		m_viterbiX = new ViterbiX(phoneSet,lexiconManager,hmmManager,fBeamWidth,2000,true,2000);	
+	}
+	
+	// decoder
+	if (m_engine->m_iFlags & INIT_DECODER) {
+	
+		float m_fLanguageModelScalingFactor = 
+			configuration->getFloatParameterValue("languageModel.scalingFactor"); 
+	
+		// pruning parameters
+		int m_iMaxActiveArcs = configuration->getIntParameterValue("pruning.maxActiveArcs");
+		int m_iMaxActiveArcsWE = configuration->getIntParameterValue("pruning.maxActiveArcsWE");
+		int m_iMaxActiveTokensArc = configuration->getIntParameterValue("pruning.maxActiveTokensArc");	
+		float m_fBeamWidthArcs = configuration->getFloatParameterValue("pruning.likelihoodBeam");
+		float m_fBeamWidthArcsWE = configuration->getFloatParameterValue("pruning.likelihoodBeamWE");
+		float m_fBeamWidthTokensArc = configuration->getFloatParameterValue("pruning.likelihoodBeamTokensArc");
+		
+		// output lattice?
+		int m_iMaxWordSequencesState = -1;
+		if (m_engine->m_bLatticeGeneration) {
+			m_iMaxWordSequencesState = 
+				configuration->getIntParameterValue("output.lattice.maxWordSequencesState");
+		}
+	
+		m_dynamicDecoder = new DynamicDecoderX(phoneSet,hmmManager,lexiconManager,
+				m_engine->m_lmManager,m_fLanguageModelScalingFactor,m_engine->m_network,m_iMaxActiveArcs,
+				m_iMaxActiveArcsWE,m_iMaxActiveTokensArc,m_fBeamWidthArcs,m_fBeamWidthArcsWE,m_fBeamWidthTokensArc,
+				m_engine->m_bLatticeGeneration,m_iMaxWordSequencesState);
+				
+		m_dynamicDecoder->initialize();
+		
+		// emission probabilities are computed by the session (the HMM-states are shared), Gaussian 
+		// selection and quantization keep per-frame state in the models so decoding needs the lock
+		if ((m_engine->m_gaussianSelector == NULL) && (m_engine->m_gaussianQuantizer == NULL)) {
+			int iEmissionCacheFrames = max(1,configuration->getIntParameterValue("emissionCache.frames"));
+			m_emissionCache = new EmissionCache(hmmManager,iEmissionCacheFrames);
+			m_dynamicDecoder->setEmissionCache(m_emissionCache);
+		} else {
+			m_bLockDecoding = true;
+		}
+		
+		// acoustic look-ahead
+		if (m_engine->m_acousticLookAhead) {
+			m_acousticLookAhead = new AcousticLookAhead(m_engine->m_acousticLookAhead);
+			m_dynamicDecoder->setAcousticLookAhead(m_acousticLookAhead);
+		}
+		
+		// performance counters and timers
+		if (configuration->getBoolParameterValue("output.profile")) {
+			m_profile = new PerformanceProfile();
+			m_dynamicDecoder->setProfile(m_profile);
+		}
+		
+		// lattices are aligned against the features of the utterance to get acoustic scores for the 
+		// confusion network
+		if (m_engine->m_bConfusionNetwork) {
+			m_viterbi = new Viterbi(phoneSet,hmmManager,lexiconManager,2000.0);
+		}
+	}
+	
+	// speaker adaptation (online fMLLR, features of each utterance are transformed using the most 
+	// recent transform estimated from previous utterances of the session)
+	if (m_engine->m_iFlags & INIT_ADAPTATION) {
+		
+		int iFramesUpdate = configuration->getIntParameterValue("adaptation.fmllr.framesUpdate");
+		int iIterations = configuration->getIntParameterValue("adaptation.fmllr.iterations");
+		bool bBestComponentOnly = configuration->getBoolParameterValue("adaptation.fmllr.bestComponentOnly");
+		
+		m_onlineFMLLR = new OnlineFMLLR(phoneSet,lexiconManager,
+			configuration->getStrParameterValue("acousticModels.file"),iIterations,bBestComponentOnly,iFramesUpdate);
+		m_onlineFMLLR->initialize();
+	}
+}
+
+// extract features from the audio
+float *BaviecaSession::extractFeatures(short *sSamples, unsigned int iSamples, unsigned int *iFeatures) {
+
+	assert(m_engine->m_bInitialized);
+	
 	MatrixBase<float> *mFeatures = m_featureExtractor->extractFeaturesStream(sSamples,iSamples);
 	if (!mFeatures) {
 		*iFeatures = -1;
 		return NULL;
 	}	
 	
-	assert(0);
-	cout << "features might be aligned to 16 byte boundaries or other, conversion needs to be done";
+	// feature vectors are returned contiguously (rows in the matrix can be padded for memory alignment)
+	unsigned int iDim = m_featureExtractor->getFeatureDim();
+	float *fFeatures = new float[mFeatures->getRows()*iDim];
+	for(unsigned int i=0 ; i < mFeatures->getRows() ; ++i) {
+		memcpy(fFeatures+i*iDim,mFeatures->getRowData(i),iDim*sizeof(float));
+	}
 	*iFeatures = mFeatures->getRows();
-	return mFeatures->getData();
+	delete mFeatures;
+	
+	return fFeatures;
+}
+
+// extract features from the audio into a caller-provided buffer (getFeatureDim() floats per feature 
+// vector), return the number of feature vectors extracted or -1 if they do not fit in the buffer
+int BaviecaSession::extractFeatures(short *sSamplesBuffer, unsigned int iSamples, float *fFeaturesBuffer, 
+	unsigned int iFeaturesBuffer) {
+
+	assert(m_engine->m_bInitialized);
+	
+	// check the size of the buffer before the stream moves forward
+	if (m_featureExtractor->getFeatureVectorsStreamMax(iSamples) > iFeaturesBuffer) {
+		BVC_WARNING << "insufficient room in the feature buffer (available: " << iFeaturesBuffer 
+			<< " required: " << m_featureExtractor->getFeatureVectorsStreamMax(iSamples) << ")";
+		return -1;
+	}
+	
+	MatrixBase<float> *mFeatures = m_featureExtractor->extractFeaturesStream(sSamplesBuffer,iSamples);
+	if (!mFeatures) {
+		return 0;
+	}
+	assert(mFeatures->getRows() <= iFeaturesBuffer);
+	unsigned int iDim = m_featureExtractor->getFeatureDim();
+	for(unsigned int i=0 ; i < mFeatures->getRows() ; ++i) {
+		memcpy(fFeaturesBuffer+i*iDim,mFeatures->getRowData(i),iDim*sizeof(float));
+	}
+	int iFeatures = mFeatures->getRows();
+	delete mFeatures;
+	
+	return iFeatures;
+}
+
+// return the maximum number of feature vectors that can be extracted from the given audio
+unsigned int BaviecaSession::getFeatureVectorsMax(unsigned int iSamples) {
+
+	assert(m_engine->m_bInitialized);
+	
+	return m_featureExtractor->getFeatureVectorsStreamMax(iSamples);
 }
 
 // return feature dimensionality
-int BaviecaAPI::getFeatureDim() {
+int BaviecaSession::getFeatureDim() {
 
-	assert(m_bInitialized);
+	assert(m_engine->m_bInitialized);
 	assert(m_featureExtractor);	
-	return m_featureExtractor->getFeatureDimContainer();
+	return m_featureExtractor->getFeatureDim();
 }
 
 // free features extracted using extractFeatures(...)
-void BaviecaAPI::free(float *fFeatures) {
+void BaviecaSession::free(float *fFeatures) {
 
 	delete [] fFeatures;		
 }
 
 // start a SAD session
-void BaviecaAPI::sadBeginSession() {
+void BaviecaSession::sadBeginSession() {
 	
-	assert(m_bInitialized);
+	assert(m_engine->m_bInitialized);
 	m_featureExtractor->resetStream();
 	m_sadModule->beginSession();
+	m_iFrameSpeechStart = -1;
 }
 
 // terminate a SAD session
-void BaviecaAPI::sadEndSession() {
+void BaviecaSession::sadEndSession() {
 
-	assert(m_bInitialized);
+	assert(m_engine->m_bInitialized);
 	m_sadModule->endSession();
 }
 
 // proces the given features
-void BaviecaAPI::sadFeed(float *fFeatures, unsigned int iFeatures) {
+void BaviecaSession::sadFeed(float *fFeatures, unsigned int iFeatures) {
 
-	assert(m_bInitialized);
+	assert(m_engine->m_bInitialized);
 	MatrixStatic<float> mFeatures(fFeatures,iFeatures,m_featureExtractor->getFeatureDim());	
 	m_sadModule->processFeatures(mFeatures);
 }
 
-// recover speech segments by doing back-tracking on the grid
-SpeechSegmentsI *BaviecaAPI::sadRecoverSpeechSegments() {
+// return the speech segments decided since the last call, a segment in progress is returned with 
+// -1 as its end and returned again once its end is decided (NULL if there are no segments)
+SpeechSegmentsI *BaviecaSession::sadGetSpeechSegments() {
 
-	//m_sadModule->printGrid();
-	assert(m_bInitialized);
+	assert(m_engine->m_bInitialized);
+	VSpeechEvent vSpeechEvent;
+	m_sadModule->getSpeechEvents(vSpeechEvent);
+	vector<SpeechSegmentI*> vSpeechSegmentI;
+	for(VSpeechEvent::iterator it = vSpeechEvent.begin() ; it != vSpeechEvent.end() ; ++it) {
+		if (it->iType == SPEECH_EVENT_START) {
+			m_iFrameSpeechStart = it->iFrame;
+		} else {
+			vSpeechSegmentI.push_back(new SpeechSegmentI(m_iFrameSpeechStart,it->iFrame));
+			m_iFrameSpeechStart = -1;
+		}
+	}
+	if (m_iFrameSpeechStart != -1) {
+		vSpeechSegmentI.push_back(new SpeechSegmentI(m_iFrameSpeechStart,-1));
+	}
+	if (vSpeechSegmentI.empty()) {
+		return NULL;
+	}
+
+	return new SpeechSegmentsI(vSpeechSegmentI);
+}
+
+// decide the remaining frames and return the speech segments not returned yet
+SpeechSegmentsI *BaviecaSession::sadRecoverSpeechSegments() {
+
+	assert(m_engine->m_bInitialized);
 	VSpeechSegment vSpeechSegment;
 	m_sadModule->recoverSpeechSegments(vSpeechSegment);
 	if (vSpeechSegment.empty()) {
 		return NULL;
 	}	
 	vector<SpeechSegmentI*> vSpeechSegmentI;
-	int i = 0;
-	for(VSpeechSegment::iterator it = vSpeechSegment.begin() ; it != vSpeechSegment.end() ; ++it, ++i) {
+	for(VSpeechSegment::iterator it = vSpeechSegment.begin() ; it != vSpeechSegment.end() ; ++it) {
+		// the start of the segment might have been returned already
+		if ((*it)->iFrameStart == -1) {
+			(*it)->iFrameStart = m_iFrameSpeechStart;
+		}
 		vSpeechSegmentI.push_back(new SpeechSegmentI((*it)->iFrameStart,(*it)->iFrameEnd));
 		delete *it;
 	}
+	m_iFrameSpeechStart = -1;
 
 	return new SpeechSegmentsI(vSpeechSegmentI);
 }
 
 // forced alignment between features and audio
-AlignmentI *BaviecaAPI::align(float *fFeatures, unsigned int iFeatures, const char *strText, 
+AlignmentI *BaviecaSession::align(float *fFeatures, unsigned int iFeatures, const char *strText, 
 	bool bMultiplePronunciations) {
 
-	assert(m_bInitialized);
+	assert(m_engine->m_bInitialized);
 	VLexUnit vLexUnit;
 	bool bAllKnown;
 	
-	if (m_lexiconManager->getLexUnits(strText,vLexUnit,bAllKnown) == false) {
+	if (m_engine->m_lexiconManager->getLexUnits(strText,vLexUnit,bAllKnown) == false) {
 		return NULL;
 	}
 	if (bAllKnown == false) {
@@ -409,15 +751,23 @@ AlignmentI *BaviecaAPI::align(float *fFeatures, unsigned int iFeatures, const ch
 	int iErrorCode;
 	
 	VLexUnit vLexUnitOptional;
-	vLexUnitOptional.push_back(m_lexiconManager->getLexUnitSilence());
+	vLexUnitOptional.push_back(m_engine->m_lexiconManager->getLexUnitSilence());
 	MatrixStatic<float> mFeatures(fFeatures,iFeatures,m_featureExtractor->getFeatureDim());	
-	Alignment *alignment = m_viterbiX->processUtterance(vLexUnit,bMultiplePronunciations,
+	Alignment *alignment = NULL;
+	m_engine->lock();
+	try {
+		alignment = m_viterbiX->processUtterance(vLexUnit,bMultiplePronunciations,
 			vLexUnitOptional,mFeatures,&dUtteranceLikelihood,iErrorCode);
+	} catch (std::runtime_error) {
+		m_engine->unlock();
+		throw;
+	}
+	m_engine->unlock();
 	if (alignment == NULL) {
 		return NULL;
 	}
 
-	VPhoneAlignment *vPhoneAlignment = alignment->getPhoneAlignment(m_lexiconManager);
+	VPhoneAlignment *vPhoneAlignment = alignment->getPhoneAlignment(m_engine->m_lexiconManager);
 	if (vPhoneAlignment == NULL) {
 		return NULL;
 	}
@@ -429,11 +779,11 @@ AlignmentI *BaviecaAPI::align(float *fFeatures, unsigned int iFeatures, const ch
 	int iPhone = 0;
 	int i=0;
 	for(VLexUnitAlignment::iterator it = vLexUnitAlignment->begin() ; it != vLexUnitAlignment->end() ; ++it, ++i) {
-		const char *strLexUnit = m_lexiconManager->getStrLexUnitPron((*it)->lexUnit->iLexUnitPron);
+		const char *strLexUnit = m_engine->m_lexiconManager->getStrLexUnitPron((*it)->lexUnit->iLexUnitPron);
 		// phone-alignment
 		vector<PhoneAlignmentI*> vPhoneAlignmentI;
 		for(unsigned int j=0 ; j<(*it)->lexUnit->vPhones.size() ; ++j) {
-			const char *strPhone = m_phoneSet->getStrPhone((*vPhoneAlignment)[iPhone]->iPhone);
+			const char *strPhone = m_engine->m_phoneSet->getStrPhone((*vPhoneAlignment)[iPhone]->iPhone);
 			assert(strPhone);
 			PhoneAlignmentI *phoneAlignmentI = new PhoneAlignmentI(strPhone,
 				(*vPhoneAlignment)[iPhone]->iStateBegin[0],
@@ -455,27 +805,80 @@ AlignmentI *BaviecaAPI::align(float *fFeatures, unsigned int iFeatures, const ch
 // DECODING ------------------------------------------------------------------------------------------
 
 // signal beginning of utterance
-void BaviecaAPI::decBeginUtterance() {
+void BaviecaSession::decBeginUtterance() {
 
-	assert(m_bInitialized);
-	assert(m_iFlags & INIT_DECODER);
+	assert(m_engine->m_bInitialized);
+	assert(m_engine->m_iFlags & INIT_DECODER);
+	// get the most recent adaptation transform
+	if (m_onlineFMLLR) {
+		m_transformUtterance = m_onlineFMLLR->beginUtterance();
+	}
+	m_vFeaturesUtterance.clear();
+	if (m_bLockDecoding) {
+		m_engine->lock();
+	}
 	m_dynamicDecoder->beginUtterance();
+	if (m_bLockDecoding) {
+		m_engine->unlock();
+	}
 }
 
 // process feature vectors from an utterance
-void BaviecaAPI::decProcess(float *fFeatures, unsigned int iFeatures) {
+void BaviecaSession::decProcess(float *fFeatures, unsigned int iFeatures) {
 
-	assert(m_bInitialized);
-	assert(m_iFlags & INIT_DECODER);
+	assert(m_engine->m_bInitialized);
+	assert(m_engine->m_iFlags & INIT_DECODER);
 	MatrixStatic<float> mFeatures(fFeatures,iFeatures,m_featureExtractor->getFeatureDim());
-	m_dynamicDecoder->process(mFeatures);	
+	if (m_onlineFMLLR) {
+		m_onlineFMLLR->addFeatures(mFeatures);
+		// apply the adaptation transform
+		if (m_transformUtterance) {
+			Matrix<float> *mFeaturesX = m_transformUtterance->apply(mFeatures);
+			if (m_viterbi) {
+				for(unsigned int i=0 ; i < mFeaturesX->getRows() ; ++i) {
+					m_vFeaturesUtterance.insert(m_vFeaturesUtterance.end(),mFeaturesX->getRowData(i),
+						mFeaturesX->getRowData(i)+mFeaturesX->getCols());
+				}
+			}
+			decode(*mFeaturesX);
+			delete mFeaturesX;
+			return;
+		}
+	}
+	// keep the features for the lattice alignment
+	if (m_viterbi) {
+		m_vFeaturesUtterance.insert(m_vFeaturesUtterance.end(),fFeatures,
+			fFeatures+iFeatures*m_featureExtractor->getFeatureDim());
+	}
+	decode(mFeatures);
+}
+
+// decode feature vectors (serialized with the other sessions if the HMM-states keep the scores)
+void BaviecaSession::decode(MatrixBase<float> &mFeatures) {
+
+	if (m_bLockDecoding == false) {
+		m_dynamicDecoder->process(mFeatures);
+		return;
+	}
+	
+	// the scores cached in the HMM-states (and in the Gaussian selector/quantizer) are indexed by the 
+	// frame within the utterance, another session may have left scores for the same frame indices
+	m_engine->lock();
+	try {
+		m_engine->m_hmmManager->resetHMMEmissionProbabilityComputation();
+		m_dynamicDecoder->process(mFeatures);
+	} catch (std::runtime_error) {
+		m_engine->unlock();
+		throw;
+	}
+	m_engine->unlock();
 }
 
 // get decoding results
-HypothesisI *BaviecaAPI::decGetHypothesis(const char *strFileHypothesisLattice) {
+HypothesisI *BaviecaSession::decGetHypothesis(const char *strFileHypothesisLattice) {
 
-	assert(m_bInitialized);
-	assert(m_iFlags & INIT_DECODER);
+	assert(m_engine->m_bInitialized);
+	assert(m_engine->m_iFlags & INIT_DECODER);
 	
 	// best path
 	vector<WordHypothesisI*> vWordHypothesisI;
@@ -485,22 +888,45 @@ HypothesisI *BaviecaAPI::decGetHypothesis(const char *strFileHypothesisLattice)
 		LBestPathElement *lBestPathElements = bestPath->getBestPathElements();
 		// extract standard lexical units with alignment information
 		for(LBestPathElement::iterator it = lBestPathElements->begin() ; it != lBestPathElements->end() ; ++it) {
-			if (m_lexiconManager->isStandard((*it)->lexUnit)) {
-				const char *strLexUnit = m_lexiconManager->getStrLexUnitPron((*it)->lexUnit->iLexUnitPron);
+			if (m_engine->m_lexiconManager->isStandard((*it)->lexUnit)) {
+				const char *strLexUnit = m_engine->m_lexiconManager->getStrLexUnitPron((*it)->lexUnit->iLexUnitPron);
 				WordHypothesisI *wordHypothesisI = new WordHypothesisI(strLexUnit,(*it)->iFrameStart,(*it)->iFrameEnd);
 				vWordHypothesisI.push_back(wordHypothesisI);
 			}
 		}
+		// keep the best path for adaptation
+		if (m_onlineFMLLR) {
+			m_onlineFMLLR->setBestPath(bestPath);
+		}
 		delete bestPath;
 	}
 	
 	// hypothesis lattice
-	if (strFileHypothesisLattice) {
-		assert(m_bLatticeGeneration);
+	if (strFileHypothesisLattice || m_engine->m_bConfusionNetwork) {
+		assert(m_engine->m_bLatticeGeneration);
 		HypothesisLattice *hypothesisLattice = m_dynamicDecoder->getHypothesisLattice();
 		if (hypothesisLattice != NULL) {
-			//hypothesisLattice->store(strFileHypothesisLattice,FILE_FORMAT_TEXT);
-			hypothesisLattice->store(strFileHypothesisLattice,FILE_FORMAT_BINARY);
+			if (strFileHypothesisLattice) {
+				//hypothesisLattice->store(strFileHypothesisLattice,FILE_FORMAT_TEXT);
+				hypothesisLattice->store(strFileHypothesisLattice,FILE_FORMAT_BINARY);
+			}
+			// minimum Bayes risk hypothesis replaces the best path
+			if (m_engine->m_bConfusionNetwork) {
+				BestPath *bestPathMBR = getBestPathMBR(hypothesisLattice);
+				if (bestPathMBR != NULL) {
+					for(vector<WordHypothesisI*>::iterator it = vWordHypothesisI.begin() ; it != vWordHypothesisI.end() ; ++it) {
+						delete *it;
+					}
+					vWordHypothesisI.clear();
+					LBestPathElement *lBestPathElements = bestPathMBR->getBestPathElements();
+					for(LBestPathElement::iterator it = lBestPathElements->begin() ; it != lBestPathElements->end() ; ++it) {
+						const char *strLexUnit = m_engine->m_lexiconManager->getStrLexUnitPron((*it)->lexUnit->iLexUnitPron);
+						vWordHypothesisI.push_back(new WordHypothesisI(strLexUnit,(*it)->iFrameStart,(*it)->iFrameEnd,
+							(*it)->fScoreConfidence));
+					}
+					delete bestPathMBR;
+				}
+			}
 			delete hypothesisLattice;
 		}
 	}
@@ -508,75 +934,266 @@ HypothesisI *BaviecaAPI::decGetHypothesis(const char *strFileHypothesisLattice)
 	return new HypothesisI(vWordHypothesisI);
 }
 
+// return the minimum Bayes risk hypothesis from the lattice of the utterance (NULL if posteriors cannot 
+// be computed), the lattice is modified
+BestPath *BaviecaSession::getBestPathMBR(HypothesisLattice *hypothesisLattice) {
+
+	// acoustic scores
+	assert(m_viterbi);
+	if (m_vFeaturesUtterance.size() != 
+		(unsigned int)(hypothesisLattice->getFrames()*m_featureExtractor->getFeatureDim())) {
+		BVC_WARNING << "unable to align the lattice: features do not match the lattice";
+		return NULL;
+	}
+	MatrixStatic<float> mFeatures(&m_vFeaturesUtterance[0],hypothesisLattice->getFrames(),
+		m_featureExtractor->getFeatureDim());
+	m_engine->lock();
+	bool bAligned = false;
+	try {
+		m_engine->m_hmmManager->resetHMMEmissionProbabilityComputation();
+		hypothesisLattice->hmmMarking(m_engine->m_hmmManager);
+		bAligned = m_viterbi->align(mFeatures,hypothesisLattice);
+	} catch (std::runtime_error) {
+		m_engine->unlock();
+		throw;
+	}
+	m_engine->unlock();
+	if (bAligned == false) {
+		BVC_WARNING << "unable to generate phone-level alignments for the lattice";
+		return NULL;
+	}
+	
+	// language model scores and insertion penalties
+	hypothesisLattice->attachLMProbabilities(m_engine->m_lmManager->getFSM());
+	hypothesisLattice->attachInsertionPenalty(m_engine->m_lexiconManager);
+	
+	// posterior probabilities (acoustic scores are scaled down instead of scaling up the lm-scores)
+	float fLMScalingFactor = m_engine->m_configuration->getFloatParameterValue("languageModel.scalingFactor");
+	hypothesisLattice->computeForwardBackwardScores(1.0f/fLMScalingFactor,1.0f);
+	hypothesisLattice->computePosteriorProbabilities();
+	
+	// confusion network
+	ConfusionNetwork *confusionNetwork = hypothesisLattice->createConfusionNetwork(CONFUSION_NETWORK_MIN_POSTERIOR);
+	BestPath *bestPath = confusionNetwork->getBestPath();
+	delete confusionNetwork;
+	
+	return bestPath;
+}
+
 // signal end of utterance
-void BaviecaAPI::decEndUtterance() {
+void BaviecaSession::decEndUtterance() {
 
-	assert(m_bInitialized);
-	assert(m_iFlags & INIT_DECODER);
+	assert(m_engine->m_bInitialized);
+	assert(m_engine->m_iFlags & INIT_DECODER);
 	m_dynamicDecoder->endUtterance();
+	// the utterance is used for adaptation in the background
+	if (m_onlineFMLLR) {
+		m_onlineFMLLR->endUtterance();
+	}
+}
+
+// return the performance profile of the current utterance in JSON format (NULL if disabled)
+const char *BaviecaSession::decGetProfile() {
+
+	assert(m_engine->m_bInitialized);
+	assert(m_engine->m_iFlags & INIT_DECODER);
+	if (m_profile == NULL) {
+		return NULL;
+	}
+	m_strProfile = m_profile->getJSON();
+	
+	return m_strProfile.c_str();
 }
 
 // return a word-level assessment given a hypothesis and a reference text
-TextAlignmentI *BaviecaAPI::getAssessment(HypothesisI *hypothesisI, const char *strReference) {
+TextAlignmentI *BaviecaSession::getAssessment(HypothesisI *hypothesisI, const char *strReference) {
 
-	// get lexical units from reference (there might be out-of-vocabulary words <unk>)
-	VLexUnit vLexUnitRef;
+	return m_engine->getAssessment(hypothesisI,strReference);
+}
+
+// feed data into speaker adaptation
+void BaviecaSession::mllrFeed(const char *strReference, float *fFeatures, unsigned int iFeatures) {
+
+	assert(m_engine->m_bInitialized);
+	assert(m_engine->m_iFlags & INIT_ADAPTATION);
+	
+	VLexUnit vLexUnit;
 	bool bAllKnown;
-	if (m_lexiconManager->getLexUnits(strReference,vLexUnitRef,bAllKnown) == false) {
-		return NULL;
+	if ((m_engine->m_lexiconManager->getLexUnits(strReference,vLexUnit,bAllKnown) == false) || (bAllKnown == false)) {
+		BVC_WARNING << "unable to use the reference for adaptation: " << strReference;
+		return;
 	}
+	MatrixStatic<float> mFeatures(fFeatures,iFeatures,m_featureExtractor->getFeatureDim());
+	m_onlineFMLLR->feed(mFeatures,vLexUnit);
+}
+
+// adapt using fed adaptation data (the transform is used from the next utterance on)
+void BaviecaSession::mllrAdapt() {
+
+	assert(m_engine->m_bInitialized);
+	assert(m_engine->m_iFlags & INIT_ADAPTATION);
 	
-	// get lexical units from the hypothesis
-	VLexUnit vLexUnitHyp;
-	for(unsigned int i=0 ; i < hypothesisI->size() ; ++i) {
-		LexUnit *lexUnit = m_lexiconManager->getLexUnitPronunciation(hypothesisI->getWordHypothesis(i)->getWord());
-		assert(lexUnit);
-		vLexUnitHyp.push_back(lexUnit);
-	}	
+	m_onlineFMLLR->update();
+}
 
-	// perform the actual alignment
-	TextAligner textAligner(m_lexiconManager);
-	TextAlignment *textAlignment = textAligner.align(vLexUnitHyp,vLexUnitRef);
-	VTAElement &vTAElement = textAlignment->getAlignment();
-	int i=0;
-	vector<TextAlignmentElementI*> vElements;
-	int iEvent;
-	for(VTAElement::iterator it = vTAElement.begin() ; it != vTAElement.end() ; ++it,++i) {
-		if ((*it)->iAlignmentEvent == TEXT_ALIGNMENT_EVENT_CORRECT) {
-			iEvent = TAE_CORRECT;
-		} else if ((*it)->iAlignmentEvent == TEXT_ALIGNMENT_EVENT_SUBSTITUTION) {		
-			iEvent = TAE_SUBSTITUTION;
-		} else if ((*it)->iAlignmentEvent == TEXT_ALIGNMENT_EVENT_DELETION) {
-			iEvent = TAE_DELETION;
-		} else {
-			assert((*it)->iAlignmentEvent == TEXT_ALIGNMENT_EVENT_INSERTION);
-			iEvent = TAE_INSERTION;
-		}
-		const char *strWordRef = NULL;
-		const char *strWordHyp = NULL;
-		if ((*it)->iIndexReference != -1) {
-			strWordRef = m_lexiconManager->getStrLexUnit((*it)->iLexUnitReference);
-		}
-		if ((*it)->iIndexHypothesis != -1) {
-			strWordHyp = m_lexiconManager->getStrLexUnit((*it)->iLexUnitHypothesis);
-		}
-		vElements.push_back(new TextAlignmentElementI(iEvent,(*it)->iIndexReference,strWordRef,(*it)->iIndexHypothesis,strWordHyp));
-	}	
-	delete textAlignment;
+// SINGLE-STREAM API ---------------------------------------------------------------------------------
+
+// constructor (receives default configuration parameters)
+BaviecaAPI::BaviecaAPI(const char *strFileConfiguration) {
+
+	m_engine = new BaviecaEngine(strFileConfiguration);
+	m_session = NULL;
+}
+
+// destructor
+BaviecaAPI::~BaviecaAPI() {
+
+	if (m_session) {
+		delete m_session;
+	}
+	delete m_engine;
+}
+
+// initialize API (overriding parameters as needed)
+bool BaviecaAPI::initialize(unsigned char iFlags, ParamValuesI *paramValues) {
+
+	if (m_engine->initialize(iFlags,paramValues) == false) {
+		return false;
+	}
+	m_session = m_engine->createSession();
+	if (m_session == NULL) {
+		m_engine->uninitialize();
+		return false;
+	}
 	
-	return new TextAlignmentI(vElements);
+	return true;
+}
+
+// uninitialize the API	
+void BaviecaAPI::uninitialize() {
+
+	assert(m_session);
+	delete m_session;
+	m_session = NULL;
+	m_engine->uninitialize();
+}
+
+// extract features from the audio
+float *BaviecaAPI::extractFeatures(short *sSamples, unsigned int iSamples, unsigned int *iFeatures) {
+
+	return m_session->extractFeatures(sSamples,iSamples,iFeatures);
+}
+
+// extract features from the audio into a caller-provided buffer (getFeatureDim() floats per feature 
+// vector), return the number of feature vectors extracted or -1 if they do not fit in the buffer
+int BaviecaAPI::extractFeatures(short *sSamplesBuffer, unsigned int iSamples, float *fFeaturesBuffer, 
+	unsigned int iFeaturesBuffer) {
+
+	return m_session->extractFeatures(sSamplesBuffer,iSamples,fFeaturesBuffer,iFeaturesBuffer);
+}
+
+// return the maximum number of feature vectors that can be extracted from the given audio
+unsigned int BaviecaAPI::getFeatureVectorsMax(unsigned int iSamples) {
+
+	return m_session->getFeatureVectorsMax(iSamples);
+}
+
+// return feature dimensionality
+int BaviecaAPI::getFeatureDim() {
+
+	return m_session->getFeatureDim();
+}
+
+// free features extracted using extractFeatures(...)
+void BaviecaAPI::free(float *fFeatures) {
+
+	delete [] fFeatures;		
+}
+
+// start a SAD session
+void BaviecaAPI::sadBeginSession() {
+	
+	m_session->sadBeginSession();
+}
+
+// terminate a SAD session
+void BaviecaAPI::sadEndSession() {
+
+	m_session->sadEndSession();
+}
+
+// proces the given features
+void BaviecaAPI::sadFeed(float *fFeatures, unsigned int iFeatures) {
+
+	m_session->sadFeed(fFeatures,iFeatures);
+}
+
+// return the speech segments decided since the last call, a segment in progress is returned with 
+// -1 as its end and returned again once its end is decided (NULL if there are no segments)
+SpeechSegmentsI *BaviecaAPI::sadGetSpeechSegments() {
+
+	return m_session->sadGetSpeechSegments();
+}
+
+// decide the remaining frames and return the speech segments not returned yet
+SpeechSegmentsI *BaviecaAPI::sadRecoverSpeechSegments() {
+
+	return m_session->sadRecoverSpeechSegments();
+}
+
+// forced alignment between features and audio
+AlignmentI *BaviecaAPI::align(float *fFeatures, unsigned int iFeatures, const char *strText, 
+	bool bMultiplePronunciations) {
+
+	return m_session->align(fFeatures,iFeatures,strText,bMultiplePronunciations);
+}
+
+// signal beginning of utterance
+void BaviecaAPI::decBeginUtterance() {
+
+	m_session->decBeginUtterance();
+}
+
+// process feature vectors from an utterance
+void BaviecaAPI::decProcess(float *fFeatures, unsigned int iFeatures) {
+
+	m_session->decProcess(fFeatures,iFeatures);
+}
+
+// get decoding results
+HypothesisI *BaviecaAPI::decGetHypothesis(const char *strFileHypothesisLattice) {
+
+	return m_session->decGetHypothesis(strFileHypothesisLattice);
+}
+
+// signal end of utterance
+void BaviecaAPI::decEndUtterance() {
+
+	m_session->decEndUtterance();
+}
+
+// return the performance profile of the current utterance in JSON format (NULL if disabled)
+const char *BaviecaAPI::decGetProfile() {
+
+	return m_session->decGetProfile();
+}
+
+// return a word-level assessment given a hypothesis and a reference text
+TextAlignmentI *BaviecaAPI::getAssessment(HypothesisI *hypothesisI, const char *strReference) {
+
+	return m_engine->getAssessment(hypothesisI,strReference);
 }
 
 // feed data into speaker adaptation
 void BaviecaAPI::mllrFeed(const char *strReference, float *fFeatures, unsigned int iFeatures) {
 
-
+	m_session->mllrFeed(strReference,fFeatures,iFeatures);
 }
 
-// adapt current acoustic models using fed adaptation data
+// adapt using fed adaptation data (the transform is used from the next utterance on)
 void BaviecaAPI::mllrAdapt() {
 
-
+	m_session->mllrAdapt();
 }
 
 };	// end-of-namespace
@@ -27,21 +27,36 @@ using namespace std;
 #include <stdlib.h>
 #include <assert.h>
 
+#if defined __linux__ || defined __APPLE__ || __MINGW32__
+#include <pthread.h>
+#endif
+
 namespace Bavieca {
 
 class BestPath;
 class ConfigurationBavieca;
+class ConfigurationFeatures;
 class DynamicDecoderX;
 class DynamicNetworkX;
 class FeatureExtractor;
 class FeatureTransformList;
 class FillerManager;
+class AcousticLookAhead;
+class EmissionCache;
+class GaussianQuantizer;
+class GaussianSelector;
 class HMMManager;
+class HypothesisLattice;
 class LexiconManager;
 class LMManager;
+template<typename Real> class MatrixBase;
 class NetworkBuilderX;
+class OnlineFMLLR;
+class PerformanceProfile;
 class PhoneSet;
 class SADModule;
+class Transform;
+class Viterbi;
 class ViterbiX;
 
 // initialization modes
@@ -61,17 +76,26 @@ class HypothesisI;
 class WordHypothesisI;
 class SpeechSegmentsI;
 
+class BaviecaSession;
+
 
 /**
 	@author daniel <dani.bolanos@gmail.com>
+	
+	Engine: shared and immutable resources (configuration, phone set, lexicon, acoustic models, Gaussian 
+	selection/quantization, language model, decoding network and acoustic look-ahead models). It is loaded 
+	once and any number of sessions can be created from it, each session can be used from a different 
+	thread. Sessions need to be destroyed before the engine is uninitialized.
 */
 
 #ifdef _MSC_VER
-class extern "C" __declspec(dllexport) BaviecaAPI {
+class extern "C" __declspec(dllexport) BaviecaEngine {
 #elif defined __linux__ || defined __APPLE__ || __MINGW32__ || defined SWIG
-class BaviecaAPI {
+class BaviecaEngine {
 #endif
 
+	friend class BaviecaSession;
+
 	private:
 	
 		unsigned char m_iFlags;					// initialization mode
@@ -79,17 +103,218 @@ class BaviecaAPI {
 		bool m_bInitialized;
 		
 		ConfigurationBavieca *m_configuration;
+		ConfigurationFeatures *m_configurationFeatures;
 		PhoneSet *m_phoneSet;
 		LexiconManager *m_lexiconManager;
-		SADModule *m_sadModule;
 		HMMManager *m_hmmManager;
-		FeatureExtractor *m_featureExtractor;
+		GaussianSelector *m_gaussianSelector;
+		GaussianQuantizer *m_gaussianQuantizer;
 		LMManager *m_lmManager;
-		ViterbiX *m_viterbiX;
 		DynamicNetworkX *m_network;
 		NetworkBuilderX *m_networkBuilder;
-		DynamicDecoderX *m_dynamicDecoder;
+		AcousticLookAhead *m_acousticLookAhead;	// phone models for the acoustic look-ahead
 		bool m_bLatticeGeneration;
+		bool m_bConfusionNetwork;				// whether hypotheses come from a confusion network (MBR)
+		
+		// feature extraction
+		float m_fWarpFactor;
+		int m_iCepstralNormalizationBufferSize;
+		int m_iCepstralNormalizationMode;
+		int m_iCepstralNormalizationMethod;
+		int m_iFeatureDim;
+		
+		// HMM-states keep a cache of the last emission probability computed, the lock serializes the 
+		// sessions that need it (forced alignment, lattice alignment and decoding with Gaussian selection or 
+		// quantization), regular decoding goes through an emission cache owned by the session
+	#if defined __linux__ || defined __APPLE__ || __MINGW32__
+		pthread_mutex_t m_mutex;
+	#endif
+		
+		// lock the HMMs
+		inline void lock() {
+		
+		#if defined __linux__ || defined __APPLE__ || __MINGW32__
+			pthread_mutex_lock(&m_mutex);
+		#endif
+		}
+		
+		// unlock the HMMs
+		inline void unlock() {
+		
+		#if defined __linux__ || defined __APPLE__ || __MINGW32__
+			pthread_mutex_unlock(&m_mutex);
+		#endif
+		}
+
+	public:
+
+		// constructor (receives default configuration parameters)
+		BaviecaEngine(const char *strFileConfiguration);
+
+		// destructor
+		~BaviecaEngine();
+		
+		// initialize the engine (overriding parameters as needed)
+		bool initialize(unsigned char iFlags, ParamValuesI *paramValues = NULL);
+		
+		// uninitialize the engine (all the sessions need to be destroyed first)
+		void uninitialize();
+		
+		// create a new session (NULL if it cannot be created), the caller is responsible for deleting it
+		BaviecaSession *createSession();
+		
+		// return feature dimensionality
+		int getFeatureDim();
+		
+		// return a word-level assessment given a hypothesis and a reference text
+		TextAlignmentI *getAssessment(HypothesisI *hypothesis, const char *strReference);
+};
+
+/**
+	@author daniel <dani.bolanos@gmail.com>
+	
+	Session: state of a single audio stream (feature extraction, speech activity detection, decoding and 
+	speaker adaptation). It only reads the resources of the engine, its memory is that of the feature 
+	extractor (cepstral normalization buffer), the SAD grid, the decoder (token tables sized by the pruning 
+	parameters, the LM look-ahead cache and the word-graph if lattices are generated), the emission cache 
+	(HMM-states x emission cache frames) and the acoustic look-ahead buffers (phones x look-ahead frames). 
+	The LM look-ahead cache is kept per session (not in the engine) because it is filled and recycled 
+	from the active tokens of the decoder, it takes a hash-table of 3 x maximum active tokens entries plus 
+	(vocabulary + look-ahead nodes) scores for each word-history cached. Online speaker adaptation loads 
+	a private copy of the acoustic models. A session must be used from a single thread at a time.
+*/
+
+#ifdef _MSC_VER
+class extern "C" __declspec(dllexport) BaviecaSession {
+#elif defined __linux__ || defined __APPLE__ || __MINGW32__ || defined SWIG
+class BaviecaSession {
+#endif
+
+	friend class BaviecaEngine;
+
+	private:
+	
+		BaviecaEngine *m_engine;				// engine the session was created from
+		FeatureExtractor *m_featureExtractor;
+		SADModule *m_sadModule;
+		ViterbiX *m_viterbiX;
+		DynamicDecoderX *m_dynamicDecoder;
+		EmissionCache *m_emissionCache;
+		AcousticLookAhead *m_acousticLookAhead;
+		OnlineFMLLR *m_onlineFMLLR;
+		Transform *m_transformUtterance;		// feature transform for the current utterance (speaker adaptation)
+		PerformanceProfile *m_profile;			// performance counters and timers of the current utterance
+		string m_strProfile;						// profile of the last utterance (JSON)
+		Viterbi *m_viterbi;						// lattice aligner (confusion networks)
+		vector<float> m_vFeaturesUtterance;	// features of the current utterance (lattice alignment)
+		bool m_bLockDecoding;					// whether decoding uses the cache of the HMM-states
+		int m_iFrameSpeechStart;				// start of the speech segment in progress (SAD)
+		
+		// constructor (sessions are created by the engine)
+		BaviecaSession(BaviecaEngine *engine);
+		
+		// create the per-stream objects
+		void initialize();
+		
+		// return the minimum Bayes risk hypothesis from the lattice of the utterance (NULL if posteriors 
+		// cannot be computed), the lattice is modified
+		BestPath *getBestPathMBR(HypothesisLattice *hypothesisLattice);
+		
+		// decode feature vectors (serialized with the other sessions if the HMM-states keep the scores)
+		void decode(MatrixBase<float> &mFeatures);
+
+	public:
+
+		// destructor
+		~BaviecaSession();
+		
+		// FEATURE EXTRACTION -------------------------------------------------------------------------------------
+		
+		// extract features from the audio
+		float *extractFeatures(short *sSamples, unsigned int iSamples, unsigned int *iFeatures);
+		
+		// extract features from the audio into a caller-provided buffer (getFeatureDim() floats per feature 
+		// vector), return the number of feature vectors extracted or -1 if they do not fit in the buffer
+		int extractFeatures(short *sSamplesBuffer, unsigned int iSamples, float *fFeaturesBuffer, 
+			unsigned int iFeaturesBuffer);
+		
+		// return the maximum number of feature vectors that can be extracted from the given audio
+		unsigned int getFeatureVectorsMax(unsigned int iSamples);
+		
+		// return feature dimensionality
+		int getFeatureDim();
+		
+		// free features extracted using extractFeatures(...)
+		void free(float *fFeatures);
+		
+		// SPEECH ACTIVITY DETECTION ------------------------------------------------------------------------------
+		
+		// start a SAD session
+		void sadBeginSession();
+		
+		// terminate a SAD session
+		void sadEndSession();
+		
+		// proces the given features
+		void sadFeed(float *fFeatures, unsigned int iFeatures);
+		
+		// return the speech segments decided since the last call, a segment in progress is returned with 
+		// -1 as its end and returned again once its end is decided (NULL if there are no segments)
+		SpeechSegmentsI *sadGetSpeechSegments();
+		
+		// decide the remaining frames and return the speech segments not returned yet
+		SpeechSegmentsI *sadRecoverSpeechSegments();	
+		
+		// FORCED ALIGNMENT --------------------------------------------------------------------------------------
+		
+		// forced alignment between features and audio
+		AlignmentI *align(float *fFeatures, unsigned int iFeatures, const char *strText, bool bMultiplePronunciations);
+			
+		// DECODING ----------------------------------------------------------------------------------------------
+		
+		// signals beginning of utterance
+		void decBeginUtterance();
+		
+		// process feature vectors from an utterance
+		void decProcess(float *fFeatures, unsigned int iFeatures);
+		
+		// get decoding results
+		HypothesisI *decGetHypothesis(const char *strFileHypothesisLattice = NULL);
+		
+		// signals end of utterance
+		void decEndUtterance();
+		
+		// return the performance profile of the current utterance in JSON format (NULL if disabled)
+		const char *decGetProfile();
+		
+		// return a word-level assessment given a hypothesis and a reference text
+		TextAlignmentI *getAssessment(HypothesisI *hypothesis, const char *strReference);
+				
+		// SPEAKER ADAPTATION ------------------------------------------------------------------------------------
+		
+		// feed data into speaker adaptation
+		void mllrFeed(const char *strReference, float *fFeatures, unsigned int iFeatures);
+		
+		// adapt using fed adaptation data (the transform is used from the next utterance on)
+		void mllrAdapt();
+};
+
+/**
+	@author daniel <dani.bolanos@gmail.com>
+	
+	Single-stream API: an engine with one session.
+*/
+
+#ifdef _MSC_VER
+class extern "C" __declspec(dllexport) BaviecaAPI {
+#elif defined __linux__ || defined __APPLE__ || __MINGW32__ || defined SWIG
+class BaviecaAPI {
+#endif
+
+	private:
+	
+		BaviecaEngine *m_engine;
+		BaviecaSession *m_session;
 
 	public:
 
@@ -112,6 +337,14 @@ class BaviecaAPI {
 		// extract features from the audio
 		float *extractFeatures(short *sSamples, unsigned int iSamples, unsigned int *iFeatures);
 		
+		// extract features from the audio into a caller-provided buffer (getFeatureDim() floats per feature 
+		// vector), return the number of feature vectors extracted or -1 if they do not fit in the buffer
+		int extractFeatures(short *sSamplesBuffer, unsigned int iSamples, float *fFeaturesBuffer, 
+			unsigned int iFeaturesBuffer);
+		
+		// return the maximum number of feature vectors that can be extracted from the given audio
+		unsigned int getFeatureVectorsMax(unsigned int iSamples);
+		
 		// return feature dimensionality
 		int getFeatureDim();
 		
@@ -129,7 +362,11 @@ class BaviecaAPI {
 		// proces the given features
 		void sadFeed(float *fFeatures, unsigned int iFeatures);
 		
-		// recover speech segments by doing back-tracking on the grid
+		// return the speech segments decided since the last call, a segment in progress is returned with 
+		// -1 as its end and returned again once its end is decided (NULL if there are no segments)
+		SpeechSegmentsI *sadGetSpeechSegments();
+		
+		// decide the remaining frames and return the speech segments not returned yet
 		SpeechSegmentsI *sadRecoverSpeechSegments();	
 		
 		// FORCED ALIGNMENT --------------------------------------------------------------------------------------
@@ -151,6 +388,9 @@ class BaviecaAPI {
 		// signals end of utterance
 		void decEndUtterance();
 		
+		// return the performance profile of the current utterance in JSON format (NULL if disabled)
+		const char *decGetProfile();
+		
 		// return a word-level assessment given a hypothesis and a reference text
 		TextAlignmentI *getAssessment(HypothesisI *hypothesis, const char *strReference);
 				
@@ -159,7 +399,7 @@ class BaviecaAPI {
 		// feed data into speaker adaptation
 		void mllrFeed(const char *strReference, float *fFeatures, unsigned int iFeatures);
 		
-		// adapt current acoustic models using fed adaptation data
+		// adapt using fed adaptation data (the transform is used from the next utterance on)
 		void mllrAdapt();
 
 };
@@ -191,7 +431,7 @@ class SpeechSegmentI {
 
 class SpeechSegmentsI {
 
-	friend class BaviecaAPI;
+	friend class BaviecaSession;
 
 	private: 
 
@@ -287,14 +527,16 @@ class WordHypothesisI {
 		string m_strWord;
 		int m_iFrameStart;
 		int m_iFrameEnd;
+		float m_fConfidence;
 
 	public:
 
-		WordHypothesisI(const char *strWord, int iFrameStart, int iFrameEnd) {
+		WordHypothesisI(const char *strWord, int iFrameStart, int iFrameEnd, float fConfidence = -1.0) {
 
 			m_strWord = (strWord) ? strWord : "";
 			m_iFrameStart = iFrameStart;
 			m_iFrameEnd = iFrameEnd;
+			m_fConfidence = fConfidence;
 		}
 
 		~WordHypothesisI() {
@@ -309,18 +551,29 @@ class WordHypothesisI {
 		int getFrameEnd() {
 			return m_iFrameEnd;
 		}
+		// posterior probability of the word (-1.0 if the hypothesis does not come from a confusion network)
+		float getConfidence() {
+			return m_fConfidence;
+		}
 };
 
 class HypothesisI {
 
-	friend class BaviecaAPI;
+	friend class BaviecaSession;
 
 	private: 
 
 		vector<WordHypothesisI*> m_vWordHypothesisI;
+		string m_strText;
 
 		HypothesisI(vector<WordHypothesisI*> &vWordHypothesisI) {			
 			m_vWordHypothesisI.assign(vWordHypothesisI.begin(),vWordHypothesisI.end());
+			for(vector<WordHypothesisI*>::iterator it = m_vWordHypothesisI.begin() ; it != m_vWordHypothesisI.end() ; ++it) {
+				if (it != m_vWordHypothesisI.begin()) {
+					m_strText += " ";
+				}
+				m_strText += (*it)->getWord();
+			}
 		}
 
 	public:
@@ -342,6 +595,26 @@ class HypothesisI {
 			}
 			return NULL;
 		}
+		
+		// bulk accessors (a single call retrieves the whole hypothesis)
+		
+		// words separated by spaces
+		const char *getText() {
+			return m_strText.c_str();
+		}
+		// start and end frame of each word (the buffer must hold 2*size() elements)
+		void getFrames(int *iFramesBuffer) {
+			for(unsigned int i=0 ; i < size() ; ++i) {
+				iFramesBuffer[2*i] = m_vWordHypothesisI[i]->getFrameStart();
+				iFramesBuffer[2*i+1] = m_vWordHypothesisI[i]->getFrameEnd();
+			}
+		}
+		// confidence of each word (the buffer must hold size() elements)
+		void getConfidences(float *fConfidencesBuffer) {
+			for(unsigned int i=0 ; i < size() ; ++i) {
+				fConfidencesBuffer[i] = m_vWordHypothesisI[i]->getConfidence();
+			}
+		}
 };
 
 // phone alignment
@@ -376,7 +649,7 @@ class PhoneAlignmentI {
 class WordAlignmentI {
 
 	friend class AlignmentI;
-	friend class BaviecaAPI;
+	friend class BaviecaSession;
 
 	private:
 
@@ -424,7 +697,7 @@ class WordAlignmentI {
 
 class AlignmentI {
 
-	friend class BaviecaAPI;
+	friend class BaviecaSession;
 
 	private:
 
@@ -497,7 +770,7 @@ class TextAlignmentElementI {
 // text alignment
 class TextAlignmentI {
 
-	friend class BaviecaAPI;
+	friend class BaviecaEngine;
 
 	private:
 
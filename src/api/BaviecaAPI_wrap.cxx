@@ -212,6 +212,13 @@ static void SWIGUNUSED SWIG_JavaThrowException(JNIEnv *jenv, SWIG_JavaExceptionC
 
 #include "BaviecaAPI.h"
 
+SWIGINTERN void Bavieca_BaviecaSession_decProcessBuffer(Bavieca::BaviecaSession *self,float *fFeaturesBuffer,unsigned int iFeatures){
+    self->decProcess(fFeaturesBuffer,iFeatures);
+  }
+SWIGINTERN void Bavieca_BaviecaAPI_decProcessBuffer(Bavieca::BaviecaAPI *self,float *fFeaturesBuffer,unsigned int iFeatures){
+    self->decProcess(fFeaturesBuffer,iFeatures);
+  }
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -235,81 +242,704 @@ SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_INIT_1ALIGNER_1get(
   
   (void)jenv;
   (void)jcls;
-  result = (int)Bavieca::INIT_ALIGNER;
-  jresult = (jint)result; 
+  result = (int)Bavieca::INIT_ALIGNER;
+  jresult = (jint)result; 
+  return jresult;
+}
+
+
+SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_INIT_1DECODER_1get(JNIEnv *jenv, jclass jcls) {
+  jint jresult = 0 ;
+  int result;
+  
+  (void)jenv;
+  (void)jcls;
+  result = (int)Bavieca::INIT_DECODER;
+  jresult = (jint)result; 
+  return jresult;
+}
+
+
+SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_INIT_1ADAPTATION_1get(JNIEnv *jenv, jclass jcls) {
+  jint jresult = 0 ;
+  int result;
+  
+  (void)jenv;
+  (void)jcls;
+  result = (int)Bavieca::INIT_ADAPTATION;
+  jresult = (jint)result; 
+  return jresult;
+}
+
+
+SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_TAE_1CORRECT_1get(JNIEnv *jenv, jclass jcls) {
+  jint jresult = 0 ;
+  int result;
+  
+  (void)jenv;
+  (void)jcls;
+  result = (int)Bavieca::TAE_CORRECT;
+  jresult = (jint)result; 
+  return jresult;
+}
+
+
+SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_TAE_1SUBSTITUTION_1get(JNIEnv *jenv, jclass jcls) {
+  jint jresult = 0 ;
+  int result;
+  
+  (void)jenv;
+  (void)jcls;
+  result = (int)Bavieca::TAE_SUBSTITUTION;
+  jresult = (jint)result; 
+  return jresult;
+}
+
+
+SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_TAE_1DELETION_1get(JNIEnv *jenv, jclass jcls) {
+  jint jresult = 0 ;
+  int result;
+  
+  (void)jenv;
+  (void)jcls;
+  result = (int)Bavieca::TAE_DELETION;
+  jresult = (jint)result; 
+  return jresult;
+}
+
+
+SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_TAE_1INSERTION_1get(JNIEnv *jenv, jclass jcls) {
+  jint jresult = 0 ;
+  int result;
+  
+  (void)jenv;
+  (void)jcls;
+  result = (int)Bavieca::TAE_INSERTION;
+  jresult = (jint)result; 
+  return jresult;
+}
+
+
+SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_new_1BaviecaEngine(JNIEnv *jenv, jclass jcls, jstring jarg1) {
+  jlong jresult = 0 ;
+  char *arg1 = (char *) 0 ;
+  Bavieca::BaviecaEngine *result = 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  arg1 = 0;
+  if (jarg1) {
+    arg1 = (char *)jenv->GetStringUTFChars(jarg1, 0);
+    if (!arg1) return 0;
+  }
+  result = (Bavieca::BaviecaEngine *)new Bavieca::BaviecaEngine((char const *)arg1);
+  *(Bavieca::BaviecaEngine **)&jresult = result; 
+  if (arg1) jenv->ReleaseStringUTFChars(jarg1, (const char *)arg1);
+  return jresult;
+}
+
+
+SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_delete_1BaviecaEngine(JNIEnv *jenv, jclass jcls, jlong jarg1) {
+  Bavieca::BaviecaEngine *arg1 = (Bavieca::BaviecaEngine *) 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  arg1 = *(Bavieca::BaviecaEngine **)&jarg1; 
+  delete arg1;
+}
+
+
+SWIGEXPORT jboolean JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaEngine_1initialize_1_1SWIG_10(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jshort jarg2, jlong jarg3, jobject jarg3_) {
+  jboolean jresult = 0 ;
+  Bavieca::BaviecaEngine *arg1 = (Bavieca::BaviecaEngine *) 0 ;
+  unsigned char arg2 ;
+  Bavieca::ParamValuesI *arg3 = (Bavieca::ParamValuesI *) 0 ;
+  bool result;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  (void)jarg3_;
+  arg1 = *(Bavieca::BaviecaEngine **)&jarg1; 
+  arg2 = (unsigned char)jarg2; 
+  arg3 = *(Bavieca::ParamValuesI **)&jarg3; 
+  result = (bool)(arg1)->initialize(arg2,arg3);
+  jresult = (jboolean)result; 
+  return jresult;
+}
+
+
+SWIGEXPORT jboolean JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaEngine_1initialize_1_1SWIG_11(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jshort jarg2) {
+  jboolean jresult = 0 ;
+  Bavieca::BaviecaEngine *arg1 = (Bavieca::BaviecaEngine *) 0 ;
+  unsigned char arg2 ;
+  bool result;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaEngine **)&jarg1; 
+  arg2 = (unsigned char)jarg2; 
+  result = (bool)(arg1)->initialize(arg2);
+  jresult = (jboolean)result; 
+  return jresult;
+}
+
+
+SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaEngine_1uninitialize(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
+  Bavieca::BaviecaEngine *arg1 = (Bavieca::BaviecaEngine *) 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaEngine **)&jarg1; 
+  (arg1)->uninitialize();
+}
+
+
+SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaEngine_1createSession(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
+  jlong jresult = 0 ;
+  Bavieca::BaviecaEngine *arg1 = (Bavieca::BaviecaEngine *) 0 ;
+  Bavieca::BaviecaSession *result = 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaEngine **)&jarg1; 
+  result = (Bavieca::BaviecaSession *)(arg1)->createSession();
+  *(Bavieca::BaviecaSession **)&jresult = result; 
+  return jresult;
+}
+
+
+SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaEngine_1getFeatureDim(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
+  jint jresult = 0 ;
+  Bavieca::BaviecaEngine *arg1 = (Bavieca::BaviecaEngine *) 0 ;
+  int result;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaEngine **)&jarg1; 
+  result = (int)(arg1)->getFeatureDim();
+  jresult = (jint)result; 
+  return jresult;
+}
+
+
+SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaEngine_1getAssessment(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jlong jarg2, jobject jarg2_, jstring jarg3) {
+  jlong jresult = 0 ;
+  Bavieca::BaviecaEngine *arg1 = (Bavieca::BaviecaEngine *) 0 ;
+  Bavieca::HypothesisI *arg2 = (Bavieca::HypothesisI *) 0 ;
+  char *arg3 = (char *) 0 ;
+  Bavieca::TextAlignmentI *result = 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  (void)jarg2_;
+  arg1 = *(Bavieca::BaviecaEngine **)&jarg1; 
+  arg2 = *(Bavieca::HypothesisI **)&jarg2; 
+  arg3 = 0;
+  if (jarg3) {
+    arg3 = (char *)jenv->GetStringUTFChars(jarg3, 0);
+    if (!arg3) return 0;
+  }
+  result = (Bavieca::TextAlignmentI *)(arg1)->getAssessment(arg2,(char const *)arg3);
+  *(Bavieca::TextAlignmentI **)&jresult = result; 
+  if (arg3) jenv->ReleaseStringUTFChars(jarg3, (const char *)arg3);
+  return jresult;
+}
+
+
+SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_delete_1BaviecaSession(JNIEnv *jenv, jclass jcls, jlong jarg1) {
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  delete arg1;
+}
+
+
+SWIGEXPORT jfloatArray JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1extractFeatures_1_1SWIG_10(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jshortArray jarg2, jlong jarg3, jlongArray jarg4) {
+  jfloatArray jresult = 0 ;
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  short *arg2 = (short *) 0 ;
+  unsigned int arg3 ;
+  unsigned int *arg4 = (unsigned int *) 0 ;
+  float *result = 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  {
+    if (!jarg2) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaNullPointerException, "array null");
+      return 0;
+    }
+    if (jenv->GetArrayLength(jarg2) == 0) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaIndexOutOfBoundsException, "Array must contain at least 1 element");
+      return 0;
+    }
+    arg2 = (short *) jenv->GetShortArrayElements(jarg2, 0); 
+  }
+  arg3 = (unsigned int)jarg3; 
+  {
+    if (!jarg4) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaNullPointerException, "array null");
+      return 0;
+    }
+    if (jenv->GetArrayLength(jarg4) == 0) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaIndexOutOfBoundsException, "Array must contain at least 1 element");
+      return 0;
+    }
+    arg4 = (unsigned int *) jenv->GetLongArrayElements(jarg4, 0); 
+  }
+  result = (float *)(arg1)->extractFeatures(arg2,arg3,arg4);
+  {
+    jresult = jenv->NewFloatArray((jsize)(*arg4*(arg1)->getFeatureDim()));
+    jenv->SetFloatArrayRegion(jresult, 0, (jsize)(*arg4*(arg1)->getFeatureDim()), result);
+    delete [] result;
+  }
+  {
+    jenv->ReleaseShortArrayElements(jarg2, (jshort *)arg2, 0); 
+  }
+  {
+    jenv->ReleaseLongArrayElements(jarg4, (jlong *)arg4, 0); 
+  }
+  
+  
+  return jresult;
+}
+
+
+SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1extractFeatures_1_1SWIG_11(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jobject jarg2, jlong jarg3, jobject jarg4, jlong jarg5) {
+  jint jresult = 0 ;
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  short *arg2 = (short *) 0 ;
+  unsigned int arg3 ;
+  float *arg4 = (float *) 0 ;
+  unsigned int arg5 ;
+  int result;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  arg2 = (short *)jenv->GetDirectBufferAddress(jarg2);
+  if (arg2 == NULL) {
+    SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "a direct buffer is required");
+    return 0;
+  }
+  jlong sSamplesBuffer_capacity = jenv->GetDirectBufferCapacity(jarg2);
+  arg3 = (unsigned int)jarg3; 
+  arg4 = (float *)jenv->GetDirectBufferAddress(jarg4);
+  if (arg4 == NULL) {
+    SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "a direct buffer is required");
+    return 0;
+  }
+  jlong fFeaturesBuffer_capacity = jenv->GetDirectBufferCapacity(jarg4);
+  arg5 = (unsigned int)jarg5; 
+  {
+    if (sSamplesBuffer_capacity < (jlong)(arg3*sizeof(short))) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "insufficient room in the samples buffer");
+      return 0;
+    }
+  }
+  {
+    if (fFeaturesBuffer_capacity < (jlong)arg5*(arg1)->getFeatureDim()) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "insufficient room in the features buffer");
+      return 0;
+    }
+  }
+  result = (int)(arg1)->extractFeatures(arg2,arg3,arg4,arg5);
+  jresult = (jint)result; 
+  return jresult;
+}
+
+
+SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1getFeatureVectorsMax(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jlong jarg2) {
+  jlong jresult = 0 ;
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  unsigned int arg2 ;
+  unsigned int result;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  arg2 = (unsigned int)jarg2; 
+  result = (unsigned int)(arg1)->getFeatureVectorsMax(arg2);
+  jresult = (jlong)result; 
+  return jresult;
+}
+
+
+SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1getFeatureDim(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
+  jint jresult = 0 ;
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  int result;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  result = (int)(arg1)->getFeatureDim();
+  jresult = (jint)result; 
+  return jresult;
+}
+
+
+SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1free(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jfloatArray jarg2) {
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  float *arg2 = (float *) 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  {
+    if (!jarg2) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaNullPointerException, "array null");
+      return ;
+    }
+    if (jenv->GetArrayLength(jarg2) == 0) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaIndexOutOfBoundsException, "Array must contain at least 1 element");
+      return ;
+    }
+    arg2 = (float *) jenv->GetFloatArrayElements(jarg2, 0); 
+  }
+  (arg1)->free(arg2);
+  {
+    jenv->ReleaseFloatArrayElements(jarg2, (jfloat *)arg2, 0); 
+  }
+  
+}
+
+
+SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1sadBeginSession(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  (arg1)->sadBeginSession();
+}
+
+
+SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1sadEndSession(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  (arg1)->sadEndSession();
+}
+
+
+SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1sadFeed(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jfloatArray jarg2, jlong jarg3) {
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  float *arg2 = (float *) 0 ;
+  unsigned int arg3 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  {
+    if (!jarg2) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaNullPointerException, "array null");
+      return ;
+    }
+    if (jenv->GetArrayLength(jarg2) == 0) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaIndexOutOfBoundsException, "Array must contain at least 1 element");
+      return ;
+    }
+    arg2 = (float *) jenv->GetFloatArrayElements(jarg2, 0); 
+  }
+  arg3 = (unsigned int)jarg3; 
+  (arg1)->sadFeed(arg2,arg3);
+  {
+    jenv->ReleaseFloatArrayElements(jarg2, (jfloat *)arg2, 0); 
+  }
+  
+}
+
+
+SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1sadGetSpeechSegments(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
+  jlong jresult = 0 ;
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  Bavieca::SpeechSegmentsI *result = 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  result = (Bavieca::SpeechSegmentsI *)(arg1)->sadGetSpeechSegments();
+  *(Bavieca::SpeechSegmentsI **)&jresult = result; 
+  return jresult;
+}
+
+
+SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1sadRecoverSpeechSegments(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
+  jlong jresult = 0 ;
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  Bavieca::SpeechSegmentsI *result = 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  result = (Bavieca::SpeechSegmentsI *)(arg1)->sadRecoverSpeechSegments();
+  *(Bavieca::SpeechSegmentsI **)&jresult = result; 
+  return jresult;
+}
+
+
+SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1align(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jfloatArray jarg2, jlong jarg3, jstring jarg4, jboolean jarg5) {
+  jlong jresult = 0 ;
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  float *arg2 = (float *) 0 ;
+  unsigned int arg3 ;
+  char *arg4 = (char *) 0 ;
+  bool arg5 ;
+  Bavieca::AlignmentI *result = 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  {
+    if (!jarg2) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaNullPointerException, "array null");
+      return 0;
+    }
+    if (jenv->GetArrayLength(jarg2) == 0) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaIndexOutOfBoundsException, "Array must contain at least 1 element");
+      return 0;
+    }
+    arg2 = (float *) jenv->GetFloatArrayElements(jarg2, 0); 
+  }
+  arg3 = (unsigned int)jarg3; 
+  arg4 = 0;
+  if (jarg4) {
+    arg4 = (char *)jenv->GetStringUTFChars(jarg4, 0);
+    if (!arg4) return 0;
+  }
+  arg5 = jarg5 ? true : false; 
+  result = (Bavieca::AlignmentI *)(arg1)->align(arg2,arg3,(char const *)arg4,arg5);
+  *(Bavieca::AlignmentI **)&jresult = result; 
+  {
+    jenv->ReleaseFloatArrayElements(jarg2, (jfloat *)arg2, 0); 
+  }
+  
+  if (arg4) jenv->ReleaseStringUTFChars(jarg4, (const char *)arg4);
+  return jresult;
+}
+
+
+SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1decBeginUtterance(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  (arg1)->decBeginUtterance();
+}
+
+
+SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1decProcess(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jfloatArray jarg2, jlong jarg3) {
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  float *arg2 = (float *) 0 ;
+  unsigned int arg3 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  {
+    if (!jarg2) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaNullPointerException, "array null");
+      return ;
+    }
+    if (jenv->GetArrayLength(jarg2) == 0) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaIndexOutOfBoundsException, "Array must contain at least 1 element");
+      return ;
+    }
+    arg2 = (float *) jenv->GetFloatArrayElements(jarg2, 0); 
+  }
+  arg3 = (unsigned int)jarg3; 
+  (arg1)->decProcess(arg2,arg3);
+  {
+    jenv->ReleaseFloatArrayElements(jarg2, (jfloat *)arg2, 0); 
+  }
+  
+}
+
+
+SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1decGetHypothesis_1_1SWIG_10(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jstring jarg2) {
+  jlong jresult = 0 ;
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  char *arg2 = (char *) 0 ;
+  Bavieca::HypothesisI *result = 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  arg2 = 0;
+  if (jarg2) {
+    arg2 = (char *)jenv->GetStringUTFChars(jarg2, 0);
+    if (!arg2) return 0;
+  }
+  result = (Bavieca::HypothesisI *)(arg1)->decGetHypothesis((char const *)arg2);
+  *(Bavieca::HypothesisI **)&jresult = result; 
+  if (arg2) jenv->ReleaseStringUTFChars(jarg2, (const char *)arg2);
+  return jresult;
+}
+
+
+SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1decGetHypothesis_1_1SWIG_11(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
+  jlong jresult = 0 ;
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  Bavieca::HypothesisI *result = 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  result = (Bavieca::HypothesisI *)(arg1)->decGetHypothesis();
+  *(Bavieca::HypothesisI **)&jresult = result; 
   return jresult;
 }
 
 
-SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_INIT_1DECODER_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  int result;
+SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1decEndUtterance(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
   
   (void)jenv;
   (void)jcls;
-  result = (int)Bavieca::INIT_DECODER;
-  jresult = (jint)result; 
-  return jresult;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  (arg1)->decEndUtterance();
 }
 
 
-SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_INIT_1ADAPTATION_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  int result;
+SWIGEXPORT jstring JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1decGetProfile(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
+  jstring jresult = 0 ;
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  char *result = 0 ;
   
   (void)jenv;
   (void)jcls;
-  result = (int)Bavieca::INIT_ADAPTATION;
-  jresult = (jint)result; 
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  result = (char *)(arg1)->decGetProfile();
+  if(result) jresult = jenv->NewStringUTF((const char *)result);
   return jresult;
 }
 
 
-SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_TAE_1CORRECT_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  int result;
+SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1getAssessment(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jlong jarg2, jobject jarg2_, jstring jarg3) {
+  jlong jresult = 0 ;
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  Bavieca::HypothesisI *arg2 = (Bavieca::HypothesisI *) 0 ;
+  char *arg3 = (char *) 0 ;
+  Bavieca::TextAlignmentI *result = 0 ;
   
   (void)jenv;
   (void)jcls;
-  result = (int)Bavieca::TAE_CORRECT;
-  jresult = (jint)result; 
+  (void)jarg1_;
+  (void)jarg2_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  arg2 = *(Bavieca::HypothesisI **)&jarg2; 
+  arg3 = 0;
+  if (jarg3) {
+    arg3 = (char *)jenv->GetStringUTFChars(jarg3, 0);
+    if (!arg3) return 0;
+  }
+  result = (Bavieca::TextAlignmentI *)(arg1)->getAssessment(arg2,(char const *)arg3);
+  *(Bavieca::TextAlignmentI **)&jresult = result; 
+  if (arg3) jenv->ReleaseStringUTFChars(jarg3, (const char *)arg3);
   return jresult;
 }
 
 
-SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_TAE_1SUBSTITUTION_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  int result;
+SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1mllrFeed(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jstring jarg2, jfloatArray jarg3, jlong jarg4) {
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  char *arg2 = (char *) 0 ;
+  float *arg3 = (float *) 0 ;
+  unsigned int arg4 ;
   
   (void)jenv;
   (void)jcls;
-  result = (int)Bavieca::TAE_SUBSTITUTION;
-  jresult = (jint)result; 
-  return jresult;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  arg2 = 0;
+  if (jarg2) {
+    arg2 = (char *)jenv->GetStringUTFChars(jarg2, 0);
+    if (!arg2) return ;
+  }
+  {
+    if (!jarg3) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaNullPointerException, "array null");
+      return ;
+    }
+    if (jenv->GetArrayLength(jarg3) == 0) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaIndexOutOfBoundsException, "Array must contain at least 1 element");
+      return ;
+    }
+    arg3 = (float *) jenv->GetFloatArrayElements(jarg3, 0); 
+  }
+  arg4 = (unsigned int)jarg4; 
+  (arg1)->mllrFeed((char const *)arg2,arg3,arg4);
+  {
+    jenv->ReleaseFloatArrayElements(jarg3, (jfloat *)arg3, 0); 
+  }
+  if (arg2) jenv->ReleaseStringUTFChars(jarg2, (const char *)arg2);
+  
 }
 
 
-SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_TAE_1DELETION_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  int result;
+SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1mllrAdapt(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
   
   (void)jenv;
   (void)jcls;
-  result = (int)Bavieca::TAE_DELETION;
-  jresult = (jint)result; 
-  return jresult;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  (arg1)->mllrAdapt();
 }
 
 
-SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_TAE_1INSERTION_1get(JNIEnv *jenv, jclass jcls) {
-  jint jresult = 0 ;
-  int result;
+SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaSession_1decProcessBuffer(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jobject jarg2, jlong jarg3) {
+  Bavieca::BaviecaSession *arg1 = (Bavieca::BaviecaSession *) 0 ;
+  float *arg2 = (float *) 0 ;
+  unsigned int arg3 ;
   
   (void)jenv;
   (void)jcls;
-  result = (int)Bavieca::TAE_INSERTION;
-  jresult = (jint)result; 
-  return jresult;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaSession **)&jarg1; 
+  arg2 = (float *)jenv->GetDirectBufferAddress(jarg2);
+  if (arg2 == NULL) {
+    SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "a direct buffer is required");
+    return ;
+  }
+  jlong fFeaturesBuffer_capacity = jenv->GetDirectBufferCapacity(jarg2);
+  arg3 = (unsigned int)jarg3; 
+  {
+    if (fFeaturesBuffer_capacity < (jlong)arg3*(arg1)->getFeatureDim()) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "insufficient room in the features buffer");
+      return ;
+    }
+  }
+  Bavieca_BaviecaSession_decProcessBuffer(arg1,arg2,arg3);
 }
 
 
@@ -390,7 +1020,7 @@ SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaAPI_1uniniti
 }
 
 
-SWIGEXPORT jfloatArray JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaAPI_1extractFeatures(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jshortArray jarg2, jlong jarg3, jlongArray jarg4) {
+SWIGEXPORT jfloatArray JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaAPI_1extractFeatures_1_1SWIG_10(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jshortArray jarg2, jlong jarg3, jlongArray jarg4) {
   jfloatArray jresult = 0 ;
   Bavieca::BaviecaAPI *arg1 = (Bavieca::BaviecaAPI *) 0 ;
   short *arg2 = (short *) 0 ;
@@ -443,6 +1073,68 @@ SWIGEXPORT jfloatArray JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaAPI_1
 }
 
 
+SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaAPI_1extractFeatures_1_1SWIG_11(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jobject jarg2, jlong jarg3, jobject jarg4, jlong jarg5) {
+  jint jresult = 0 ;
+  Bavieca::BaviecaAPI *arg1 = (Bavieca::BaviecaAPI *) 0 ;
+  short *arg2 = (short *) 0 ;
+  unsigned int arg3 ;
+  float *arg4 = (float *) 0 ;
+  unsigned int arg5 ;
+  int result;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaAPI **)&jarg1; 
+  arg2 = (short *)jenv->GetDirectBufferAddress(jarg2);
+  if (arg2 == NULL) {
+    SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "a direct buffer is required");
+    return 0;
+  }
+  jlong sSamplesBuffer_capacity = jenv->GetDirectBufferCapacity(jarg2);
+  arg3 = (unsigned int)jarg3; 
+  arg4 = (float *)jenv->GetDirectBufferAddress(jarg4);
+  if (arg4 == NULL) {
+    SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "a direct buffer is required");
+    return 0;
+  }
+  jlong fFeaturesBuffer_capacity = jenv->GetDirectBufferCapacity(jarg4);
+  arg5 = (unsigned int)jarg5; 
+  {
+    if (sSamplesBuffer_capacity < (jlong)(arg3*sizeof(short))) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "insufficient room in the samples buffer");
+      return 0;
+    }
+  }
+  {
+    if (fFeaturesBuffer_capacity < (jlong)arg5*(arg1)->getFeatureDim()) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "insufficient room in the features buffer");
+      return 0;
+    }
+  }
+  result = (int)(arg1)->extractFeatures(arg2,arg3,arg4,arg5);
+  jresult = (jint)result; 
+  return jresult;
+}
+
+
+SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaAPI_1getFeatureVectorsMax(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jlong jarg2) {
+  jlong jresult = 0 ;
+  Bavieca::BaviecaAPI *arg1 = (Bavieca::BaviecaAPI *) 0 ;
+  unsigned int arg2 ;
+  unsigned int result;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaAPI **)&jarg1; 
+  arg2 = (unsigned int)jarg2; 
+  result = (unsigned int)(arg1)->getFeatureVectorsMax(arg2);
+  jresult = (jlong)result; 
+  return jresult;
+}
+
+
 SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaAPI_1getFeatureDim(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
   jint jresult = 0 ;
   Bavieca::BaviecaAPI *arg1 = (Bavieca::BaviecaAPI *) 0 ;
@@ -536,6 +1228,21 @@ SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaAPI_1sadFeed
 }
 
 
+SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaAPI_1sadGetSpeechSegments(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
+  jlong jresult = 0 ;
+  Bavieca::BaviecaAPI *arg1 = (Bavieca::BaviecaAPI *) 0 ;
+  Bavieca::SpeechSegmentsI *result = 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaAPI **)&jarg1; 
+  result = (Bavieca::SpeechSegmentsI *)(arg1)->sadGetSpeechSegments();
+  *(Bavieca::SpeechSegmentsI **)&jresult = result; 
+  return jresult;
+}
+
+
 SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaAPI_1sadRecoverSpeechSegments(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
   jlong jresult = 0 ;
   Bavieca::BaviecaAPI *arg1 = (Bavieca::BaviecaAPI *) 0 ;
@@ -681,6 +1388,21 @@ SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaAPI_1decEndU
 }
 
 
+SWIGEXPORT jstring JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaAPI_1decGetProfile(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
+  jstring jresult = 0 ;
+  Bavieca::BaviecaAPI *arg1 = (Bavieca::BaviecaAPI *) 0 ;
+  char *result = 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaAPI **)&jarg1; 
+  result = (char *)(arg1)->decGetProfile();
+  if(result) jresult = jenv->NewStringUTF((const char *)result);
+  return jresult;
+}
+
+
 SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaAPI_1getAssessment(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jlong jarg2, jobject jarg2_, jstring jarg3) {
   jlong jresult = 0 ;
   Bavieca::BaviecaAPI *arg1 = (Bavieca::BaviecaAPI *) 0 ;
@@ -753,6 +1475,32 @@ SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaAPI_1mllrAda
 }
 
 
+SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_BaviecaAPI_1decProcessBuffer(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jobject jarg2, jlong jarg3) {
+  Bavieca::BaviecaAPI *arg1 = (Bavieca::BaviecaAPI *) 0 ;
+  float *arg2 = (float *) 0 ;
+  unsigned int arg3 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::BaviecaAPI **)&jarg1; 
+  arg2 = (float *)jenv->GetDirectBufferAddress(jarg2);
+  if (arg2 == NULL) {
+    SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "a direct buffer is required");
+    return ;
+  }
+  jlong fFeaturesBuffer_capacity = jenv->GetDirectBufferCapacity(jarg2);
+  arg3 = (unsigned int)jarg3; 
+  {
+    if (fFeaturesBuffer_capacity < (jlong)arg3*(arg1)->getFeatureDim()) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "insufficient room in the features buffer");
+      return ;
+    }
+  }
+  Bavieca_BaviecaAPI_decProcessBuffer(arg1,arg2,arg3);
+}
+
+
 SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_new_1SpeechSegmentI(JNIEnv *jenv, jclass jcls, jint jarg1, jint jarg2) {
   jlong jresult = 0 ;
   int arg1 ;
@@ -959,7 +1707,32 @@ SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_ParamValuesI_1getP
 }
 
 
-SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_new_1WordHypothesisI(JNIEnv *jenv, jclass jcls, jstring jarg1, jint jarg2, jint jarg3) {
+SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_new_1WordHypothesisI_1_1SWIG_10(JNIEnv *jenv, jclass jcls, jstring jarg1, jint jarg2, jint jarg3, jfloat jarg4) {
+  jlong jresult = 0 ;
+  char *arg1 = (char *) 0 ;
+  int arg2 ;
+  int arg3 ;
+  float arg4 ;
+  Bavieca::WordHypothesisI *result = 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  arg1 = 0;
+  if (jarg1) {
+    arg1 = (char *)jenv->GetStringUTFChars(jarg1, 0);
+    if (!arg1) return 0;
+  }
+  arg2 = (int)jarg2; 
+  arg3 = (int)jarg3; 
+  arg4 = (float)jarg4; 
+  result = (Bavieca::WordHypothesisI *)new Bavieca::WordHypothesisI((char const *)arg1,arg2,arg3,arg4);
+  *(Bavieca::WordHypothesisI **)&jresult = result; 
+  if (arg1) jenv->ReleaseStringUTFChars(jarg1, (const char *)arg1);
+  return jresult;
+}
+
+
+SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_new_1WordHypothesisI_1_1SWIG_11(JNIEnv *jenv, jclass jcls, jstring jarg1, jint jarg2, jint jarg3) {
   jlong jresult = 0 ;
   char *arg1 = (char *) 0 ;
   int arg2 ;
@@ -1037,6 +1810,21 @@ SWIGEXPORT jint JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_WordHypothesisI_1ge
 }
 
 
+SWIGEXPORT jfloat JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_WordHypothesisI_1getConfidence(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
+  jfloat jresult = 0 ;
+  Bavieca::WordHypothesisI *arg1 = (Bavieca::WordHypothesisI *) 0 ;
+  float result;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::WordHypothesisI **)&jarg1; 
+  result = (float)(arg1)->getConfidence();
+  jresult = (jfloat)result; 
+  return jresult;
+}
+
+
 SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_delete_1HypothesisI(JNIEnv *jenv, jclass jcls, jlong jarg1) {
   Bavieca::HypothesisI *arg1 = (Bavieca::HypothesisI *) 0 ;
   
@@ -1079,6 +1867,69 @@ SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_HypothesisI_1getWo
 }
 
 
+SWIGEXPORT jstring JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_HypothesisI_1getText(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_) {
+  jstring jresult = 0 ;
+  Bavieca::HypothesisI *arg1 = (Bavieca::HypothesisI *) 0 ;
+  char *result = 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::HypothesisI **)&jarg1; 
+  result = (char *)(arg1)->getText();
+  if(result) jresult = jenv->NewStringUTF((const char *)result);
+  return jresult;
+}
+
+
+SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_HypothesisI_1getFrames(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jobject jarg2) {
+  Bavieca::HypothesisI *arg1 = (Bavieca::HypothesisI *) 0 ;
+  int *arg2 = (int *) 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::HypothesisI **)&jarg1; 
+  arg2 = (int *)jenv->GetDirectBufferAddress(jarg2);
+  if (arg2 == NULL) {
+    SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "a direct buffer is required");
+    return ;
+  }
+  jlong iFramesBuffer_capacity = jenv->GetDirectBufferCapacity(jarg2);
+  {
+    if (iFramesBuffer_capacity < (jlong)(2*(arg1)->size())) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "insufficient room in the frames buffer");
+      return ;
+    }
+  }
+  (arg1)->getFrames(arg2);
+}
+
+
+SWIGEXPORT void JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_HypothesisI_1getConfidences(JNIEnv *jenv, jclass jcls, jlong jarg1, jobject jarg1_, jobject jarg2) {
+  Bavieca::HypothesisI *arg1 = (Bavieca::HypothesisI *) 0 ;
+  float *arg2 = (float *) 0 ;
+  
+  (void)jenv;
+  (void)jcls;
+  (void)jarg1_;
+  arg1 = *(Bavieca::HypothesisI **)&jarg1; 
+  arg2 = (float *)jenv->GetDirectBufferAddress(jarg2);
+  if (arg2 == NULL) {
+    SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "a direct buffer is required");
+    return ;
+  }
+  jlong fConfidencesBuffer_capacity = jenv->GetDirectBufferCapacity(jarg2);
+  {
+    if (fConfidencesBuffer_capacity < (jlong)(arg1)->size()) {
+      SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException, "insufficient room in the confidences buffer");
+      return ;
+    }
+  }
+  (arg1)->getConfidences(arg2);
+}
+
+
 SWIGEXPORT jlong JNICALL Java_blt_bavieca_BaviecaAPI_1SWIGJNI_new_1PhoneAlignmentI(JNIEnv *jenv, jclass jcls, jstring jarg1, jint jarg2, jint jarg3) {
   jlong jresult = 0 ;
   char *arg1 = (char *) 0 ;
@@ -42,12 +42,24 @@ void ConfigurationBavieca::defineParameters() {
 	
 	// acoustic models
 	defineParameter("acousticModels.file","acoustic models",PARAMETER_TYPE_FILE,false);
+	defineParameter("acousticModels.gaussianSelection.file","Gaussian selection codebook and shortlists (built by hmmx)",
+		PARAMETER_TYPE_FILE,true);
+	defineParameter("acousticModels.gaussianSelection.codewords","codebook size for Gaussian selection (built at load time)",
+		PARAMETER_TYPE_INTEGER,true,"[1|65536]");
+	defineParameter("acousticModels.gaussianSelection.threshold","maximum log-likelihood distance to the best component in a shortlist",
+		PARAMETER_TYPE_FLOAT,true,"[0.0|1000000.0]","10.0");
+	defineParameter("acousticModels.gaussianSelection.floor","minimum number of components in a shortlist",
+		PARAMETER_TYPE_INTEGER,true,"[1|1000]","1");
+	defineParameter("acousticModels.quantization","quantization of the Gaussian parameters used for decoding",
+		PARAMETER_TYPE_STRING,true,"none|int8|int16","none");
 	
 	// speech activity detection
 	defineParameter("sad.maxGaussianSilence","max Gaussian components for silence model",PARAMETER_TYPE_INTEGER,true);
 	defineParameter("sad.maxGaussianSpeech","max Gaussian components for speech model",PARAMETER_TYPE_INTEGER,true);
 	defineParameter("sad.speechPadding","speech padding",PARAMETER_TYPE_INTEGER,true);
 	defineParameter("sad.speechPenalty","speech insertion penalty",PARAMETER_TYPE_FLOAT,true);
+	defineParameter("sad.maxLatency","maximum delay (# frames) before speech boundaries are decided (-1: no limit)",
+		PARAMETER_TYPE_INTEGER,true,NULL,"-1");
 	
 	// lexicon
 	defineParameter("lexicon.file","pronunciation lexicon",PARAMETER_TYPE_FILE,true);
@@ -77,11 +89,34 @@ void ConfigurationBavieca::defineParameters() {
 		PARAMETER_TYPE_INTEGER,true);
 	defineParameter("pruning.maxActiveTokensArc","maximum number of active tokens per arc",
 		PARAMETER_TYPE_INTEGER,true);
+	
+	// emission probabilities computed ahead of time
+	defineParameter("emissionCache.frames","number of frames an HMM-state is scored on at once (batch/chunked decoding)",
+		PARAMETER_TYPE_INTEGER,true,"[1|64]","1");
+	
+	// acoustic look-ahead (word-initial arcs)
+	defineParameter("acousticLookAhead.frames","number of frames looked ahead when activating word-initial arcs (0 disables it)",
+		PARAMETER_TYPE_INTEGER,true,"[0|20]","0");
+	defineParameter("acousticLookAhead.components","number of Gaussian components of the context-independent phone models",
+		PARAMETER_TYPE_INTEGER,true,"[1|256]","8");
+	defineParameter("acousticLookAhead.weight","weight of the acoustic look-ahead score",
+		PARAMETER_TYPE_FLOAT,true,"[0.0|1.0]","0.5");
 		
+	// speaker adaptation (online fMLLR)
+	defineParameter("adaptation.fmllr.framesUpdate","adaptation frames between transform re-estimations",
+		PARAMETER_TYPE_INTEGER,true,"[1|1000000]","1000");
+	defineParameter("adaptation.fmllr.iterations","number of iterations of the transform estimation",
+		PARAMETER_TYPE_INTEGER,true,"[1|100]","20");
+	defineParameter("adaptation.fmllr.bestComponentOnly","whether adaptation data goes to the best scoring Gaussian only",
+		PARAMETER_TYPE_BOOLEAN,true,"yes|no","yes");
 	// decoder output
 	defineParameter("output.lattice.maxWordSequencesState",
 		"maximum number of different word sequences exiting a state",
 		PARAMETER_TYPE_INTEGER,true,"[2|100]","5");
+	defineParameter("output.profile","whether to collect performance counters and timers for each utterance",
+		PARAMETER_TYPE_BOOLEAN,true,"yes|no","no");
+	defineParameter("output.confusionNetwork","whether to output the minimum Bayes risk hypothesis from a confusion network (requires lattice generation and context dependent models)",
+		PARAMETER_TYPE_BOOLEAN,true,"yes|no","no");
 }
 
 // load the configuration parameters
@@ -141,7 +176,6 @@ bool ConfigurationBavieca::areDecodingParametersSet() {
 		isParameterSet("languageModel.format") &&
 		isParameterSet("languageModel.type") &&
 		isParameterSet("languageModel.scalingFactor") &&
-		isParameterSet("languageModel.ngram") &&
 		isParameterSet("languageModel.crossUtterance") &&
 		isParameterSet("insertionPenalty.standard") &&
 		isParameterSet("insertionPenalty.filler") &&
@@ -0,0 +1,205 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#include <stdexcept>
+#include <fstream>
+#include <sstream>
+
+#include "BaviecaAPI.h"
+#include "FileUtils.h"
+#include "Global.h"
+#include "LexiconManager.h"
+#include "SyntheticTask.h"
+
+using namespace Bavieca;
+
+// size of the synthetic task (small so the test runs in a few seconds)
+#define TEST_PHONES				20
+#define TEST_WORDS				300
+#define TEST_GAUSSIANS			8
+#define TEST_SEED					7
+#define TEST_UTTERANCES			2
+#define TEST_WORDS_UTTERANCE	8
+#define TEST_CHUNK_FRAMES		1		// sessions alternate at every frame so cached scores collide
+
+// write the API configuration file for the synthetic task
+void writeConfiguration(const string &strFile, const string &strFolder, SyntheticTask &syntheticTask,
+	const char *strAcousticModels) {
+
+	ofstream os(strFile.c_str());
+	os << "feature.configurationFile = " << syntheticTask.getFileFeatureConfiguration() << endl;
+	os << "feature.cepstralNormalization.mode = utterance" << endl;
+	os << "feature.cepstralNormalization.method = CMN" << endl;
+	os << "feature.cepstralNormalization.bufferSize = 1000000" << endl;
+	os << "feature.warpFactor = 1.0" << endl;
+	os << "phoneticSymbolSet.file = " << syntheticTask.getFilePhoneSet() << endl;
+	os << "acousticModels.file = " << syntheticTask.getFileAcousticModels() << endl;
+	os << strAcousticModels << endl;
+	os << "lexicon.file = " << syntheticTask.getFileLexicon() << endl;
+	os << "languageModel.file = " << syntheticTask.getFileLanguageModel() << endl;
+	os << "languageModel.format = ARPA" << endl;
+	os << "languageModel.type = ngram" << endl;
+	os << "languageModel.scalingFactor = 20.0" << endl;
+	os << "insertionPenalty.standard = -25.0" << endl;
+	os << "insertionPenalty.filler = 0.0" << endl;
+	os << "insertionPenalty.filler.file = " << strFolder << PATH_SEPARATOR << "fillers.txt" << endl;
+	os << "pruning.maxActiveArcs = 5000" << endl;
+	os << "pruning.maxActiveArcsWE = 500" << endl;
+	os << "pruning.maxActiveTokensArc = 10" << endl;
+	os << "pruning.likelihoodBeam = 200.0" << endl;
+	os << "pruning.likelihoodBeamWE = 150.0" << endl;
+	os << "pruning.likelihoodBeamTokensArc = 100.0" << endl;
+	os.close();
+}
+
+// return the hypothesis as text (words and alignment)
+string getHypothesis(BaviecaSession *session) {
+
+	ostringstream oss;
+	HypothesisI *hypothesis = session->decGetHypothesis();
+	for(unsigned int i=0 ; i < hypothesis->size() ; ++i) {
+		WordHypothesisI *word = hypothesis->getWordHypothesis(i);
+		oss << word->getWord() << "(" << word->getFrameStart() << "," << word->getFrameEnd() << ") ";
+	}
+	delete hypothesis;
+
+	return oss.str();
+}
+
+// feed the next chunk of the utterance to the session, returns whether there was something to feed
+bool feedChunk(BaviecaSession *session, Matrix<float> *mFeatures, unsigned int &iFrame) {
+
+	if (iFrame >= mFeatures->getRows()) {
+		return false;
+	}
+	unsigned int iFrames = min(mFeatures->getRows()-iFrame,(unsigned int)TEST_CHUNK_FRAMES);
+	session->decProcess(mFeatures->getRowData(iFrame),iFrames);
+	iFrame += iFrames;
+
+	return true;
+}
+
+// decode the utterances one after another and with their chunks interleaved (one session for each utterance),
+// the hypotheses need to be the same
+bool testInterleavedSessions(const char *strFileConfiguration, vector<Matrix<float>*> &vFeatures) {
+
+	BaviecaEngine engine(strFileConfiguration);
+	if (engine.initialize(INIT_DECODER) == false) {
+		BVC_WARNING << "unable to initialize the engine: " << strFileConfiguration;
+		return false;
+	}
+
+	// (1) each utterance alone
+	vector<string> vHypothesisAlone;
+	for(unsigned int i=0 ; i < vFeatures.size() ; ++i) {
+		BaviecaSession *session = engine.createSession();
+		session->decBeginUtterance();
+		unsigned int iFrame = 0;
+		while(feedChunk(session,vFeatures[i],iFrame));
+		vHypothesisAlone.push_back(getHypothesis(session));
+		session->decEndUtterance();
+		delete session;
+	}
+
+	// (2) utterances interleaved, chunks of different sessions have the same frame indices
+	vector<BaviecaSession*> vSession;
+	vector<unsigned int> vFrame(vFeatures.size(),0);
+	for(unsigned int i=0 ; i < vFeatures.size() ; ++i) {
+		vSession.push_back(engine.createSession());
+		vSession.back()->decBeginUtterance();
+	}
+	bool bFed = true;
+	while(bFed) {
+		bFed = false;
+		for(unsigned int i=0 ; i < vSession.size() ; ++i) {
+			bFed |= feedChunk(vSession[i],vFeatures[i],vFrame[i]);
+		}
+	}
+	bool bOk = true;
+	for(unsigned int i=0 ; i < vSession.size() ; ++i) {
+		string strHypothesis = getHypothesis(vSession[i]);
+		vSession[i]->decEndUtterance();
+		delete vSession[i];
+		if (vHypothesisAlone[i].empty()) {
+			BVC_WARNING << "utterance " << i << " produced an empty hypothesis";
+			bOk = false;
+		}
+		if (strHypothesis != vHypothesisAlone[i]) {
+			BVC_WARNING << "utterance " << i << " alone: \"" << vHypothesisAlone[i] << "\" interleaved: \"" <<
+				strHypothesis << "\"";
+			bOk = false;
+		}
+	}
+
+	engine.uninitialize();
+
+	return bOk;
+}
+
+// test the decoding sessions of the API (receives a folder to create the synthetic task in)
+int main(int argc, char *argv[]) {
+
+	if (argc != 2) {
+		cerr << "usage: " << argv[0] << " folder" << endl;
+		return -1;
+	}
+	string strFolder = argv[1];
+
+	try {
+
+		SyntheticTask syntheticTask(strFolder.c_str(),TEST_PHONES,TEST_WORDS,TEST_GAUSSIANS,TEST_SEED);
+		syntheticTask.create();
+
+		ofstream osFillers((strFolder+PATH_SEPARATOR+"fillers.txt").c_str());
+		osFillers << LEX_UNIT_SILENCE_SYMBOL << " 0.0" << endl;
+		osFillers.close();
+
+		vector<Matrix<float>*> vFeatures;
+		for(int i=0 ; i < TEST_UTTERANCES ; ++i) {
+			string strTranscription;
+			vFeatures.push_back(syntheticTask.generateUtterance(TEST_WORDS_UTTERANCE,strTranscription));
+		}
+
+		// Gaussian selection and quantization keep per-frame scores in the shared models
+		const char *strModes[][2] = {
+			{"quantization","acousticModels.quantization = int8"},
+			{"gaussianSelection","acousticModels.gaussianSelection.codewords = 64"}};
+
+		int iFailed = 0;
+		for(int i=0 ; i < 2 ; ++i) {
+			string strFileConfiguration = strFolder+PATH_SEPARATOR+"configuration_"+strModes[i][0]+".txt";
+			writeConfiguration(strFileConfiguration,strFolder,syntheticTask,strModes[i][1]);
+			bool bOk = testInterleavedSessions(strFileConfiguration.c_str(),vFeatures);
+			cout << "interleaved sessions (" << strModes[i][0] << "): " << (bOk ? "passed" : "FAILED") << endl;
+			if (bOk == false) {
+				++iFailed;
+			}
+		}
+
+		for(unsigned int i=0 ; i < vFeatures.size() ; ++i) {
+			delete vFeatures[i];
+		}
+
+		return (iFailed == 0) ? 0 : 1;
+
+	} catch (std::runtime_error &e) {
+		std::cerr << e.what() << std::endl;
+		return -1;
+	}
+}
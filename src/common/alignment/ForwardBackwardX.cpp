@@ -359,6 +359,324 @@ Alignment *ForwardBackwardX::processUtterance(VLexUnit &vLexUnitTranscription, b
 }
 
 
+// aligns a lattice against the given feature vectors using Posterior Probabilities as the edge occupation
+// probability (discriminative training)
+// - time-constrained: the trellis of each edge only covers the frames in which each of its HMM-states can be 
+//   occupied (aligned phone frames plus a margin), no memory is allocated for the rest of the utterance
+// - emission scores are computed once for each (HMM-state,frame) pair and shared across edges
+Alignment *ForwardBackwardX::processLattice(HypothesisLattice *lattice, MatrixBase<float> &mFeatures, 
+	float fScaleAM, float fScaleLM, double &dLikelihood, bool bMMI, float fBoostingFactor, int iTimeMargin, 
+	const char **strReturnCode) {
+
+	double dTimeBegin = TimeUtils::getTimeMilliseconds();
+	
+	assert(iTimeMargin >= 0);
+	int iFeatures = mFeatures.getRows();
+	int iEdges = -1;
+	LEdge **edges = lattice->getEdges(&iEdges);
+	
+	// boosted MMI -> compute phone-accuracy for each phone in the lattice
+	if (bMMI) {
+		// get the time-alignment of the reference
+		VLPhoneAlignment *vLPhoneAlignment = lattice->getBestPathAlignment();
+		if (vLPhoneAlignment == NULL) {
+			*strReturnCode = FB_RETURN_CODE_UNABLE_TO_GET_BEST_PATH_FROM_LATTICE;
+			return NULL;
+		}
+		// compute phone accuracy respect to the reference
+		lattice->computePhoneAccuracy(*vLPhoneAlignment,true,false);
+		delete vLPhoneAlignment;
+	}
+	
+	// (1) compute the time window of each HMM-state within each edge and the frame-range of the emission caches
+	int *iEdgeStates = new int[iEdges+1];			// first state of each edge
+	int *iEdgeCells = new int[iEdges+1];			// first trellis cell of each edge
+	iEdgeStates[0] = 0;
+	for(int i=0 ; i < iEdges ; ++i) {
+		iEdgeStates[i+1] = iEdgeStates[i]+edges[i]->iPhones*NUMBER_HMM_STATES;
+	}
+	FBLatticeState *states = new FBLatticeState[iEdgeStates[iEdges]];
+	int iHMMStatesPhysical = m_hmmManagerAlignment->getNumberHMMStatesPhysical();
+	int *iEmissionCache = new int[iHMMStatesPhysical];
+	for(int i=0 ; i < iHMMStatesPhysical ; ++i) {
+		iEmissionCache[i] = -1;
+	}
+	vector<FBEmissionCache> vEmissionCache;
+	int iCellsEdgeMax = 0;
+	iEdgeCells[0] = 0;
+	const char *strError = NULL;
+	for(int i=0 ; (i < iEdges) && (strError == NULL) ; ++i) {
+		int iStates = iEdgeStates[i+1]-iEdgeStates[i];
+		if ((iStates == 0) || (edges[i]->iFrameEnd-edges[i]->iFrameStart+1 < iStates)) {
+			strError = FB_RETURN_CODE_INSUFFICIENT_NUMBER_FEATURE_VECTORS;
+			break;
+		}
+		int iCells = 0;
+		for(int j=0 ; j < iStates ; ++j) {
+			LPhoneAlignment *phoneAlignment = &edges[i]->phoneAlignment[j/NUMBER_HMM_STATES];
+			int iState = j%NUMBER_HMM_STATES;
+			HMMState *hmmState = m_hmmManagerAlignment->getHMMState(phoneAlignment->iHMMState[iState]);
+			if (hmmState == NULL) {
+				strError = FB_RETURN_CODE_UTTERANCE_UNKNOWN_LATTICE_HMMSTATE;
+				break;
+			}
+			// the state can be occupied anywhere within the aligned span of its phone plus the margin (margin 0 
+			// keeps phone boundaries fixed and runs forward-backward within each phone), leaving room for its 
+			// predecessors and successors within the phone and within the edge
+			int iPhoneBegin = phoneAlignment->iStateBegin[0]-iTimeMargin;
+			int iPhoneEnd = phoneAlignment->iStateEnd[NUMBER_HMM_STATES-1]+iTimeMargin;
+			FBLatticeState *state = &states[iEdgeStates[i]+j];
+			state->iFrameStart = max(iPhoneBegin+iState,edges[i]->iFrameStart+j);
+			state->iFrameEnd = min(iPhoneEnd-(NUMBER_HMM_STATES-1-iState),edges[i]->iFrameEnd-(iStates-1-j));
+			if (state->iFrameStart > state->iFrameEnd) {
+				strError = FB_RETURN_CODE_LATTICE_EDGE_UNALIGNABLE;
+				break;
+			}
+			state->iOffset = iCells;
+			iCells += state->iFrameEnd-state->iFrameStart+1;
+			// extend the frame-range of the emission cache
+			if (iEmissionCache[hmmState->getId()] == -1) {
+				FBEmissionCache emissionCache;
+				emissionCache.hmmState = hmmState;
+				emissionCache.iFrameStart = state->iFrameStart;
+				emissionCache.iFrameEnd = state->iFrameEnd;
+				emissionCache.iOffset = -1;
+				iEmissionCache[hmmState->getId()] = (int)vEmissionCache.size();
+				vEmissionCache.push_back(emissionCache);
+			} else {
+				FBEmissionCache &emissionCache = vEmissionCache[iEmissionCache[hmmState->getId()]];
+				emissionCache.iFrameStart = min(emissionCache.iFrameStart,state->iFrameStart);
+				emissionCache.iFrameEnd = max(emissionCache.iFrameEnd,state->iFrameEnd);
+			}
+			state->iCache = iEmissionCache[hmmState->getId()];
+		}
+		iEdgeCells[i+1] = iEdgeCells[i]+iCells;
+		iCellsEdgeMax = max(iCellsEdgeMax,iCells);
+	}
+	delete [] iEmissionCache;
+	
+	// the trellis is reused across edges, it only needs to fit the largest edge
+	FBTrellisNode *trellis = NULL;
+	if (strError == NULL) {
+		trellis = newTrellis(1,iCellsEdgeMax,strReturnCode);
+	} else {
+		*strReturnCode = strError;
+	}
+	if (trellis == NULL) {
+		delete [] iEdgeStates;
+		delete [] iEdgeCells;
+		delete [] states;
+		return NULL;
+	}
+	
+	// emission cache (scores are computed on demand)
+	int iEmissionCacheSize = 0;
+	for(vector<FBEmissionCache>::iterator it = vEmissionCache.begin() ; it != vEmissionCache.end() ; ++it) {
+		it->iOffset = iEmissionCacheSize;
+		iEmissionCacheSize += it->iFrameEnd-it->iFrameStart+1;
+	}
+	float *fEmissionCache = new float[iEmissionCacheSize];
+	for(int i=0 ; i < iEmissionCacheSize ; ++i) {
+		fEmissionCache[i] = -FLT_MAX;
+	}
+	
+	// (2) forward-backward within each edge, keep the within-edge occupation of each cell
+	double *dOccupationCells = new double[iEdgeCells[iEdges]];
+	for(int i=0 ; i < iEdges ; ++i) {
+	
+		FBLatticeState *statesEdge = &states[iEdgeStates[i]];
+		int iStates = iEdgeStates[i+1]-iEdgeStates[i];
+		double dLikelihoodEdge = forwardBackwardEdge(mFeatures,edges[i]->iFrameStart,edges[i]->iFrameEnd,
+			statesEdge,iStates,&vEmissionCache[0],fEmissionCache,trellis);
+		if (dLikelihoodEdge == -DBL_MAX) {
+			strError = FB_RETURN_CODE_LATTICE_EDGE_UNALIGNABLE;
+			break;
+		}
+		
+		// acoustic score of the edge
+		edges[i]->fScoreAM = (float)dLikelihoodEdge;
+		if (bMMI) {
+			for(int iPhone = 0 ; iPhone < edges[i]->iPhones ; ++iPhone) {
+				edges[i]->fScoreAM -= fBoostingFactor*edges[i]->fPhoneAccuracy[iPhone];
+			}
+		}
+		
+		// hmm-state occupation (cells outside the beam are discarded)
+		double dThreshold = dLikelihoodEdge+m_fForwardPruningBeam;
+		double *dOccupationEdge = &dOccupationCells[iEdgeCells[i]];
+		for(int iCell = 0 ; iCell < iEdgeCells[i+1]-iEdgeCells[i] ; ++iCell) {
+			FBTrellisNode &node = trellis[iCell];
+			dOccupationEdge[iCell] = 0.0;
+			if ((node.dForward != -DBL_MAX) && (node.dBackward != -DBL_MAX) && 
+				(node.dForward+node.dBackward >= dThreshold)) {
+				dOccupationEdge[iCell] = exp(node.dForward+node.dBackward-dLikelihoodEdge);
+			}
+		}	
+	}
+	deleteTrellis(trellis);
+	delete [] fEmissionCache;
+	
+	if (strError != NULL) {
+		*strReturnCode = strError;
+		delete [] iEdgeStates;
+		delete [] iEdgeCells;
+		delete [] states;
+		delete [] dOccupationCells;
+		return NULL;
+	}
+	
+	// (3) compute edge posterior probabilities (edge occupation probabilities)
+	lattice->computeForwardBackwardScores(fScaleAM,fScaleLM);
+	lattice->computePosteriorProbabilities();
+	
+	// (4) multiply occupations by the corresponding edge posterior probability and accumulate them at the 
+	// (HMM-state,frame) level using the layout of the emission cache
+	double *dOccupation = new double[iEmissionCacheSize];
+	for(int i=0 ; i < iEmissionCacheSize ; ++i) {
+		dOccupation[i] = 0.0;
+	}
+	for(int i=0 ; i < iEdges ; ++i) {
+		double *dOccupationEdge = &dOccupationCells[iEdgeCells[i]];
+		for(int j = iEdgeStates[i] ; j < iEdgeStates[i+1] ; ++j) {
+			FBLatticeState *state = &states[j];
+			FBEmissionCache &emissionCache = vEmissionCache[state->iCache];
+			double *dOccupationState = &dOccupation[emissionCache.iOffset+state->iFrameStart-emissionCache.iFrameStart];
+			for(int t = 0 ; t <= state->iFrameEnd-state->iFrameStart ; ++t) {
+				dOccupationState[t] += dOccupationEdge[state->iOffset+t]*edges[i]->fPP;
+			}
+		}
+	}
+	
+	// (5) build the alignment
+	FrameAlignment **frameAlignment = new FrameAlignment*[iFeatures];
+	for(int t=0 ; t < iFeatures ; ++t) {
+		frameAlignment[t] = new FrameAlignment;
+	}
+	for(vector<FBEmissionCache>::iterator it = vEmissionCache.begin() ; it != vEmissionCache.end() ; ++it) {
+		for(int t = it->iFrameStart ; t <= it->iFrameEnd ; ++t) {
+			double dOccupationProb = dOccupation[it->iOffset+t-it->iFrameStart];
+			if (dOccupationProb > 0.0) {
+				frameAlignment[t]->push_back(Alignment::newStateOcc(it->hmmState->getId(),dOccupationProb));
+			}
+		}
+	}
+	Alignment *alignment = new Alignment(ALIGNMENT_TYPE_FORWARD_BACKWARD);
+	for(int t=0 ; t < iFeatures ; ++t) {
+		alignment->addFrameAlignmentBack(frameAlignment[t]);
+	}
+	
+	// compute the lattice likelihood
+	dLikelihood = lattice->getLikelihood();
+	
+	int iCells = iEdgeCells[iEdges];
+	int iCellsDense = iFeatures*iEdgeStates[iEdges];
+	
+	// clean-up
+	delete [] frameAlignment;
+	delete [] dOccupation;
+	delete [] dOccupationCells;
+	delete [] iEdgeStates;
+	delete [] iEdgeCells;
+	delete [] states;
+	
+	double dTimeEnd = TimeUtils::getTimeMilliseconds();
+	double dTimeSeconds = (dTimeEnd-dTimeBegin)/1000.0;
+	
+	BVC_VERB << "processing time: " << FLT(6,2) << dTimeSeconds << " seconds (RTF:"
+		<< FLT(6,2) << dTimeSeconds/(((double)iFeatures)/100.0) << ") trellis cells: " << iCells 
+		<< " (dense: " << iCellsDense << ")";
+	
+	*strReturnCode = FB_RETURN_CODE_SUCCESS;
+
+	return alignment;
+}
+
+// forward/backward computation within a lattice edge, only the cells within the time window of each 
+// HMM-state are visited, returns the edge likelihood
+double ForwardBackwardX::forwardBackwardEdge(MatrixBase<float> &mFeatures, int iFrameStart, int iFrameEnd,
+	FBLatticeState *states, int iStates, FBEmissionCache *emissionCache, float *fEmissionCache, 
+	FBTrellisNode *trellis) {
+
+	// initialization, emission scores are taken from the cache or computed and cached
+	for(int j=0 ; j < iStates ; ++j) {
+		FBEmissionCache *cache = &emissionCache[states[j].iCache];
+		FBTrellisNode *nodes = &trellis[states[j].iOffset];
+		float *fScores = &fEmissionCache[cache->iOffset+states[j].iFrameStart-cache->iFrameStart];
+		for(int t = 0 ; t <= states[j].iFrameEnd-states[j].iFrameStart ; ++t) {
+			if (fScores[t] == -FLT_MAX) {
+				fScores[t] = cache->hmmState->computeEmissionProbability(mFeatures.getRowData(states[j].iFrameStart+t),-1);
+			}
+			nodes[t].fScore = fScores[t];
+			nodes[t].dForward = -DBL_MAX;
+			nodes[t].dBackward = -DBL_MAX;
+		}
+	}
+	
+	// the edge starts at the first state and ends at the last one
+	if ((states[0].iFrameStart != iFrameStart) || (states[iStates-1].iFrameEnd != iFrameEnd)) {
+		return -DBL_MAX;
+	}
+
+	// (1) forward-pass: the window of a state is completed before moving to the next one
+	trellis[0].dForward = trellis[0].fScore;
+	for(int j=0 ; j < iStates ; ++j) {
+		FBLatticeState *state = &states[j];
+		FBTrellisNode *nodes = &trellis[state->iOffset];
+		for(int t = max(state->iFrameStart,iFrameStart+1) ; t <= state->iFrameEnd ; ++t) {
+			FBTrellisNode *node = &nodes[t-state->iFrameStart];
+			// (a) same state
+			if (t-1 >= state->iFrameStart) {
+				node->dForward = nodes[t-1-state->iFrameStart].dForward;
+			}
+			// (b) previous state
+			if ((j > 0) && (t-1 >= states[j-1].iFrameStart) && (t-1 <= states[j-1].iFrameEnd)) {
+				double dForwardPrev = trellis[states[j-1].iOffset+t-1-states[j-1].iFrameStart].dForward;
+				if (dForwardPrev != -DBL_MAX) {
+					node->dForward = Numeric::logAddition(node->dForward,dForwardPrev);
+				}
+			}
+			if (node->dForward != -DBL_MAX) {
+				node->dForward += node->fScore;
+			}
+		}
+	}
+	
+	double dLikelihood = trellis[states[iStates-1].iOffset+iFrameEnd-states[iStates-1].iFrameStart].dForward;
+	if (dLikelihood == -DBL_MAX) {
+		return -DBL_MAX;
+	}
+	
+	// (2) backward-pass
+	trellis[states[iStates-1].iOffset+iFrameEnd-states[iStates-1].iFrameStart].dBackward = 0.0;
+	for(int j=iStates-1 ; j >= 0 ; --j) {
+		FBLatticeState *state = &states[j];
+		FBTrellisNode *nodes = &trellis[state->iOffset];
+		for(int t = min(state->iFrameEnd,iFrameEnd-1) ; t >= state->iFrameStart ; --t) {
+			FBTrellisNode *node = &nodes[t-state->iFrameStart];
+			// skip nodes that can't be reached from the edge start
+			if (node->dForward == -DBL_MAX) {
+				continue;
+			}
+			// (a) same state
+			if (t+1 <= state->iFrameEnd) {
+				FBTrellisNode *nodeSame = &nodes[t+1-state->iFrameStart];
+				if (nodeSame->dBackward != -DBL_MAX) {
+					node->dBackward = nodeSame->dBackward+nodeSame->fScore;
+				}
+			}
+			// (b) next state
+			if ((j < iStates-1) && (t+1 >= states[j+1].iFrameStart) && (t+1 <= states[j+1].iFrameEnd)) {
+				FBTrellisNode *nodeNext = &trellis[states[j+1].iOffset+t+1-states[j+1].iFrameStart];
+				if (nodeNext->dBackward != -DBL_MAX) {
+					node->dBackward = Numeric::logAddition(node->dBackward,nodeNext->dBackward+nodeNext->fScore);
+				}
+			}
+		}
+	}
+
+	return dLikelihood;
+}
+
 // print the trellis
 void ForwardBackwardX::print(FBTrellisNode *node, int iRows, int iColumns) {
 
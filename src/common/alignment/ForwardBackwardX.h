@@ -38,6 +38,22 @@ typedef struct {
 	double dBackward;				// backward log-likelihood
 } FBTrellisNode;
 
+// emission scores of a HMM-state cached across all the lattice edges in which the state appears
+typedef struct {
+	HMMState *hmmState;			// HMM-state
+	int iFrameStart;				// first frame in the cache
+	int iFrameEnd;					// last frame in the cache
+	int iOffset;					// offset of the first frame in the cache buffer
+} FBEmissionCache;
+
+// HMM-state within a lattice edge, it can only be occupied within a time window
+typedef struct {
+	int iCache;						// emission cache of the HMM-state
+	int iFrameStart;				// first frame the state can be occupied
+	int iFrameEnd;					// last frame the state can be occupied
+	int iOffset;					// offset of the first frame in the edge trellis
+} FBLatticeState;
+
 // return codes
 #define FB_RETURN_CODE_SUCCESS																"success"
 #define FB_RETURN_CODE_EMPTY_TRANSCRIPTION												"no lexical units found in the transcription"
@@ -48,6 +64,7 @@ typedef struct {
 #define FB_RETURN_CODE_UTTERANCE_UNKNOWN_LATTICE_HMMSTATE							"hmm-state in lattice was not found in hmm-set"
 #define FB_RETURN_CODE_UNABLE_TO_GET_BEST_PATH_FROM_LATTICE							"unable to get the best path from the lattice"
 #define FB_RETURN_CODE_UTTERANCE_TOO_LONG_NUMERICAL_INACCURACIES					"numerical inaccuracies, utterance too long"
+#define FB_RETURN_CODE_LATTICE_EDGE_UNALIGNABLE											"unable to align the hmm-states of a lattice edge within its time span"
 
 // default values for trellis and trellis cache size
 #define MAX_TRELLIS_SIZE_MB_DEFAULT					500
@@ -94,6 +111,12 @@ class ForwardBackwardX {
 		// delete a trellis
 		void deleteTrellis(FBTrellisNode *trellis);
 		
+		// forward/backward computation within a lattice edge, only the cells within the time window of each 
+		// HMM-state are visited, returns the edge likelihood
+		double forwardBackwardEdge(MatrixBase<float> &mFeatures, int iFrameStart, int iFrameEnd, 
+			FBLatticeState *states, int iStates, FBEmissionCache *emissionCache, float *fEmissionCache, 
+			FBTrellisNode *trellis);
+		
 	public:
 
 		// constructor
@@ -110,8 +133,11 @@ class ForwardBackwardX {
 			double *dUtteranceLikelihood, const char **strReturnCode);
 			
 		// aligns a lattice against the given feature vectors using Posterior Probabilities as the edge occupation
-		// probability (discriminative training)
-		Alignment *processLattice(HypothesisLattice *lattice, MatrixBase<float> &mFeatures, const char **strReturnCode);
+		// probability (discriminative training), HMM-states within each edge can be occupied up to iTimeMargin 
+		// frames away from the aligned boundaries of their phone (always within the edge time span)
+		Alignment *processLattice(HypothesisLattice *lattice, MatrixBase<float> &mFeatures, float fScaleAM, 
+			float fScaleLM, double &dLikelihood, bool bMMI, float fBoostingFactor, int iTimeMargin, 
+			const char **strReturnCode);
 };
 
 };	// end-of-namespace
@@ -72,6 +72,9 @@
 // verbose output
 #define BVC_VERBOSE_ENABLED
 
+// performance counters and cycle timers (decoding profile)
+#define BVC_PROFILING_ENABLED
+
 // asserts
 //#define NDEBUG 
 #include <assert.h> 
@@ -572,7 +572,8 @@ float LMFSM::toFinalState(int iLMState) {
 // return language model scores for all words in the vocabulary for a given LM-state (word history)
 void LMFSM::getLMScores(int iLMState, float *fLMScores, int iVocabularySize) {
 
-	double dTimeBegin = TimeUtils::getTimeMilliseconds();
+	// called on every look-ahead cache miss, only timed when verbose output is on
+	double dTimeBegin = BVC_VERB_ENABLED ? TimeUtils::getTimeMilliseconds() : 0.0;
 
 	LMArc **lmArcBackoff = new LMArc*[m_iNGramOrder-1];
 	int iEmpty = m_iNGramOrder-2;
@@ -626,11 +627,12 @@ void LMFSM::getLMScores(int iLMState, float *fLMScores, int iVocabularySize) {
 	//printf("computed: %d\n",iComputed);
 	
 	// set lm-score for filler units and sentence markers (0.0)
-	// that kind of lexical units are after the lexical units for all unigrams
-	//for(int i=m_iUnigrams ; i < iVocabularySize ; ++i) {
-		//fLMScores[i] = 0.0;
-		//printf("lex: %s\n",m_lexiconManager->getStrLexUnit(i));
-	//}
+	// filler units are not necessarily part of the language model
+	for(int i=0 ; i < iVocabularySize ; ++i) {
+		if ((fLMScores[i] == FLT_MAX) && (m_lexiconManager->isStandard(i) == false)) {
+			fLMScores[i] = 0.0;
+		}
+	}
 	// there may or maynot be unigrams for the unknown symbol and the sentence markers 
 	fLMScores[m_lexiconManager->m_lexUnitUnknown->iLexUnit] = 0.0;
 	fLMScores[m_lexiconManager->m_lexUnitBegSentence->iLexUnit] = 0.0;
@@ -643,8 +645,7 @@ void LMFSM::getLMScores(int iLMState, float *fLMScores, int iVocabularySize) {
 	
 	delete [] lmArcBackoff;
 
-	double dTimeEnd = TimeUtils::getTimeMilliseconds();
-	BVC_VERB << "seconds: " << (dTimeEnd-dTimeBegin)/1000.0 << " seconds" << endl;
+	BVC_VERB << "seconds: " << (TimeUtils::getTimeMilliseconds()-dTimeBegin)/1000.0 << " seconds";
 }
 
 // compute the likelihood of the given sequence of words
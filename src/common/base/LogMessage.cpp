@@ -17,37 +17,171 @@
  *---------------------------------------------------------------------------------------------*/
 
 #include <stdexcept>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iomanip>
 
 #include "LogMessage.h"
+#include "LogSink.h"
+#include "TimeUtils.h"
 
 namespace Bavieca {
 
-LogMessage::LogMessage(const char *strType, const char *strFile, const char *strFunction, int iLine)
+volatile int LogMessage::m_iLevelEnabled = LOG_LEVEL_VERBOSE;
+int LogMessage::m_iFormat = LOG_FORMAT_TEXT;
+LogSink *LogMessage::m_logSink = NULL;
+
+// logging settings from the environment are applied before main is called
+static int g_iLogConfiguration = LogMessage::configure();
+
+LogMessage::LogMessage(int iLevel, const char *strType, const char *strFunction, const char *strFile, int iLine)
 {
+	m_iLevel = iLevel;
 	m_strType = strType;
-	if ((m_strType.compare("Error") == 0) || (m_strType.compare("Warning") == 0)) {
-		m_stream << strFile << " " << strFunction << " " << iLine << " ";
+	m_strFunction = strFunction;
+	m_strFile = strFile;
+	m_iLine = iLine;
+	if ((m_iFormat == LOG_FORMAT_TEXT) && (m_iLevel <= LOG_LEVEL_WARNING)) {
+		m_stream << strFunction << " " << strFile << " " << iLine << " ";
 	}
 }
 
 LogMessage::~LogMessage()
 {
-	if (m_strType.compare("Error") == 0) {
-		std::cerr << "Error: " << m_stream.str() << endl;
+	if (m_iLevel == LOG_LEVEL_ERROR) {
+		// errors are output synchronously, after any pending record
+		flush();
+		string *strRecord = buildRecord();
+		std::cerr << *strRecord << endl;
+		delete strRecord;
 		throw std::runtime_error(m_stream.str());
-	} else if (m_strType.compare("Warning") == 0) {
-		std::cerr << "Warning: " << m_stream.str() << endl;
-	} else if (m_strType.compare("Information") == 0) {
-		std::cout << m_stream.str() << endl;
-	} else if (m_strType.compare("Verbose") == 0) {
-#ifdef BVC_VERBOSE_ENABLED
-		std::cout << "[verb] " << m_stream.str() << endl;
-#endif
-	} else {
-		std::cerr << m_stream.str()  << endl;
+	}
+	
+	string *strRecord = buildRecord();
+	bool bError = (m_iLevel == LOG_LEVEL_WARNING);
+	if ((m_logSink == NULL) || (m_logSink->push(strRecord,bError) == false)) {
+		if (bError) {
+			std::cerr << *strRecord << '\n';
+		} else {
+			std::cout << *strRecord << '\n';
+		}
+		delete strRecord;
 	}
 }
 
-};	// end-of-namespace
+// build the record to output
+string *LogMessage::buildRecord() {
+
+	if (m_iFormat == LOG_FORMAT_STRUCTURED) {
+		ostringstream oss;
+		oss << "ts=" << std::fixed << std::setprecision(0) << TimeUtils::getTimeMilliseconds() << " level=";
+		for(const char *c = m_strType ; *c != 0 ; ++c) {
+			oss << (char)tolower(*c);
+		}
+		oss << " func=" << m_strFunction << " file=" << m_strFile << " line=" << m_iLine << " msg=\"";
+		const string &strMessage = m_stream.str();
+		for(string::const_iterator it = strMessage.begin() ; it != strMessage.end() ; ++it) {
+			if ((*it == '"') || (*it == '\\')) {
+				oss << '\\' << *it;
+			} else if (*it == '\n') {
+				oss << "\\n";
+			} else {
+				oss << *it;
+			}
+		}
+		oss << "\"";
+		return new string(oss.str());
+	}
+	
+	switch(m_iLevel) {
+		case LOG_LEVEL_ERROR: {
+			return new string("Error: "+m_stream.str());
+		}
+		case LOG_LEVEL_WARNING: {
+			return new string("Warning: "+m_stream.str());
+		}
+		case LOG_LEVEL_VERBOSE: {
+			return new string("[verb] "+m_stream.str());
+		}
+		default: {
+			return new string(m_stream.str());
+		}
+	}
+}
 
+// set the logging level from its name: error|warning|information|verbose (returns false if unknown)
+bool LogMessage::setLevel(const char *strLevel) {
+
+	const char *strLevels[] = {"error","warning","information","verbose"};
+	for(int i=LOG_LEVEL_ERROR ; i <= LOG_LEVEL_VERBOSE ; ++i) {
+		if (strcmp(strLevel,strLevels[i]) == 0) {
+			setLevel(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+// enable/disable asynchronous output (records are written by a background thread)
+bool LogMessage::setAsync(bool bAsync) {
+
+	if (bAsync) {
+		if (m_logSink) {
+			return true;
+		}
+		LogSink *logSink = new LogSink();
+		if (logSink->start() == false) {
+			delete logSink;
+			return false;
+		}
+		m_logSink = logSink;
+		// pending records must be written out before the process ends
+		static bool bExitHandler = false;
+		if (bExitHandler == false) {
+			atexit(LogMessage::flushAtExit);
+			bExitHandler = true;
+		}
+	} else if (m_logSink) {
+		LogSink *logSink = m_logSink;
+		m_logSink = NULL;
+		delete logSink;
+	}
+	
+	return true;
+}
 
+// wait until all the pending records are written
+void LogMessage::flush() {
+
+	if (m_logSink) {
+		m_logSink->flush();
+	}
+}
+
+// write out pending records and stop the asynchronous output
+void LogMessage::flushAtExit() {
+
+	setAsync(false);
+}
+
+// configure the logging from the environment (BAVIECA_LOG_LEVEL, BAVIECA_LOG_FORMAT, BAVIECA_LOG_ASYNC)
+int LogMessage::configure() {
+
+	const char *strLevel = getenv("BAVIECA_LOG_LEVEL");
+	if (strLevel && (setLevel(strLevel) == false)) {
+		std::cerr << "Warning: unknown logging level: " << strLevel << endl;
+	}
+	const char *strFormat = getenv("BAVIECA_LOG_FORMAT");
+	if (strFormat && (strcmp(strFormat,"structured") == 0)) {
+		setFormat(LOG_FORMAT_STRUCTURED);
+	}
+	const char *strAsync = getenv("BAVIECA_LOG_ASYNC");
+	if (strAsync && ((strcmp(strAsync,"1") == 0) || (strcmp(strAsync,"yes") == 0))) {
+		setAsync(true);
+	}
+	
+	return m_iLevelEnabled;
+}
+
+};	// end-of-namespace
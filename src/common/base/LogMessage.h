@@ -34,11 +34,28 @@ namespace Bavieca {
 #define __func__ __FUNCTION__
 #endif
 
-#define BVC_MESSAGE(type) LogMessage(type,__func__,__FILE__,__LINE__).getStream()
-#define BVC_ERROR BVC_MESSAGE("Error")								// error
-#define BVC_WARNING BVC_MESSAGE("Warning")						// warning 
-#define BVC_INFORMATION BVC_MESSAGE("Information")				// high-level information
-#define BVC_VERB BVC_MESSAGE("Verbose")							// detailed information
+// logging levels (messages at levels above the current one are discarded)
+enum {LOG_LEVEL_ERROR=0, LOG_LEVEL_WARNING, LOG_LEVEL_INFORMATION, LOG_LEVEL_VERBOSE};
+
+// logging formats
+enum {LOG_FORMAT_TEXT=0, LOG_FORMAT_STRUCTURED};
+
+// disabled levels are checked before the message is built, so neither the message nor its 
+// arguments are evaluated (verbose messages are compiled out if BVC_VERBOSE_ENABLED is not defined)
+#define BVC_MESSAGE(level,type) if (!BVC_LOG_ENABLED(level)) ; else LogMessage(level,type,__func__,__FILE__,__LINE__).getStream()
+#define BVC_LOG_ENABLED(level) (LogMessage::isEnabled(level))
+#ifdef BVC_VERBOSE_ENABLED
+#define BVC_VERB_ENABLED BVC_LOG_ENABLED(LOG_LEVEL_VERBOSE)
+#else
+#define BVC_VERB_ENABLED false
+#endif
+
+#define BVC_ERROR LogMessage(LOG_LEVEL_ERROR,"Error",__func__,__FILE__,__LINE__).getStream()		// error
+#define BVC_WARNING BVC_MESSAGE(LOG_LEVEL_WARNING,"Warning")						// warning 
+#define BVC_INFORMATION BVC_MESSAGE(LOG_LEVEL_INFORMATION,"Information")		// high-level information
+#define BVC_VERB if (!BVC_VERB_ENABLED) ; else LogMessage(LOG_LEVEL_VERBOSE,"Verbose",__func__,__FILE__,__LINE__).getStream()		// detailed information
+
+class LogSink;
 
 /**
 	@author daniel <dani.bolanos@gmail.com>
@@ -48,11 +65,25 @@ class LogMessage {
 	private:
 	
 		ostringstream m_stream;
-		string m_strType;
+		int m_iLevel;
+		const char *m_strType;
+		const char *m_strFunction;
+		const char *m_strFile;
+		int m_iLine;
+		
+		static volatile int m_iLevelEnabled;			// current logging level
+		static int m_iFormat;								// logging format
+		static LogSink *m_logSink;							// asynchronous output (if enabled)
+		
+		// build the record to output
+		string *buildRecord();
+		
+		// write out pending records and stop the asynchronous output
+		static void flushAtExit();
 
 	public:
 
-		LogMessage(const char *strType, const char *strFile, const char *strFunction, int iLine);
+		LogMessage(int iLevel, const char *strType, const char *strFunction, const char *strFile, int iLine);
 
 		~LogMessage();
 		
@@ -60,6 +91,43 @@ class LogMessage {
 		
 			return m_stream;
 		}
+		
+		// return whether messages at the given level are output
+		static inline bool isEnabled(int iLevel) {
+		
+			return (iLevel <= m_iLevelEnabled);
+		}
+		
+		// set the logging level
+		static void setLevel(int iLevel) {
+		
+			m_iLevelEnabled = iLevel;
+		}
+		
+		// return the logging level
+		static int getLevel() {
+		
+			return m_iLevelEnabled;
+		}
+		
+		// set the logging level from its name: error|warning|information|verbose (returns false if unknown)
+		static bool setLevel(const char *strLevel);
+		
+		// set the logging format: text (default) or structured (key=value records)
+		static void setFormat(int iFormat) {
+		
+			m_iFormat = iFormat;
+		}
+		
+		// enable/disable asynchronous output (records are written by a background thread)
+		// note: it must not be called while other threads are logging
+		static bool setAsync(bool bAsync);
+		
+		// wait until all the pending records are written
+		static void flush();
+		
+		// configure the logging from the environment (BAVIECA_LOG_LEVEL, BAVIECA_LOG_FORMAT, BAVIECA_LOG_ASYNC)
+		static int configure();
 };
 
 };	// end-of-namespace
@@ -0,0 +1,201 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#include <iostream>
+#include <assert.h>
+
+#include "LogSink.h"
+
+#ifdef BVC_LOG_ASYNC_SUPPORTED
+#include <unistd.h>
+#endif
+
+namespace Bavieca {
+
+// constructor
+LogSink::LogSink(unsigned int iCapacity) {
+
+	// round the capacity to a power of two
+	m_iCapacity = 2;
+	while(m_iCapacity < iCapacity) {
+		m_iCapacity <<= 1;
+	}
+	m_iMask = m_iCapacity-1;
+	m_records = new LogRecord[m_iCapacity];
+	for(unsigned int i=0 ; i < m_iCapacity ; ++i) {
+		m_records[i].iSequence = i;
+		m_records[i].strRecord = NULL;
+		m_records[i].bError = false;
+	}
+	m_iEnqueue = 0;
+	m_iDequeue = 0;
+	m_bRunning = false;
+}
+
+// destructor (stops the consumer thread after writing out any pending records)
+LogSink::~LogSink() {
+
+	stop();
+	drain();
+	delete [] m_records;
+}
+
+// start the consumer thread
+bool LogSink::start() {
+
+#ifdef BVC_LOG_ASYNC_SUPPORTED
+	if (m_bRunning) {
+		return true;
+	}
+	m_bRunning = true;
+	if (pthread_create(&m_thread,NULL,LogSink::run,this) != 0) {
+		m_bRunning = false;
+		return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+// stop the consumer thread (pending records are written out)
+void LogSink::stop() {
+
+#ifdef BVC_LOG_ASYNC_SUPPORTED
+	if (m_bRunning == false) {
+		return;
+	}
+	m_bRunning = false;
+	pthread_join(m_thread,NULL);
+#endif
+}
+
+// enqueue a record (waits while the queue is full), returns false if the consumer is not running
+bool LogSink::push(string *strRecord, bool bError) {
+
+#ifdef BVC_LOG_ASYNC_SUPPORTED
+	if (m_bRunning == false) {
+		return false;
+	}
+	
+	// claim a slot: a slot is free when its sequence number matches the enqueue position
+	LogRecord *record = NULL;
+	unsigned int iPosition = m_iEnqueue;
+	while(true) {
+		record = m_records+(iPosition & m_iMask);
+		int iDifference = (int)(record->iSequence-iPosition);
+		if (iDifference == 0) {
+			if (__sync_bool_compare_and_swap(&m_iEnqueue,iPosition,iPosition+1)) {
+				break;
+			}
+		} else if (iDifference < 0) {
+			// full: wait for the consumer (writing the record out directly would break the order)
+			usleep(50);
+			if (m_bRunning == false) {
+				return false;
+			}
+		}
+		iPosition = m_iEnqueue;
+	}
+	
+	// fill the slot and publish it
+	record->strRecord = strRecord;
+	record->bError = bError;
+	__sync_synchronize();
+	record->iSequence = iPosition+1;
+	
+	return true;
+#else
+	return false;
+#endif
+}
+
+// write out all the records in the queue, returns the number of records written
+int LogSink::drain() {
+
+	int iRecords = 0;
+	bool bOutput = false;
+	bool bError = false;
+	while(true) {
+		LogRecord *record = m_records+(m_iDequeue & m_iMask);
+		if ((int)(record->iSequence-(m_iDequeue+1)) < 0) {
+			break;		// empty
+		}
+#ifdef BVC_LOG_ASYNC_SUPPORTED
+		__sync_synchronize();
+#endif
+		if (record->bError) {
+			std::cerr << *record->strRecord << '\n';
+			bError = true;
+		} else {
+			std::cout << *record->strRecord << '\n';
+			bOutput = true;
+		}
+		delete record->strRecord;
+		record->strRecord = NULL;
+#ifdef BVC_LOG_ASYNC_SUPPORTED
+		__sync_synchronize();
+#endif
+		record->iSequence = m_iDequeue+m_iCapacity;
+		++m_iDequeue;
+		++iRecords;
+	}
+	if (bOutput) {
+		std::cout.flush();
+	}
+	if (bError) {
+		std::cerr.flush();
+	}
+	
+	return iRecords;
+}
+
+// consumer thread main function
+void *LogSink::run(void *data) {
+
+#ifdef BVC_LOG_ASYNC_SUPPORTED
+	LogSink *logSink = (LogSink*)data;
+	while(logSink->m_bRunning) {
+		if (logSink->drain() == 0) {
+			usleep(1000);
+		}
+	}
+	// records enqueued before stopping
+	logSink->drain();
+#endif
+	return NULL;
+}
+
+// wait until all the records enqueued so far are written out
+void LogSink::flush() {
+
+#ifdef BVC_LOG_ASYNC_SUPPORTED
+	unsigned int iPosition = m_iEnqueue;
+	while(m_bRunning) {
+		LogRecord *record = m_records+((iPosition-1) & m_iMask);
+		// the slot of the last record enqueued is recycled once it is written out
+		if ((iPosition == 0) || ((int)(record->iSequence-(iPosition-1+m_iCapacity)) >= 0)) {
+			break;
+		}
+		usleep(100);
+	}
+#endif
+}
+
+};	// end-of-namespace
@@ -0,0 +1,94 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#ifndef LOGSINK_H
+#define LOGSINK_H
+
+#include <string>
+
+using namespace std;
+
+#if defined __GNUC__ && !defined _MSC_VER && !defined __MINGW32__
+#define BVC_LOG_ASYNC_SUPPORTED
+#include <pthread.h>
+#endif
+
+namespace Bavieca {
+
+// default number of records the queue can hold (must be a power of two)
+#define LOG_SINK_CAPACITY_DEFAULT		4096
+
+// record in the queue
+typedef struct {
+	volatile unsigned int iSequence;	// sequence number (slot ownership)
+	string *strRecord;					// formatted record
+	bool bError;							// whether the record goes to the error stream
+} LogRecord;
+
+/**
+	@author daniel <dani.bolanos@gmail.com>
+	
+	Asynchronous output of log records: producers (any thread) enqueue formatted records in a 
+	bounded lock-free queue (multiple producers, single consumer) and a background thread writes 
+	them out. Producers wait while the queue is full so records from a thread keep their order.
+*/
+class LogSink {
+
+	private:
+	
+		LogRecord *m_records;				// circular queue of records
+		unsigned int m_iCapacity;			// queue capacity
+		unsigned int m_iMask;				// capacity-1
+		volatile unsigned int m_iEnqueue;	// position to enqueue the next record
+		unsigned int m_iDequeue;			// position to dequeue the next record (consumer only)
+		volatile bool m_bRunning;			// whether the consumer thread is running
+#ifdef BVC_LOG_ASYNC_SUPPORTED
+		pthread_t m_thread;					// consumer thread
+#endif
+	
+		// write out all the records in the queue, returns the number of records written
+		int drain();
+		
+		// consumer thread main function
+		static void *run(void *data);
+
+	public:
+
+		// constructor
+		LogSink(unsigned int iCapacity = LOG_SINK_CAPACITY_DEFAULT);
+
+		// destructor (stops the consumer thread after writing out any pending records)
+		~LogSink();
+		
+		// start the consumer thread
+		bool start();
+		
+		// stop the consumer thread (pending records are written out)
+		void stop();
+		
+		// enqueue a record (waits while the queue is full), returns false if the consumer is not running
+		bool push(string *strRecord, bool bError);
+		
+		// wait until all the records enqueued so far are written out
+		void flush();
+};
+
+};	// end-of-namespace
+
+#endif
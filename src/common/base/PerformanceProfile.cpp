@@ -0,0 +1,106 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#include <sstream>
+
+#include "PerformanceProfile.h"
+
+namespace Bavieca {
+
+BVC_THREAD_LOCAL PerformanceProfile *PerformanceProfile::m_profileCurrent = NULL;
+
+// constructor
+PerformanceProfile::PerformanceProfile() {
+
+	reset();
+}
+
+// destructor
+PerformanceProfile::~PerformanceProfile() {
+
+	if (m_profileCurrent == this) {
+		m_profileCurrent = NULL;
+	}
+}
+
+// reset the counters and timers
+void PerformanceProfile::reset() {
+
+	for(int i=0 ; i < PROFILE_COUNTERS ; ++i) {
+		m_iCounters[i] = 0;
+	}
+	for(int i=0 ; i < PROFILE_TIMERS ; ++i) {
+		m_iCycles[i] = 0;
+	}
+}
+
+// accumulate the values of the given profile
+void PerformanceProfile::add(PerformanceProfile &profile) {
+
+	for(int i=0 ; i < PROFILE_COUNTERS ; ++i) {
+		m_iCounters[i] += profile.m_iCounters[i];
+	}
+	for(int i=0 ; i < PROFILE_TIMERS ; ++i) {
+		m_iCycles[i] += profile.m_iCycles[i];
+	}
+}
+
+// return the name of a counter
+const char *PerformanceProfile::getCounterName(int iCounter) {
+
+	static const char *strNames[PROFILE_COUNTERS] = {"frames","emissionsComputed","emissionCacheHits",
+		"gaussiansEvaluated","arcsActive","tokensExpanded","tokensPruned","laCacheHits","laCacheMisses",
+		"gcRuns","gcItemsSwept","latticeMerges","latticeEdges"};
+	
+	return strNames[iCounter];
+}
+
+// return the name of a timer
+const char *PerformanceProfile::getTimerName(int iTimer) {
+
+	static const char *strNames[PROFILE_TIMERS] = {"decoding","expansion","emission","pruning",
+		"lmLookAhead","gc","lattice"};
+	
+	return strNames[iTimer];
+}
+
+// write the profile in JSON format (single line)
+void PerformanceProfile::printJSON(ostream &os) {
+
+	os << "{\"counters\": {";
+	for(int i=0 ; i < PROFILE_COUNTERS ; ++i) {
+		os << ((i > 0) ? ", " : "") << "\"" << getCounterName(i) << "\": " << m_iCounters[i];
+	}
+	os << "}, \"cycles\": {";
+	for(int i=0 ; i < PROFILE_TIMERS ; ++i) {
+		os << ((i > 0) ? ", " : "") << "\"" << getTimerName(i) << "\": " << m_iCycles[i];
+	}
+	os << "}}";
+}
+
+// return the profile in JSON format (single line)
+string PerformanceProfile::getJSON() {
+
+	ostringstream oss;
+	printJSON(oss);
+	
+	return oss.str();
+}
+
+};	// end-of-namespace
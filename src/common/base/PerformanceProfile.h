@@ -0,0 +1,211 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#ifndef PERFORMANCEPROFILE_H
+#define PERFORMANCEPROFILE_H
+
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+#include "Global.h"
+
+#if defined _MSC_VER
+#include <intrin.h>
+#define BVC_THREAD_LOCAL __declspec(thread)
+#else
+#if defined __i386__ || defined __x86_64__
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+#define BVC_THREAD_LOCAL __thread
+#endif
+
+namespace Bavieca {
+
+// counters
+enum {
+	PROFILE_COUNTER_FRAMES=0,						// feature frames processed
+	PROFILE_COUNTER_EMISSIONS_COMPUTED,			// emission probabilities computed
+	PROFILE_COUNTER_EMISSION_CACHE_HITS,		// emission probabilities reused (same state and frame)
+	PROFILE_COUNTER_GAUSSIANS_EVALUATED,		// Gaussian components evaluated
+	PROFILE_COUNTER_ARCS_ACTIVE,					// arcs (or states) active after pruning (summed over frames)
+	PROFILE_COUNTER_TOKENS_EXPANDED,				// tokens propagated to the next frame
+	PROFILE_COUNTER_TOKENS_PRUNED,				// tokens removed by pruning
+	PROFILE_COUNTER_LA_CACHE_HITS,				// LM look-ahead cache hits
+	PROFILE_COUNTER_LA_CACHE_MISSES,				// LM look-ahead cache misses (look-ahead trees computed)
+	PROFILE_COUNTER_GC_RUNS,						// garbage collections of history items
+	PROFILE_COUNTER_GC_ITEMS_SWEPT,				// history items made available by garbage collection
+	PROFILE_COUNTER_LATTICE_MERGES,				// word sequence merges (lattice generation)
+	PROFILE_COUNTER_LATTICE_EDGES,				// lattice edges generated
+	PROFILE_COUNTERS
+};
+
+// timers (inclusive: expansion includes emission scoring and LM look-ahead) 
+enum {
+	PROFILE_TIMER_DECODING=0,						// feature vector processing (whole search)
+	PROFILE_TIMER_EXPANSION,						// token expansion
+	PROFILE_TIMER_EMISSION,							// emission probability computation
+	PROFILE_TIMER_PRUNING,							// pruning
+	PROFILE_TIMER_LM_LOOKAHEAD,					// LM look-ahead tree computation (cache misses)
+	PROFILE_TIMER_GC,									// garbage collection of history items
+	PROFILE_TIMER_LATTICE,							// lattice building
+	PROFILE_TIMERS
+};
+
+// instrumentation, it only records if a profile is attached to the calling thread and it is 
+// compiled out if BVC_PROFILING_ENABLED is not defined
+#ifdef BVC_PROFILING_ENABLED
+#define BVC_PROFILE_COUNT(counter,n) { PerformanceProfile *profile_ = PerformanceProfile::getCurrent(); \
+	if (profile_) { profile_->count(counter,n); } }
+#define BVC_PROFILE_TIMER_BEGIN(var) unsigned long long var = \
+	(PerformanceProfile::getCurrent() ? PerformanceProfile::getCycleCount() : 0)
+#define BVC_PROFILE_TIMER_END(timer,var) { PerformanceProfile *profile_ = PerformanceProfile::getCurrent(); \
+	if (profile_) { profile_->addCycles(timer,PerformanceProfile::getCycleCount()-var); } }
+#define BVC_PROFILE_SCOPE(profile) PerformanceProfileScope performanceProfileScope_(profile)
+#else
+#define BVC_PROFILE_COUNT(counter,n)
+#define BVC_PROFILE_TIMER_BEGIN(var)
+#define BVC_PROFILE_TIMER_END(timer,var)
+#define BVC_PROFILE_SCOPE(profile)
+#endif
+
+/**
+	@author daniel <dani.bolanos@gmail.com>
+	
+	Performance counters and cycle timers collected while decoding. A decoder attaches its profile 
+	to the thread while it runs, so components shared across decoders (i.e. HMM-states) record 
+	into the profile of the decoder calling them.
+*/
+class PerformanceProfile {
+
+	private:
+	
+		unsigned long long m_iCounters[PROFILE_COUNTERS];		// counters
+		unsigned long long m_iCycles[PROFILE_TIMERS];			// cycles spent
+		
+		static BVC_THREAD_LOCAL PerformanceProfile *m_profileCurrent;		// profile attached to the thread
+
+	public:
+
+		// constructor
+		PerformanceProfile();
+
+		// destructor
+		~PerformanceProfile();
+		
+		// reset the counters and timers
+		void reset();
+		
+		// add to a counter
+		inline void count(int iCounter, unsigned long long iValue) {
+		
+			m_iCounters[iCounter] += iValue;
+		}
+		
+		// add cycles to a timer
+		inline void addCycles(int iTimer, unsigned long long iCycles) {
+		
+			m_iCycles[iTimer] += iCycles;
+		}
+		
+		// return a counter
+		inline unsigned long long getCounter(int iCounter) {
+		
+			return m_iCounters[iCounter];
+		}
+		
+		// return the cycles spent in a timer
+		inline unsigned long long getCycles(int iTimer) {
+		
+			return m_iCycles[iTimer];
+		}
+		
+		// accumulate the values of the given profile
+		void add(PerformanceProfile &profile);
+		
+		// return the name of a counter
+		static const char *getCounterName(int iCounter);
+		
+		// return the name of a timer
+		static const char *getTimerName(int iTimer);
+		
+		// write the profile in JSON format (single line)
+		void printJSON(ostream &os);
+		
+		// return the profile in JSON format (single line)
+		string getJSON();
+		
+		// return the value of the cycle counter (nanoseconds where no cycle counter is available)
+		static inline unsigned long long getCycleCount() {
+		
+		#if defined _MSC_VER || defined __i386__ || defined __x86_64__
+			return __rdtsc();
+		#else
+			struct timespec ts;
+			clock_gettime(CLOCK_MONOTONIC,&ts);
+			return ((unsigned long long)ts.tv_sec)*1000000000ULL+ts.tv_nsec;
+		#endif
+		}
+		
+		// return the profile attached to the calling thread (NULL if none)
+		static inline PerformanceProfile *getCurrent() {
+		
+			return m_profileCurrent;
+		}
+		
+		// attach a profile to the calling thread (NULL to detach)
+		static inline void setCurrent(PerformanceProfile *profile) {
+		
+			m_profileCurrent = profile;
+		}
+};
+
+/**
+	@author daniel <dani.bolanos@gmail.com>
+	
+	Attaches a profile to the calling thread for the lifetime of the object.
+*/
+class PerformanceProfileScope {
+
+	private:
+	
+		PerformanceProfile *m_profilePrevious;
+
+	public:
+	
+		// constructor
+		PerformanceProfileScope(PerformanceProfile *profile) {
+		
+			m_profilePrevious = PerformanceProfile::getCurrent();
+			PerformanceProfile::setCurrent(profile);
+		}
+		
+		// destructor
+		~PerformanceProfileScope() {
+		
+			PerformanceProfile::setCurrent(m_profilePrevious);
+		}
+};
+
+};	// end-of-namespace
+
+#endif
@@ -0,0 +1,166 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#include "BeamController.h"
+#include "LogMessage.h"
+#include "TimeUtils.h"
+
+#include <iomanip>
+#include <math.h>
+#include <string.h>
+
+namespace Bavieca {
+
+// constructor
+BeamController::BeamController(int iMode, float fTarget, float fBeam, float fBeamMin, float fBeamMax) {
+
+	assert(fBeamMin <= fBeamMax);
+
+	m_iMode = iMode;
+	m_fTarget = fTarget;
+	m_fBeamMin = fBeamMin;
+	m_fBeamMax = fBeamMax;
+	reset(fBeam);
+}
+
+// destructor
+BeamController::~BeamController() {
+
+}
+
+// return the adaptive beam mode from its string representation
+int BeamController::getMode(const char *strMode) {
+
+	if (strcmp(strMode,ADAPTIVE_BEAM_MODE_STR_NONE) == 0) {
+		return ADAPTIVE_BEAM_MODE_NONE;
+	} else if (strcmp(strMode,ADAPTIVE_BEAM_MODE_STR_ACTIVE) == 0) {
+		return ADAPTIVE_BEAM_MODE_ACTIVE;
+	} else if (strcmp(strMode,ADAPTIVE_BEAM_MODE_STR_RTF) == 0) {
+		return ADAPTIVE_BEAM_MODE_RTF;
+	} else {
+		BVC_ERROR << "unknown adaptive beam mode: " << strMode;
+		return -1;
+	}
+}
+
+// return the string representation of the adaptive beam mode
+const char *BeamController::getStrMode(int iMode) {
+
+	switch(iMode) {
+		case ADAPTIVE_BEAM_MODE_ACTIVE: {
+			return ADAPTIVE_BEAM_MODE_STR_ACTIVE;
+		}
+		case ADAPTIVE_BEAM_MODE_RTF: {
+			return ADAPTIVE_BEAM_MODE_STR_RTF;
+		}
+		default: {
+			return ADAPTIVE_BEAM_MODE_STR_NONE;
+		}
+	}
+}
+
+// reset the beam and session statistics
+void BeamController::reset(float fBeam) {
+
+	m_fBeam = min(max(fBeam,m_fBeamMin),m_fBeamMax);
+	m_dMeasurement = -1.0;
+	m_dTimeLast = -1.0;
+	m_iFramesSession = 0;
+	m_dBeamSumSession = 0.0;
+	m_dActiveSumSession = 0.0;
+	beginUtterance();
+}
+
+// begin utterance
+void BeamController::beginUtterance() {
+
+	m_iFrames = 0;
+	m_dBeamSum = 0.0;
+	m_fBeamLow = FLT_MAX;
+	m_fBeamHigh = -FLT_MAX;
+	m_dActiveSum = 0.0;
+	m_iFramesAtMin = 0;
+	m_iFramesAtMax = 0;
+	// the time elapsed between utterances is not decoding time
+	m_dTimeLast = -1.0;
+}
+
+// update the beam given the number of arcs/states that survived pruning, returns the new beam
+float BeamController::update(int iActive) {
+
+	// get the measurement for the current frame
+	double dMeasurement = -1.0;
+	if (m_iMode == ADAPTIVE_BEAM_MODE_ACTIVE) {
+		dMeasurement = max(iActive,1);
+	} else if (m_iMode == ADAPTIVE_BEAM_MODE_RTF) {
+		double dTime = TimeUtils::getTimeMilliseconds();
+		if (m_dTimeLast >= 0.0) {
+			dMeasurement = max(dTime-m_dTimeLast,0.001);
+		}
+		m_dTimeLast = dTime;
+	}
+	
+	// smooth it and move the beam proportionally to the log-error
+	if (dMeasurement > 0.0) {
+		if (m_dMeasurement < 0.0) {
+			m_dMeasurement = dMeasurement;
+		} else {
+			m_dMeasurement = ADAPTIVE_BEAM_SMOOTHING*dMeasurement+(1.0-ADAPTIVE_BEAM_SMOOTHING)*m_dMeasurement;
+		}
+		double dTarget = m_fTarget;
+		if (m_iMode == ADAPTIVE_BEAM_MODE_RTF) {
+			dTarget *= ADAPTIVE_BEAM_FRAME_DURATION;
+		}
+		float fStep = (float)(ADAPTIVE_BEAM_GAIN*(m_fBeamMax-m_fBeamMin)*log(dTarget/m_dMeasurement));
+		m_fBeam = min(max(m_fBeam+fStep,m_fBeamMin),m_fBeamMax);
+	}
+	
+	// statistics
+	++m_iFrames;
+	m_dBeamSum += m_fBeam;
+	m_fBeamLow = min(m_fBeamLow,m_fBeam);
+	m_fBeamHigh = max(m_fBeamHigh,m_fBeam);
+	m_dActiveSum += iActive;
+	if (m_fBeam == m_fBeamMin) {
+		++m_iFramesAtMin;
+	} else if (m_fBeam == m_fBeamMax) {
+		++m_iFramesAtMax;
+	}
+	
+	return m_fBeam;
+}
+
+// end utterance (logs the decisions made by the controller)
+void BeamController::endUtterance() {
+
+	m_iFramesSession += m_iFrames;
+	m_dBeamSumSession += m_dBeamSum;
+	m_dActiveSumSession += m_dActiveSum;
+
+	if (m_iFrames == 0) {
+		return;
+	}
+	
+	BVC_VERB << "adaptive beam (" << getStrMode(m_iMode) << ", target: " << m_fTarget << ") frames: " << 
+		m_iFrames << " beam avg: " << FLT(8,2) << m_dBeamSum/m_iFrames << " min: " << FLT(8,2) << m_fBeamLow << 
+		" max: " << FLT(8,2) << m_fBeamHigh << " active avg: " << FLT(10,2) << m_dActiveSum/m_iFrames << 
+		" frames at min/max: " << m_iFramesAtMin << "/" << m_iFramesAtMax;
+}
+
+};	// end-of-namespace
@@ -0,0 +1,133 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#ifndef BEAMCONTROLLER_H
+#define BEAMCONTROLLER_H
+
+#include "Global.h"
+
+namespace Bavieca {
+
+// adaptive beam modes
+#define ADAPTIVE_BEAM_MODE_NONE				0		// fixed beams
+#define ADAPTIVE_BEAM_MODE_ACTIVE			1		// target number of active arcs/states after pruning
+#define ADAPTIVE_BEAM_MODE_RTF				2		// target real time factor (measured wall-clock time)
+
+#define ADAPTIVE_BEAM_MODE_STR_NONE			"none"
+#define ADAPTIVE_BEAM_MODE_STR_ACTIVE		"active"
+#define ADAPTIVE_BEAM_MODE_STR_RTF			"rtf"
+
+// controller settings
+#define ADAPTIVE_BEAM_SMOOTHING				0.10		// weight of the current frame in the smoothed measurement
+#define ADAPTIVE_BEAM_GAIN						0.05		// beam update for a unit log-error (fraction of the beam range)
+#define ADAPTIVE_BEAM_FRAME_DURATION		10.0		// frame duration in milliseconds (100 frames per second)
+
+/**
+	@author daniel <dani.bolanos@gmail.com>
+	
+	Feedback controller that adjusts the likelihood beam after each frame so the search meets a target 
+	number of active arcs/states or a target real time factor, the beam is kept within [min,max].
+*/
+class BeamController {
+
+	private:
+	
+		int m_iMode;						// adaptive beam mode
+		float m_fTarget;					// target # active arcs/states or RTF
+		float m_fBeamMin;					// minimum beam
+		float m_fBeamMax;					// maximum beam
+		float m_fBeam;						// current beam
+		double m_dMeasurement;			// smoothed measurement (# active arcs/states or milliseconds per frame)
+		double m_dTimeLast;				// time of the last update (milliseconds)
+		
+		// utterance statistics
+		int m_iFrames;
+		double m_dBeamSum;
+		float m_fBeamLow;
+		float m_fBeamHigh;
+		double m_dActiveSum;
+		int m_iFramesAtMin;
+		int m_iFramesAtMax;
+		
+		// session statistics
+		int m_iFramesSession;
+		double m_dBeamSumSession;
+		double m_dActiveSumSession;
+
+	public:
+
+		// constructor
+		BeamController(int iMode, float fTarget, float fBeam, float fBeamMin, float fBeamMax);
+
+		// destructor
+		~BeamController();
+		
+		// return the adaptive beam mode from its string representation
+		static int getMode(const char *strMode);
+		
+		// return the string representation of the adaptive beam mode
+		static const char *getStrMode(int iMode);
+		
+		// set the target
+		inline void setTarget(float fTarget) {
+		
+			m_fTarget = fTarget;
+		}
+		
+		// return the target
+		inline float getTarget() {
+		
+			return m_fTarget;
+		}
+		
+		// return the current beam
+		inline float getBeam() {
+		
+			return m_fBeam;
+		}
+		
+		// return the average beam across the session
+		inline float getBeamAverageSession() {
+		
+			return (m_iFramesSession > 0) ? (float)(m_dBeamSumSession/m_iFramesSession) : m_fBeam;
+		}
+		
+		// return the average number of active arcs/states across the session
+		inline float getActiveAverageSession() {
+		
+			return (m_iFramesSession > 0) ? (float)(m_dActiveSumSession/m_iFramesSession) : 0.0f;
+		}
+		
+		// reset the beam and session statistics
+		void reset(float fBeam);
+		
+		// begin utterance
+		void beginUtterance();
+		
+		// update the beam given the number of arcs/states that survived pruning, returns the new beam
+		float update(int iActive);
+		
+		// end utterance (logs the decisions made by the controller)
+		void endUtterance();
+
+};
+
+};	// end-of-namespace
+
+#endif
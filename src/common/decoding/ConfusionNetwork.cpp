@@ -0,0 +1,255 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#include <algorithm>
+#include <iomanip>
+
+#include "BestPath.h"
+#include "ConfusionNetwork.h"
+#include "FileOutput.h"
+
+namespace Bavieca {
+
+// constructor
+ConfusionNetwork::ConfusionNetwork(LexiconManager *lexiconManager) {
+
+	m_lexiconManager = lexiconManager;
+}
+
+// destructor
+ConfusionNetwork::~ConfusionNetwork() {
+
+	for(VCNSlot::iterator it = m_vSlots.begin() ; it != m_vSlots.end() ; ++it) {
+		delete *it;
+	}
+}
+
+// build the network by clustering edges around a pivot path, each edge is compared only to the 
+// slots it overlaps in time (binary search) so the cost is O(E log E) in the number of edges
+void ConfusionNetwork::build(VLEdge &vEdgePivot, VLEdge &vEdges) {
+
+	// (1) each edge in the pivot path starts a slot (the pivot path is a sequence of edges so 
+	// the slots are disjoint and sorted by time)
+	for(VLEdge::iterator it = vEdgePivot.begin() ; it != vEdgePivot.end() ; ++it) {
+		CNSlot *slot = newSlot((int)m_vSlots.size(),(*it)->iFrameStart,(*it)->iFrameEnd,(*it)->lexUnit);
+		addEdge(slot,*it);
+	}
+	
+	// (2) cluster the remaining edges, most likely first so they are the ones creating new slots 
+	VLEdge vEdgesSorted(vEdges);
+	sort(vEdgesSorted.begin(),vEdgesSorted.end(),compareEdgePP);
+	for(VLEdge::iterator it = vEdgesSorted.begin() ; it != vEdgesSorted.end() ; ++it) {
+	
+		LEdge *edge = *it;
+		float fFrames = (float)(edge->iFrameEnd-edge->iFrameStart+1);
+		
+		// best overlapping slot and longest interval of the edge not covered by any slot
+		CNSlot *slotBest = NULL;
+		float fScoreBest = -FLT_MAX;
+		int iOverlapBest = 0;
+		int iGap = 0;
+		int iGapStart = -1;
+		int iGapEnd = -1;
+		int iGapPosition = -1;
+		int iFrame = edge->iFrameStart;
+		int iSlot = findSlot(edge->iFrameStart);
+		for( ; (iSlot < (int)m_vSlots.size()) && (m_vSlots[iSlot]->iFrameStart <= edge->iFrameEnd) ; ++iSlot) {
+			CNSlot *slot = m_vSlots[iSlot];
+			// uncovered interval before the slot
+			if (slot->iFrameStart-iFrame > iGap) {
+				iGap = slot->iFrameStart-iFrame;
+				iGapStart = iFrame;
+				iGapEnd = slot->iFrameStart-1;
+				iGapPosition = iSlot;
+			}
+			iFrame = slot->iFrameEnd+1;
+			// time overlap
+			int iOverlap = min(slot->iFrameEnd,edge->iFrameEnd)-max(slot->iFrameStart,edge->iFrameStart)+1;
+			assert(iOverlap > 0);
+			// phonetic similarity (full if the word is already hypothesized in the slot)
+			float fSimilarity = -1.0;
+			for(VCNEntry::iterator jt = slot->vEntries.begin() ; jt != slot->vEntries.end() ; ++jt) {
+				if (jt->lexUnit->iLexUnit == edge->lexUnit->iLexUnit) {
+					fSimilarity = 1.0;
+					break;
+				}
+			}
+			if (fSimilarity < 0.0) {
+				fSimilarity = phoneticSimilarity(edge->lexUnit,slot->lexUnitRef);
+			}
+			float fScore = ((float)iOverlap)/fFrames + CONFUSION_NETWORK_WEIGHT_PHONETIC*fSimilarity;
+			if (fScore > fScoreBest) {
+				fScoreBest = fScore;
+				slotBest = slot;
+				iOverlapBest = iOverlap;
+			}
+		}
+		// uncovered interval after the last overlapping slot
+		if (edge->iFrameEnd-iFrame+1 > iGap) {
+			iGap = edge->iFrameEnd-iFrame+1;
+			iGapStart = iFrame;
+			iGapEnd = edge->iFrameEnd;
+			iGapPosition = iSlot;
+		}
+		
+		// the edge goes to a new slot if it mostly falls in between existing slots
+		if ((slotBest == NULL) || 
+			((iGap > iOverlapBest) && (iGap >= CONFUSION_NETWORK_MIN_FRACTION_GAP*fFrames))) {
+			assert(iGap > 0);
+			slotBest = newSlot(iGapPosition,iGapStart,iGapEnd,edge->lexUnit);
+		}
+		addEdge(slotBest,edge);
+	}
+	
+	// (3) normalize the slots: posteriors of overlapping edges from the same path may be clustered 
+	// together, the remaining probability mass goes to the empty hypothesis
+	for(VCNSlot::iterator it = m_vSlots.begin() ; it != m_vSlots.end() ; ++it) {
+		double dPP = 0.0;
+		for(VCNEntry::iterator jt = (*it)->vEntries.begin() ; jt != (*it)->vEntries.end() ; ++jt) {
+			dPP += jt->dPP;
+		}
+		if (dPP > 1.0) {
+			for(VCNEntry::iterator jt = (*it)->vEntries.begin() ; jt != (*it)->vEntries.end() ; ++jt) {
+				jt->dPP /= dPP;
+			}
+			(*it)->dPPEmpty = 0.0;
+		} else {
+			(*it)->dPPEmpty = 1.0-dPP;
+		}
+		sort((*it)->vEntries.begin(),(*it)->vEntries.end(),compareEntryPP);
+	}
+}
+
+// return the index of the first slot that ends at or after the given frame
+int ConfusionNetwork::findSlot(int iFrame) {
+
+	int iLow = 0;
+	int iHigh = (int)m_vSlots.size();
+	while(iLow < iHigh) {
+		int iMiddle = (iLow+iHigh)/2;
+		if (m_vSlots[iMiddle]->iFrameEnd < iFrame) {
+			iLow = iMiddle+1;
+		} else {
+			iHigh = iMiddle;
+		}
+	}
+	
+	return iLow;
+}
+
+// create a new slot at the given position
+CNSlot *ConfusionNetwork::newSlot(int iPosition, int iFrameStart, int iFrameEnd, LexUnit *lexUnit) {
+
+	CNSlot *slot = new CNSlot;
+	slot->iFrameStart = iFrameStart;
+	slot->iFrameEnd = iFrameEnd;
+	slot->lexUnitRef = lexUnit;
+	slot->dPPEmpty = 1.0;
+	m_vSlots.insert(m_vSlots.begin()+iPosition,slot);
+	
+	return slot;
+}
+
+// accumulate the posterior of an edge into the slot
+void ConfusionNetwork::addEdge(CNSlot *slot, LEdge *edge) {
+
+	for(VCNEntry::iterator it = slot->vEntries.begin() ; it != slot->vEntries.end() ; ++it) {
+		if (it->lexUnit->iLexUnit == edge->lexUnit->iLexUnit) {
+			it->iFrameStart = min(it->iFrameStart,edge->iFrameStart);
+			it->iFrameEnd = max(it->iFrameEnd,edge->iFrameEnd);
+			it->dPP += edge->fPP;
+			return;
+		}
+	}
+	
+	CNEntry entry;
+	entry.lexUnit = edge->lexUnit;
+	entry.iFrameStart = edge->iFrameStart;
+	entry.iFrameEnd = edge->iFrameEnd;
+	entry.dPP = edge->fPP;
+	slot->vEntries.push_back(entry);
+}
+
+// phonetic similarity between two lexical units in the range [0-1] (normalized edit distance)
+float ConfusionNetwork::phoneticSimilarity(LexUnit *lexUnit1, LexUnit *lexUnit2) {
+
+	unsigned int iPhones1 = (unsigned int)lexUnit1->vPhones.size();
+	unsigned int iPhones2 = (unsigned int)lexUnit2->vPhones.size();
+	if ((iPhones1 == 0) || (iPhones2 == 0)) {
+		return 0.0;
+	}
+	
+	// edit distance keeping only two rows of the table
+	vector<int> vRowPrev(iPhones2+1);
+	vector<int> vRow(iPhones2+1);
+	for(unsigned int j=0 ; j <= iPhones2 ; ++j) {
+		vRowPrev[j] = j;
+	}
+	for(unsigned int i=1 ; i <= iPhones1 ; ++i) {
+		vRow[0] = i;
+		for(unsigned int j=1 ; j <= iPhones2 ; ++j) {
+			int iCost = (lexUnit1->vPhones[i-1] == lexUnit2->vPhones[j-1]) ? 0 : 1;
+			vRow[j] = min(min(vRowPrev[j]+1,vRow[j-1]+1),vRowPrev[j-1]+iCost);
+		}
+		vRowPrev.swap(vRow);
+	}
+	
+	return 1.0f-((float)vRowPrev[iPhones2])/((float)max(iPhones1,iPhones2));
+}
+
+// return the minimum Bayes risk hypothesis (the most likely entry from each slot, confidence 
+// scores are the slot posteriors)
+BestPath *ConfusionNetwork::getBestPath() {
+
+	BestPath *bestPath = new BestPath(m_lexiconManager,0.0);
+	for(VCNSlot::iterator it = m_vSlots.begin() ; it != m_vSlots.end() ; ++it) {
+		if ((*it)->vEntries.empty() || ((*it)->vEntries.front().dPP <= (*it)->dPPEmpty)) {
+			continue;
+		}
+		CNEntry &entry = (*it)->vEntries.front();
+		bestPath->newElementBack(entry.iFrameStart,entry.iFrameEnd,0.0,0.0,0.0,(float)entry.dPP,
+			entry.lexUnit,0.0);
+	}
+	
+	return bestPath;
+}
+
+// store the network to disk (text format)
+void ConfusionNetwork::store(const char *strFile) {
+
+	FileOutput file(strFile,false);
+	file.open();
+	print(file.getStream());
+	file.close();
+}
+
+// print the network (one slot per line: time interval followed by the hypotheses and posteriors)
+void ConfusionNetwork::print(ostream &os) {
+
+	for(VCNSlot::iterator it = m_vSlots.begin() ; it != m_vSlots.end() ; ++it) {
+		os << setw(6) << (*it)->iFrameStart << " " << setw(6) << (*it)->iFrameEnd;
+		for(VCNEntry::iterator jt = (*it)->vEntries.begin() ; jt != (*it)->vEntries.end() ; ++jt) {
+			os << " " << m_lexiconManager->getStrLexUnit(jt->lexUnit->iLexUnit) << " " 
+				<< fixed << setprecision(4) << jt->dPP;
+		}
+		os << " " << CONFUSION_NETWORK_EMPTY_SYMBOL << " " << fixed << setprecision(4) << (*it)->dPPEmpty << endl;
+	}
+}
+
+};	// end-of-namespace
@@ -0,0 +1,140 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#ifndef CONFUSIONNETWORK_H
+#define CONFUSIONNETWORK_H
+
+using namespace std;
+
+#include <vector>
+
+#include "HypothesisLattice.h"
+#include "LexiconManager.h"
+
+namespace Bavieca {
+
+class BestPath;
+
+// weight of the phonetic similarity (respect to the time overlap) when clustering an edge into a slot
+#define CONFUSION_NETWORK_WEIGHT_PHONETIC			0.5
+
+// minimum fraction of the edge frames not covered by any slot needed to create a new slot
+#define CONFUSION_NETWORK_MIN_FRACTION_GAP			0.5
+
+// default minimum posterior probability of an edge to be clustered into the network
+#define CONFUSION_NETWORK_MIN_POSTERIOR				0.001
+
+// symbol used for the empty hypothesis (deletion) when writing the network
+#define CONFUSION_NETWORK_EMPTY_SYMBOL				"<eps>"
+
+// word hypothesis in a slot of the confusion network (collapses edges with the same lexical unit)
+typedef struct {
+	LexUnit *lexUnit;					// lexical unit (pronunciation of the first edge clustered)
+	int iFrameStart;					// earliest start frame of the clustered edges
+	int iFrameEnd;						// latest end frame of the clustered edges
+	double dPP;							// accumulated posterior probability
+} CNEntry;
+
+typedef vector<CNEntry> VCNEntry;
+
+// slot of the confusion network (competing word hypotheses over a time interval)
+typedef struct {
+	int iFrameStart;					// start frame
+	int iFrameEnd;						// end frame
+	LexUnit *lexUnitRef;				// lexical unit that created the slot (for phonetic similarity)
+	VCNEntry vEntries;				// word hypotheses (sorted by posterior once the network is built)
+	double dPPEmpty;					// posterior probability of the empty hypothesis (deletion)
+} CNSlot;
+
+typedef vector<CNSlot*> VCNSlot;
+
+/**
+	@author daniel <dani.bolanos@gmail.com>
+*/
+class ConfusionNetwork {
+
+	private:
+	
+		LexiconManager *m_lexiconManager;
+		VCNSlot m_vSlots;								// slots sorted by time (disjoint intervals)
+		
+		// return the index of the first slot that ends at or after the given frame
+		int findSlot(int iFrame);
+		
+		// create a new slot at the given position
+		CNSlot *newSlot(int iPosition, int iFrameStart, int iFrameEnd, LexUnit *lexUnit);
+		
+		// accumulate the posterior of an edge into the slot
+		void addEdge(CNSlot *slot, LEdge *edge);
+		
+		// phonetic similarity between two lexical units in the range [0-1] (normalized edit distance)
+		static float phoneticSimilarity(LexUnit *lexUnit1, LexUnit *lexUnit2);
+		
+		// compare edges by posterior probability (higher first)
+		static bool compareEdgePP(const LEdge *edge1, const LEdge *edge2) {
+		
+			return (edge1->fPP > edge2->fPP);
+		}
+		
+		// compare slot entries by posterior probability (higher first)
+		static bool compareEntryPP(const CNEntry &entry1, const CNEntry &entry2) {
+		
+			return (entry1.dPP > entry2.dPP);
+		}
+
+	public:
+
+		// constructor
+		ConfusionNetwork(LexiconManager *lexiconManager);
+
+		// destructor
+		~ConfusionNetwork();
+		
+		// build the network by clustering edges around a pivot path, each edge is compared only to the 
+		// slots it overlaps in time (binary search) so the cost is O(E log E) in the number of edges
+		void build(VLEdge &vEdgePivot, VLEdge &vEdges);
+		
+		// return the number of slots
+		inline unsigned int size() {
+		
+			return (unsigned int)m_vSlots.size();
+		}
+		
+		// return the given slot
+		inline CNSlot *getSlot(unsigned int iSlot) {
+		
+			assert(iSlot < m_vSlots.size());
+			return m_vSlots[iSlot];
+		}
+		
+		// return the minimum Bayes risk hypothesis (the most likely entry from each slot, confidence 
+		// scores are the slot posteriors)
+		BestPath *getBestPath();
+		
+		// store the network to disk (text format)
+		void store(const char *strFile);
+		
+		// print the network
+		void print(ostream &os = cout);
+
+};
+
+};	// end-of-namespace
+
+#endif
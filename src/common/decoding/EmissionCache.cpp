@@ -0,0 +1,102 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#include "EmissionCache.h"
+#include "HMMManager.h"
+#include "LogMessage.h"
+
+#include <iomanip>
+
+namespace Bavieca {
+
+// constructor
+EmissionCache::EmissionCache(HMMManager *hmmManager, int iFrames) {
+
+	assert(iFrames >= 1);
+
+	m_iFrames = iFrames;
+	hmmManager->getHMMStatesDecoding(&m_iHMMStates);
+	m_fScores = new float[m_iHMMStates*m_iFrames];
+	m_iTimeBegin = new int[m_iHMMStates];
+	m_iTimeEnd = new int[m_iHMMStates];
+	m_fFeatures = NULL;
+	m_iStride = 0;
+	m_iWindows = 0;
+	m_iScores = 0;
+	beginUtterance();
+}
+
+// destructor
+EmissionCache::~EmissionCache() {
+
+	delete [] m_fScores;
+	delete [] m_iTimeBegin;
+	delete [] m_iTimeEnd;
+}
+
+// begin utterance
+void EmissionCache::beginUtterance() {
+
+	for(int i=0 ; i < m_iHMMStates ; ++i) {
+		m_iTimeBegin[i] = -1;
+		m_iTimeEnd[i] = -1;
+	}
+	m_fFeatures = NULL;
+	m_iTimeFeaturesBegin = -1;
+	m_iTimeFeaturesEnd = -1;
+}
+
+// set the feature vectors of the chunk to decode (iTimeBegin is the time-stamp of the first one)
+void EmissionCache::setFeatures(MatrixBase<float> &mFeatures, int iTimeBegin) {
+
+	m_fFeatures = mFeatures.getData();
+	m_iStride = mFeatures.getStride();
+	m_iTimeFeaturesBegin = iTimeBegin;
+	m_iTimeFeaturesEnd = iTimeBegin+mFeatures.getRows();
+}
+
+// compute the window of the given HMM-state starting at the given frame and return the first score
+float EmissionCache::computeWindow(HMMStateDecoding *hmmStateDecoding, int iTime) {
+
+	BVC_PROFILE_TIMER_BEGIN(iCycles);
+	int iHMMState = hmmStateDecoding->getId();
+	int iFrames = min(m_iFrames,m_iTimeFeaturesEnd-iTime);
+	float *fScores = m_fScores+iHMMState*m_iFrames;
+	hmmStateDecoding->computeEmissionProbabilityBatch(m_fFeatures+(iTime-m_iTimeFeaturesBegin)*m_iStride,
+		m_iStride,iFrames,fScores);
+	BVC_PROFILE_TIMER_END(PROFILE_TIMER_EMISSION,iCycles);
+	m_iTimeBegin[iHMMState] = iTime;
+	m_iTimeEnd[iHMMState] = iTime+iFrames;
+	
+	++m_iWindows;
+	m_iScores += iFrames;
+	BVC_PROFILE_COUNT(PROFILE_COUNTER_EMISSIONS_COMPUTED,iFrames);
+	BVC_PROFILE_COUNT(PROFILE_COUNTER_GAUSSIANS_EVALUATED,iFrames*hmmStateDecoding->getGaussianComponents());
+	
+	return fScores[0];
+}
+
+// print session statistics
+void EmissionCache::print() {
+
+	BVC_INFORMATION << "emission cache: " << m_iFrames << " frames per window, " << m_iWindows << 
+		" windows computed, " << FLT(6,2) << getFramesPerWindowSession() << " frames per window on average";
+}
+
+};	// end-of-namespace
@@ -0,0 +1,108 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#ifndef EMISSIONCACHE_H
+#define EMISSIONCACHE_H
+
+#include "Global.h"
+#include "HMMStateDecoding.h"
+#include "MatrixBase.h"
+
+namespace Bavieca {
+
+class HMMManager;
+
+/**
+	@author daniel <dani.bolanos@gmail.com>
+	
+	Emission probability cache for the case in which the feature vectors are available ahead of time 
+	(batch decoding or chunked streaming). When an HMM-state is scored at a frame not in its window, its 
+	emission probabilities are computed for that frame and the following ones (up to the window size and 
+	the end of the chunk) in a single pass over its Gaussian components, later frames only look them up.
+	The cache kept inside each HMM-state is never used, so several decoders can share the HMMs.
+*/
+class EmissionCache {
+
+	private:
+	
+		int m_iFrames;						// window size (frames)
+		int m_iHMMStates;					// number of HMM-states
+		float *m_fScores;					// emission probabilities [HMM-state x frame]
+		int *m_iTimeBegin;				// first frame in the window of each HMM-state
+		int *m_iTimeEnd;					// frame after the last frame in the window of each HMM-state
+		
+		// features of the current chunk
+		float *m_fFeatures;
+		int m_iStride;
+		int m_iTimeFeaturesBegin;
+		int m_iTimeFeaturesEnd;
+		
+		// session statistics
+		long long m_iWindows;			// number of windows computed
+		long long m_iScores;				// number of emission probabilities computed
+		
+		// compute the window of the given HMM-state starting at the given frame and return the first score
+		float computeWindow(HMMStateDecoding *hmmStateDecoding, int iTime);
+
+	public:
+
+		// constructor
+		EmissionCache(HMMManager *hmmManager, int iFrames);
+
+		// destructor
+		~EmissionCache();
+		
+		// begin utterance
+		void beginUtterance();
+		
+		// set the feature vectors of the chunk to decode (iTimeBegin is the time-stamp of the first one)
+		void setFeatures(MatrixBase<float> &mFeatures, int iTimeBegin);
+		
+		// return the emission probability of the HMM-state at the given frame
+		// (fFeatures are used if the frame is not in the current chunk)
+		inline float computeEmissionProbability(HMMStateDecoding *hmmStateDecoding, float *fFeatures, int iTime) {
+		
+			int iHMMState = hmmStateDecoding->getId();
+			if ((iTime >= m_iTimeBegin[iHMMState]) && (iTime < m_iTimeEnd[iHMMState])) {
+				BVC_PROFILE_COUNT(PROFILE_COUNTER_EMISSION_CACHE_HITS,1);
+				return m_fScores[iHMMState*m_iFrames+iTime-m_iTimeBegin[iHMMState]];
+			}
+			if ((iTime < m_iTimeFeaturesBegin) || (iTime >= m_iTimeFeaturesEnd)) {
+				float fScore;
+				hmmStateDecoding->computeEmissionProbabilityBatch(fFeatures,0,1,&fScore);
+				return fScore;
+			}
+			
+			return computeWindow(hmmStateDecoding,iTime);
+		}
+		
+		// return the average number of frames scored per window across the session
+		inline float getFramesPerWindowSession() {
+		
+			return (m_iWindows > 0) ? ((float)m_iScores)/((float)m_iWindows) : 0.0f;
+		}
+		
+		// print session statistics
+		void print();
+
+};
+
+};	// end-of-namespace
+
+#endif
@@ -0,0 +1,144 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#include "FrameSkipper.h"
+#include "LogMessage.h"
+
+#include <iomanip>
+#include <string.h>
+
+namespace Bavieca {
+
+// constructor
+FrameSkipper::FrameSkipper(int iMode, int iRate, float fThreshold, int iDim) {
+
+	assert(iRate >= 1);
+	assert(iDim > 0);
+
+	m_iMode = iMode;
+	m_iRate = iRate;
+	m_fThreshold = fThreshold;
+	m_iDim = iDim;
+	m_fFeatures = new float[m_iDim];
+	m_fEnergy = 0.0;
+	m_iFramesSession = 0;
+	m_iFramesEvaluatedSession = 0;
+	beginUtterance();
+}
+
+// destructor
+FrameSkipper::~FrameSkipper() {
+
+	delete [] m_fFeatures;
+}
+
+// return the frame skipping mode from its string representation
+int FrameSkipper::getMode(const char *strMode) {
+
+	if (strcmp(strMode,FRAME_SKIPPING_MODE_STR_NONE) == 0) {
+		return FRAME_SKIPPING_MODE_NONE;
+	} else if (strcmp(strMode,FRAME_SKIPPING_MODE_STR_FIXED) == 0) {
+		return FRAME_SKIPPING_MODE_FIXED;
+	} else if (strcmp(strMode,FRAME_SKIPPING_MODE_STR_ADAPTIVE) == 0) {
+		return FRAME_SKIPPING_MODE_ADAPTIVE;
+	} else {
+		BVC_ERROR << "unknown frame skipping mode: " << strMode;
+		return -1;
+	}
+}
+
+// return the string representation of the frame skipping mode
+const char *FrameSkipper::getStrMode(int iMode) {
+
+	switch(iMode) {
+		case FRAME_SKIPPING_MODE_FIXED: {
+			return FRAME_SKIPPING_MODE_STR_FIXED;
+		}
+		case FRAME_SKIPPING_MODE_ADAPTIVE: {
+			return FRAME_SKIPPING_MODE_STR_ADAPTIVE;
+		}
+		default: {
+			return FRAME_SKIPPING_MODE_STR_NONE;
+		}
+	}
+}
+
+// begin utterance
+void FrameSkipper::beginUtterance() {
+
+	m_iTime = -1;
+	m_iSkipped = 0;
+	m_iFrames = 0;
+	m_iFramesEvaluated = 0;
+}
+
+// return the features to evaluate emission probabilities with at the given frame and its time-stamp
+float *FrameSkipper::select(float *fFeatures, int iTime, int *iTimeEmission) {
+
+	++m_iFrames;
+
+	// skip the frame?
+	bool bSkip = false;
+	if ((m_iTime != -1) && (m_iSkipped+1 < m_iRate)) {
+		if (m_iMode == FRAME_SKIPPING_MODE_FIXED) {
+			bSkip = true;
+		} else if (m_iMode == FRAME_SKIPPING_MODE_ADAPTIVE) {
+			float fDistance = 0.0;
+			for(int i=0 ; i < m_iDim ; ++i) {
+				float fDiff = fFeatures[i]-m_fFeatures[i];
+				fDistance += fDiff*fDiff;
+			}
+			bSkip = (fDistance <= m_fThreshold*m_fEnergy);
+		}
+	}
+	
+	if (bSkip) {
+		++m_iSkipped;
+	} else {
+		memcpy(m_fFeatures,fFeatures,m_iDim*sizeof(float));
+		m_fEnergy = 0.0;
+		for(int i=0 ; i < m_iDim ; ++i) {
+			m_fEnergy += fFeatures[i]*fFeatures[i];
+		}
+		m_iTime = iTime;
+		m_iSkipped = 0;
+		++m_iFramesEvaluated;
+	}
+	
+	*iTimeEmission = m_iTime;
+	
+	return m_fFeatures;
+}
+
+// end utterance
+void FrameSkipper::endUtterance() {
+
+	m_iFramesSession += m_iFrames;
+	m_iFramesEvaluatedSession += m_iFramesEvaluated;
+
+	if (m_iFrames == 0) {
+		return;
+	}
+	
+	BVC_VERB << "frame skipping (" << getStrMode(m_iMode) << ", rate: " << m_iRate << ") frames: " << m_iFrames << 
+		" evaluated: " << m_iFramesEvaluated << " (" << FLT(6,2) << 
+		100.0*((float)m_iFramesEvaluated)/((float)m_iFrames) << "%)";
+}
+
+};	// end-of-namespace
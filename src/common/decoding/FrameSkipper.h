@@ -0,0 +1,99 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#ifndef FRAMESKIPPER_H
+#define FRAMESKIPPER_H
+
+#include "Global.h"
+
+namespace Bavieca {
+
+// frame skipping modes
+#define FRAME_SKIPPING_MODE_NONE				0		// emission probabilities are evaluated at every frame
+#define FRAME_SKIPPING_MODE_FIXED			1		// emission probabilities are evaluated every N frames
+#define FRAME_SKIPPING_MODE_ADAPTIVE		2		// frames close to the last evaluated frame are skipped (up to N-1)
+
+#define FRAME_SKIPPING_MODE_STR_NONE			"none"
+#define FRAME_SKIPPING_MODE_STR_FIXED			"fixed"
+#define FRAME_SKIPPING_MODE_STR_ADAPTIVE		"adaptive"
+
+/**
+	@author daniel <dani.bolanos@gmail.com>
+	
+	Decides which frames get their emission probabilities evaluated. On skipped frames the search still 
+	advances one frame but the emission probabilities of the last evaluated frame are reused, the 
+	decoders achieve that by scoring with the features and the time-stamp of that frame, so scores 
+	already in the HMM-state cache are reused and states activated on the skipped frame are scored 
+	against the same features. 
+*/
+class FrameSkipper {
+
+	private:
+	
+		int m_iMode;						// frame skipping mode
+		int m_iRate;						// maximum number of frames sharing the same evaluation
+		float m_fThreshold;				// maximum relative change of the features for a frame to be skipped
+		int m_iDim;							// feature dimensionality
+		float *m_fFeatures;				// features of the last evaluated frame
+		float m_fEnergy;					// squared norm of the last evaluated frame
+		int m_iTime;						// time-stamp of the last evaluated frame
+		int m_iSkipped;					// number of consecutive skipped frames
+		
+		// utterance statistics
+		int m_iFrames;
+		int m_iFramesEvaluated;
+		
+		// session statistics
+		int m_iFramesSession;
+		int m_iFramesEvaluatedSession;
+
+	public:
+
+		// constructor
+		FrameSkipper(int iMode, int iRate, float fThreshold, int iDim);
+
+		// destructor
+		~FrameSkipper();
+		
+		// return the frame skipping mode from its string representation
+		static int getMode(const char *strMode);
+		
+		// return the string representation of the frame skipping mode
+		static const char *getStrMode(int iMode);
+		
+		// begin utterance
+		void beginUtterance();
+		
+		// return the features to evaluate emission probabilities with at the given frame and its time-stamp
+		float *select(float *fFeatures, int iTime, int *iTimeEmission);
+		
+		// end utterance
+		void endUtterance();
+		
+		// return the fraction of frames evaluated across the session
+		inline float getEvaluatedRatioSession() {
+		
+			return (m_iFramesSession > 0) ? ((float)m_iFramesEvaluatedSession)/((float)m_iFramesSession) : 1.0f;
+		}
+
+};
+
+};	// end-of-namespace
+
+#endif
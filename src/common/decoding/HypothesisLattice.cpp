@@ -19,6 +19,7 @@
 
 #include "Alignment.h"
 #include "BestPath.h"
+#include "ConfusionNetwork.h"
 #include "FileInput.h"
 #include "FileOutput.h"
 #include "HMMManager.h"
@@ -49,6 +50,10 @@ HypothesisLattice::HypothesisLattice(PhoneSet *phoneSet, LexiconManager *lexicon
 	m_iNodes = -1;
 	m_iEdges = -1;
 	m_iFrames = -1;	
+	
+	// hmm-marking
+	m_iContextSizeWW = 0;
+	m_iContextSizeCW = 0;
 }
 
 // destructor
@@ -1581,9 +1586,12 @@ void HypothesisLattice::hmmMarking(HMMManager *hmmManager) {
 // WER computation ---------------------------------------------------------------------------
 
 // compute the Lattice Word Error Rate (also known as oracle)
+// the lattice is composed with the Levenshtein automaton of the reference: nodes are visited in 
+// topological order and each node keeps the best alignment for every reference position reachable 
+// within the beam (states are recombined on (lattice node, reference position))
 // - perfect match: prune all paths with edit errors (the goal is to get WER = 0 or failure)
-// note: the alignment is not time synchronous so pruning based on best-partial-score is 
-//       not possible (unless we are looking for a perfect-match)
+// - pruning: besides the beam, state (node,r) is discarded if a state (node,r') with r' > r satisfies
+//   score(r')+r' <= score(r)+r, since any completion from r costs at most (r'-r) less than from r'
 LatticeWER *HypothesisLattice::computeWER(VLexUnit &vLexUnitReference, BestPath **bestPath, 
 	Mappings *mappings, bool bPerfectMatch, int iBeamSize) {
 
@@ -1611,189 +1619,204 @@ LatticeWER *HypothesisLattice::computeWER(VLexUnit &vLexUnitReference, BestPath
 		}
 	}	
 	
- 	double dTimeBegin = TimeUtils::getTimeMilliseconds();	
+ 	double dTimeBegin = TimeUtils::getTimeMilliseconds();
 	
-	// create an array of active tokens
-	m_tokenCurrent = new LWERToken[LATTICE_WER_MAX_TOKENS];
-	m_tokenNext = new LWERToken[LATTICE_WER_MAX_TOKENS];
-	m_iActiveTokensCurrent = 0;	
+	int iWordsReference = (int)vLexUnitReference.size();
 	
-	// create the table of nodes used to keep the active tokens at each node
-	m_iTokenNode = new int[m_iNodes];
-	for(int i=0 ; i < m_iNodes ; ++i) {
-		m_iTokenNode[i] = -1;
-	}	
+	// apply mappings to the reference
+	vector<const char*> vStrReference;
+	if (mappings) {
+		for(VLexUnit::iterator it = vLexUnitReference.begin() ; it != vLexUnitReference.end() ; ++it) {
+			vStrReference.push_back((*mappings)[m_lexiconManager->getStrLexUnit((*it)->iLexUnit)]);
+		}
+	}
 	
-	// allocate memory for the history items and create the linked list of available items
-	m_iHistoryItems = LATTICE_WER_HISTORY_ITEMS_START;
-	m_historyItems = new LWERHistoryItem[m_iHistoryItems];
-	for(int i=0 ; i < m_iHistoryItems-1 ; ++i) {
-		m_historyItems[i].iPrev = i+1;
-	}
-	m_historyItems[m_iHistoryItems-1].iPrev = -1;
-	m_iHistoryItemAvailable = 0;	
-	
-	// propagate tokens from the starting node
-	m_tokenCurrent[0].iScore = 0;
-	m_tokenCurrent[0].iNode = m_lnodeInitial->iNode;
-	m_tokenCurrent[0].iReference = -1;
-	m_tokenCurrent[0].iHistoryItem = -1;
-	m_iActiveTokensCurrent=1;
-	
-	// propagate tokens until no token is active
-	m_iActiveTokensNext = 0;	
-	m_tokenBest.iNode = -1;
-	m_tokenBest.iScore = INT_MAX;
-	while(m_iActiveTokensCurrent > 0) {
-	
-		// propagate active tokens at the current time-frame
-		m_iActiveTokensNext = 0;
-		int iTokensToProcess = m_iActiveTokensCurrent;
-		for(int i=0 ; ((i < LATTICE_WER_MAX_TOKENS) && (iTokensToProcess > 0)) ; ++i) {
-	
-			// skip inactive tokens (pruned)
-			if (m_tokenCurrent[i].iNode == -1) {
-				continue;
-			}	
-			
-			--iTokensToProcess;
-			
-			// is the token at the final node and all the words in the reference seen?
-			if ((m_tokenCurrent[i].iNode == m_lnodeFinal->iNode) && 
-				(m_tokenCurrent[i].iReference == (int)vLexUnitReference.size()-1)) {
-				// best scoring token so far?
-				if (m_tokenCurrent[i].iScore < m_tokenBest.iScore) {
-					memcpy(&m_tokenBest,&m_tokenCurrent[i],sizeof(LWERToken));
-					//printf("best final token: %8.2f %4d\n",m_tokenBest.fScore,m_tokenBest.iReference);
-				} 
-				// first token with perfect score? if so, finish the search
-				if (m_tokenBest.iScore == 0) {
-					break;
+	// sort the nodes topologically
+	VLNode vLNode;
+	getNodesTopologicalOrder(vLNode);	
+	
+	// alignment window of each node and table of states
+	VLWERNode vNode(m_iNodes);
+	VLWERState vState;
+	vState.reserve(4*m_iNodes);
+	
+	// alignment window of the node being processed (indexed by reference position)
+	LWERState stateEmpty;
+	stateEmpty.iScore = LATTICE_WER_SCORE_INFINITE;
+	stateEmpty.iEdge = -1;
+	stateEmpty.iAlignmentEvent = ALIGNMENT_EVENT_SKIP_HYP;
+	VLWERState vWindow(iWordsReference+1,stateEmpty);
+	vector<int> vHistogram(iBeamSize+1,0);
+	
+	for(VLNode::iterator it = vLNode.begin() ; it != vLNode.end() ; ++it) {
+	
+		LNode *node = *it;
+		LWERNode &nodeWER = vNode[node->iNode];
+		nodeWER.iReferenceStart = 0;
+		nodeWER.iStates = 0;
+		nodeWER.iState = (int)vState.size();	
+	
+		// (1) get the window of reference positions reachable from the predecessors
+		int iLow = INT_MAX;
+		int iHigh = -1;
+		if (node == m_lnodeInitial) {
+			vWindow[0].iScore = 0;
+			iLow = 0;
+			iHigh = 0;
+		} else {
+			for(LEdge *edge = node->edgePrev ; edge != NULL ; edge = edge->edgeNext) {
+				LWERNode &nodePrev = vNode[edge->nodePrev->iNode];
+				if (nodePrev.iStates == 0) {
+					continue;
 				}
+				iLow = min(iLow,nodePrev.iReferenceStart);
+				iHigh = max(iHigh,min(nodePrev.iReferenceStart+nodePrev.iStates,iWordsReference));
 			}
-			// propagate tokens through the successor nodes
-			else {
-				for(LEdge *edge = m_lnodes[m_tokenCurrent[i].iNode]->edgeNext ; edge != NULL ; edge = edge->edgePrev) {	
-					if (m_tokenCurrent[i].iNode != m_lnodeFinal->iNode) {
-						// skip hypothesis
-						if (m_lexiconManager->isFiller(edge->lexUnit)) {
-							activateToken(&m_tokenCurrent[i],edge,ALIGNMENT_EVENT_SKIP_HYP);
-						} 
-						// insertion
-						else if (!bPerfectMatch) {
-							activateToken(&m_tokenCurrent[i],edge,ALIGNMENT_EVENT_INSERTION);	
-						}
+			if (iHigh == -1) {
+				continue;
+			}
+		}
+		
+		// (2) extend the alignments from the predecessors through the incoming edges
+		if (node != m_lnodeInitial) {
+			for(LEdge *edge = node->edgePrev ; edge != NULL ; edge = edge->edgeNext) {
+				LWERNode &nodePrev = vNode[edge->nodePrev->iNode];
+				bool bFiller = m_lexiconManager->isFiller(edge->lexUnit);
+				const char *strHyp = NULL;
+				if ((mappings) && (bFiller == false)) {
+					strHyp = (*mappings)[m_lexiconManager->getStrLexUnit(edge->lexUnit->iLexUnit)];
+				}
+				for(int i=0 ; i < nodePrev.iStates ; ++i) {
+					LWERState &statePrev = vState[nodePrev.iState+i];
+					if (statePrev.iScore == LATTICE_WER_SCORE_INFINITE) {
+						continue;
 					}
-					if (m_tokenCurrent[i].iReference+1 < (int)vLexUnitReference.size()) {
-						// skip reference
-						if (m_lexiconManager->isFiller(vLexUnitReference[m_tokenCurrent[i].iReference+1])) {
-							activateToken(&m_tokenCurrent[i],NULL,ALIGNMENT_EVENT_SKIP_REF);
-						}
-						// deletion
-						else if (!bPerfectMatch) {
-							activateToken(&m_tokenCurrent[i],NULL,ALIGNMENT_EVENT_DELETION);
-						}
+					int iReference = nodePrev.iReferenceStart+i;
+					// fillers in the hypothesis are skipped
+					if (bFiller) {
+						relaxWERState(vWindow,iReference,statePrev.iScore,edge->iEdge,ALIGNMENT_EVENT_SKIP_HYP);
+						continue;
+					}
+					// insertion
+					if (!bPerfectMatch) {
+						relaxWERState(vWindow,iReference,statePrev.iScore+ALIGNMENT_PENALTY_INSERTION,edge->iEdge,
+							ALIGNMENT_EVENT_INSERTION);
 					}
 					// substitution/correct
-					if ((m_tokenCurrent[i].iNode != m_lnodeFinal->iNode) && 
-						(m_tokenCurrent[i].iReference+1 < (int)vLexUnitReference.size()) &&
-						(m_lexiconManager->isFiller(edge->lexUnit) == false) && 
-						(m_lexiconManager->isFiller(vLexUnitReference[m_tokenCurrent[i].iReference+1]) == false)) {
-						// no mappings
-						if (mappings == NULL) {	
-							if (edge->lexUnit->iLexUnit == vLexUnitReference[m_tokenCurrent[i].iReference+1]->iLexUnit) {
-								activateToken(&m_tokenCurrent[i],edge,ALIGNMENT_EVENT_CORRECT);
-							} else if (!bPerfectMatch) {
-								activateToken(&m_tokenCurrent[i],edge,ALIGNMENT_EVENT_SUBSTITUTION);
-							}
+					if (iReference < iWordsReference) {
+						bool bMatch = false;
+						if (mappings == NULL) {
+							bMatch = (edge->lexUnit->iLexUnit == vLexUnitReference[iReference]->iLexUnit);
+						} else {
+							bMatch = (strcmp(strHyp,vStrReference[iReference]) == 0);
 						}
-						// apply mappings to hypothesis and reference word
-						else {
-							const char *strHyp = (*mappings)[m_lexiconManager->getStrLexUnit(edge->lexUnit->iLexUnit)];
-							const char *strRef = (*mappings)[m_lexiconManager->getStrLexUnit(
-								vLexUnitReference[m_tokenCurrent[i].iReference+1]->iLexUnit)];
-							if (strcmp(strHyp,strRef) == 0) {
-								activateToken(&m_tokenCurrent[i],edge,ALIGNMENT_EVENT_CORRECT);	
-							} else if (!bPerfectMatch) {
-								activateToken(&m_tokenCurrent[i],edge,ALIGNMENT_EVENT_SUBSTITUTION);
-							}
+						if (bMatch) {
+							relaxWERState(vWindow,iReference+1,statePrev.iScore,edge->iEdge,ALIGNMENT_EVENT_CORRECT);
+						} else if (!bPerfectMatch) {
+							relaxWERState(vWindow,iReference+1,statePrev.iScore+ALIGNMENT_PENALTY_SUBSTITUTION,
+								edge->iEdge,ALIGNMENT_EVENT_SUBSTITUTION);
 						}
 					}
-				}	
+				}
 			}
 		}
-		if (m_tokenBest.iScore == 0) {
-			break;
+		
+		// (3) get the best score at the node
+		int iScoreBest = LATTICE_WER_SCORE_INFINITE;
+		for(int r=iLow ; r <= iHigh ; ++r) {
+			iScoreBest = min(iScoreBest,vWindow[r].iScore);
 		}
 		
-		// pruning ------------------------------------
+		// (4) deletions (reference words consumed without moving in the lattice), at the final node
+		// all the remaining reference words need to be consumed so the beam is not applied
+		if ((!bPerfectMatch) && (iScoreBest != LATTICE_WER_SCORE_INFINITE)) {
+			for(int r=iLow ; r < iWordsReference ; ++r) {
+				if (vWindow[r].iScore == LATTICE_WER_SCORE_INFINITE) {
+					if (r >= iHigh) {
+						break;
+					}
+					continue;
+				}
+				int iScore = vWindow[r].iScore+ALIGNMENT_PENALTY_DELETION;
+				if ((r+1 > iHigh) && (node != m_lnodeFinal) && (iScore > iScoreBest+iBeamSize)) {
+					break;
+				}
+				iHigh = max(iHigh,r+1);
+				relaxWERState(vWindow,r+1,iScore,-1,ALIGNMENT_EVENT_DELETION);
+			}
+		}
 		
-		// (1) get the best score
-		int iScoreBest = INT_MAX;
-		if (m_tokenBest.iNode != -1) {
-			iScoreBest = m_tokenBest.iScore;
-		}	
-		for(int i=0 ; i < m_iActiveTokensNext ; ++i) {
-			if (m_tokenNext[i].iScore < iScoreBest) {
-				iScoreBest = m_tokenNext[i].iScore;
+		// (5) pruning: beam and dominated states (the final node keeps the deletions leading to the 
+		// complete alignment)
+		int iScoreDominant = LATTICE_WER_SCORE_INFINITE;
+		int iActive = 0;
+		for(int r=iHigh ; (r >= iLow) && (node != m_lnodeFinal) ; --r) {
+			LWERState &state = vWindow[r];
+			if (state.iScore == LATTICE_WER_SCORE_INFINITE) {
+				continue;
 			}
-			//printf("active: %6d (score: %6.2f) reference: %6d node: %x event: %d\n",m_tokenNext[i].node->iNode,
-			//	m_tokenNext[i].fScore,m_tokenNext[i].iReference,m_tokenNext[i].node,m_tokenNext[i].historyItem->iAlignmentEvent);
-			m_iTokenNode[m_tokenNext[i].iNode] = -1;	
-		}
-		// build histogram
-		int *iHistogram = new int[iBeamSize+1];
-		for(int i=0 ; i < iBeamSize+1 ; ++i) {
-			iHistogram[i] = 0;
-		}	
-		for(int i=0 ; i < m_iActiveTokensNext ; ++i) {
-			int iBin = min(m_tokenNext[i].iScore-iScoreBest,iBeamSize);
-			assert((iBin >= 0) && (iBin <= iBeamSize));
-			iHistogram[iBin]++;
-		}	
-		int iThreshold = 0;
-		int iSeen = 0;
-		for(int i=0 ; i < iBeamSize+1 ; ++i) {
-			iSeen += iHistogram[i];
-			if (iSeen > LATTICE_WER_MAX_ACTIVE_TOKENS) {
-				break;
+			if ((state.iScore > iScoreBest+iBeamSize) || (state.iScore+r >= iScoreDominant)) {
+				state = stateEmpty;
+				continue;
 			}
-			iThreshold += 1;
-		}
-		delete [] iHistogram;	
-		// (2) prune active tokens outside the beam
-		int iPruned = 0;
-		for(int i=0 ; i < m_iActiveTokensNext ; ++i) {	
-			if (m_tokenNext[i].iScore-iScoreBest > iThreshold) {
-				m_tokenNext[i].iNode = -1;
-				++iPruned;
+			iScoreDominant = state.iScore+r;
+			++vHistogram[state.iScore-iScoreBest];
+			++iActive;
+		}
+		
+		// (5.1) histogram pruning: keep a bounded window of states favoring the ones that are closer 
+		// to the end of the reference (not at the final node, it must keep the complete alignment)
+		if ((node != m_lnodeFinal) && 
+			((iActive > LATTICE_WER_MAX_STATES_NODE) || (iHigh-iLow+1 > LATTICE_WER_MAX_STATES_NODE))) {
+			int iThreshold = 0;
+			int iSeen = vHistogram[0];
+			while((iThreshold < iBeamSize) && (iSeen+vHistogram[iThreshold+1] <= LATTICE_WER_MAX_STATES_NODE)) {
+				++iThreshold;
+				iSeen += vHistogram[iThreshold];
+			}
+			int iKept = 0;
+			int iLastKept = -1;
+			for(int r=iHigh ; r >= iLow ; --r) {
+				LWERState &state = vWindow[r];
+				if (state.iScore == LATTICE_WER_SCORE_INFINITE) {
+					continue;
+				}
+				if ((state.iScore > iScoreBest+iThreshold) || (iKept == LATTICE_WER_MAX_STATES_NODE) || 
+					((iLastKept != -1) && (iLastKept-r >= LATTICE_WER_MAX_STATES_NODE))) {
+					state = stateEmpty;
+					continue;
+				}
+				if (iLastKept == -1) {
+					iLastKept = r;
+				}
+				++iKept;
 			}
 		}
-		m_iActiveTokensNext -= iPruned;	
+		fill(vHistogram.begin(),vHistogram.end(),0);
 		
-		// sanity check
-		for(int i=0 ; i < m_iNodes ; ++i) {
-			assert(m_iTokenNode[i] == -1);
+		// (6) keep the surviving states and reset the window
+		int iFirst = iLow;
+		while((iFirst <= iHigh) && (vWindow[iFirst].iScore == LATTICE_WER_SCORE_INFINITE)) {
+			++iFirst;
+		}
+		int iLast = iHigh;
+		while((iLast >= iFirst) && (vWindow[iLast].iScore == LATTICE_WER_SCORE_INFINITE)) {
+			--iLast;
+		}
+		if (iFirst <= iLast) {
+			nodeWER.iReferenceStart = iFirst;
+			nodeWER.iStates = iLast-iFirst+1;
+			vState.insert(vState.end(),vWindow.begin()+iFirst,vWindow.begin()+iLast+1);
+		}
+		for(int r=iLow ; r <= iHigh ; ++r) {
+			vWindow[r] = stateEmpty;
 		}
-		
-		//printf("bestScore: %5.2f (reference: %4d) active states: %6d pruned: %6d\n",
-		//	fScoreBest,iReferenceBest,m_iActiveTokensNext,iPruned);
-		
-		// swap
-		m_iActiveTokensCurrent = m_iActiveTokensNext;
-		LWERToken *tokenAux = m_tokenCurrent;
-		m_tokenCurrent = m_tokenNext;
-		m_tokenNext = tokenAux;
 	}
 	
 	// unable to find a perfect match? (WER > 0)
-	if (m_tokenBest.iNode == -1) {
+	LWERNode &nodeFinal = vNode[m_lnodeFinal->iNode];
+	if ((nodeFinal.iStates == 0) || (nodeFinal.iReferenceStart+nodeFinal.iStates-1 != iWordsReference)) {
 		assert(bPerfectMatch);
-		// clean-up
-		delete [] m_tokenCurrent;
-		delete [] m_tokenNext;
-		delete [] m_iTokenNode;	
-		delete [] m_historyItems;	
 		return NULL;
 	}	
 	
@@ -1802,9 +1825,9 @@ LatticeWER *HypothesisLattice::computeWER(VLexUnit &vLexUnitReference, BestPath
 		clearBestPath();
 	}
 	
-	// do back-tracing on the best token to compute the Lattice WER
+	// do back-tracing from the final state to compute the Lattice WER
 	LatticeWER *latticeWER = new LatticeWER;
-	latticeWER->iWordsReference = (int)vLexUnitReference.size();
+	latticeWER->iWordsReference = iWordsReference;
 	latticeWER->iInsertions = 0;
 	latticeWER->iDeletions = 0;
 	latticeWER->iSubstitutions = 0;
@@ -1815,80 +1838,69 @@ LatticeWER *HypothesisLattice::computeWER(VLexUnit &vLexUnitReference, BestPath
 		*bestPath = new BestPath(m_lexiconManager,0.0);
 	}
 	
-	assert(m_tokenBest.iNode != -1);
-	int iHistoryItem = m_tokenBest.iHistoryItem;
-	while(iHistoryItem != -1) {
+	LNode *node = m_lnodeFinal;
+	int iReference = iWordsReference;
+	while((node != m_lnodeInitial) || (iReference > 0)) {
 	
-		LWERHistoryItem *historyItem = m_historyItems+iHistoryItem;	
+		LWERNode &nodeWER = vNode[node->iNode];
+		assert((iReference >= nodeWER.iReferenceStart) && (iReference < nodeWER.iReferenceStart+nodeWER.iStates));
+		LWERState &state = vState[nodeWER.iState+iReference-nodeWER.iReferenceStart];
+		assert(state.iScore != LATTICE_WER_SCORE_INFINITE);
 	
+		// deletion
+		if (state.iAlignmentEvent == ALIGNMENT_EVENT_DELETION) {
+			++latticeWER->iDeletions;
+			--iReference;
+			continue;
+		}
+		
 		// keep and mark the best path in the lattice
-		if (historyItem->iAlignmentEvent != ALIGNMENT_EVENT_DELETION) {
-			latticeWER->vLexUnitBest.push_back(m_ledges[historyItem->iEdge]->lexUnit);	
-			m_ledges[historyItem->iEdge]->bBestPath = true;
-		}	
+		LEdge *edge = m_ledges[state.iEdge];
+		latticeWER->vLexUnitBest.push_back(edge->lexUnit);	
+		edge->bBestPath = true;
 			
 		// correct
-		if (historyItem->iAlignmentEvent == ALIGNMENT_EVENT_CORRECT) {
-			//cout << "correct:	" << m_lexiconManager->getStrLexUnit(historyItem->edge->lexUnit->iLexUnit) <<
-			//	" " << m_lexiconManager->getStrLexUnit(vLexUnitReference[historyItem->iReference]->iLexUnit) << endl;			
+		if (state.iAlignmentEvent == ALIGNMENT_EVENT_CORRECT) {
 			++latticeWER->iCorrect;
+			--iReference;
 		} 
 		// insertion	
-		else if (historyItem->iAlignmentEvent == ALIGNMENT_EVENT_INSERTION) {
-			//cout << "insertion: " << m_lexiconManager->getStrLexUnit(historyItem->edge->lexUnit->iLexUnit) << endl;
+		else if (state.iAlignmentEvent == ALIGNMENT_EVENT_INSERTION) {
 			++latticeWER->iInsertions;
 		}
-		// deletion
-		else if (historyItem->iAlignmentEvent == ALIGNMENT_EVENT_DELETION) {
-			//cout << "deletion: " << m_lexiconManager->getStrLexUnit(vLexUnitReference[historyItem->iReference]->iLexUnit) 
-			//	<< endl;
-			++latticeWER->iDeletions;
-		}
 		// substitution
-		else if (historyItem->iAlignmentEvent == ALIGNMENT_EVENT_SUBSTITUTION) {
-			//cout << "substitution: " << m_lexiconManager->getStrLexUnit(historyItem->edge->lexUnit->iLexUnit) <<
-			//	m_lexiconManager->getStrLexUnit(vLexUnitReference[historyItem->iReference]->iLexUnit) << endl;
+		else if (state.iAlignmentEvent == ALIGNMENT_EVENT_SUBSTITUTION) {
 			++latticeWER->iSubstitutions;
+			--iReference;
 		}
 		// skip hypothesis
-		else if (historyItem->iAlignmentEvent == ALIGNMENT_EVENT_SKIP_HYP) {
-			//cout << "skip: " << m_lexiconManager->getStrLexUnit(historyItem->edge->lexUnit->iLexUnit) << endl;
-		}
-		// skip reference
 		else {
-			assert(historyItem->iAlignmentEvent == ALIGNMENT_EVENT_SKIP_REF);
-			//cout << "skip: " << m_lexiconManager->getStrLexUnit(vLexUnitReference[historyItem->iReference]->iLexUnit) << endl;
+			assert(state.iAlignmentEvent == ALIGNMENT_EVENT_SKIP_HYP);
 		}
 				
 		// add it to the best path
-		if ((bestPath) && (historyItem->iAlignmentEvent != ALIGNMENT_EVENT_DELETION) &&
-			(historyItem->iAlignmentEvent != ALIGNMENT_EVENT_SKIP_REF)) {
+		if (bestPath) {
 			float fScore = 0.0;
-			float fScoreAM = isProperty(LATTICE_PROPERTY_AM_PROB) ? m_ledges[historyItem->iEdge]->fScoreAM : 0.0;
-			float fScoreLM = isProperty(LATTICE_PROPERTY_LM_PROB) ? m_ledges[historyItem->iEdge]->fScoreLM : 0.0;
-			float fConfidence = isProperty(LATTICE_PROPERTY_CONFIDENCE) ? m_ledges[historyItem->iEdge]->fConfidence : 0.0;
-			float fInsertionPenalty = 
-				isProperty(LATTICE_PROPERTY_INSERTION_PENALTY) ? m_ledges[historyItem->iEdge]->fInsertionPenalty : 0.0;
-			(*bestPath)->newElementFront(m_ledges[historyItem->iEdge]->iFrameStart,m_ledges[historyItem->iEdge]->iFrameEnd,
-				fScore,fScoreAM,fScoreLM,fConfidence,m_ledges[historyItem->iEdge]->lexUnit,fInsertionPenalty);
+			float fScoreAM = isProperty(LATTICE_PROPERTY_AM_PROB) ? edge->fScoreAM : 0.0;
+			float fScoreLM = isProperty(LATTICE_PROPERTY_LM_PROB) ? edge->fScoreLM : 0.0;
+			float fConfidence = isProperty(LATTICE_PROPERTY_CONFIDENCE) ? edge->fConfidence : 0.0;
+			float fInsertionPenalty = isProperty(LATTICE_PROPERTY_INSERTION_PENALTY) ? edge->fInsertionPenalty : 0.0;
+			(*bestPath)->newElementFront(edge->iFrameStart,edge->iFrameEnd,
+				fScore,fScoreAM,fScoreLM,fConfidence,edge->lexUnit,fInsertionPenalty);
 		}
-				
-		iHistoryItem = (m_historyItems+iHistoryItem)->iPrev;
+		
+		node = edge->nodePrev;
 	}
+	reverse(latticeWER->vLexUnitBest.begin(),latticeWER->vLexUnitBest.end());
 	
 	// compute WER from alignment errors
 	latticeWER->iErrors = latticeWER->iInsertions+latticeWER->iDeletions+latticeWER->iSubstitutions;
+	assert(latticeWER->iErrors == vState[nodeFinal.iState+nodeFinal.iStates-1].iScore);
 	latticeWER->fWER = ((float)latticeWER->iErrors*100.0f)/((float)latticeWER->iWordsReference);	
 	latticeWER->iOOV = iOOV;
 	
 	// set the best-path property
 	setProperty(LATTICE_PROPERTY_BEST_PATH,"yes");
-		
-	// clean-up
-	delete [] m_tokenCurrent;
-	delete [] m_tokenNext;
-	delete [] m_iTokenNode;	
-	delete [] m_historyItems;
 	
  	double dTimeEnd = TimeUtils::getTimeMilliseconds();
  	double dTime = (dTimeEnd-dTimeBegin)/1000.0;
@@ -1901,111 +1913,6 @@ LatticeWER *HypothesisLattice::computeWER(VLexUnit &vLexUnitReference, BestPath
 	return latticeWER;
 }
 
-// history item garbage collection: free-up unused history items
-void HypothesisLattice::historyItemGarbageCollection() {
-
-	// (1) initialize all the history items as unused
-	for(int i=0 ; i < m_iHistoryItems ; ++i) {
-		m_historyItems[i].bUsed = false;
-	}
-
-	// (2) mark history items in use as used
-	int iItemsUsed = 0;
-	
-	// current tokens
-	int iTokensToProcess = m_iActiveTokensCurrent;
-	for(int i=0 ; ((i < LATTICE_WER_MAX_TOKENS) && (iTokensToProcess > 0)) ; ++i) {
-
-		// skip inactive tokens (pruned)
-		if (m_tokenCurrent[i].iNode == -1) {
-			continue;
-		}	
-		
-		--iTokensToProcess;
-		
-		for(int iHistoryItem = m_tokenCurrent[i].iHistoryItem ; iHistoryItem != -1 ; iHistoryItem = (m_historyItems+iHistoryItem)->iPrev) {
-			LWERHistoryItem *historyItem = m_historyItems+iHistoryItem;
-			if (historyItem->bUsed) {
-				break;
-			}
-			historyItem->bUsed = true;
-			++iItemsUsed;
-		}
-	}
-
-	// next tokens
-	for(int i=0 ; i < m_iActiveTokensNext ; ++i) {
-		
-		for(int iHistoryItem = m_tokenNext[i].iHistoryItem ; iHistoryItem != -1 ; iHistoryItem = (m_historyItems+iHistoryItem)->iPrev) {
-			LWERHistoryItem *historyItem = m_historyItems+iHistoryItem;
-			if (historyItem->bUsed) {
-				break;
-			}
-			historyItem->bUsed = true;
-			++iItemsUsed;
-		}
-	}
-	
-	// best token
-	if (m_tokenBest.iNode != -1) {
-		for(int iHistoryItem = m_tokenBest.iHistoryItem ; iHistoryItem != -1 ; iHistoryItem = (m_historyItems+iHistoryItem)->iPrev) {
-			LWERHistoryItem *historyItem = m_historyItems+iHistoryItem;
-			if (historyItem->bUsed) {
-				break;
-			}
-			historyItem->bUsed = true;
-			++iItemsUsed;
-		}	
-	}
-
-	assert(iItemsUsed <= m_iHistoryItems);
-	if (iItemsUsed > (0.2*m_iHistoryItems)) {
-
-		//printf("garbageCollector: reallocating to %d elements\n",m_iHistoryItems*2);
-		
-		// allocate a new data structure with double capacity		
-		LWERHistoryItem *historyItems = new LWERHistoryItem[m_iHistoryItems*2];
-		
-		// copy the active items from the old data structure
-		for(int i=0 ; i < m_iHistoryItems ; ++i) {
-			historyItems[i].iPrev = m_historyItems[i].iPrev;
-			historyItems[i].iEdge = m_historyItems[i].iEdge;
-			historyItems[i].iReference = m_historyItems[i].iReference;
-			historyItems[i].iAlignmentEvent = m_historyItems[i].iAlignmentEvent;
-			historyItems[i].bUsed = m_historyItems[i].bUsed;
-		}
-		
-		// create the linked list of available items
-		for(int i=m_iHistoryItems ; i < (2*m_iHistoryItems)-1 ; ++i) {
-			historyItems[i].iPrev = i+1;
-			historyItems[i].bUsed = false;	
-		}
-		historyItems[(2*m_iHistoryItems)-1].iPrev = -1;
-		historyItems[(2*m_iHistoryItems)-1].bUsed = false;
-		
-		delete [] m_historyItems;
-		m_historyItems = historyItems;
-		m_iHistoryItemAvailable = m_iHistoryItems;
-		m_iHistoryItems *= 2;		
-		
-	} 
-	// just recycle unused items
-	else {
-		//printf("garbageCollector: recycling (%d items used)\n",iItemsUsed);
-		
-		// put unused items in the list of available items
-		int *iHistoryItemAux = &m_iHistoryItemAvailable;
-		for(int i=0 ; i < m_iHistoryItems ; ++i) {
-			if (m_historyItems[i].bUsed == false) {
-				*iHistoryItemAux = i;
-				iHistoryItemAux = &(m_historyItems[i].iPrev);
-			}
-		}
-		*iHistoryItemAux = -1;
-		assert(m_iHistoryItemAvailable != -1);
-	}	
-}
-
 // rescore the lattice using the given rescoring method (Dijkstra)
 // - all edges in the lattice contain the cost of moving from the source node to the 
 //   destination node, that cost is expressed in terms of log-likelihood (like in 
@@ -2327,6 +2234,300 @@ void HypothesisLattice::attachLMProbabilities(LMFSM *lmFSM) {
  	BVC_VERB << "processing time: " << dTime << " seconds, RTF: " << dRTF;
 }
 
+// attach lm-probabilities composing the lattice with the language model on-the-fly (in topological 
+// order), paths reaching a node with the same lm-state are merged and the expansion is pruned using 
+// the forward scores and the backward scores of the original lattice
+void HypothesisLattice::attachLMProbabilitiesPruned(LMFSM *lmFSM, float fScaleAM, float fScaleLM, float fBeam, 
+	int iMaxLMStatesNode) {
+
+ 	double dTimeBegin = TimeUtils::getTimeMilliseconds();
+ 	
+ 	assert(iMaxLMStatesNode > 0);
+ 	
+	bool bAM = isProperty(LATTICE_PROPERTY_AM_PROB);
+	bool bLM = isProperty(LATTICE_PROPERTY_LM_PROB);
+	bool bIP = isProperty(LATTICE_PROPERTY_INSERTION_PENALTY);
+	
+	int iNodesOriginal = m_iNodes;
+	int iEdgesOriginal = m_iEdges;
+	
+	// (1) sort the nodes in topological order
+	VLNode vLNode;
+	getNodesTopologicalOrder(vLNode);
+	
+	// (2) backward scores of the original lattice (best score from each node to the final node), 
+	// they are used to estimate the score of complete paths while composing the lattice, this is only 
+	// meaningful if the lattice already carries lm-scores (i.e. from a lower order language model)
+	double *dScoreBackward = new double[m_iNodes];
+	for(VLNode::reverse_iterator it = vLNode.rbegin() ; it != vLNode.rend() ; ++it) {
+		if (*it == m_lnodeFinal) {
+			dScoreBackward[(*it)->iNode] = 0.0;
+			continue;
+		}
+		double dScoreBest = -DBL_MAX;
+		for(LEdge *edge = (*it)->edgeNext ; edge ; edge = edge->edgePrev) {
+			double dScore = dScoreBackward[edge->nodeNext->iNode];
+			dScore += ((bAM ? edge->fScoreAM : 0.0)+(bIP ? edge->fInsertionPenalty : 0.0))*fScaleAM;
+			dScore += (bLM ? edge->fScoreLM : 0.0)*fScaleLM;
+			dScoreBest = max(dScoreBest,dScore);
+		}
+		dScoreBackward[(*it)->iNode] = dScoreBest;
+	}
+	
+	// (3) composition: nodes of the composed lattice are pairs (lattice node, lm-state), they are only kept
+	// for nodes not yet processed (the frontier), so memory is bounded by the lattice width
+	VLComposedNode *vComposedNodes = new VLComposedNode[m_iNodes];
+	map<int,int> *mLMStateComposedNode = new map<int,int>[m_iNodes];
+	
+	LComposedNode composedNodeInitial;
+	composedNodeInitial.lnode = newNode(m_lnodeInitial->iFrame);
+	composedNodeInitial.iLMState = lmFSM->getInitialState();
+	composedNodeInitial.dScore = 0.0;
+	vComposedNodes[m_lnodeInitial->iNode].push_back(composedNodeInitial);
+	LNode *lnodeInitial = composedNodeInitial.lnode;
+	LNode *lnodeFinal = newNode(m_lnodeFinal->iFrame);
+	VLNode vLNodeComposed;
+	vLNodeComposed.push_back(lnodeInitial);
+	vLNodeComposed.push_back(lnodeFinal);
+	
+	double dScoreBestEstimate = -DBL_MAX;
+	int iComposedNodesPruned = 0;
+	int iComposedNodesMax = 0;
+	
+	for(VLNode::iterator it = vLNode.begin() ; it != vLNode.end() ; ++it) {
+	
+		LNode *node = *it;
+		if (node == m_lnodeFinal) {
+			continue;
+		}
+		VLComposedNode &vComposedNodesNode = vComposedNodes[node->iNode];
+		
+		// (3.1) beam pruning: local (nodes sharing the lattice node) and global (estimate of the complete path
+		// score, only with lm-scores available), followed by histogram pruning, the best node always survives
+		sort(vComposedNodesNode.begin(),vComposedNodesNode.end(),compareComposedNodeScore);
+		iComposedNodesMax = max(iComposedNodesMax,(int)vComposedNodesNode.size());
+		unsigned int iSurvivors = 1;
+		if (vComposedNodesNode.empty() == false) {
+			double dScoreLocal = vComposedNodesNode.front().dScore;
+			double dScoreThreshold = dScoreLocal-fBeam;
+			if (bLM) {
+				dScoreBestEstimate = max(dScoreBestEstimate,dScoreLocal+dScoreBackward[node->iNode]);
+				dScoreThreshold = max(dScoreThreshold,dScoreBestEstimate-fBeam-dScoreBackward[node->iNode]);
+			}
+			while((iSurvivors < vComposedNodesNode.size()) && ((int)iSurvivors < iMaxLMStatesNode) && 
+				(vComposedNodesNode[iSurvivors].dScore >= dScoreThreshold)) {
+				++iSurvivors;
+			}
+		}
+		for(unsigned int i = iSurvivors ; i < vComposedNodesNode.size() ; ++i) {
+			// incoming edges are removed, predecessors left without successors are removed at the end
+			LNode *lnodePruned = vComposedNodesNode[i].lnode;
+			for(LEdge *edge = lnodePruned->edgePrev ; edge ; ) {
+				LEdge *edgeNext = edge->edgeNext;
+				LEdge **edgeAux = &(edge->nodePrev->edgeNext);
+				while(*edgeAux != edge) {
+					edgeAux = &((*edgeAux)->edgePrev);
+				}
+				*edgeAux = edge->edgePrev;
+				deleteEdge(edge);
+				edge = edgeNext;
+			}
+			lnodePruned->edgePrev = NULL;
+			++iComposedNodesPruned;
+		}
+		if (iSurvivors < vComposedNodesNode.size()) {
+			vComposedNodesNode.resize(iSurvivors);
+		}
+		
+		// (3.2) expand the surviving nodes through the outgoing edges
+		for(VLComposedNode::iterator jt = vComposedNodesNode.begin() ; jt != vComposedNodesNode.end() ; ++jt) {
+			for(LEdge *edge = node->edgeNext ; edge ; edge = edge->edgePrev) {
+			
+				// lm-state and score
+				float fScoreLM = 0.0;
+				int iLMState = jt->iLMState;
+				if (m_lexiconManager->isStandard(edge->lexUnit)) {
+					iLMState = lmFSM->updateLMState(jt->iLMState,edge->lexUnit->iLexUnit,&fScoreLM);
+				}
+				// the transition to the final state is attached to the last edge (same as the full expansion)
+				if (edge->nodeNext == m_lnodeFinal) {
+					fScoreLM += lmFSM->toFinalState(iLMState);
+				}
+				double dScore = jt->dScore + fScoreLM*fScaleLM + 
+					((bAM ? edge->fScoreAM : 0.0)+(bIP ? edge->fInsertionPenalty : 0.0))*fScaleAM;
+				
+				// get the destination node (paths reaching the final node are all merged)
+				LNode *lnodeDest = NULL;
+				if (edge->nodeNext == m_lnodeFinal) {
+					lnodeDest = lnodeFinal;
+				} else {
+					VLComposedNode &vComposedNodesDest = vComposedNodes[edge->nodeNext->iNode];
+					map<int,int> &mLMState = mLMStateComposedNode[edge->nodeNext->iNode];
+					map<int,int>::iterator kt = mLMState.find(iLMState);
+					if (kt == mLMState.end()) {
+						LComposedNode composedNode;
+						composedNode.lnode = newNode(edge->nodeNext->iFrame);
+						composedNode.iLMState = iLMState;
+						composedNode.dScore = dScore;
+						mLMState.insert(map<int,int>::value_type(iLMState,(int)vComposedNodesDest.size()));
+						vComposedNodesDest.push_back(composedNode);
+						vLNodeComposed.push_back(composedNode.lnode);
+						lnodeDest = composedNode.lnode;
+					} else {
+						LComposedNode &composedNode = vComposedNodesDest[kt->second];
+						composedNode.dScore = max(composedNode.dScore,dScore);
+						lnodeDest = composedNode.lnode;
+					}
+				}
+				
+				LEdge *edgeDup = copyEdge(edge);
+				edgeDup->fScoreLM = fScoreLM;
+				edgeDup->iLMStatePrev = jt->iLMState;
+				edgeDup->iLMState = iLMState;
+				connectEdge(jt->lnode,edgeDup,lnodeDest);
+			}
+		}
+		
+		// the node is processed, its composed nodes are not needed anymore
+		VLComposedNode().swap(vComposedNodesNode);
+		map<int,int>().swap(mLMStateComposedNode[node->iNode]);
+	}
+	
+	delete [] vComposedNodes;
+	delete [] mLMStateComposedNode;
+	delete [] dScoreBackward;
+	
+	// (4) remove dead ends (nodes from which the final node is not reachable because of pruning)
+	assert(lnodeFinal->edgePrev != NULL);
+	MLNode mLNodeAlive;
+	LLNode lNodes;
+	lNodes.push_back(lnodeFinal);
+	mLNodeAlive.insert(MLNode::value_type(lnodeFinal,true));
+	while(lNodes.empty() == false) {
+		LNode *lnode = lNodes.front();
+		lNodes.pop_front();
+		for(LEdge *edge = lnode->edgePrev ; edge ; edge = edge->edgeNext) {
+			if (mLNodeAlive.find(edge->nodePrev) == mLNodeAlive.end()) {
+				mLNodeAlive.insert(MLNode::value_type(edge->nodePrev,true));
+				lNodes.push_back(edge->nodePrev);
+			}
+		}
+	}
+	for(VLNode::iterator it = vLNodeComposed.begin() ; it != vLNodeComposed.end() ; ++it) {
+		// alive node: remove edges going to dead ends
+		if (mLNodeAlive.find(*it) != mLNodeAlive.end()) {
+			LEdge **edgeAux = &((*it)->edgeNext);
+			while(*edgeAux) {
+				LEdge *edge = *edgeAux;
+				if (mLNodeAlive.find(edge->nodeNext) == mLNodeAlive.end()) {
+					*edgeAux = edge->edgePrev;
+					deleteEdge(edge);
+				} else {
+					edgeAux = &(edge->edgePrev);
+				}
+			}
+		} 
+		// dead end: edges leaving it go to dead ends too
+		else {
+			for(LEdge *edge = (*it)->edgeNext ; edge ; ) {
+				LEdge *edgePrev = edge->edgePrev;
+				deleteEdge(edge);
+				edge = edgePrev;
+			}
+		}
+	}
+	for(VLNode::iterator it = vLNodeComposed.begin() ; it != vLNodeComposed.end() ; ++it) {
+		if (mLNodeAlive.find(*it) == mLNodeAlive.end()) {
+			delete *it;
+		}
+	}
+	
+	// (5) replace the original lattice
+	for(int i=0 ; i < m_iNodes ; ++i) {
+		delete m_lnodes[i];
+	}
+	for(int i=0 ; i < m_iEdges ; ++i) {
+		deleteEdge(m_ledges[i]);
+	}
+	buildContainer(lnodeInitial,lnodeFinal);
+	
+	// scores derived from the original topology are not valid anymore
+	removeProperty(LATTICE_PROPERTY_BEST_PATH);
+	removeProperty(LATTICE_PROPERTY_FWD_PROB);
+	removeProperty(LATTICE_PROPERTY_BWD_PROB);
+	removeProperty(LATTICE_PROPERTY_PP);
+	removeProperty(LATTICE_PROPERTY_CONFIDENCE);
+	setProperty(LATTICE_PROPERTY_LM_PROB,"yes");
+	setProperty(LATTICE_PROPERTY_NGRAM,LMManager::getStrNGram(lmFSM->getNGramOrder()));
+	
+	check();
+	
+	BVC_VERB << "nodes: " << iNodesOriginal << " -> " << m_iNodes << ", edges: " << iEdgesOriginal << " -> " << m_iEdges;
+	BVC_VERB << "composed nodes pruned: " << iComposedNodesPruned << ", max lm-states per node: " << iComposedNodesMax;
+	
+	// compute processing time
+ 	double dTimeEnd = TimeUtils::getTimeMilliseconds();
+ 	double dTime = (dTimeEnd-dTimeBegin)/1000.0;
+ 	double dRTF = dTime/(m_iFrames/100.0);	
+ 	BVC_VERB << "processing time: " << dTime << " seconds, RTF: " << dRTF;
+}
+
+// return the nodes in the lattice in topological order
+void HypothesisLattice::getNodesTopologicalOrder(VLNode &vLNode) {
+
+	int *iIncoming = new int[m_iNodes];
+	for(int i=0 ; i < m_iNodes ; ++i) {
+		iIncoming[i] = 0;
+	}
+	for(int i=0 ; i < m_iEdges ; ++i) {
+		++iIncoming[m_ledges[i]->nodeNext->iNode];
+	}
+	
+	vLNode.clear();
+	vLNode.reserve(m_iNodes);
+	vLNode.push_back(m_lnodeInitial);
+	for(unsigned int i=0 ; i < vLNode.size() ; ++i) {
+		for(LEdge *edge = vLNode[i]->edgeNext ; edge ; edge = edge->edgePrev) {
+			if (--iIncoming[edge->nodeNext->iNode] == 0) {
+				vLNode.push_back(edge->nodeNext);
+			}
+		}
+	}
+	assert((int)vLNode.size() == m_iNodes);
+	
+	delete [] iIncoming;
+}
+
+// create a copy of a lattice edge including alignment and phonetic context
+LEdge *HypothesisLattice::copyEdge(LEdge *edgeOriginal) {
+
+	LEdge *edge = newEdge(edgeOriginal);
+	edge->fPP = edgeOriginal->fPP;
+	edge->fConfidence = edgeOriginal->fConfidence;
+	
+	if (edgeOriginal->phoneAlignment) {
+		edge->phoneAlignment = new LPhoneAlignment[edge->iPhones];
+		memcpy(edge->phoneAlignment,edgeOriginal->phoneAlignment,edge->iPhones*sizeof(LPhoneAlignment));
+	}
+	if (edgeOriginal->fPhoneAccuracy) {
+		edge->fPhoneAccuracy = new float[edge->iPhones];
+		memcpy(edge->fPhoneAccuracy,edgeOriginal->fPhoneAccuracy,edge->iPhones*sizeof(float));
+	}
+	int iContextSizeMax = max(m_iContextSizeCW,m_iContextSizeWW);
+	edge->iContextLeft = NULL;
+	edge->iContextRight = NULL;
+	if (edgeOriginal->iContextLeft) {
+		edge->iContextLeft = new unsigned char[iContextSizeMax];
+		memcpy(edge->iContextLeft,edgeOriginal->iContextLeft,iContextSizeMax*sizeof(unsigned char));
+	}
+	if (edgeOriginal->iContextRight) {
+		edge->iContextRight = new unsigned char[iContextSizeMax];
+		memcpy(edge->iContextRight,edgeOriginal->iContextRight,iContextSizeMax*sizeof(unsigned char));
+	}
+	
+	return edge;
+}
+
 // attach insertion penalties
 void HypothesisLattice::attachInsertionPenalty(LexiconManager *lexiconManager) {
 
@@ -2478,7 +2679,8 @@ void HypothesisLattice::computePhoneAccuracy(VLPhoneAlignment &vLPhoneAlignment,
 
 // n-best list generation -----------------------------------------------
 
-// create a n-best list from the lattice
+// create a n-best list from the lattice (lazy recursive enumeration of paths, entries are unique 
+// word sequences added to the list as they are found)
 NBestList *HypothesisLattice::createNBestList(int iN, const char *strRescoringMethod) {
 
 	// determine the function to use for getting the edge log-weight
@@ -2500,75 +2702,63 @@ NBestList *HypothesisLattice::createNBestList(int iN, const char *strRescoringMe
 		}
 	} 
 	
-	resetAuxEdges();
-	
-	// compute Viterbi paths and scores
-	untouchEdges();
-	assert(m_lnodeFinal->edgePrev != NULL);
-	for(LEdge *edge = m_lnodeFinal->edgePrev ; edge != NULL ; edge = edge->edgeNext) {
-		viterbi(edge);
-	}	
-
-	// compute reverse Viterbi paths and scores
-	untouchEdges();
-	assert(m_lnodeInitial->edgeNext != NULL);
-	for(LEdge *edge = m_lnodeInitial->edgeNext ; edge != NULL ; edge = edge->edgePrev) {
-		viterbiReverse(edge);
-	}	
+	// paths found so far to each node (sorted by score) and candidates to be the next path (heap)
+	VLNBestPath *vPaths = new VLNBestPath[m_iNodes];
+	VLNBestPath *vCandidates = new VLNBestPath[m_iNodes];
+	bool *bCandidates = new bool[m_iNodes];
 	
-	// create the n-best
-	untouchEdges();
-	// sort edges by path score
-	LLEdge lEdge;
-	for(int i=0 ; i<m_iEdges ; ++i) {
-		assert((m_ledges[i]->edgePrevAux) || (m_ledges[i]->nodePrev == m_lnodeInitial));
-		assert((m_ledges[i]->edgeNextAux) || (m_ledges[i]->nodeNext == m_lnodeFinal));
-		lEdge.push_back(m_ledges[i]);
+	// (1) best path to each node (Viterbi in topological order)
+	VLNode vLNode;
+	getNodesTopologicalOrder(vLNode);
+	for(VLNode::iterator it = vLNode.begin() ; it != vLNode.end() ; ++it) {
+		LNBestPath path;
+		path.edge = NULL;
+		path.iRankPrev = -1;
+		path.dScore = ((*it) == m_lnodeInitial) ? 0.0 : -DBL_MAX;
+		for(LEdge *edge = (*it)->edgePrev ; edge ; edge = edge->edgeNext) {
+			double dScore = vPaths[edge->nodePrev->iNode].front().dScore;
+			dScore += bLikelihood ? edgeLogLikelihood(edge) : edgeLogPP(edge);
+			if ((path.edge == NULL) || (dScore > path.dScore)) {
+				path.edge = edge;
+				path.iRankPrev = 0;
+				path.dScore = dScore;
+			}
+		}
+		vPaths[(*it)->iNode].push_back(path);
+		bCandidates[(*it)->iNode] = false;
 	}
-	lEdge.sort(comparePathScore);
-		
-	// each entry in the n-best list is generated by finding the unmarked 
-	// edge in the lattice with the highest score and then getting its path
+	
+	// (2) enumerate paths to the final node by rank, collapsing those with the same word sequence
 	NBestList *nBestList = new NBestList();
-	for(int i = 0 ; i < iN ; ++i) {
+	set<vector<int> > sWordSequences;
+	int iPaths = 0;
+	for(unsigned int iRank = 0 ; (nBestList->size() < (unsigned int)iN) && 
+		(iRank < (unsigned int)iN*LATTICE_NBEST_MAX_PATHS_ENTRY) ; ++iRank) {
 	
-		// get the best unmarked edge in the lattice (it is not in any n-best entry yet)
-		LEdge *edgeBest = NULL;
-		for(LLEdge::iterator it = lEdge.begin() ; it != lEdge.end() ; ) {
-			if ((*it)->lexUnit->iType != LEX_UNIT_TYPE_STANDARD) {
-				++it;
-				continue;
-			}
-			if ((*it)->bTouched == true) {
-				it = lEdge.erase(it);
-			} else {
-				edgeBest = *it;
-				break;
-			}
-		}
-		if (!edgeBest) {
+		if (computeNBestPath(m_lnodeFinal,iRank,vPaths,vCandidates,bCandidates,bLikelihood) == false) {
 			break;
 		}
-			
-		// recover path using the trace-back and trace-forward pointers
+		++iPaths;
+		
+		// recover the path and its word sequence
 		LLEdge lPath;
-		LEdge *edgeAux = edgeBest;
-		while(edgeAux->nodePrev != m_lnodeInitial) {
-			edgeAux->edgePrevAux->bTouched = true;
-			lPath.push_front(edgeAux->edgePrevAux);
-			edgeAux = edgeAux->edgePrevAux;	
+		vector<int> vWords;
+		LNode *node = m_lnodeFinal;
+		int iRankNode = iRank;
+		while(node != m_lnodeInitial) {
+			LNBestPath &path = vPaths[node->iNode][iRankNode];
+			lPath.push_front(path.edge);
+			if (path.edge->lexUnit->iType == LEX_UNIT_TYPE_STANDARD) {
+				vWords.push_back(path.edge->lexUnit->iLexUnit);
+			}
+			iRankNode = path.iRankPrev;
+			node = path.edge->nodePrev;
 		}
-		lPath.push_back(edgeBest);
-		edgeBest->bTouched = true;
-		edgeAux = edgeBest;
-		while(edgeAux->nodeNext != m_lnodeFinal) {
-			edgeAux->edgeNextAux->bTouched = true;
-			lPath.push_back(edgeAux->edgeNextAux);
-			edgeAux = edgeAux->edgeNextAux;	
+		if (sWordSequences.insert(vWords).second == false) {
+			continue;
 		}
 		
 		// add the path to the n-best list
-		double dLikelihoodPath = edgeBest->dScoreViterbi + edgeBest->dScoreViterbiReverse;
 		NBestListEntry *nBestListEntry = new NBestListEntry(m_lexiconManager);
 		for(LLEdge::iterator jt = lPath.begin() ; jt != lPath.end() ; ++jt) {
 			double dLikelihoodAM = isProperty(LATTICE_PROPERTY_AM_PROB) ? (*jt)->fScoreAM : 0.0;
@@ -2578,12 +2768,148 @@ NBestList *HypothesisLattice::createNBestList(int iN, const char *strRescoringMe
 			nBestListEntry->add(new NBestListEntryElement((*jt)->iFrameStart,(*jt)->iFrameEnd,
 				(*jt)->lexUnit,dLikelihoodAM,dLikelihoodLM,dIP,dPP));	
 		}
-		nBestListEntry->setLikelihood(dLikelihoodPath);
+		nBestListEntry->setLikelihood(vPaths[m_lnodeFinal->iNode][iRank].dScore);
 		nBestList->add(nBestListEntry);
 	}
 	
+	BVC_VERB << "n-best entries: " << nBestList->size() << " (paths enumerated: " << iPaths << ")";
+	
+	delete [] vPaths;
+	delete [] vCandidates;
+	delete [] bCandidates;
+	
 	return nBestList;
 }
+
+// compute the path of the given rank to the node (the paths of lower rank must exist), it returns
+// whether the path exists
+bool HypothesisLattice::computeNBestPath(LNode *node, unsigned int iRank, VLNBestPath *vPaths, 
+	VLNBestPath *vCandidates, bool *bCandidates, bool bLikelihood) {
+
+	VLNBestPath &vPathsNode = vPaths[node->iNode];
+	if (iRank < vPathsNode.size()) {
+		return true;
+	}
+	assert(iRank == vPathsNode.size());
+	// there is a single (empty) path to the initial node
+	if (node == m_lnodeInitial) {
+		return false;
+	}
+	
+	VLNBestPath &vCandidatesNode = vCandidates[node->iNode];
+	
+	// first time: candidates are the best paths to the predecessors extended by the edge to the node
+	if (bCandidates[node->iNode] == false) {
+		for(LEdge *edge = node->edgePrev ; edge ; edge = edge->edgeNext) {
+			if (edge == vPathsNode.front().edge) {
+				continue;
+			}
+			LNBestPath path;
+			path.edge = edge;
+			path.iRankPrev = 0;
+			path.dScore = vPaths[edge->nodePrev->iNode].front().dScore;
+			path.dScore += bLikelihood ? edgeLogLikelihood(edge) : edgeLogPP(edge);
+			vCandidatesNode.push_back(path);
+		}
+		make_heap(vCandidatesNode.begin(),vCandidatesNode.end(),compareNBestPathScore);
+		bCandidates[node->iNode] = true;
+	}
+	
+	// the last path to the node is extended by the next path to the source node of its last edge
+	LEdge *edge = vPathsNode.back().edge;
+	int iRankPrev = vPathsNode.back().iRankPrev+1;
+	if (computeNBestPath(edge->nodePrev,iRankPrev,vPaths,vCandidates,bCandidates,bLikelihood)) {
+		LNBestPath path;
+		path.edge = edge;
+		path.iRankPrev = iRankPrev;
+		path.dScore = vPaths[edge->nodePrev->iNode][iRankPrev].dScore;
+		path.dScore += bLikelihood ? edgeLogLikelihood(edge) : edgeLogPP(edge);
+		vCandidatesNode.push_back(path);
+		push_heap(vCandidatesNode.begin(),vCandidatesNode.end(),compareNBestPathScore);
+	}
+	
+	if (vCandidatesNode.empty()) {
+		return false;
+	}
+	
+	// the best candidate is the next path
+	pop_heap(vCandidatesNode.begin(),vCandidatesNode.end(),compareNBestPathScore);
+	vPathsNode.push_back(vCandidatesNode.back());
+	vCandidatesNode.pop_back();
+	
+	return true;
+}
+
+// create a confusion network from the lattice: the path with the highest expected number of correct 
+// words is the pivot and the remaining edges are clustered around it by time overlap and phonetic 
+// similarity
+ConfusionNetwork *HypothesisLattice::createConfusionNetwork(float fMinPosterior) {
+
+	if (!isProperty(LATTICE_PROPERTY_PP)) {
+		BVC_ERROR << "posterior probabilities are needed to build a confusion network";
+	}
+	
+	// (1) pivot path: maximize the sum of posteriors of standard words (Viterbi in topological order)
+	double *dScoreNode = new double[m_iNodes];
+	LEdge **edgeBestNode = new LEdge*[m_iNodes];
+	for(int i=0 ; i < m_iNodes ; ++i) {
+		dScoreNode[i] = -DBL_MAX;
+		edgeBestNode[i] = NULL;
+	}
+	dScoreNode[m_lnodeInitial->iNode] = 0.0;
+	VLNode vLNode;
+	getNodesTopologicalOrder(vLNode);
+	for(VLNode::iterator it = vLNode.begin() ; it != vLNode.end() ; ++it) {
+		for(LEdge *edge = (*it)->edgeNext ; edge ; edge = edge->edgePrev) {
+			double dScore = dScoreNode[(*it)->iNode];
+			if (m_lexiconManager->isStandard(edge->lexUnit)) {
+				dScore += edge->fPP;
+			}
+			if ((edgeBestNode[edge->nodeNext->iNode] == NULL) || (dScore > dScoreNode[edge->nodeNext->iNode])) {
+				dScoreNode[edge->nodeNext->iNode] = dScore;
+				edgeBestNode[edge->nodeNext->iNode] = edge;
+			}
+		}
+	}
+	
+	// recover the pivot path
+	bool *bPivot = new bool[m_iEdges];
+	for(int i=0 ; i < m_iEdges ; ++i) {
+		bPivot[i] = false;
+	}
+	VLEdge vEdgePivot;
+	for(LNode *node = m_lnodeFinal ; node != m_lnodeInitial ; node = edgeBestNode[node->iNode]->nodePrev) {
+		assert(edgeBestNode[node->iNode] != NULL);
+		LEdge *edge = edgeBestNode[node->iNode];
+		bPivot[edge->iEdge] = true;
+		if (m_lexiconManager->isStandard(edge->lexUnit)) {
+			vEdgePivot.push_back(edge);
+		}
+	}
+	reverse(vEdgePivot.begin(),vEdgePivot.end());
+	
+	// (2) edges to cluster: standard words off the pivot path with enough posterior probability
+	VLEdge vEdges;
+	for(int i=0 ; i < m_iEdges ; ++i) {
+		if ((bPivot[i] == false) && (m_ledges[i]->fPP >= fMinPosterior) && 
+			m_lexiconManager->isStandard(m_ledges[i]->lexUnit)) {
+			vEdges.push_back(m_ledges[i]);
+		}
+	}
+	
+	delete [] dScoreNode;
+	delete [] edgeBestNode;
+	delete [] bPivot;
+	
+	// (3) build the network
+	ConfusionNetwork *confusionNetwork = new ConfusionNetwork(m_lexiconManager);
+	confusionNetwork->build(vEdgePivot,vEdges);
+	
+	BVC_VERB << "confusion network: " << confusionNetwork->size() << " slots (" << vEdges.size()+vEdgePivot.size() 
+		<< " edges clustered out of " << m_iEdges << ")";
+	
+	return confusionNetwork;
+}
 		
 // viterbi: for each edge keep predecessor edge and path score up to the edge
 void HypothesisLattice::viterbi(LEdge *edge) {
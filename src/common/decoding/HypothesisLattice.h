@@ -25,6 +25,7 @@ using namespace std;
 #include <vector>
 #include <list>
 #include <map>
+#include <set>
 #include <iomanip>
 
 #include <float.h>
@@ -37,6 +38,7 @@ namespace Bavieca {
 
 class Alignment;
 class BestPath;
+class ConfusionNetwork;
 class LMFSM;
 class LMManager;
 class Mappings;
@@ -146,6 +148,32 @@ typedef vector<LNode*> VLNode;
 typedef list<LNode*> LLNode;
 typedef map<LNode*,bool> MLNode;
 
+// node of the lattice composed with a language model (on-the-fly lm rescoring)
+typedef struct {
+	LNode *lnode;					// node in the composed lattice
+	int iLMState;					// language model state
+	double dScore;					// best (scaled) path score from the initial node
+} LComposedNode;
+
+typedef vector<LComposedNode> VLComposedNode;
+
+// default maximum number of lm-states kept for each lattice node (on-the-fly lm rescoring)
+#define LATTICE_LM_RESCORING_MAX_LM_STATES_NODE		100
+
+// path from the initial node to a given node (n-best recursive enumeration), the path is defined by
+// its last edge and the rank of the path that leads to the edge's source node
+typedef struct {
+	LEdge *edge;					// last edge in the path (NULL for the path to the initial node)
+	int iRankPrev;					// rank of the path to the source node of the edge
+	double dScore;					// path score
+} LNBestPath;
+
+typedef vector<LNBestPath> VLNBestPath;
+
+// maximum number of paths enumerated for each entry in the n-best list (paths with the same word sequence 
+// are collapsed, so the enumeration is bounded in case many paths differ only in fillers or pronunciations)
+#define LATTICE_NBEST_MAX_PATHS_ENTRY				1000
+
 // to keep lattice depth information
 typedef struct {
 	int iFramesEdges;
@@ -179,31 +207,33 @@ typedef struct {
 #define ALIGNMENT_PENALTY_DELETION			1
 #define ALIGNMENT_PENALTY_SUBSTITUTION		1
 
-// lattice WER computation
-#define LATTICE_WER_MAX_TOKENS				5000000
-#define LATTICE_WER_MAX_ACTIVE_TOKENS		20000
-#define LATTICE_WER_HISTORY_ITEMS_START	100000
-
-// beam size for Word Error Rate computation
+// beam size for Word Error Rate computation (alignment errors respect to the best state at each node)
 #define LATTICE_WER_COMPUTATION_BEAM		5
 
-// structure for the backtrace (Lattice WER computation)
-typedef struct _LWERHistoryItem {
-	int iPrev;									// previous history item
-	int iEdge;									// edge in the lattice
-	int iReference;							// reference index
-	unsigned char iAlignmentEvent;		// ins|del|subs
-	bool bUsed;
-} LWERHistoryItem;
+// Lattice WER computation: composition of the lattice with the Levenshtein automaton of the reference, 
+// each lattice node keeps the alignment states for a window of reference positions
+typedef struct {
+	int iReferenceStart;						// first reference position (# reference words consumed) in the window
+	int iStates;								// # reference positions in the window
+	int iState;									// first state of the window in the table of states
+} LWERNode;
+
+typedef vector<LWERNode> VLWERNode;
+
+// alignment state (lattice node, reference position)
+typedef struct {
+	int iScore;									// alignment errors
+	int iEdge;									// edge reaching the state (-1 for deletions)
+	unsigned char iAlignmentEvent;		// alignment event
+} LWERState;
+
+typedef vector<LWERState> VLWERState;
+
+// maximum number of alignment states kept at each lattice node (histogram pruning)
+#define LATTICE_WER_MAX_STATES_NODE			200
 
-// token to compute the lattice WER
-typedef struct _LWERToken {
-	int iScore;					// alignment score
-	int iNode;					// node in the lattice
-	int iReference;			// reference index
-	int iHistoryItem;			// last history-item (back-trace)
-	int iPrev;					// previous token in the list of active tokens for a given lattice node
-} LWERToken;
+// score of unreachable alignment states
+#define LATTICE_WER_SCORE_INFINITE			INT_MAX
 
 // confidence measures (all of them are based on posterior probabilities)
 #define CONFIDENCE_MEASURE_NONE					0
@@ -245,17 +275,6 @@ class HypothesisLattice {
 		float m_fAMScalingFactor;
 		float m_fLMScalingFactor;
 		
-		// Lattice WER computation
-		LWERToken *m_tokenCurrent;					// current active tokens
-		int m_iActiveTokensCurrent;
-		LWERToken *m_tokenNext;						// next active tokens
-		int m_iActiveTokensNext;
-		int *m_iTokenNode;							// table of nodes used to keep the active tokens at each node
-		LWERHistoryItem *m_historyItems;			// history items allocated
-		int m_iHistoryItems;							// # history items allocated
-		int m_iHistoryItemAvailable;				// next history item that is available
-		LWERToken m_tokenBest;
-		
 		// hmm-marking
 		unsigned char m_iContextSizeWW;				// within-word context size
 		unsigned char m_iContextSizeCW;				// cross-word context size
@@ -278,6 +297,15 @@ class HypothesisLattice {
 		// destroy the lattice
 		void destroy();
 		
+		// create a copy of a lattice edge including alignment and phonetic context
+		LEdge *copyEdge(LEdge *edgeOriginal);
+		
+		// compare composed nodes by score
+		static bool compareComposedNodeScore(const LComposedNode &node1, const LComposedNode &node2) {
+		
+			return (node1.dScore > node2.dScore);
+		}
+		
 		// set a property
 		void setProperty(const char *strProperty, const char *strValue) {
 		
@@ -719,112 +747,20 @@ class HypothesisLattice {
 		
 		// lattice Word Error Rate -------------------------------------------------------------
 		
-		// compute the Lattice Word Error Rate (also known as oracle)
+		// compute the Lattice Word Error Rate (also known as oracle), nodes are processed in topological 
+		// order keeping the best alignment for each reference position within the beam
 		LatticeWER *computeWER(VLexUnit &vLexUnitReference, BestPath **bestPath = NULL, 
 			Mappings *mappings = NULL, bool bPerfectMatch = false, int iBeam = LATTICE_WER_COMPUTATION_BEAM);
 			
-		// history item garbage collection: free-up unused history items
-		void historyItemGarbageCollection();
-		
-		// initializes a new history item to the given values
-		int newLWERHistoryItem(int iPrev, unsigned char iAlignmentEvent, LEdge *edge, int iReference) {
-		
-			if (m_iHistoryItemAvailable == -1) {
-				historyItemGarbageCollection();
-			}
-			assert(m_iHistoryItemAvailable != -1);
-			
-			LWERHistoryItem *historyItem = m_historyItems+m_iHistoryItemAvailable;
-			m_iHistoryItemAvailable = (m_historyItems+m_iHistoryItemAvailable)->iPrev;
-		
-			historyItem->iPrev = iPrev;
-			historyItem->iAlignmentEvent = iAlignmentEvent;
-			historyItem->iEdge = edge ? edge->iEdge : -1;	
-			historyItem->iReference = iReference;
-		
-			return (int)(historyItem-m_historyItems);
-		}
-		
-		// delete a history item
-		void deleteLWERHistoryItem(int iHistoryItem) {
-		
-			(m_historyItems+iHistoryItem)->iPrev = m_iHistoryItemAvailable;
-			m_iHistoryItemAvailable = iHistoryItem;
-		}
-		
-		// activates a token
-		void activateToken(LWERToken *tokenPrev, LEdge *edge, unsigned char iAlignmentEvent) {
-		
-			LWERToken *token = &m_tokenNext[m_iActiveTokensNext];
-			
-			if (edge) {
-				token->iNode = edge->nodeNext->iNode;
-			} else {
-				token->iNode = tokenPrev->iNode;
-			}
-			token->iScore = tokenPrev->iScore;
-			switch(iAlignmentEvent) {
-				case ALIGNMENT_EVENT_INSERTION: {
-					token->iScore += ALIGNMENT_PENALTY_INSERTION;
-					token->iReference = tokenPrev->iReference;
-					break;
-				}
-				case ALIGNMENT_EVENT_DELETION: {
-					token->iScore += ALIGNMENT_PENALTY_DELETION;
-					token->iReference = tokenPrev->iReference+1;
-					break;
-				}
-				case ALIGNMENT_EVENT_SUBSTITUTION: {
-					token->iScore += ALIGNMENT_PENALTY_SUBSTITUTION;
-					token->iReference = tokenPrev->iReference+1;
-					break;
-				}
-				case ALIGNMENT_EVENT_CORRECT: {
-					token->iReference = tokenPrev->iReference+1;
-					break;
-				}
-				case ALIGNMENT_EVENT_SKIP_HYP: {
-					token->iReference = tokenPrev->iReference;
-					break;
-				}
-				case ALIGNMENT_EVENT_SKIP_REF: {
-					token->iReference = tokenPrev->iReference+1;
-					break;
-				}
-				default: {
-					assert(0);
-				}
-			}
-			if (token->iScore > m_tokenBest.iScore) {
-				return;
-			}
-			
-			token->iHistoryItem = newLWERHistoryItem(tokenPrev->iHistoryItem,iAlignmentEvent,edge,token->iReference);
-			assert(token->iNode != -1);
-			
-			// try to recombine
-			bool bRecombined = false;			
-			for(int iTokenAux = m_iTokenNode[token->iNode] ; iTokenAux != -1 ; iTokenAux = (m_tokenNext+iTokenAux)->iPrev) {
-				LWERToken *tokenAux = m_tokenNext+iTokenAux; 
-				assert(tokenAux->iNode != -1);
-				if ((tokenAux->iNode == token->iNode) && (tokenAux->iReference == token->iReference)) {
-					if (tokenAux->iScore > token->iScore) {
-						tokenAux->iScore = token->iScore;
-						deleteLWERHistoryItem(tokenAux->iHistoryItem);
-						tokenAux->iHistoryItem = token->iHistoryItem;
-					} else {
-						deleteLWERHistoryItem(token->iHistoryItem);
-					}
-					bRecombined = true;
-					break;
-				}
-			}	
-			if (bRecombined == false) {
-				token->iPrev = m_iTokenNode[token->iNode];
-				m_iTokenNode[token->iNode] = token-m_tokenNext;
-				assert(token->iNode != -1);
-				++m_iActiveTokensNext;
-				assert(m_iActiveTokensNext < LATTICE_WER_MAX_TOKENS);
+		// relax an alignment state of the Lattice WER computation
+		inline void relaxWERState(VLWERState &vWindow, int iReference, int iScore, int iEdge, 
+			unsigned char iAlignmentEvent) {
+		
+			LWERState &state = vWindow[iReference];
+			if (iScore < state.iScore) {
+				state.iScore = iScore;
+				state.iEdge = iEdge;
+				state.iAlignmentEvent = iAlignmentEvent;
 			}
 		}
 		
@@ -1068,6 +1004,15 @@ class HypothesisLattice {
 		//       word context
 		void attachLMProbabilities(LMFSM *lmFSM);
 		
+		// attach lm-probabilities composing the lattice with the language model on-the-fly (in topological 
+		// order), paths reaching a node with the same lm-state are merged and the expansion is pruned using 
+		// the forward scores and the backward scores of the original lattice
+		void attachLMProbabilitiesPruned(LMFSM *lmFSM, float fScaleAM, float fScaleLM, float fBeam, 
+			int iMaxLMStatesNode = LATTICE_LM_RESCORING_MAX_LM_STATES_NODE);
+		
+		// return the nodes in the lattice in topological order
+		void getNodesTopologicalOrder(VLNode &vLNode);
+		
 		// attach insertion penalties
 		void attachInsertionPenalty(LexiconManager *lexiconManager);	
 		
@@ -1076,9 +1021,28 @@ class HypothesisLattice {
 		
 		// n-best list generation -----------------------------------------------
 		
-		// create a n-best list from the lattice
+		// create a n-best list from the lattice (lazy recursive enumeration of paths, entries are unique 
+		// word sequences added to the list as they are found)
 		NBestList *createNBestList(int iN, const char *strRescoringMethod);
 		
+		// compute the path of the given rank to the node (the paths of lower rank must exist), it returns
+		// whether the path exists
+		bool computeNBestPath(LNode *node, unsigned int iRank, VLNBestPath *vPaths, VLNBestPath *vCandidates, 
+			bool *bCandidates, bool bLikelihood);
+		
+		// compare n-best paths by score (heap of candidates)
+		static bool compareNBestPathScore(const LNBestPath &path1, const LNBestPath &path2) {
+		
+			return (path1.dScore < path2.dScore);
+		}
+		
+		// confusion network generation ---------------------------------------
+		
+		// create a confusion network from the lattice: the path with the highest expected number of 
+		// correct words is the pivot and the remaining edges are clustered around it by time overlap and 
+		// phonetic similarity (edges with a posterior below the threshold are not clustered)
+		ConfusionNetwork *createConfusionNetwork(float fMinPosterior);
+		
 		// viterbi: for each edge keep predecessor edge and path score up to the edge
 		void viterbi(LEdge *edge);
 		
@@ -59,6 +59,11 @@ class NBestList {
 		void add(NBestListEntry *entry) {
 			m_vEntries.push_back(entry);
 		}
+		
+		// return the number of entries in the list
+		unsigned int size() {
+			return (unsigned int)m_vEntries.size();
+		}
 };
 
 };	// end-of-namespace
@@ -76,6 +76,13 @@ class TrnFile {
 			}		
 			return it->second->strTranscription.c_str();
 		}
+		
+		// return the entry at the given position
+		inline TrnEntry *getEntry(unsigned int i) {
+		
+			assert(i < m_vTrnEntry.size());
+			return m_vTrnEntry[i];
+		}
 
 };
 
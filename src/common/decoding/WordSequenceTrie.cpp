@@ -0,0 +1,134 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#include "WordSequenceTrie.h"
+#include "LogMessage.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <string.h>
+
+namespace Bavieca {
+
+// constructor
+WordSequenceTrie::WordSequenceTrie(int iNodesInitial) {
+
+	// the number of buckets is the smallest power of two not below the number of nodes
+	int iBuckets = 1;
+	while(iBuckets < iNodesInitial) {
+		iBuckets <<= 1;
+	}
+	m_iNodesMax = iBuckets;
+	m_nodes = new WSTrieNode[m_iNodesMax];
+	m_iBuckets = new int[iBuckets];
+	m_iBucketsMask = iBuckets-1;
+	m_iNodes = 0;
+	reset();
+}
+
+// destructor
+WordSequenceTrie::~WordSequenceTrie() {
+
+	delete [] m_nodes;
+	delete [] m_iBuckets;
+}
+
+// remove all the word sequences but the empty one
+void WordSequenceTrie::reset() {
+
+	for(int i=0 ; i <= m_iBucketsMask ; ++i) {
+		m_iBuckets[i] = -1;
+	}
+	
+	// empty word sequence (it is never hashed, it is only a prefix)
+	m_nodes[WORD_SEQUENCE_EMPTY].iPrev = -1;
+	m_nodes[WORD_SEQUENCE_EMPTY].iLexUnit = -1;
+	m_nodes[WORD_SEQUENCE_EMPTY].iNext = -1;
+	m_iNodes = 1;
+}
+
+// double the capacity and rehash the nodes
+void WordSequenceTrie::grow() {
+
+	int iNodesMax = 2*m_iNodesMax;
+	WSTrieNode *nodes = new WSTrieNode[iNodesMax];
+	memcpy(nodes,m_nodes,m_iNodes*sizeof(WSTrieNode));
+	delete [] m_nodes;
+	m_nodes = nodes;
+	m_iNodesMax = iNodesMax;
+	
+	// node ids do not change, only the buckets are rebuilt
+	delete [] m_iBuckets;
+	m_iBuckets = new int[iNodesMax];
+	m_iBucketsMask = iNodesMax-1;
+	for(int i=0 ; i <= m_iBucketsMask ; ++i) {
+		m_iBuckets[i] = -1;
+	}
+	for(int i=WORD_SEQUENCE_EMPTY+1 ; i < m_iNodes ; ++i) {
+		unsigned int iBucket = hash(m_nodes[i].iPrev,m_nodes[i].iLexUnit) & m_iBucketsMask;
+		m_nodes[i].iNext = m_iBuckets[iBucket];
+		m_iBuckets[iBucket] = i;
+	}
+}
+
+// return the lexical units in the word sequence (in chronological order)
+void WordSequenceTrie::getLexUnits(int iWordSequence, vector<int> &vLexUnits) {
+
+	vLexUnits.clear();
+	for(int i = iWordSequence ; i != WORD_SEQUENCE_EMPTY ; i = m_nodes[i].iPrev) {
+		vLexUnits.push_back(m_nodes[i].iLexUnit);
+	}
+	reverse(vLexUnits.begin(),vLexUnits.end());
+}
+
+// compute the load factor of the hash table (debugging)
+float WordSequenceTrie::computeLoadFactor(int *iBucketsUsed, int *iCollisions) {
+
+	*iBucketsUsed = 0;
+	*iCollisions = 0;
+	for(int i=0 ; i <= m_iBucketsMask ; ++i) {
+		if (m_iBuckets[i] != -1) {
+			++(*iBucketsUsed);
+			for(int j = m_nodes[m_iBuckets[i]].iNext ; j != -1 ; j = m_nodes[j].iNext) {
+				++(*iCollisions);
+			}
+		}
+	}
+	
+	return ((float)(*iBucketsUsed))/((float)(m_iBucketsMask+1));
+}
+
+// print stats (debugging)
+void WordSequenceTrie::printStats() {
+
+	int iBucketsUsed = 0;
+	int iCollisions = 0;
+	float fLoadFactor = computeLoadFactor(&iBucketsUsed,&iCollisions);
+	
+	BVC_VERB << "- word sequences ---------------------------";
+	BVC_VERB << " # word sequences: " << setw(8) << m_iNodes;
+	BVC_VERB << " # nodes allocated:" << setw(8) << m_iNodesMax;
+	BVC_VERB << " # buckets used:   " << setw(8) << iBucketsUsed << " (" << FLT(5,2) << 
+		100.0*((float)iBucketsUsed)/((float)(m_iBucketsMask+1)) << "%)";
+	BVC_VERB << " # collisions:     " << setw(8) << iCollisions;
+	BVC_VERB << " load factor:      " << FLT(8,4) << fLoadFactor;
+	BVC_VERB << "--------------------------------------------";
+}
+
+};	// end-of-namespace
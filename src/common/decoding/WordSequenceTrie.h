@@ -0,0 +1,140 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#ifndef WORDSEQUENCETRIE_H
+#define WORDSEQUENCETRIE_H
+
+using namespace std;
+#include <vector>
+
+#include "Global.h"
+
+namespace Bavieca {
+
+// identifier of the empty word sequence (root of the trie)
+#define WORD_SEQUENCE_EMPTY					0
+
+// initial number of nodes (grows as needed)
+#define WORD_SEQUENCE_TRIE_NODES_INITIAL	(1<<16)
+
+// node in the trie (a word sequence is its prefix plus its last lexical unit)
+typedef struct {
+	int iPrev;						// prefix (word sequence without the last lexical unit)
+	int iLexUnit;					// last lexical unit in the word sequence (-1 for the empty sequence)
+	int iNext;						// next node in the bucket (to handle collisions)
+} WSTrieNode;
+
+/**
+	@author daniel <dani.bolanos@gmail.com>
+	
+	Interned word sequences for lattice generation. Each unique word sequence is a node that points to its 
+	prefix, so it is identified by a single integer: two sequences are equal if they have the same id and 
+	extending a sequence by one lexical unit is a hash lookup on the pair (prefix, lexical unit).
+*/
+class WordSequenceTrie {
+
+	private:
+	
+		WSTrieNode *m_nodes;			// nodes (index = word sequence id)
+		int m_iNodes;					// nodes in use
+		int m_iNodesMax;				// nodes allocated
+		int *m_iBuckets;				// first node in each bucket (-1 if empty)
+		int m_iBucketsMask;			// # buckets - 1 (# buckets is a power of two)
+		
+		// hash function
+		inline unsigned int hash(int iWordSequence, int iLexUnit) {
+		
+			unsigned int iHash = ((unsigned int)iWordSequence)*2654435761u;
+			iHash ^= ((unsigned int)iLexUnit)*2246822519u;
+			iHash ^= iHash >> 15;
+			
+			return iHash;
+		}
+		
+		// double the capacity and rehash the nodes
+		void grow();
+
+	public:
+
+		// constructor
+		WordSequenceTrie(int iNodesInitial = WORD_SEQUENCE_TRIE_NODES_INITIAL);
+
+		// destructor
+		~WordSequenceTrie();
+		
+		// remove all the word sequences but the empty one
+		void reset();
+		
+		// return the word sequence resulting from appending the lexical unit to the given one
+		inline int extend(int iWordSequence, int iLexUnit) {
+		
+			assert((iWordSequence >= 0) && (iWordSequence < m_iNodes));
+		
+			unsigned int iBucket = hash(iWordSequence,iLexUnit) & m_iBucketsMask;
+			for(int i = m_iBuckets[iBucket] ; i != -1 ; i = m_nodes[i].iNext) {
+				if ((m_nodes[i].iPrev == iWordSequence) && (m_nodes[i].iLexUnit == iLexUnit)) {
+					return i;
+				}
+			}
+			
+			// not found: create it
+			if (m_iNodes == m_iNodesMax) {
+				grow();
+				iBucket = hash(iWordSequence,iLexUnit) & m_iBucketsMask;
+			}
+			WSTrieNode *node = m_nodes+m_iNodes;
+			node->iPrev = iWordSequence;
+			node->iLexUnit = iLexUnit;
+			node->iNext = m_iBuckets[iBucket];
+			m_iBuckets[iBucket] = m_iNodes;
+			
+			return m_iNodes++;
+		}
+		
+		// return the prefix of a word sequence
+		inline int getPrev(int iWordSequence) {
+		
+			return m_nodes[iWordSequence].iPrev;
+		}
+		
+		// return the last lexical unit of a word sequence
+		inline int getLexUnit(int iWordSequence) {
+		
+			return m_nodes[iWordSequence].iLexUnit;
+		}
+		
+		// return the number of word sequences (including the empty one)
+		inline int size() {
+		
+			return m_iNodes;
+		}
+		
+		// return the lexical units in the word sequence (in chronological order)
+		void getLexUnits(int iWordSequence, vector<int> &vLexUnits);
+		
+		// compute the load factor of the hash table (debugging)
+		float computeLoadFactor(int *iBucketsUsed, int *iCollisions);
+		
+		// print stats (debugging)
+		void printStats();
+};
+
+};	// end-of-namespace
+
+#endif
@@ -0,0 +1,329 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#include "AcousticLookAhead.h"
+#include "HMMManager.h"
+#include "LogMessage.h"
+#include "PhoneSet.h"
+
+#include <iomanip>
+#include <vector>
+
+namespace Bavieca {
+
+// constructor
+AcousticLookAhead::AcousticLookAhead(PhoneSet *phoneSet, HMMManager *hmmManager, int iComponents, int iFrames, 
+	float fWeight) {
+
+	assert(iComponents >= 1);
+	assert(iFrames >= 1);
+
+	m_phoneSet = phoneSet;
+	m_hmmManager = hmmManager;
+	m_iDim = m_hmmManager->getFeatureDim();
+	m_iPhones = m_phoneSet->size();
+	m_iComponents = iComponents;
+	m_iFrames = iFrames;
+	m_fWeight = fWeight;
+	m_iGaussiansPhone = NULL;
+	m_fMean = NULL;
+	m_fCovariance = NULL;
+	m_fConstant = NULL;
+	m_bModelsShared = false;
+	m_fScoresFrame = new float[m_iFrames*m_iPhones];
+	m_iTimeFrame = new int[m_iFrames];
+	m_fLookAhead = new float[m_iPhones];
+	beginUtterance();
+}
+
+// constructor (shares the phone models of the given look-ahead, which must outlive this object, 
+// only the buffers used to decode are allocated)
+AcousticLookAhead::AcousticLookAhead(AcousticLookAhead *acousticLookAhead) {
+
+	assert(acousticLookAhead->m_iGaussiansPhone);
+
+	m_phoneSet = acousticLookAhead->m_phoneSet;
+	m_hmmManager = acousticLookAhead->m_hmmManager;
+	m_iDim = acousticLookAhead->m_iDim;
+	m_iPhones = acousticLookAhead->m_iPhones;
+	m_iComponents = acousticLookAhead->m_iComponents;
+	m_iFrames = acousticLookAhead->m_iFrames;
+	m_fWeight = acousticLookAhead->m_fWeight;
+	m_iGaussiansPhone = acousticLookAhead->m_iGaussiansPhone;
+	m_fMean = acousticLookAhead->m_fMean;
+	m_fCovariance = acousticLookAhead->m_fCovariance;
+	m_fConstant = acousticLookAhead->m_fConstant;
+	m_bModelsShared = true;
+	m_fScoresFrame = new float[m_iFrames*m_iPhones];
+	m_iTimeFrame = new int[m_iFrames];
+	m_fLookAhead = new float[m_iPhones];
+	beginUtterance();
+}
+
+// destructor
+AcousticLookAhead::~AcousticLookAhead() {
+
+	if ((m_iGaussiansPhone) && (m_bModelsShared == false)) {
+		delete [] m_iGaussiansPhone;
+		delete [] m_fMean;
+		delete [] m_fCovariance;
+		delete [] m_fConstant;
+	}
+	delete [] m_fScoresFrame;
+	delete [] m_iTimeFrame;
+	delete [] m_fLookAhead;
+}
+
+// derive the context-independent phone models (HMMs need to be initialized for decoding)
+void AcousticLookAhead::build() {
+
+	assert(m_iGaussiansPhone == NULL);
+
+	m_iGaussiansPhone = new int[m_iPhones];
+	m_fMean = new float[m_iPhones*m_iComponents*m_iDim];
+	m_fCovariance = new float[m_iPhones*m_iComponents*m_iDim];
+	m_fConstant = new float[m_iPhones*m_iComponents];
+	
+	int iHMMStates = 0;
+	HMMStateDecoding *hmmStates = m_hmmManager->getHMMStatesDecoding(&iHMMStates);
+	
+	float *fWeightDim = new float[m_iDim];
+	float *fCentroids = new float[m_iComponents*m_iDim];
+	double *dAcc = new double[m_iComponents*(2*m_iDim+1)];
+	
+	for(int iPhone=0 ; iPhone < m_iPhones ; ++iPhone) {
+	
+		m_iGaussiansPhone[iPhone] = 0;
+	
+		// pool the Gaussian components of all the HMM-states of the phone 
+		vector<GaussianDecoding*> vGaussian;
+		int iStates = 0;
+		for(int i=0 ; i < iHMMStates ; ++i) {
+			if (hmmStates[i].getPhone() != iPhone) {
+				continue;
+			}
+			int iComponents = 0;
+			GaussianDecoding *gaussians = hmmStates[i].getGaussians(iComponents);
+			for(int j=0 ; j < iComponents ; ++j) {
+				vGaussian.push_back(gaussians+j);
+			}
+			++iStates;
+		}
+		if (vGaussian.empty()) {
+			continue;
+		}
+		int iGaussians = (int)vGaussian.size();
+		int iClusters = min(m_iComponents,iGaussians);
+		
+		// the distance to the centroids is weighted by the average inverted covariance
+		for(int d=0 ; d < m_iDim ; ++d) {
+			double dSum = 0.0;
+			for(int i=0 ; i < iGaussians ; ++i) {
+				dSum += vGaussian[i]->fCovariance[d];
+			}
+			fWeightDim[d] = (float)(dSum/((double)iGaussians));
+		}
+		
+		// initial centroids: means evenly spaced across the pool
+		for(int c=0 ; c < iClusters ; ++c) {
+			memcpy(fCentroids+c*m_iDim,vGaussian[(c*iGaussians)/iClusters]->fMean,m_iDim*sizeof(float));
+		}
+		
+		// k-means on the means
+		vector<int> vAssignment(iGaussians,0);
+		for(int iIteration=0 ; iIteration < ACOUSTIC_LOOK_AHEAD_KMEANS_ITERATIONS ; ++iIteration) {
+			for(int i=0 ; i < iGaussians ; ++i) {
+				float fDistanceBest = FLT_MAX;
+				for(int c=0 ; c < iClusters ; ++c) {
+					float fDistance = 0.0;
+					for(int d=0 ; d < m_iDim ; ++d) {
+						float fDiff = vGaussian[i]->fMean[d]-fCentroids[c*m_iDim+d];
+						fDistance += fDiff*fDiff*fWeightDim[d];
+					}
+					if (fDistance < fDistanceBest) {
+						fDistanceBest = fDistance;
+						vAssignment[i] = c;
+					}
+				}
+			}
+			// update the centroids (empty clusters keep their centroid)
+			for(int c=0 ; c < iClusters ; ++c) {
+				double dWeight = 0.0;
+				for(int d=0 ; d < m_iDim ; ++d) {
+					dAcc[c*m_iDim+d] = 0.0;
+				}
+				for(int i=0 ; i < iGaussians ; ++i) {
+					if (vAssignment[i] == c) {
+						dWeight += vGaussian[i]->fWeight;
+						for(int d=0 ; d < m_iDim ; ++d) {
+							dAcc[c*m_iDim+d] += vGaussian[i]->fWeight*vGaussian[i]->fMean[d];
+						}
+					}
+				}
+				if (dWeight > 0.0) {
+					for(int d=0 ; d < m_iDim ; ++d) {
+						fCentroids[c*m_iDim+d] = (float)(dAcc[c*m_iDim+d]/dWeight);
+					}
+				}
+			}
+		}
+		
+		// merge the components in each cluster by moment matching
+		// (covariances are inverted and divided by two, the weights of each state add up to one)
+		for(int c=0 ; c < iClusters ; ++c) {
+			double *dWeight = dAcc+c*(2*m_iDim+1);
+			double *dFirst = dWeight+1;
+			double *dSecond = dFirst+m_iDim;
+			*dWeight = 0.0;
+			for(int d=0 ; d < m_iDim ; ++d) {
+				dFirst[d] = 0.0;
+				dSecond[d] = 0.0;
+			}
+			for(int i=0 ; i < iGaussians ; ++i) {
+				if (vAssignment[i] != c) {
+					continue;
+				}
+				GaussianDecoding *gaussian = vGaussian[i];
+				*dWeight += gaussian->fWeight;
+				for(int d=0 ; d < m_iDim ; ++d) {
+					double dVariance = 1.0/(2.0*gaussian->fCovariance[d]);
+					dFirst[d] += gaussian->fWeight*gaussian->fMean[d];
+					dSecond[d] += gaussian->fWeight*(dVariance+gaussian->fMean[d]*gaussian->fMean[d]);
+				}
+			}
+			if (*dWeight <= 0.0) {
+				continue;
+			}
+			int iGaussian = iPhone*m_iComponents+m_iGaussiansPhone[iPhone];
+			float *fMean = m_fMean+iGaussian*m_iDim;
+			float *fCovariance = m_fCovariance+iGaussian*m_iDim;
+			double dLogDeterminant = 0.0;
+			for(int d=0 ; d < m_iDim ; ++d) {
+				double dMean = dFirst[d]/(*dWeight);
+				double dVariance = max(dSecond[d]/(*dWeight)-dMean*dMean,1.0e-6);
+				fMean[d] = (float)dMean;
+				fCovariance[d] = (float)(1.0/(2.0*dVariance));
+				dLogDeterminant += log(dVariance);
+			}
+			m_fConstant[iGaussian] = (float)(log((*dWeight)/((double)iStates))-
+				0.5*((double)m_iDim)*log(2.0*PI_NUMBER)-0.5*dLogDeterminant);
+			++m_iGaussiansPhone[iPhone];
+		}
+	}
+	
+	delete [] fWeightDim;
+	delete [] fCentroids;
+	delete [] dAcc;
+}
+
+// begin utterance
+void AcousticLookAhead::beginUtterance() {
+
+	for(int i=0 ; i < m_iFrames ; ++i) {
+		m_iTimeFrame[i] = -1;
+	}
+	m_iTime = -1;
+	m_fFeatures = NULL;
+	m_iStride = 0;
+	m_iTimeFeaturesBegin = -1;
+	m_iTimeFeaturesEnd = -1;
+}
+
+// set the feature vectors of the chunk to decode (iTimeBegin is the time-stamp of the first one)
+void AcousticLookAhead::setFeatures(MatrixBase<float> &mFeatures, int iTimeBegin) {
+
+	m_fFeatures = mFeatures.getData();
+	m_iStride = mFeatures.getStride();
+	m_iTimeFeaturesBegin = iTimeBegin;
+	m_iTimeFeaturesEnd = iTimeBegin+mFeatures.getRows();
+}
+
+// compute the normalized phone scores of a frame
+void AcousticLookAhead::computeScoresFrame(float *fFeatures, float *fScores) {
+
+	float fScoreBest = -FLT_MAX;
+	for(int iPhone=0 ; iPhone < m_iPhones ; ++iPhone) {
+		float fScorePhone = -FLT_MAX;
+		for(int g=0 ; g < m_iGaussiansPhone[iPhone] ; ++g) {
+			int iGaussian = iPhone*m_iComponents+g;
+			float *fMean = m_fMean+iGaussian*m_iDim;
+			float *fCovariance = m_fCovariance+iGaussian*m_iDim;
+			float fAcc = m_fConstant[iGaussian];
+			for(int d=0 ; d < m_iDim ; ++d) {
+				fAcc -= (fFeatures[d]-fMean[d])*(fFeatures[d]-fMean[d])*fCovariance[d];
+			}
+			fScorePhone = max(fScorePhone,fAcc);
+		}
+		fScores[iPhone] = fScorePhone;
+		fScoreBest = max(fScoreBest,fScorePhone);
+	}
+	
+	// phones not modeled are not penalized
+	for(int iPhone=0 ; iPhone < m_iPhones ; ++iPhone) {
+		fScores[iPhone] = (m_iGaussiansPhone[iPhone] > 0) ? fScores[iPhone]-fScoreBest : 0.0f;
+	}
+}
+
+// compute the look-ahead scores of all the phones at the given frame
+void AcousticLookAhead::computeLookAhead(int iTime) {
+
+	for(int iPhone=0 ; iPhone < m_iPhones ; ++iPhone) {
+		m_fLookAhead[iPhone] = 0.0;
+	}
+	
+	// frames beyond the current chunk are not available (no penalty)
+	for(int i=1 ; i <= m_iFrames ; ++i) {
+		int iTimeFrame = iTime+i;
+		if ((iTimeFrame < m_iTimeFeaturesBegin) || (iTimeFrame >= m_iTimeFeaturesEnd)) {
+			break;
+		}
+		int iSlot = iTimeFrame % m_iFrames;
+		float *fScores = m_fScoresFrame+iSlot*m_iPhones;
+		if (m_iTimeFrame[iSlot] != iTimeFrame) {
+			computeScoresFrame(m_fFeatures+(iTimeFrame-m_iTimeFeaturesBegin)*m_iStride,fScores);
+			m_iTimeFrame[iSlot] = iTimeFrame;
+		}
+		for(int iPhone=0 ; iPhone < m_iPhones ; ++iPhone) {
+			m_fLookAhead[iPhone] += fScores[iPhone];
+		}
+	}
+	
+	for(int iPhone=0 ; iPhone < m_iPhones ; ++iPhone) {
+		m_fLookAhead[iPhone] *= m_fWeight;
+	}
+	m_iTime = iTime;
+}
+
+// print information about the phone models
+void AcousticLookAhead::print() {
+
+	int iPhonesModeled = 0;
+	int iGaussians = 0;
+	for(int iPhone=0 ; iPhone < m_iPhones ; ++iPhone) {
+		if (m_iGaussiansPhone[iPhone] > 0) {
+			++iPhonesModeled;
+			iGaussians += m_iGaussiansPhone[iPhone];
+		}
+	}
+	
+	BVC_INFORMATION << "acoustic look-ahead: " << m_iFrames << " frames, weight: " << FLT(5,2) << m_fWeight << 
+		", " << iPhonesModeled << " phones modeled with " << iGaussians << " Gaussian components";
+}
+
+};	// end-of-namespace
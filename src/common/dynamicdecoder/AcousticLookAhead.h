@@ -0,0 +1,120 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#ifndef ACOUSTICLOOKAHEAD_H
+#define ACOUSTICLOOKAHEAD_H
+
+#include "Global.h"
+#include "MatrixBase.h"
+
+namespace Bavieca {
+
+class HMMManager;
+class PhoneSet;
+
+// k-means iterations used to derive the context-independent phone models
+#define ACOUSTIC_LOOK_AHEAD_KMEANS_ITERATIONS		10
+
+/**
+	@author daniel <dani.bolanos@gmail.com>
+	
+	Phone-level acoustic look-ahead. A small context-independent Gaussian mixture is derived for each 
+	phone by clustering (with moment matching) the Gaussian components of all the HMM-states of the phone. 
+	The look-ahead score of a phone at frame t is the sum over frames t+1...t+N of the difference between 
+	its score and the score of the best phone, scaled by a weight, so it is never positive. The decoder 
+	adds it to the score of word-initial arcs only to decide whether they are activated.
+*/
+class AcousticLookAhead {
+
+	private:
+	
+		PhoneSet *m_phoneSet;
+		HMMManager *m_hmmManager;
+		int m_iDim;							// feature dimensionality
+		int m_iPhones;						// number of phones
+		int m_iComponents;				// maximum number of Gaussian components per phone
+		int m_iFrames;						// look-ahead frames
+		float m_fWeight;					// look-ahead weight
+		
+		// context-independent phone models
+		int *m_iGaussiansPhone;			// number of Gaussian components of each phone (0 if the phone is not modeled)
+		float *m_fMean;					// means [phone x component x dimension]
+		float *m_fCovariance;			// inverted covariances divided by two [phone x component x dimension]
+		float *m_fConstant;				// constants [phone x component]
+		bool m_bModelsShared;			// whether the phone models belong to another look-ahead object
+		
+		// features of the current chunk
+		float *m_fFeatures;
+		int m_iStride;
+		int m_iTimeFeaturesBegin;
+		int m_iTimeFeaturesEnd;
+		
+		// normalized phone scores of the frames in the look-ahead window [frame (ring) x phone]
+		float *m_fScoresFrame;
+		int *m_iTimeFrame;
+		
+		// look-ahead scores at the current frame
+		float *m_fLookAhead;
+		int m_iTime;
+		
+		// compute the normalized phone scores of a frame
+		void computeScoresFrame(float *fFeatures, float *fScores);
+		
+		// compute the look-ahead scores of all the phones at the given frame
+		void computeLookAhead(int iTime);
+
+	public:
+
+		// constructor
+		AcousticLookAhead(PhoneSet *phoneSet, HMMManager *hmmManager, int iComponents, int iFrames, float fWeight);
+		
+		// constructor (shares the phone models of the given look-ahead, which must outlive this object, 
+		// only the buffers used to decode are allocated)
+		AcousticLookAhead(AcousticLookAhead *acousticLookAhead);
+
+		// destructor
+		~AcousticLookAhead();
+		
+		// derive the context-independent phone models (HMMs need to be initialized for decoding)
+		void build();
+		
+		// begin utterance
+		void beginUtterance();
+		
+		// set the feature vectors of the chunk to decode (iTimeBegin is the time-stamp of the first one)
+		void setFeatures(MatrixBase<float> &mFeatures, int iTimeBegin);
+		
+		// return the look-ahead score of the given phone at the given frame (frames after it are looked at)
+		inline float getScore(unsigned char iPhone, int iTime) {
+		
+			if (iTime != m_iTime) {
+				computeLookAhead(iTime);
+			}
+			
+			return m_fLookAhead[iPhone];
+		}
+		
+		// print information about the phone models
+		void print();
+
+};
+
+};	// end-of-namespace
+
+#endif
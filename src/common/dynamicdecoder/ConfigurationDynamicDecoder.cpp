@@ -62,6 +62,16 @@ void ConfigurationDynamicDecoder::defineParameters() {
 	
 	// acoustic models
 	defineParameter("acousticModels.file","acoustic models",PARAMETER_TYPE_FILE,false);
+	defineParameter("acousticModels.gaussianSelection.file","Gaussian selection codebook and shortlists (built by hmmx)",
+		PARAMETER_TYPE_FILE,true);
+	defineParameter("acousticModels.gaussianSelection.codewords","codebook size for Gaussian selection (built at load time)",
+		PARAMETER_TYPE_INTEGER,true,"[1|65536]");
+	defineParameter("acousticModels.gaussianSelection.threshold","maximum log-likelihood distance to the best component in a shortlist",
+		PARAMETER_TYPE_FLOAT,true,"[0.0|1000000.0]","10.0");
+	defineParameter("acousticModels.gaussianSelection.floor","minimum number of components in a shortlist",
+		PARAMETER_TYPE_INTEGER,true,"[1|1000]","1");
+	defineParameter("acousticModels.quantization","quantization of the Gaussian parameters used for decoding",
+		PARAMETER_TYPE_STRING,true,"none|int8|int16","none");
 	
 	// language model
 	defineParameter("languageModel.file","language model",PARAMETER_TYPE_FILE,false);
@@ -91,6 +101,34 @@ void ConfigurationDynamicDecoder::defineParameters() {
 		PARAMETER_TYPE_INTEGER,false);
 	defineParameter("pruning.maxActiveTokensArc","maximum number of active tokens per arc",
 		PARAMETER_TYPE_INTEGER,false);
+	defineParameter("pruning.adaptive.mode","adaptive beam mode (active arcs or real time factor target)",
+		PARAMETER_TYPE_STRING,true,"none|active|rtf","none");
+	defineParameter("pruning.adaptive.target","target number of active arcs or real time factor",
+		PARAMETER_TYPE_FLOAT,true);
+	defineParameter("pruning.adaptive.likelihoodBeamMin","minimum likelihood beam for pruning arcs",
+		PARAMETER_TYPE_FLOAT,true);
+	defineParameter("pruning.adaptive.likelihoodBeamMax","maximum likelihood beam for pruning arcs",
+		PARAMETER_TYPE_FLOAT,true);
+	
+	// frame skipping
+	defineParameter("frameSkipping.mode","frame skipping mode (emission probabilities are reused on skipped frames)",
+		PARAMETER_TYPE_STRING,true,"none|fixed|adaptive","none");
+	defineParameter("frameSkipping.rate","maximum number of frames sharing the same emission probabilities",
+		PARAMETER_TYPE_INTEGER,true,"[1|10]","2");
+	defineParameter("frameSkipping.threshold","maximum relative change of the features for a frame to be skipped (adaptive)",
+		PARAMETER_TYPE_FLOAT,true,"[0.0|1.0]","0.05");
+	
+	// emission probabilities computed ahead of time
+	defineParameter("emissionCache.frames","number of frames an HMM-state is scored on at once (batch/chunked decoding)",
+		PARAMETER_TYPE_INTEGER,true,"[1|64]","1");
+	
+	// acoustic look-ahead (word-initial arcs)
+	defineParameter("acousticLookAhead.frames","number of frames looked ahead when activating word-initial arcs (0 disables it)",
+		PARAMETER_TYPE_INTEGER,true,"[0|20]","0");
+	defineParameter("acousticLookAhead.components","number of Gaussian components of the context-independent phone models",
+		PARAMETER_TYPE_INTEGER,true,"[1|256]","8");
+	defineParameter("acousticLookAhead.weight","weight of the acoustic look-ahead score",
+		PARAMETER_TYPE_FLOAT,true,"[0.0|1.0]","0.5");
 	
 	// decoder output
 	defineParameter("output.bestSinglePath","",PARAMETER_TYPE_BOOLEAN,true,"yes|no","yes");
@@ -101,6 +139,8 @@ void ConfigurationDynamicDecoder::defineParameters() {
 	defineParameter("output.audio.folder","folder to store the audio",PARAMETER_TYPE_FOLDER,true);
 	defineParameter("output.features.folder","folder to store the features",PARAMETER_TYPE_FOLDER,true);
 	defineParameter("output.alignment.folder","folder to store the alignment",PARAMETER_TYPE_FOLDER,true);
+	defineParameter("output.profile.file","file to store the decoding profile of each utterance (JSON lines)",
+		PARAMETER_TYPE_FILE,true);
 }
 
 // load the configuration parameters
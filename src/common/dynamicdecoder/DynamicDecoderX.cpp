@@ -19,7 +19,10 @@
 
 #include "DynamicDecoderX.h"
 
+#include "AcousticLookAhead.h"
+#include "BeamController.h"
 #include "BestPath.h"
+#include "FrameSkipper.h"
 #include "LMFSM.h"
 #include "HMMManager.h"
 #include "LMManager.h"
@@ -49,6 +52,7 @@ DynamicDecoderX::DynamicDecoderX(PhoneSet *phoneSet, HMMManager *hmmManager,
 	// network properties
 	m_arcs = m_dynamicNetwork->getArcs(&m_iArcs);
 	m_nodes = m_dynamicNetwork->getNodes(&m_iNodes);
+	m_nodeStates = NULL;
 	
 	m_iTimeCurrent = -1;
 	
@@ -59,6 +63,14 @@ DynamicDecoderX::DynamicDecoderX(PhoneSet *phoneSet, HMMManager *hmmManager,
 	m_fBeamWidthNodes = fBeamWidthNodes;	
 	m_fBeamWidthNodesWE = fBeamWidthNodesWE;	
 	m_fBeamWidthTokensNode = fBeamWidthTokensNode;
+	m_beamController = NULL;
+	m_fBeamRatioNodesWE = 1.0;
+	m_fBeamRatioTokensNode = 1.0;
+	m_frameSkipper = NULL;
+	m_iTimeEmission = -1;
+	m_emissionCache = NULL;
+	m_acousticLookAhead = NULL;
+	m_profile = NULL;
 		
 	// active nodes
 	m_nodesActiveCurrent = NULL;
@@ -70,14 +82,15 @@ DynamicDecoderX::DynamicDecoderX(PhoneSet *phoneSet, HMMManager *hmmManager,
 	m_iHistoryItemBegSentence = -1;
 	m_iHistoryItemAvailable = -1;
 	m_iTimeGarbageCollectionLast = -1;
+	m_iHistoryItemsYoung = NULL;
+	m_iHistoryItemsYoungSize = 0;
+	m_iHistoryItemsYoungLimit = 0;
+	m_iHistoryItemsFrozen = 0;
 	
 	// word-graph generation
 	m_bLatticeGeneration = bWordGraphGeneration;
 	m_iMaxWordSequencesState = iMaxWordSequencesState;
-	m_iWSHashBuckets = UINT_MAX;
-	m_iWSHashEntries = UINT_MAX;	
-	m_wshashEntries = NULL;
-	m_iWSHashEntryCollisionAvailable = -1;
+	m_wordSequenceTrie = NULL;
 	
 	// wrod-graph tokens
 	m_iWGTokens = 0;
@@ -102,6 +115,9 @@ void DynamicDecoderX::initialize() {
 	// max tokens per active arc
 	m_iTokensNodeMax = m_iMaxActiveTokensNode*2;
 
+	// search state of the network nodes
+	m_nodeStates = new DNodeState[m_iNodes];
+	
 	// allocate memory for the tables of active arcs
 	m_iNodesActiveCurrentMax = m_iMaxActiveNodes*5;
 	m_iNodesActiveNextMax = m_iMaxActiveNodes*5;	
@@ -123,6 +139,7 @@ void DynamicDecoderX::initialize() {
 	// history item management (there exists garbage collection for history items)
 	m_iHistoryItems = 10000;
 	m_historyItems = new HistoryItem[m_iHistoryItems];
+	m_iHistoryItemsYoung = new int[m_iHistoryItems];
 	m_iHistoryItemsAuxBuffer = new int[m_iTokensNodeMax];
 	m_iHistoryItemsAux = NULL;
 	m_iHistoryItemsAuxSize = -1;
@@ -133,15 +150,8 @@ void DynamicDecoderX::initialize() {
 		
 	// word-graph generation
 	if (m_bLatticeGeneration) {
-		// allocate memory for the hash table
-		m_iWSHashBuckets = 100000;
-		m_iWSHashEntries = 2*m_iWSHashBuckets;
-		m_wshashEntries = new WSHashEntry[m_iWSHashEntries];
-		// set all the entries to "old"
-		for(unsigned int i=0 ; i < m_iWSHashEntries ; ++i) {
-			m_wshashEntries[i].iTime = -1;	
-		}	
-		m_iWSHashEntryCollisionAvailable = m_iWSHashBuckets;
+		// unique word sequences (grows as needed)
+		m_wordSequenceTrie = new WordSequenceTrie();
 		
 		// word-graph token management (there exists garbage collection for wg-tokens)
 		m_iWGTokens = 5000*m_iMaxWordSequencesState;
@@ -164,6 +174,7 @@ void DynamicDecoderX::uninitialize() {
 	
 	assert(m_bInitialized);
 	
+	delete [] m_nodeStates;
 	delete [] m_nodesActiveCurrent;
 	delete [] m_nodesActiveNext;
 	delete [] m_tokensCurrent;
@@ -171,11 +182,12 @@ void DynamicDecoderX::uninitialize() {
 	delete [] m_activeTokenCurrent;
 	delete [] m_activeTokenNext;
 	delete [] m_historyItems;
+	delete [] m_iHistoryItemsYoung;
 	delete [] m_iHistoryItemsAuxBuffer;
 	delete m_lmLookAhead;
 	// word-graph generation?
 	if (m_bLatticeGeneration) {
-		delete [] m_wshashEntries;
+		delete m_wordSequenceTrie;
 		delete [] m_wgTokens;
 		delete [] m_iWordSequenceAux;
 	}
@@ -190,10 +202,10 @@ void DynamicDecoderX::beginUtterance() {
 
 	// mark all the nodes as inactive
 	for(int i=0 ; i < m_iNodes; ++i) {
-		m_nodes[i].iActiveTokensCurrent = 0;
-		m_nodes[i].iActiveTokensCurrentBase = -1;
-		m_nodes[i].iActiveTokensNext = 0;
-		m_nodes[i].iActiveTokensNextBase = -1;
+		m_nodeStates[i].iActiveTokensCurrent = 0;
+		m_nodeStates[i].iActiveTokensCurrentBase = -1;
+		m_nodeStates[i].iActiveTokensNext = 0;
+		m_nodeStates[i].iActiveTokensNextBase = -1;
 	}
 	
 	// reset history items
@@ -206,6 +218,31 @@ void DynamicDecoderX::beginUtterance() {
 	m_iHistoryItemAvailable = 0;
 	m_iTimeGarbageCollectionLast = -1;	
 	m_iHistoryItemBegSentence = -1;
+	m_iHistoryItemsYoungSize = 0;
+	m_iHistoryItemsYoungLimit = min((int)m_iHistoryItems,HISTORY_ITEMS_GENERATION_MIN);
+	m_iHistoryItemsFrozen = 0;
+	
+	// the adaptive beam carries over from the previous utterance
+	if (m_beamController) {
+		m_beamController->beginUtterance();
+		setBeamWidths(m_beamController->getBeam());
+	}
+	
+	if (m_frameSkipper) {
+		m_frameSkipper->beginUtterance();
+	}
+	
+	if (m_emissionCache) {
+		m_emissionCache->beginUtterance();
+	}
+	
+	if (m_acousticLookAhead) {
+		m_acousticLookAhead->beginUtterance();
+	}
+	
+	if (m_profile) {
+		m_profile->reset();
+	}
 	
 	// active tokens
 	m_iActiveTokenTables = 0;
@@ -220,7 +257,10 @@ void DynamicDecoderX::beginUtterance() {
 	// utterance information
 	m_iFeatureVectorsUtterance = 0;
 	
-	m_hmmManager->resetHMMEmissionProbabilityComputation();
+	// the emission cache does not use the time-stamps of the HMM-states (they might be shared)
+	if (m_emissionCache == NULL) {
+		m_hmmManager->resetHMMEmissionProbabilityComputation();
+	}
 	
 	// lattice generation
 	if (m_bLatticeGeneration) {
@@ -234,24 +274,20 @@ void DynamicDecoderX::beginUtterance() {
 		m_wgTokens[m_iWGTokens-m_iMaxWordSequencesState].iPrev = -1;
 		m_iWGTokenAvailable = 0;	
 		
-		// set all the entries as "old" (hash table of word-sequences)
-		for(unsigned int i=0 ; i < m_iWSHashEntries ; ++i) {
-			m_wshashEntries[i].iTime = -1;	
-		}	
-		m_iWSHashEntryCollisionAvailable = m_iWSHashBuckets;
+		// remove the word sequences of the previous utterance
+		m_wordSequenceTrie->reset();
 	}	
 }
 		
 // end utterance
 void DynamicDecoderX::endUtterance() {
 
-	if (m_bLatticeGeneration) {
-		for(unsigned int i=0 ; i < m_iWSHashEntries ; ++i) {
-			if (m_wshashEntries[i].iTime != -1) {
-				assert(m_wshashEntries[i].iLexUnit);
-				delete [] m_wshashEntries[i].iLexUnit;
-			}
-		}
+	if (m_beamController) {
+		m_beamController->endUtterance();
+	}
+	
+	if (m_frameSkipper) {
+		m_frameSkipper->endUtterance();
 	}
 
 	assert(m_bInitialized);
@@ -267,11 +303,27 @@ void DynamicDecoderX::process(MatrixBase<float> &mFeatures) {
 	
 	double dTimeBegin = TimeUtils::getTimeMilliseconds();
 	
+	BVC_PROFILE_SCOPE(m_profile);
+	BVC_PROFILE_TIMER_BEGIN(iCyclesDecoding);
+	BVC_PROFILE_COUNT(PROFILE_COUNTER_FRAMES,mFeatures.getRows());
+	
+	// the whole chunk is available to compute emission probabilities ahead of time
+	if (m_emissionCache) {
+		m_emissionCache->setFeatures(mFeatures,m_iFeatureVectorsUtterance);
+	}
+	if (m_acousticLookAhead) {
+		m_acousticLookAhead->setFeatures(mFeatures,m_iFeatureVectorsUtterance);
+	}
+	
 	unsigned int t = 0;
 	if (m_iFeatureVectorsUtterance == 0) {
 		m_iTimeCurrent = 0;
 		// root node expansion	
 		VectorStatic<float> vFeatureVector = mFeatures.getRow(0);
+		m_iTimeEmission = 0;
+		if (m_frameSkipper) {
+			m_frameSkipper->select(vFeatureVector.getData(),m_iTimeCurrent,&m_iTimeEmission);
+		}
 		expandRoot(vFeatureVector);
 		// output search status
 		BVC_VERB << "t= " << setw(5) << m_iTimeCurrent << " nodes= " << setw(6) << m_iNodesActiveCurrent << 
@@ -284,11 +336,27 @@ void DynamicDecoderX::process(MatrixBase<float> &mFeatures) {
 	for( ; t < mFeatures.getRows() ; ++t, ++m_iTimeCurrent) {	
 	
 		// prune active nodes/tokens
+		BVC_PROFILE_TIMER_BEGIN(iCyclesPruning);
 		pruning();
+		BVC_PROFILE_TIMER_END(PROFILE_TIMER_PRUNING,iCyclesPruning);
+		BVC_PROFILE_COUNT(PROFILE_COUNTER_ARCS_ACTIVE,m_iNodesActiveCurrent);
+		
+		// adapt the beams to the amount of search that survived pruning
+		if (m_beamController) {
+			setBeamWidths(m_beamController->update(m_iNodesActiveCurrent));
+		}
 		
 		// next frame expansion
 		VectorStatic<float> vFeatureVector = mFeatures.getRow(t);
-		expand(vFeatureVector,m_iTimeCurrent);	
+		float *fFeatureVector = vFeatureVector.getData();
+		m_iTimeEmission = m_iTimeCurrent;
+		if (m_frameSkipper) {
+			fFeatureVector = m_frameSkipper->select(fFeatureVector,m_iTimeCurrent,&m_iTimeEmission);
+		}
+		VectorStatic<float> vFeatureVectorEmission(fFeatureVector,mFeatures.getCols());
+		BVC_PROFILE_TIMER_BEGIN(iCyclesExpansion);
+		expand(vFeatureVectorEmission,m_iTimeCurrent);	
+		BVC_PROFILE_TIMER_END(PROFILE_TIMER_EXPANSION,iCyclesExpansion);
 		
 		// output search status
 		if (m_iTimeCurrent % 100 == 0) {
@@ -301,6 +369,8 @@ void DynamicDecoderX::process(MatrixBase<float> &mFeatures) {
 	
 	m_iFeatureVectorsUtterance += mFeatures.getRows();	
 	
+	BVC_PROFILE_TIMER_END(PROFILE_TIMER_DECODING,iCyclesDecoding);
+	
 	double dTimeEnd = TimeUtils::getTimeMilliseconds();
 	double dTimeSeconds = (dTimeEnd-dTimeBegin)/1000.0;
 	
@@ -325,6 +395,7 @@ void DynamicDecoderX::expandRoot(VectorBase<float> &vFeatureVector) {
 	historyItemBegSentence->iPrev = -1;
 	historyItemBegSentence->iActive = -1;
 	historyItemBegSentence->iWGToken = -1;	
+	historyItemBegSentence->iWordSequence = -1;
 	
 	// expand the root node
 	DArc *arcEnd = m_arcs+(nodeRoot+1)->iArcNext;
@@ -332,14 +403,25 @@ void DynamicDecoderX::expandRoot(VectorBase<float> &vFeatureVector) {
 		assert(arc->iType == ARC_TYPE_HMM);
 		
 		DNode *nodeDest = m_nodes+arc->iNodeDest;
+		DNodeState *nodeStateDest = m_nodeStates+arc->iNodeDest;
 			
-		// compute emission probability
-		fScore = arc->state->computeEmissionProbability(vFeatureVector.getData(),0);	
-		
 		// apply insertion-penalty
-		fScore += m_dynamicNetwork->getIP((m_nodes+arc->iNodeDest)->iIPIndex);	
+		fScore = m_dynamicNetwork->getIP((m_nodes+arc->iNodeDest)->iIPIndex);	
+		
+		// acoustic look-ahead (only used to decide whether the arc is activated), the emission probability 
+		// is only computed for arcs that pass the beam with the look-ahead score
+		float fScoreLA = 0.0;
+		if (m_acousticLookAhead) {
+			fScoreLA = m_acousticLookAhead->getScore(arc->state->getPhone(),0);
+			if (fScore+fScoreLA <= m_fScoreBest-m_fBeamWidthNodes) {
+				continue;
+			}
+		}
 		
-		if (fScore > m_fScoreBest-m_fBeamWidthNodes) {
+		// compute emission probability
+		fScore += computeEmissionProbability(arc->state,vFeatureVector.getData(),0);	
+		
+		if (fScore+fScoreLA > m_fScoreBest-m_fBeamWidthNodes) {
 		
 			if (fScore > m_fScoreBest) {
 				m_fScoreBest = fScore;
@@ -370,11 +452,11 @@ void DynamicDecoderX::expandRoot(VectorBase<float> &vFeatureVector) {
 			}
 			
 			// activate the token
-			assert(nodeDest->iActiveTokensNextBase == -1);
-			nodeDest->iActiveTokensNextBase = newActiveTokenTable();
-			(m_activeTokenNext+nodeDest->iActiveTokensNextBase)[0].iLMState = token->iLMState;
-			(m_activeTokenNext+nodeDest->iActiveTokensNextBase)[0].iToken = iToken;
-			nodeDest->iActiveTokensNext = 1;	
+			assert(nodeStateDest->iActiveTokensNextBase == -1);
+			nodeStateDest->iActiveTokensNextBase = newActiveTokenTable();
+			(m_activeTokenNext+nodeStateDest->iActiveTokensNextBase)[0].iLMState = token->iLMState;
+			(m_activeTokenNext+nodeStateDest->iActiveTokensNextBase)[0].iToken = iToken;
+			nodeStateDest->iActiveTokensNext = 1;	
 			m_nodesActiveNext[m_iNodesActiveNext++] = nodeDest;
 			assert(m_iNodesActiveNext < m_iNodesActiveNextMax);
 		}
@@ -396,13 +478,14 @@ void DynamicDecoderX::expand(VectorBase<float> &vFeatureVector, int t) {
 	for(int l=0 ; l < m_iNodesActiveCurrent ; ++l) {
 		
 		DNode *node = m_nodesActiveCurrent[l];
-		ActiveToken *activeTokensCurrent = m_activeTokenCurrent+node->iActiveTokensCurrentBase;
+		DNodeState *nodeState = getNodeState(node);
+		ActiveToken *activeTokensCurrent = m_activeTokenCurrent+nodeState->iActiveTokensCurrentBase;
 		HMMStateDecoding *state = (m_tokensCurrent+activeTokensCurrent[0].iToken)->state;
 		
 		// (1) self loop (the hmm-state is in the token)
 		
 		// compute emission probability
-		fScore = state->computeEmissionProbability(vFeatureVector.getData(),t);	
+		fScore = computeEmissionProbability(state,vFeatureVector.getData(),m_iTimeEmission);	
 	
 		// regular-node
 		float *fScoreBest = &m_fScoreBest;
@@ -414,7 +497,7 @@ void DynamicDecoderX::expand(VectorBase<float> &vFeatureVector, int t) {
 		}*/	
 		
 		// propagate tokens within the arc
-		for(int i=0 ; i < node->iActiveTokensCurrent ; ++i) {	
+		for(int i=0 ; i < nodeState->iActiveTokensCurrent ; ++i) {	
 		
 			Token *token = m_tokensCurrent+(activeTokensCurrent+i)->iToken;
 			fScoreToken = token->fScore+fScore;
@@ -447,16 +530,16 @@ void DynamicDecoderX::expand(VectorBase<float> &vFeatureVector, int t) {
 				}
 				
 				// activate the arc
-				if (node->iActiveTokensNextBase == -1) {
-					node->iActiveTokensNextBase = newActiveTokenTable();
-					node->iActiveTokensNext = 0;
+				if (nodeState->iActiveTokensNextBase == -1) {
+					nodeState->iActiveTokensNextBase = newActiveTokenTable();
+					nodeState->iActiveTokensNext = 0;
 					m_nodesActiveNext[m_iNodesActiveNext++] = node;
 					assert(m_iNodesActiveNext < m_iNodesActiveNextMax);
 				}
-				(m_activeTokenNext+node->iActiveTokensNextBase)[node->iActiveTokensNext].iLMState = token->iLMState;
-				(m_activeTokenNext+node->iActiveTokensNextBase)[node->iActiveTokensNext].iToken = iToken;
-				node->iActiveTokensNext++;
-				assert(node->iActiveTokensNext < m_iTokensNodeMax);
+				(m_activeTokenNext+nodeState->iActiveTokensNextBase)[nodeState->iActiveTokensNext].iLMState = token->iLMState;
+				(m_activeTokenNext+nodeState->iActiveTokensNextBase)[nodeState->iActiveTokensNext].iToken = iToken;
+				nodeState->iActiveTokensNext++;
+				assert(nodeState->iActiveTokensNext < m_iTokensNodeMax);
 			}
 		}
 	}
@@ -465,18 +548,19 @@ void DynamicDecoderX::expand(VectorBase<float> &vFeatureVector, int t) {
 	for(int i=0 ; i < m_iNodesActiveCurrent ; ++i) {
 	
 		DNode *node = m_nodesActiveCurrent[i];
+		DNodeState *nodeState = getNodeState(node);
 		
 		// word-end? if so, get ready to extend word history
 		m_iHistoryItemsAux = NULL;
 		if (node->bWordEnd) {
-			m_iHistoryItemsAuxSize = node->iActiveTokensCurrent;
-			assert(node->iActiveTokensCurrent < m_iTokensNodeMax);
+			m_iHistoryItemsAuxSize = nodeState->iActiveTokensCurrent;
+			assert(nodeState->iActiveTokensCurrent < m_iTokensNodeMax);
 			m_iHistoryItemsAux = m_iHistoryItemsAuxBuffer;
-			for(int j=0 ; j < node->iActiveTokensCurrent ; ++j) {
+			for(int j=0 ; j < nodeState->iActiveTokensCurrent ; ++j) {
 				m_iHistoryItemsAux[j] = -1;
 			}
 			if (m_bLatticeGeneration) {
-				for(int j=0 ; j < node->iActiveTokensCurrent ; ++j) {
+				for(int j=0 ; j < nodeState->iActiveTokensCurrent ; ++j) {
 					m_iWordSequenceAux[j] = -1;
 				}
 			}
@@ -493,8 +577,8 @@ void DynamicDecoderX::expand(VectorBase<float> &vFeatureVector, int t) {
 			else if (arcNext->iType == ARC_TYPE_WORD) {	
 			
 				// lm-transition
-				LMTransition *lmTransition = new LMTransition[node->iActiveTokensCurrent];
-				for(int j=0 ; j < node->iActiveTokensCurrent ; ++j) {
+				LMTransition *lmTransition = new LMTransition[nodeState->iActiveTokensCurrent];
+				for(int j=0 ; j < nodeState->iActiveTokensCurrent ; ++j) {
 					lmTransition[j].iLMState = -1;
 				}	
 							
@@ -522,11 +606,11 @@ void DynamicDecoderX::expand(VectorBase<float> &vFeatureVector, int t) {
 				
 				// there can be multiple words (homophones) getting to a starting node
 				if (node->bWordEnd) {
-					for(int j=0 ; j < node->iActiveTokensCurrent ; ++j) {
+					for(int j=0 ; j < nodeState->iActiveTokensCurrent ; ++j) {
 						m_iHistoryItemsAux[j] = -1;
 					}
 					if (m_bLatticeGeneration) {
-						for(int j=0 ; j < node->iActiveTokensCurrent ; ++j) {
+						for(int j=0 ; j < nodeState->iActiveTokensCurrent ; ++j) {
 							m_iWordSequenceAux[j] = -1;
 						}
 					}
@@ -551,8 +635,8 @@ void DynamicDecoderX::expand(VectorBase<float> &vFeatureVector, int t) {
 						assert(arcNext2->iType == ARC_TYPE_WORD);	
 						
 						// lm-transition
-						LMTransition *lmTransition = new LMTransition[node->iActiveTokensCurrent];
-						for(int j=0 ; j < node->iActiveTokensCurrent ; ++j) {
+						LMTransition *lmTransition = new LMTransition[nodeState->iActiveTokensCurrent];
+						for(int j=0 ; j < nodeState->iActiveTokensCurrent ; ++j) {
 							lmTransition[j].iLMState = -1;
 						}	
 						
@@ -580,11 +664,11 @@ void DynamicDecoderX::expand(VectorBase<float> &vFeatureVector, int t) {
 						
 						// there can be multiple words (homophones) getting to a starting node
 						if (node->bWordEnd) {
-							for(int j=0 ; j < node->iActiveTokensCurrent ; ++j) {
+							for(int j=0 ; j < nodeState->iActiveTokensCurrent ; ++j) {
 								m_iHistoryItemsAux[j] = -1;
 							}
 							if (m_bLatticeGeneration) {
-								for(int j=0 ; j < node->iActiveTokensCurrent ; ++j) {
+								for(int j=0 ; j < nodeState->iActiveTokensCurrent ; ++j) {
 									m_iWordSequenceAux[j] = -1;
 								}
 							}
@@ -596,22 +680,24 @@ void DynamicDecoderX::expand(VectorBase<float> &vFeatureVector, int t) {
 			}
 		}
 		
-		node->iActiveTokensCurrent = 0;
-		node->iActiveTokensCurrentBase = -1;
+		nodeState->iActiveTokensCurrent = 0;
+		nodeState->iActiveTokensCurrentBase = -1;
 	}
 }
 
 // expand a series of tokens to a hmm-state
 void DynamicDecoderX::expandToHMM(DNode *node, DArc *arcNext, VectorBase<float> &vFeatureVector, int t) {
 
+	DNodeState *nodeState = getNodeState(node);
 	float fScore;
 	float fScoreToken;
-	ActiveToken *activeTokensCurrent = m_activeTokenCurrent+node->iActiveTokensCurrentBase;
+	ActiveToken *activeTokensCurrent = m_activeTokenCurrent+nodeState->iActiveTokensCurrentBase;
 	DNode *nodeNext = m_nodes+arcNext->iNodeDest;
-	ActiveToken *activeTokensNext = m_activeTokenNext+nodeNext->iActiveTokensNextBase;
+	DNodeState *nodeStateNext = m_nodeStates+arcNext->iNodeDest;
+	ActiveToken *activeTokensNext = m_activeTokenNext+nodeStateNext->iActiveTokensNextBase;
 
 	// compute emission probability
-	fScore = arcNext->state->computeEmissionProbability(vFeatureVector.getData(),t);	
+	fScore = computeEmissionProbability(arcNext->state,vFeatureVector.getData(),m_iTimeEmission);	
 
 	bool bWordEnd = (nodeNext->iIPIndex != -1);
 
@@ -630,7 +716,8 @@ void DynamicDecoderX::expandToHMM(DNode *node, DArc *arcNext, VectorBase<float>
 	}*/
 	
 	// propagate tokens within the arc
-	for(int j=0 ; j < node->iActiveTokensCurrent ; ++j) {
+	BVC_PROFILE_COUNT(PROFILE_COUNTER_TOKENS_EXPANDED,nodeState->iActiveTokensCurrent);
+	for(int j=0 ; j < nodeState->iActiveTokensCurrent ; ++j) {
 	
 		Token *token = m_tokensCurrent+(activeTokensCurrent+j)->iToken;
 		fScoreToken = token->fScore+fScore;
@@ -650,7 +737,7 @@ void DynamicDecoderX::expandToHMM(DNode *node, DArc *arcNext, VectorBase<float>
 			
 			// token recombination?
 			bool bFound = false;
-			for(int k=0 ; k < nodeNext->iActiveTokensNext ; ++k) {
+			for(int k=0 ; k < nodeStateNext->iActiveTokensNext ; ++k) {
 				if (activeTokensNext[k].iLMState == token->iLMState) {
 					Token *tokenRec = m_tokensNext+activeTokensNext[k].iToken;
 					// no lattice-generation
@@ -784,20 +871,20 @@ void DynamicDecoderX::expandToHMM(DNode *node, DArc *arcNext, VectorBase<float>
 			}
 			
 			// activate the node
-			if (nodeNext->iActiveTokensNextBase == -1) {
-				nodeNext->iActiveTokensNextBase = newActiveTokenTable();
-				nodeNext->iActiveTokensNext = 0;
-				activeTokensNext = m_activeTokenNext+nodeNext->iActiveTokensNextBase;
+			if (nodeStateNext->iActiveTokensNextBase == -1) {
+				nodeStateNext->iActiveTokensNextBase = newActiveTokenTable();
+				nodeStateNext->iActiveTokensNext = 0;
+				activeTokensNext = m_activeTokenNext+nodeStateNext->iActiveTokensNextBase;
 				m_nodesActiveNext[m_iNodesActiveNext++] = nodeNext;	
 				assert(m_iNodesActiveNext < m_iNodesActiveNextMax);
 			}
-			activeTokensNext[nodeNext->iActiveTokensNext].iLMState = token->iLMState;
-			activeTokensNext[nodeNext->iActiveTokensNext].iToken = iToken;
-			nodeNext->iActiveTokensNext++;
-			if (nodeNext->iActiveTokensNext >= m_iTokensNodeMax) {
+			activeTokensNext[nodeStateNext->iActiveTokensNext].iLMState = token->iLMState;
+			activeTokensNext[nodeStateNext->iActiveTokensNext].iToken = iToken;
+			nodeStateNext->iActiveTokensNext++;
+			if (nodeStateNext->iActiveTokensNext >= m_iTokensNodeMax) {
 				pruneExtraTokens(nodeNext);
 			}
-			assert(nodeNext->iActiveTokensNext < m_iTokensNodeMax);
+			assert(nodeStateNext->iActiveTokensNext < m_iTokensNodeMax);
 		}
 	}
 }
@@ -806,21 +893,21 @@ void DynamicDecoderX::expandToHMM(DNode *node, DArc *arcNext, VectorBase<float>
 void DynamicDecoderX::expandToHMMNewWord(DNode *node, DArc *arcNext, LexUnit *lexUnit, LMTransition *lmTransition, 
 	VectorBase<float> &vFeatureVector, int t) {
 
-	float fScore;
+	DNodeState *nodeState = getNodeState(node);
+	float fScore = 0.0;
 	float fScoreLM;
 	float fScoreToken;
-	ActiveToken *activeTokensCurrent = m_activeTokenCurrent+node->iActiveTokensCurrentBase;
+	ActiveToken *activeTokensCurrent = m_activeTokenCurrent+nodeState->iActiveTokensCurrentBase;
 	DNode *nodeNext = m_nodes+arcNext->iNodeDest;
-	ActiveToken *activeTokensNext = m_activeTokenNext+nodeNext->iActiveTokensNextBase;
-	
-	// compute emission probability
-	fScore = arcNext->state->computeEmissionProbability(vFeatureVector.getData(),t);	
+	DNodeState *nodeStateNext = m_nodeStates+arcNext->iNodeDest;
+	ActiveToken *activeTokensNext = m_activeTokenNext+nodeStateNext->iActiveTokensNextBase;
 
 	bool bWordEnd = (nodeNext->iIPIndex != -1);
 
 	// apply insertion-penalty?
+	float fScoreIP = 0.0;
 	if (bWordEnd) {
-		fScore += m_dynamicNetwork->getIP(m_nodes[arcNext->iNodeDest].iIPIndex);
+		fScoreIP = m_dynamicNetwork->getIP(m_nodes[arcNext->iNodeDest].iIPIndex);
 	}
 
 	// regular-arc
@@ -831,9 +918,21 @@ void DynamicDecoderX::expandToHMMNewWord(DNode *node, DArc *arcNext, LexUnit *le
 		//fScoreBest = &m_fScoreBestWE;
 		//fBeamWidth = m_fBeamWidthNodesWE;
 	}
+	
+	// acoustic look-ahead (only used to decide whether the arc is activated), when it is used the emission 
+	// probability is only computed once a token passes the beam with the look-ahead score
+	float fScoreLA = 0.0;
+	bool bEmission = false;
+	if (m_acousticLookAhead) {
+		fScoreLA = m_acousticLookAhead->getScore(arcNext->state->getPhone(),t);
+	} else {
+		fScore = computeEmissionProbability(arcNext->state,vFeatureVector.getData(),m_iTimeEmission)+fScoreIP;
+		bEmission = true;
+	}
 
 	// propagate tokens within the node
-	for(int j=0 ; j < node->iActiveTokensCurrent ; ++j) {
+	BVC_PROFILE_COUNT(PROFILE_COUNTER_TOKENS_EXPANDED,nodeState->iActiveTokensCurrent);
+	for(int j=0 ; j < nodeState->iActiveTokensCurrent ; ++j) {
 	
 		Token *token = m_tokensCurrent+activeTokensCurrent[j].iToken;
 		int iLMState = -1;
@@ -855,8 +954,18 @@ void DynamicDecoderX::expandToHMMNewWord(DNode *node, DArc *arcNext, LexUnit *le
 			fScoreLM = 0.0;
 		}
 		
+		// acoustic look-ahead pruning
+		if (bEmission == false) {
+			if (token->fScore+fScoreIP+fScoreLM+fScoreLA <= (*fScoreBest-fBeamWidth)) {
+				continue;
+			}
+			// compute emission probability
+			fScore = computeEmissionProbability(arcNext->state,vFeatureVector.getData(),m_iTimeEmission)+fScoreIP;
+			bEmission = true;
+		}
+		
 		fScoreToken = token->fScore+fScore+fScoreLM;
-		if (fScoreToken > (*fScoreBest-fBeamWidth)) {
+		if (fScoreToken+fScoreLA > (*fScoreBest-fBeamWidth)) {
 		
 			// keep higher score
 			if (fScoreToken > *fScoreBest) {
@@ -865,7 +974,7 @@ void DynamicDecoderX::expandToHMMNewWord(DNode *node, DArc *arcNext, LexUnit *le
 			
 			// token recombination?
 			bool bFound = false;
-			for(int k=0 ; k < nodeNext->iActiveTokensNext ; ++k) {
+			for(int k=0 ; k < nodeStateNext->iActiveTokensNext ; ++k) {
 				if (activeTokensNext[k].iLMState == iLMState) {
 					Token *tokenRec = m_tokensNext+activeTokensNext[k].iToken;
 					assert(tokenRec->state == arcNext->state);
@@ -1013,21 +1122,21 @@ void DynamicDecoderX::expandToHMMNewWord(DNode *node, DArc *arcNext, LexUnit *le
 			}
 				
 			// activate the node
-			if (nodeNext->iActiveTokensNextBase == -1) {
-				assert(nodeNext->iActiveTokensNext == 0);
-				nodeNext->iActiveTokensNextBase = newActiveTokenTable();
-				nodeNext->iActiveTokensNext = 0;
-				activeTokensNext = m_activeTokenNext+nodeNext->iActiveTokensNextBase;
+			if (nodeStateNext->iActiveTokensNextBase == -1) {
+				assert(nodeStateNext->iActiveTokensNext == 0);
+				nodeStateNext->iActiveTokensNextBase = newActiveTokenTable();
+				nodeStateNext->iActiveTokensNext = 0;
+				activeTokensNext = m_activeTokenNext+nodeStateNext->iActiveTokensNextBase;
 				m_nodesActiveNext[m_iNodesActiveNext++] = nodeNext;
 				assert(m_iNodesActiveNext < m_iNodesActiveNextMax);
 			}
-			activeTokensNext[nodeNext->iActiveTokensNext].iLMState = iLMState;
-			activeTokensNext[nodeNext->iActiveTokensNext].iToken = iToken;
-			nodeNext->iActiveTokensNext++;
-			if (nodeNext->iActiveTokensNext >= m_iTokensNodeMax) {
+			activeTokensNext[nodeStateNext->iActiveTokensNext].iLMState = iLMState;
+			activeTokensNext[nodeStateNext->iActiveTokensNext].iToken = iToken;
+			nodeStateNext->iActiveTokensNext++;
+			if (nodeStateNext->iActiveTokensNext >= m_iTokensNodeMax) {
 				pruneExtraTokens(nodeNext);
 			}	
-			assert(nodeNext->iActiveTokensNext < m_iTokensNodeMax);
+			assert(nodeStateNext->iActiveTokensNext < m_iTokensNodeMax);
 		}
 	}
 }
@@ -1056,10 +1165,11 @@ void DynamicDecoderX::pruningOriginal() {
 	int iWillSurviveRegular = 0;
 	int iWillSurviveWE = 0;
 	for(int i=0 ; i < m_iNodesActiveNext ; ++i) {
+		DNodeState *nodeState = getNodeState(m_nodesActiveNext[i]);
 		// get the best score
-		assert(m_nodesActiveNext[i]->iActiveTokensNext > 0);
-		for(int j=0 ; j < m_nodesActiveNext[i]->iActiveTokensNext ; ++j) {
-			Token *token = m_tokensNext+(m_activeTokenNext+m_nodesActiveNext[i]->iActiveTokensNextBase)[j].iToken;
+		assert(nodeState->iActiveTokensNext > 0);
+		for(int j=0 ; j < nodeState->iActiveTokensNext ; ++j) {
+			Token *token = m_tokensNext+(m_activeTokenNext+nodeState->iActiveTokensNextBase)[j].iToken;
 			if (token->fScore > fScoreBestNode[i]) {
 				fScoreBestNode[i] = token->fScore;
 			}
@@ -1099,10 +1209,11 @@ void DynamicDecoderX::pruningOriginal() {
 		float fAuxRegular = ((float)iNumberBins)/fLengthRegular;
 		float fAuxWE = ((float)iNumberBins)/fLengthWE;
 		for(int i=0 ; i < m_iNodesActiveNext ; ++i) {
+			DNodeState *nodeState = getNodeState(m_nodesActiveNext[i]);
 			// WE-arc
 			if (m_nodesActiveNext[i]->bWordEnd) {	
-				for(int j=0 ; j < m_nodesActiveNext[i]->iActiveTokensNext ; ++j) {
-					Token *token = m_tokensNext+(m_activeTokenNext+m_nodesActiveNext[i]->iActiveTokensNextBase)[j].iToken;
+				for(int j=0 ; j < nodeState->iActiveTokensNext ; ++j) {
+					Token *token = m_tokensNext+(m_activeTokenNext+nodeState->iActiveTokensNextBase)[j].iToken;
 					if (token->fScore <= fThresholdWE) {
 						continue;
 					}	
@@ -1114,8 +1225,8 @@ void DynamicDecoderX::pruningOriginal() {
 			}
 			// regular arc
 			else {
-				for(int j=0 ; j < m_nodesActiveNext[i]->iActiveTokensNext ; ++j) {
-					Token *token = m_tokensNext+(m_activeTokenNext+m_nodesActiveNext[i]->iActiveTokensNextBase)[j].iToken;
+				for(int j=0 ; j < nodeState->iActiveTokensNext ; ++j) {
+					Token *token = m_tokensNext+(m_activeTokenNext+nodeState->iActiveTokensNextBase)[j].iToken;
 					if (token->fScore <= fThresholdRegular) {
 						continue;
 					}	
@@ -1201,7 +1312,8 @@ void DynamicDecoderX::pruningOriginal() {
 	for(int i=0 ; i < m_iNodesActiveNext ; ++i) {	
 	
 		DNode *node = m_nodesActiveNext[i];
-		assert(node->iActiveTokensNext > 0);
+		DNodeState *nodeState = getNodeState(node);
+		assert(nodeState->iActiveTokensNext > 0);
 		
 		/*if (arc->bWordEnd == false) {
 			fThresholdArc = max(fThresholdRegular,fScoreBestNode[i]-m_fBeamWidthTokensArc);		
@@ -1267,8 +1379,8 @@ void DynamicDecoderX::pruningOriginal() {
 		// actual within-arc token pruning
 		int iPruned = 0;
 		int iAvailable = -1;
-		ActiveToken *activeTokensNext = m_activeTokenNext+node->iActiveTokensNextBase;
-		for(int j=0 ; j < node->iActiveTokensNext ; ++j) {
+		ActiveToken *activeTokensNext = m_activeTokenNext+nodeState->iActiveTokensNextBase;
+		for(int j=0 ; j < nodeState->iActiveTokensNext ; ++j) {
 			Token *token = m_tokensNext+activeTokensNext[j].iToken;
 			if (token->fScore < fThresholdArc) {	
 				if (iAvailable == -1) {
@@ -1281,18 +1393,18 @@ void DynamicDecoderX::pruningOriginal() {
 			}
 		}
 		iPrunedTotal += iPruned;
-		assert(node->iActiveTokensCurrentBase == -1);
-		assert(node->iActiveTokensCurrent == 0);
-		int iSurvivors = node->iActiveTokensNext-iPruned;
+		assert(nodeState->iActiveTokensCurrentBase == -1);
+		assert(nodeState->iActiveTokensCurrent == 0);
+		int iSurvivors = nodeState->iActiveTokensNext-iPruned;
 		//iSurvivorsH[iSurvivors]++;
 		if (iSurvivors > 0) {
-			assert(node->iActiveTokensNextBase != -1);
-			node->iActiveTokensCurrentBase = node->iActiveTokensNextBase;
-			node->iActiveTokensCurrent = iSurvivors;
+			assert(nodeState->iActiveTokensNextBase != -1);
+			nodeState->iActiveTokensCurrentBase = nodeState->iActiveTokensNextBase;
+			nodeState->iActiveTokensCurrent = iSurvivors;
 			m_nodesActiveCurrent[m_iNodesActiveCurrent++] = node;
 		}
-		node->iActiveTokensNextBase = -1;
-		node->iActiveTokensNext = 0;
+		nodeState->iActiveTokensNextBase = -1;
+		nodeState->iActiveTokensNext = 0;
 	}
 	
 	/*int iAcc = 0;
@@ -1341,16 +1453,17 @@ void DynamicDecoderX::pruning() {
 	for(int i=0 ; i < m_iNodesActiveNext ; ++i) {
 	
 		DNode *node = m_nodesActiveNext[i];
-		assert(node->iActiveTokensNext > 0);
+		DNodeState *nodeState = getNodeState(node);
+		assert(nodeState->iActiveTokensNext > 0);
 		fThresholdNode[i] = fThresholdRegular;
 		
 		// (a) histogram pruning within the node
-		if (node->iActiveTokensNext > m_iMaxActiveTokensNode) {
+		if (nodeState->iActiveTokensNext > m_iMaxActiveTokensNode) {
 		
 			// get the best score within the node
 			fScoreBestNode = -FLT_MAX;
-			for(int j=0 ; j < node->iActiveTokensNext ; ++j) {
-				Token *token = m_tokensNext+(m_activeTokenNext+node->iActiveTokensNextBase)[j].iToken;
+			for(int j=0 ; j < nodeState->iActiveTokensNext ; ++j) {
+				Token *token = m_tokensNext+(m_activeTokenNext+nodeState->iActiveTokensNextBase)[j].iToken;
 				if (token->fScore > fScoreBestNode) {
 					fScoreBestNode = token->fScore;
 				}
@@ -1368,8 +1481,8 @@ void DynamicDecoderX::pruning() {
 				iBins[j] = 0;
 			}
 			// (2.2) fill the bins, the first bin keeps the best tokens
-			ActiveToken *activeTokensNext = m_activeTokenNext+node->iActiveTokensNextBase;
-			for(int j=0 ; j < node->iActiveTokensNext ; ++j) {
+			ActiveToken *activeTokensNext = m_activeTokenNext+nodeState->iActiveTokensNextBase;
+			for(int j=0 ; j < nodeState->iActiveTokensNext ; ++j) {
 				Token *token = m_tokensNext+activeTokensNext[j].iToken;
 				if (token->fScore > fThresholdNode[i]) {
 					iBin = (int)(fabs(token->fScore-fScoreBestNode)/fBinSize);
@@ -1391,7 +1504,7 @@ void DynamicDecoderX::pruning() {
 			}
 			fThresholdNode[i] = max(fThresholdNode[i],fThresholdHistogram);
 		} else {
-			iSurvivorsAll += node->iActiveTokensNext;
+			iSurvivorsAll += nodeState->iActiveTokensNext;
 		}
 	}
 	
@@ -1413,8 +1526,9 @@ void DynamicDecoderX::pruning() {
 		int iBin;
 		
 		for(int i=0 ; i < m_iNodesActiveNext ; ++i) {
-			ActiveToken *activeTokens = m_activeTokenNext+m_nodesActiveNext[i]->iActiveTokensNextBase;
-			for(int j=0 ; j < m_nodesActiveNext[i]->iActiveTokensNext ; ++j) {
+			DNodeState *nodeState = getNodeState(m_nodesActiveNext[i]);
+			ActiveToken *activeTokens = m_activeTokenNext+nodeState->iActiveTokensNextBase;
+			for(int j=0 ; j < nodeState->iActiveTokensNext ; ++j) {
 				Token *token = m_tokensNext+activeTokens[j].iToken;
 				if (token->fScore <= fThresholdNode[i]) {
 					continue;
@@ -1444,12 +1558,13 @@ void DynamicDecoderX::pruning() {
 	for(int i=0 ; i < m_iNodesActiveNext ; ++i) {
 	
 		DNode *node = m_nodesActiveNext[i];
+		DNodeState *nodeState = getNodeState(node);
 		fThresholdNode[i] = max(fThresholdNode[i],fThresholdRegular);	
 		
 		int iPruned = 0;
 		int iAvailable = -1;
-		ActiveToken *activeTokensNext = m_activeTokenNext+node->iActiveTokensNextBase;
-		for(int j=0 ; j < node->iActiveTokensNext ; ++j) {
+		ActiveToken *activeTokensNext = m_activeTokenNext+nodeState->iActiveTokensNextBase;
+		for(int j=0 ; j < nodeState->iActiveTokensNext ; ++j) {
 			Token *token = m_tokensNext+activeTokensNext[j].iToken;
 			if (token->fScore < fThresholdNode[i]) {
 				if (iAvailable == -1) {
@@ -1462,18 +1577,18 @@ void DynamicDecoderX::pruning() {
 			}
 		}
 		iPrunedTotal += iPruned;
-		assert(node->iActiveTokensCurrentBase == -1);
-		assert(node->iActiveTokensCurrent == 0);
-		int iSurvivors = node->iActiveTokensNext-iPruned;
+		assert(nodeState->iActiveTokensCurrentBase == -1);
+		assert(nodeState->iActiveTokensCurrent == 0);
+		int iSurvivors = nodeState->iActiveTokensNext-iPruned;
 		//iSurvivorsH[iSurvivors]++;
 		if (iSurvivors > 0) {
-			assert(node->iActiveTokensNextBase != -1);
-			node->iActiveTokensCurrentBase = node->iActiveTokensNextBase;
-			node->iActiveTokensCurrent = iSurvivors;
+			assert(nodeState->iActiveTokensNextBase != -1);
+			nodeState->iActiveTokensCurrentBase = nodeState->iActiveTokensNextBase;
+			nodeState->iActiveTokensCurrent = iSurvivors;
 			m_nodesActiveCurrent[m_iNodesActiveCurrent++] = node;
 		}
-		node->iActiveTokensNextBase = -1;
-		node->iActiveTokensNext = 0;
+		nodeState->iActiveTokensNextBase = -1;
+		nodeState->iActiveTokensNext = 0;
 	}
 	
 	delete [] iBins;
@@ -1481,6 +1596,8 @@ void DynamicDecoderX::pruning() {
 	
 	//printf("# tokens active: (%d -> %d)\n",m_iTokensNext,m_iTokensNext-iPrunedTotal);
 	
+	BVC_PROFILE_COUNT(PROFILE_COUNTER_TOKENS_PRUNED,iPrunedTotal);
+	
 	// clean the table of next active states
 	m_iNodesActiveNext = 0;	
 	
@@ -1637,128 +1754,189 @@ void DynamicDecoderX::getDestinationMonophoneLexUnits(DNode *node, VLexUnit &vLe
 	}
 }
 
-// garbage collection of history items
-// (1) it starts by marking the active items by traversing back items from the active states
-// (2) it adds inactive items to the queue of available items
+// garbage collection of history items (incremental)
+// (1) it marks the young items that are active by traversing back items from the active states
+// (2) items shared by all the active paths are frozen, they will be in the best path so they are not visited again
+// (3) inactive young items are added to the queue of available items
+// note: collections are triggered after a fixed number of allocations (the young generation), so the cost of 
+// each collection depends on the number of active paths and not on the length of the utterance
 void DynamicDecoderX::historyItemGarbageCollection() {
 
+	BVC_PROFILE_TIMER_BEGIN(iCycles);
+	BVC_PROFILE_COUNT(PROFILE_COUNTER_GC_RUNS,1);
+
 	int iItemsActive = 0;
 	
 	// (1) check if garbage collection was already run within the current time frame
-	// note: this is an undesirable situation because it requires an extra pass over the complete array of items
-	// it should be avoided by allocating a larger number of entries from the beginning
 	if (m_iTimeGarbageCollectionLast == m_iTimeCurrent) {
-		// mark all the history items as inactive
-		for(unsigned int i=0 ; i < m_iHistoryItems ; ++i) {
-			m_historyItems[i].iActive = -1;
+		// mark the young items as inactive (frozen items keep their mark)
+		for(int i=0 ; i < m_iHistoryItemsYoungSize ; ++i) {
+			m_historyItems[m_iHistoryItemsYoung[i]].iActive = -1;
 		}	
 	}	
 	
 	// (2) mark items coming from active arcs as active
+	int iHistoryItemCommon = -2;
 	// (2.1) active arcs for current time frame
 	for(int i=0 ; i < m_iNodesActiveCurrent ; ++i) {
-		ActiveToken *activeTokens = m_activeTokenCurrent+m_nodesActiveCurrent[i]->iActiveTokensCurrentBase;
-		for(int j=0 ; j < m_nodesActiveCurrent[i]->iActiveTokensCurrent ; ++j) {
-			Token *token = m_tokensCurrent+activeTokens[j].iToken;
-			int iHistoryItem = token->iHistoryItem;	
-			while((iHistoryItem != -1) && ((m_historyItems+iHistoryItem)->iActive != m_iTimeCurrent)) {
-				(m_historyItems+iHistoryItem)->iActive = m_iTimeCurrent;	
-				iHistoryItem = (m_historyItems+iHistoryItem)->iPrev;
-				++iItemsActive;
-			}
+		DNodeState *nodeState = getNodeState(m_nodesActiveCurrent[i]);
+		ActiveToken *activeTokens = m_activeTokenCurrent+nodeState->iActiveTokensCurrentBase;
+		for(int j=0 ; j < nodeState->iActiveTokensCurrent ; ++j) {
+			markHistoryItems((m_tokensCurrent+activeTokens[j].iToken)->iHistoryItem,iItemsActive,iHistoryItemCommon);
 		}
 	}	
 	// (2.2) active arcs for next time frame
-	// TODO: it would be faster to traverse the array of next tokens, but this should not be too bad
 	for(int i=0 ; i < m_iNodesActiveNext ; ++i) {
-		ActiveToken *activeTokens = m_activeTokenNext+m_nodesActiveNext[i]->iActiveTokensNextBase;
-		for(int j=0 ; j < m_nodesActiveNext[i]->iActiveTokensNext ; ++j) {
-			Token *token = m_tokensNext+activeTokens[j].iToken;
-			int iHistoryItem = token->iHistoryItem;	
-			while((iHistoryItem != -1) && ((m_historyItems+iHistoryItem)->iActive != m_iTimeCurrent)) {
-				(m_historyItems+iHistoryItem)->iActive = m_iTimeCurrent;	
-				iHistoryItem = (m_historyItems+iHistoryItem)->iPrev;
-				++iItemsActive;
-			}
+		DNodeState *nodeState = getNodeState(m_nodesActiveNext[i]);
+		ActiveToken *activeTokens = m_activeTokenNext+nodeState->iActiveTokensNextBase;
+		for(int j=0 ; j < nodeState->iActiveTokensNext ; ++j) {
+			markHistoryItems((m_tokensNext+activeTokens[j].iToken)->iHistoryItem,iItemsActive,iHistoryItemCommon);
 		}
 	}
 	// check also auxiliar arrays for history items in use
 	if (m_iHistoryItemsAux != NULL) {
 		for(int i=0 ; i < m_iHistoryItemsAuxSize ; ++i) {
 			if (m_iHistoryItemsAux[i] != -1) {
-				if ((m_historyItems+m_iHistoryItemsAux[i])->iActive != m_iTimeCurrent) {	
-					(m_historyItems+m_iHistoryItemsAux[i])->iActive = m_iTimeCurrent;
-					++iItemsActive;
-				}
+				markHistoryItems(m_iHistoryItemsAux[i],iItemsActive,iHistoryItemCommon);
 			}
 		}	
 	}
 	
-	// (3) if a certain percentage* of the items are active then we need to allocate 
-	// a bigger data structure to keep the new history items
-	// (* if we wait until all the items are active there will be many calls to the garbage collector
-	// when the array of reach a high occupation, that would introduce substantial overhead)
-	assert(iItemsActive <= (int)m_iHistoryItems);
-	if (iItemsActive >= (0.20*m_iHistoryItems)) {
+	// (3) freeze the items shared by all the active paths
+	for(int i = iHistoryItemCommon ; (i >= 0) && (m_historyItems[i].iActive != HISTORY_ITEM_FROZEN) ; 
+		i = m_historyItems[i].iPrev) {
+		m_historyItems[i].iActive = HISTORY_ITEM_FROZEN;
+		++m_iHistoryItemsFrozen;
+		--iItemsActive;
+	}
+	
+	// (4) inactive young items are made available, active ones are kept as young items
+	int iYoung = 0;
+	for(int i=0 ; i < m_iHistoryItemsYoungSize ; ++i) {
+		HistoryItem *historyItem = m_historyItems+m_iHistoryItemsYoung[i];
+		if (historyItem->iActive == m_iTimeCurrent) {
+			m_iHistoryItemsYoung[iYoung++] = m_iHistoryItemsYoung[i];
+		} else if (historyItem->iActive != HISTORY_ITEM_FROZEN) {
+			historyItem->iActive = -1;
+			historyItem->iEndFrame = -1;
+			historyItem->iPrev = m_iHistoryItemAvailable;
+			m_iHistoryItemAvailable = m_iHistoryItemsYoung[i];
+		}
+	}
+	BVC_PROFILE_COUNT(PROFILE_COUNTER_GC_ITEMS_SWEPT,m_iHistoryItemsYoungSize-iYoung);
+	m_iHistoryItemsYoungSize = iYoung;
+	assert(m_iHistoryItemsYoungSize == iItemsActive);
+	
+	// (5) size the next generation so collections are not frequent compared to the number of active items 
+	// and make sure there are enough available items for it 
+	m_iHistoryItemsYoungLimit = max(HISTORY_ITEMS_GENERATION_MIN,5*iItemsActive);
+	int iAvailable = m_iHistoryItems-m_iHistoryItemsFrozen-m_iHistoryItemsYoungSize;
+	if (iAvailable < m_iHistoryItemsYoungLimit-m_iHistoryItemsYoungSize) {
+		growHistoryItems(m_iHistoryItemsYoungLimit-m_iHistoryItemsYoungSize);
+	}
+	
+	m_iTimeGarbageCollectionLast = m_iTimeCurrent;
+	
+	BVC_PROFILE_TIMER_END(PROFILE_TIMER_GC,iCycles);
+}
 
-		//printf("history item garbage collection...\n");	
-		//printf("allocating space for new items (item sused: %d existing: %d)\n",iItemsActive,m_iHistoryItems);	
-		
-		// allocate a new data structure with double capacity
-		HistoryItem *historyItems = NULL;
-		try {
-			historyItems = new HistoryItem[m_iHistoryItems*2];
-		} 
-		catch (const std::bad_alloc&) {
-			int iBytes = m_iHistoryItems*2*sizeof(WGToken);
-			BVC_ERROR << "unable to allocate memory for history items, " << iBytes << " Bytes needed";
+// mark the history items in the path ending at the given item as active and update the most recent 
+// item shared by all the paths marked so far (-2: no paths marked yet, -1: paths only share frozen items)
+void DynamicDecoderX::markHistoryItems(int iHistoryItem, int &iItemsActive, int &iHistoryItemCommon) {
+
+	int iHistoryItemStart = iHistoryItem;
+	while((iHistoryItem != -1) && (m_historyItems[iHistoryItem].iActive != m_iTimeCurrent) && 
+		(m_historyItems[iHistoryItem].iActive != HISTORY_ITEM_FROZEN)) {
+		m_historyItems[iHistoryItem].iActive = m_iTimeCurrent;
+		iHistoryItem = m_historyItems[iHistoryItem].iPrev;
+		++iItemsActive;
+	}
+	
+	if (iHistoryItemCommon == -1) {
+		return;
+	}
+	
+	// the path reached the frozen prefix: only the first path marked can do so
+	if ((iHistoryItem == -1) || (m_historyItems[iHistoryItem].iActive == HISTORY_ITEM_FROZEN)) {
+		if ((iHistoryItemCommon == -2) && (iHistoryItem != iHistoryItemStart)) {
+			iHistoryItemCommon = iHistoryItemStart;
+		} else {
+			iHistoryItemCommon = -1;
 		}
-		
-		// copy the active items from the old data structure
-		for(unsigned int i=0 ; i < m_iHistoryItems ; ++i) {
-			historyItems[i].iLexUnitPron = m_historyItems[i].iLexUnitPron;
-			historyItems[i].iEndFrame = m_historyItems[i].iEndFrame;
-			historyItems[i].fScore = m_historyItems[i].fScore;
-			historyItems[i].iActive = m_iTimeCurrent;
-			historyItems[i].iWGToken = m_historyItems[i].iWGToken;
-			historyItems[i].iPrev = m_historyItems[i].iPrev;
+		return;
+	}
+	
+	// the path joined already marked items: find the most recent item shared with the common item
+	// (items in a path have strictly increasing ending frames)
+	int iHistoryItemAux = iHistoryItemCommon;
+	while(iHistoryItemAux != iHistoryItem) {
+		if ((m_historyItems[iHistoryItemAux].iActive == HISTORY_ITEM_FROZEN) || 
+			(m_historyItems[iHistoryItem].iActive == HISTORY_ITEM_FROZEN)) {
+			iHistoryItemCommon = -1;
+			return;
 		}
-		
-		// create the linked list of available items
-		for(unsigned int i=m_iHistoryItems ; i < (2*m_iHistoryItems)-1 ; ++i) {
-			historyItems[i].iPrev = i+1;
-			historyItems[i].iActive = -1;	
+		if (m_historyItems[iHistoryItemAux].iEndFrame > m_historyItems[iHistoryItem].iEndFrame) {
+			iHistoryItemAux = m_historyItems[iHistoryItemAux].iPrev;
+		} else {
+			iHistoryItem = m_historyItems[iHistoryItem].iPrev;
 		}
-		historyItems[(2*m_iHistoryItems)-1].iPrev = -1;
-		historyItems[(2*m_iHistoryItems)-1].iActive = -1;
-		
-		delete [] m_historyItems;
-		m_historyItems = historyItems;
-		m_iHistoryItemAvailable = m_iHistoryItems;
-		m_iHistoryItems *= 2;
-	}
-	// (3') there are inactive items: create a linked list with them
-	else {
-		int *iHistoryItemAux = &m_iHistoryItemAvailable;
-		for(unsigned int i = 0 ; i < m_iHistoryItems ; ++i) {
-			if (m_historyItems[i].iActive != m_iTimeCurrent) {
-				m_historyItems[i].iActive = -1;
-				m_historyItems[i].iEndFrame = -1;
-				*iHistoryItemAux = i;
-				iHistoryItemAux = &m_historyItems[i].iPrev;	
-			}
+		if ((iHistoryItemAux == -1) || (iHistoryItem == -1)) {
+			iHistoryItemCommon = -1;
+			return;
 		}
-		*iHistoryItemAux = -1;
+	}
+	iHistoryItemCommon = iHistoryItemAux;
+}
+
+// grow the array of history items so it has the given number of available items
+void DynamicDecoderX::growHistoryItems(int iAvailable) {
+
+	unsigned int iHistoryItems = m_iHistoryItems;
+	while((int)(iHistoryItems-m_iHistoryItems) < iAvailable) {
+		iHistoryItems *= 2;
 	}
 	
-	m_iTimeGarbageCollectionLast = m_iTimeCurrent;
+	// allocate a new data structure
+	HistoryItem *historyItems = NULL;
+	int *iHistoryItemsYoung = NULL;
+	try {
+		historyItems = new HistoryItem[iHistoryItems];
+		iHistoryItemsYoung = new int[iHistoryItems];
+	} 
+	catch (const std::bad_alloc&) {
+		int iBytes = iHistoryItems*(sizeof(HistoryItem)+sizeof(int));
+		BVC_ERROR << "unable to allocate memory for history items, " << iBytes << " Bytes needed";
+	}
+	
+	// copy the items from the old data structure
+	memcpy(historyItems,m_historyItems,m_iHistoryItems*sizeof(HistoryItem));
+	memcpy(iHistoryItemsYoung,m_iHistoryItemsYoung,m_iHistoryItemsYoungSize*sizeof(int));
+	
+	// append the new items to the linked list of available items
+	for(unsigned int i=m_iHistoryItems ; i < iHistoryItems-1 ; ++i) {
+		historyItems[i].iPrev = i+1;
+		historyItems[i].iActive = -1;	
+	}
+	historyItems[iHistoryItems-1].iPrev = m_iHistoryItemAvailable;
+	historyItems[iHistoryItems-1].iActive = -1;
 	
-	//printf("%d used %d total\n",iItemsActive,m_iHistoryItems);	
+	delete [] m_historyItems;
+	delete [] m_iHistoryItemsYoung;
+	m_historyItems = historyItems;
+	m_iHistoryItemsYoung = iHistoryItemsYoung;
+	m_iHistoryItemAvailable = m_iHistoryItems;
+	m_iHistoryItems = iHistoryItems;
 }
 		
 // marks unused history items as available (lattice generation)
+// note: items cannot be frozen since lattice paths merge, but the sweep and the trigger are the same as in the 
+// incremental collector: only items in use (all of them are young) are visited and collections happen once the 
+// young generation is full
 void DynamicDecoderX::historyItemGarbageCollectionLattice(bool bRecycleHistoryItems, bool bRecycleWGTokens) {
 
+	BVC_PROFILE_TIMER_BEGIN(iCycles);
+	BVC_PROFILE_COUNT(PROFILE_COUNTER_GC_RUNS,1);
+
 	unsigned int iItemsActive = 0;
 	unsigned int iTokensActive = 0;
 	assert(bRecycleHistoryItems != bRecycleWGTokens);
@@ -1766,12 +1944,12 @@ void DynamicDecoderX::historyItemGarbageCollectionLattice(bool bRecycleHistoryIt
 	//printf("doing garbage collection\n");
 	
 	// (0) check if garbage collection was already run within the current time frame
-	// note: this is an undesirable situation because it requires an extra pass over the complete array of items
+	// note: this is an undesirable situation because it requires an extra pass over the complete array of wg-tokens
 	// it should be avoided by allocating a larger number of entries from the beginning
 	if (m_iTimeGarbageCollectionLast == m_iTimeCurrent) {
-		// mark all the history items as inactive
-		for(unsigned int i=0 ; i < m_iHistoryItems ; ++i) {
-			m_historyItems[i].iActive = -1;
+		// mark the history items in use as inactive
+		for(int i=0 ; i < m_iHistoryItemsYoungSize ; ++i) {
+			m_historyItems[m_iHistoryItemsYoung[i]].iActive = -1;
 		}	
 		// mark all the word-graph tokens as inactive
 		for(unsigned int i=0 ; i < m_iWGTokens ; i += m_iMaxWordSequencesState) {
@@ -1791,8 +1969,9 @@ void DynamicDecoderX::historyItemGarbageCollectionLattice(bool bRecycleHistoryIt
 	// (1) mark items coming from active arcs as active
 	// (1.1) active arcs for current time frame
 	for(int i=0 ; i < m_iNodesActiveCurrent ; ++i) {
-		ActiveToken *activeTokens = m_activeTokenCurrent+m_nodesActiveCurrent[i]->iActiveTokensCurrentBase;
-		for(int j=0 ; j < m_nodesActiveCurrent[i]->iActiveTokensCurrent ; ++j) {
+		DNodeState *nodeState = getNodeState(m_nodesActiveCurrent[i]);
+		ActiveToken *activeTokens = m_activeTokenCurrent+nodeState->iActiveTokensCurrentBase;
+		for(int j=0 ; j < nodeState->iActiveTokensCurrent ; ++j) {
 			Token *token = m_tokensCurrent+activeTokens[j].iToken;
 			int iHistoryItem = token->iHistoryItem;	
 			while((iHistoryItem != -1) && ((m_historyItems+iHistoryItem)->iActive != m_iTimeCurrent)) {
@@ -1827,8 +2006,9 @@ void DynamicDecoderX::historyItemGarbageCollectionLattice(bool bRecycleHistoryIt
 	
 	// (1.1) active arcs for next time frame
 	for(int i=0 ; i < m_iNodesActiveNext ; ++i) {
-		ActiveToken *activeTokens = m_activeTokenNext+m_nodesActiveNext[i]->iActiveTokensNextBase;	
-		for(int j=0 ; j < m_nodesActiveNext[i]->iActiveTokensNext ; ++j) {
+		DNodeState *nodeState = getNodeState(m_nodesActiveNext[i]);
+		ActiveToken *activeTokens = m_activeTokenNext+nodeState->iActiveTokensNextBase;	
+		for(int j=0 ; j < nodeState->iActiveTokensNext ; ++j) {
 			Token *token = m_tokensNext+activeTokens[j].iToken;
 			int iHistoryItem = token->iHistoryItem;	
 			while((iHistoryItem != -1) && ((m_historyItems+iHistoryItem)->iActive != m_iTimeCurrent)) {
@@ -1926,62 +2106,28 @@ void DynamicDecoderX::historyItemGarbageCollectionLattice(bool bRecycleHistoryIt
 	//printf("# active wg-tokens: %d  %d #items: %d\n",iTokensActive,m_iTokensNext,iItemsActive);
 	
 	if (bRecycleHistoryItems) {
-		// (2) if a certain percentage* of the items are active then we need to allocate 
-		// a bigger data structure to keep the new history items
-		// (* otherwise if we wait until all the items are active there will be many calls to the garbage collector
-		// when the array reaches a high occupation, that would introduce substantial overhead)
-		assert(iItemsActive <= m_iHistoryItems);
-		if (iItemsActive >= (0.20*m_iHistoryItems)) {
-	
-			//printf("history item garbage collection...\n");	
-			//printf("allocating space for new items (item sused: %d existing: %d)\n",iItemsActive,m_iHistoryItems);	
-			
-			// allocate a new data structure with double capacity	
-			HistoryItem *historyItems = NULL;
-			try {
-				historyItems = new HistoryItem[m_iHistoryItems*2];
-			} 
-			catch (const std::bad_alloc&) {
-				int iBytes = m_iHistoryItems*2*sizeof(WGToken);
-				BVC_ERROR << "unable to allocate memory for history items, " << iBytes << " Bytes needed";
-			}		
-			
-			// copy the active items from the old data structure
-			for(unsigned int i=0 ; i < m_iHistoryItems ; ++i) {
-				historyItems[i].iLexUnitPron = m_historyItems[i].iLexUnitPron;
-				historyItems[i].iEndFrame = m_historyItems[i].iEndFrame;
-				historyItems[i].fScore = m_historyItems[i].fScore;
-				historyItems[i].iActive = m_iTimeCurrent;
-				historyItems[i].iWGToken = m_historyItems[i].iWGToken;
-				historyItems[i].iPrev = m_historyItems[i].iPrev;
-			}
-			
-			// create the linked list of available items
-			int iLastIndex = (2*m_iHistoryItems)-1;
-			for(int i=m_iHistoryItems ; i < iLastIndex ; ++i) {
-				historyItems[i].iPrev = i+1;
-				historyItems[i].iActive = -1;	
+		// (2) inactive young items are made available, active ones are kept as young items
+		int iYoung = 0;
+		for(int i=0 ; i < m_iHistoryItemsYoungSize ; ++i) {
+			HistoryItem *historyItem = m_historyItems+m_iHistoryItemsYoung[i];
+			if (historyItem->iActive == m_iTimeCurrent) {
+				m_iHistoryItemsYoung[iYoung++] = m_iHistoryItemsYoung[i];
+			} else {
+				historyItem->iActive = -1;
+				historyItem->iEndFrame = -1;
+				historyItem->iPrev = m_iHistoryItemAvailable;
+				m_iHistoryItemAvailable = m_iHistoryItemsYoung[i];
 			}
-			historyItems[iLastIndex].iPrev = -1;
-			historyItems[iLastIndex].iActive = -1;
-			
-			delete [] m_historyItems;
-			m_historyItems = historyItems;
-			m_iHistoryItemAvailable = m_iHistoryItems;
-			m_iHistoryItems *= 2;
 		}
-		// (2') there are inactive items: create a linked list with them
-		else {
-			int *iHistoryItemAux = &m_iHistoryItemAvailable;
-			for(unsigned int i = 0 ; i < m_iHistoryItems ; ++i) {
-				if (m_historyItems[i].iActive != m_iTimeCurrent) {
-					m_historyItems[i].iActive = -1;
-					m_historyItems[i].iEndFrame = -1;
-					*iHistoryItemAux = i;
-					iHistoryItemAux = &m_historyItems[i].iPrev;	
-				}
-			}
-			*iHistoryItemAux = -1;
+		BVC_PROFILE_COUNT(PROFILE_COUNTER_GC_ITEMS_SWEPT,m_iHistoryItemsYoungSize-iYoung);
+		m_iHistoryItemsYoungSize = iYoung;
+		
+		// (3) size the next generation so collections are not frequent compared to the number of active items 
+		// and make sure there are enough available items for it
+		m_iHistoryItemsYoungLimit = max(HISTORY_ITEMS_GENERATION_MIN,5*m_iHistoryItemsYoungSize);
+		int iAvailable = m_iHistoryItems-m_iHistoryItemsYoungSize;
+		if (iAvailable < m_iHistoryItemsYoungLimit-m_iHistoryItemsYoungSize) {
+			growHistoryItems(m_iHistoryItemsYoungLimit-m_iHistoryItemsYoungSize);
 		}
 	}
 	
@@ -2042,7 +2188,9 @@ void DynamicDecoderX::historyItemGarbageCollectionLattice(bool bRecycleHistoryIt
 	
 	m_iTimeGarbageCollectionLast = m_iTimeCurrent;
 	
-	//printf("%d used %d total\n",iItemsActive,m_iHistoryItems);	
+	//printf("%d used %d total\n",iItemsActive,m_iHistoryItems);
+	
+	BVC_PROFILE_TIMER_END(PROFILE_TIMER_GC,iCycles);
 }
 
 // build a hypothesis lattice for the utterance
@@ -2050,6 +2198,9 @@ HypothesisLattice *DynamicDecoderX::getHypothesisLattice() {
 
 	assert(m_bInitialized);
 	double dTimeBegin = TimeUtils::getTimeMilliseconds();
+	
+	BVC_PROFILE_SCOPE(m_profile);
+	BVC_PROFILE_TIMER_BEGIN(iCycles);
 		
 	float fScoreBest = -FLT_MAX;
 	float fScoreToken;
@@ -2264,6 +2415,9 @@ HypothesisLattice *DynamicDecoderX::getHypothesisLattice() {
  	hypothesisLattice->buildContainer(lnodeInitial,lnodeFinal);
  	//hypothesisLattice->attachLMProbabilities(m_lmManager);
  	
+ 	BVC_PROFILE_COUNT(PROFILE_COUNTER_LATTICE_EDGES,hypothesisLattice->getEdges());
+ 	BVC_PROFILE_TIMER_END(PROFILE_TIMER_LATTICE,iCycles);
+ 	
  	double dTimeEnd = TimeUtils::getTimeMilliseconds();
  	double dTime = (dTimeEnd-dTimeBegin)/1000.0;
  	
@@ -2302,6 +2456,8 @@ void DynamicDecoderX::keepBestHistoryItem(int iHistoryItem) {
 // 2) unique: this is linear too
 bool DynamicDecoderX::mergeWordSequences(int iWGToken1, int iWGToken2) {
 
+	BVC_PROFILE_COUNT(PROFILE_COUNTER_LATTICE_MERGES,1);
+
 	WGToken *wgTokenTable = NULL;
 	WGToken *wgToken1 = iWGToken1+m_wgTokens;
 	WGToken *wgToken2 = iWGToken2+m_wgTokens;
@@ -2396,62 +2552,21 @@ bool DynamicDecoderX::mergeWordSequences(int iWGToken1, int iWGToken2) {
 	return bReturn;
 }
 
-// compute the load factor of the hash table containing unque word sequences
-float DynamicDecoderX::computeLoadFactorHashWordSequences(int *iBucketsUsed, int *iCollisions) {
-
-	// count 
-	*iBucketsUsed = 0;
-	*iCollisions = 0;
-	for(unsigned int i=0 ; i < m_iWSHashEntries ; ++i) {
-		if (m_wshashEntries[i].iTime > -1) {
-			if (i < m_iWSHashBuckets) {
-				++(*iBucketsUsed);
-			} else {
-				++(*iCollisions);
-			}
-		}
-	}
-
-	// load factor
-	return ((float)(*iBucketsUsed))/((float)m_iWSHashBuckets);
-}
-
-// show hash-occupation information (debugging)
+// show hash-occupation information of the unique word sequences (debugging)
 void DynamicDecoderX::printHashsStats() {
 
-	int iBucketsUsed = 0;
-	int iCollisions = 0;
-	float fLoadFactor = computeLoadFactorHashWordSequences(&iBucketsUsed,&iCollisions);
-	
-	BVC_VERB << "- hash table containing word-sequences ---";
-	BVC_VERB << " # buckets:      " << setw(8) << m_iWSHashBuckets;
-	BVC_VERB << " # entries:      " << setw(8) << m_iWSHashEntries;
-	BVC_VERB << " # buckets used: " << setw(8) << iBucketsUsed << " (" << FLT(5,2) << 
-		100.0*((float)iBucketsUsed)/((float)m_iWSHashBuckets) << "%)";
-	BVC_VERB << " # collisions:   " << setw(8) << iCollisions << " (" << FLT(5,2) <<
-		100.0*((float)iCollisions)/((float)(iBucketsUsed+iCollisions)) << "%)";
-	BVC_VERB << " # elements:     " << setw(8) << iBucketsUsed+iCollisions;
-	BVC_VERB << " load factor:    " << FLT(8,4) << fLoadFactor;
-	BVC_VERB << "------------------------------------------";
+	m_wordSequenceTrie->printStats();
 }
 
-// print the hash-contents (debugging)
+// print the unique word sequences (debugging)
 void DynamicDecoderX::printHashContents() {
 
-	for(unsigned int i=0 ; i < m_iWSHashEntries ; ++i) {
-		WSHashEntry *entry = &m_wshashEntries[i];
-		if (entry->iTime != -1) {
-			BVC_VERB << "[BUCKET]";
-			do {
-				BVC_VERB << "entry:";
-				for(int j=0 ; j < entry->iLexUnits ; ++j) {
-					m_lexiconManager->print(m_lexiconManager->getLexUnit(entry->iLexUnit[j]));
-				}
-				if (entry->iNext == -1) {
-					break;
-				}
-				entry = m_wshashEntries+entry->iNext;
-			} while(1);
+	vector<int> vLexUnits;
+	for(int i=WORD_SEQUENCE_EMPTY+1 ; i < m_wordSequenceTrie->size() ; ++i) {
+		BVC_VERB << "word sequence: " << i;
+		m_wordSequenceTrie->getLexUnits(i,vLexUnits);
+		for(unsigned int j=0 ; j < vLexUnits.size() ; ++j) {
+			m_lexiconManager->print(m_lexiconManager->getLexUnit(vLexUnits[j]));
 		}
 	}
 }
@@ -2459,12 +2574,13 @@ void DynamicDecoderX::printHashContents() {
 // prune active tokens that are not in the top-N within a node 
 void DynamicDecoderX::pruneExtraTokens(DNode *node) {
 
-	assert(node->iActiveTokensNext >= m_iTokensNodeMax);
+	DNodeState *nodeState = getNodeState(node);
+	assert(nodeState->iActiveTokensNext >= m_iTokensNodeMax);
 
 	// get the best score within the node
 	float fScoreBestNode = -FLT_MAX;
-	for(int j=0 ; j < node->iActiveTokensNext ; ++j) {
-		Token *token = m_tokensNext+(m_activeTokenNext+node->iActiveTokensNextBase)[j].iToken;
+	for(int j=0 ; j < nodeState->iActiveTokensNext ; ++j) {
+		Token *token = m_tokensNext+(m_activeTokenNext+nodeState->iActiveTokensNextBase)[j].iToken;
 		if (token->fScore > fScoreBestNode) {
 			fScoreBestNode = token->fScore;
 		}
@@ -2485,8 +2601,8 @@ void DynamicDecoderX::pruneExtraTokens(DNode *node) {
 		iBins[j] = 0;
 	}
 	// fill the bins, the first bin keeps the best tokens
-	ActiveToken *activeTokensNext = m_activeTokenNext+node->iActiveTokensNextBase;
-	for(int j=0 ; j < node->iActiveTokensNext ; ++j) {
+	ActiveToken *activeTokensNext = m_activeTokenNext+nodeState->iActiveTokensNextBase;
+	for(int j=0 ; j < nodeState->iActiveTokensNext ; ++j) {
 		Token *token = m_tokensNext+activeTokensNext[j].iToken;
 		if (token->fScore >= fThresholdLikelihood) {
 			iBin = (int)(fabs(token->fScore-fScoreBestNode)/fBinSize);
@@ -2511,7 +2627,7 @@ void DynamicDecoderX::pruneExtraTokens(DNode *node) {
 	// actual pruning
 	int iPruned = 0;
 	int iAvailable = -1;
-	for(int j=0 ; j < node->iActiveTokensNext ; ++j) {
+	for(int j=0 ; j < nodeState->iActiveTokensNext ; ++j) {
 		Token *token = m_tokensNext+activeTokensNext[j].iToken;
 		if (token->fScore < fThresholdNode) {
 			if (iAvailable == -1) {
@@ -2524,16 +2640,16 @@ void DynamicDecoderX::pruneExtraTokens(DNode *node) {
 			++iAvailable;
 		}
 	}
-	node->iActiveTokensNext = node->iActiveTokensNext-iPruned;
+	nodeState->iActiveTokensNext = nodeState->iActiveTokensNext-iPruned;
 	
 	// this should never happen
-	if ((node->iActiveTokensNext >= m_iTokensNodeMax) || (node->iActiveTokensNext == 0)) {
+	if ((nodeState->iActiveTokensNext >= m_iTokensNodeMax) || (nodeState->iActiveTokensNext == 0)) {
 		for(int i=0 ; i < iNumberBins ; ++i) {
 			BVC_VERB << setw(3) << i << " -> " << setw(4) << iBins[i];
 		}
 	}
 	
-	assert(node->iActiveTokensNext < m_iTokensNodeMax);
+	assert(nodeState->iActiveTokensNext < m_iTokensNodeMax);
 
 	delete [] iBins;
 }
@@ -2545,8 +2661,9 @@ void DynamicDecoderX::getActiveLMStates(map<int,bool> &mLMState) {
 
 	// (1) active arcs for current time frame
 	for(int i=0 ; i < m_iNodesActiveCurrent ; ++i) {
-		ActiveToken *activeTokens = m_activeTokenCurrent+m_nodesActiveCurrent[i]->iActiveTokensCurrentBase;
-		for(int j=0 ; j < m_nodesActiveCurrent[i]->iActiveTokensCurrent ; ++j) {
+		DNodeState *nodeState = getNodeState(m_nodesActiveCurrent[i]);
+		ActiveToken *activeTokens = m_activeTokenCurrent+nodeState->iActiveTokensCurrentBase;
+		for(int j=0 ; j < nodeState->iActiveTokensCurrent ; ++j) {
 			Token *token = m_tokensCurrent+activeTokens[j].iToken;
 			if (token->iLANode != -1) {
 				assert(token->iLMState != -1);
@@ -2556,8 +2673,9 @@ void DynamicDecoderX::getActiveLMStates(map<int,bool> &mLMState) {
 	}	
 	// (2) active arcs for next time frame
 	for(int i=0 ; i < m_iNodesActiveNext ; ++i) {
-		ActiveToken *activeTokens = m_activeTokenNext+m_nodesActiveNext[i]->iActiveTokensNextBase;
-		for(int j=0 ; j < m_nodesActiveNext[i]->iActiveTokensNext ; ++j) {
+		DNodeState *nodeState = getNodeState(m_nodesActiveNext[i]);
+		ActiveToken *activeTokens = m_activeTokenNext+nodeState->iActiveTokensNextBase;
+		for(int j=0 ; j < nodeState->iActiveTokensNext ; ++j) {
 			Token *token = m_tokensNext+activeTokens[j].iToken;
 			if (token->iLANode != -1) {
 				assert(token->iLMState != -1);
@@ -2567,5 +2685,17 @@ void DynamicDecoderX::getActiveLMStates(map<int,bool> &mLMState) {
 	}
 }
 
+// set the controller that adapts the beams after each frame (NULL for fixed beams)
+void DynamicDecoderX::setBeamController(BeamController *beamController) {
+
+	// keep the ratios of the configured beams
+	if (m_beamController == NULL) {
+		assert(m_fBeamWidthNodes > 0.0);
+		m_fBeamRatioNodesWE = m_fBeamWidthNodesWE/m_fBeamWidthNodes;
+		m_fBeamRatioTokensNode = m_fBeamWidthTokensNode/m_fBeamWidthNodes;
+	}
+	m_beamController = beamController;
+}
+
 };	// end-of-namespace
 
@@ -21,12 +21,18 @@
 #define DYNAMICDECODERX_H
 
 #include "DynamicNetworkX.h"
+#include "EmissionCache.h"
 #include "HypothesisLattice.h"
 #include "LexiconManager.h"
+#include "PerformanceProfile.h"
+#include "WordSequenceTrie.h"
 
 namespace Bavieca {
 
+class AcousticLookAhead;
+class BeamController;
 class BestPath;
+class FrameSkipper;
 class HMMManager;
 class PhoneSet;
 class LMLookAhead;
@@ -36,20 +42,16 @@ class LMManager;
 #define NUMBER_BINS_HISTOGRAM							50
 #define NUMBER_BINS_HISTOGRAM_WITHIN_NODE			100
 
+// history item garbage collection
+#define HISTORY_ITEM_FROZEN								INT_MAX	// item in the common prefix of all active paths
+#define HISTORY_ITEMS_GENERATION_MIN					5000		// minimum # items allocated between collections
+
 // language model transition (auxiliar structure)
 typedef struct {
 	int iLMState;				// next lm-state
 	float fScoreLM;			// associated score
 } LMTransition;
 
-// entry in the hash table that keeps unique word sequences (lattice generation)
-typedef struct _WSHashEntry {
-	int iTime;					// time frame of last insertion (-1 initially)
-	int iLexUnits;				// number of lexical units in the word sequence
-	int *iLexUnit;				// lexical units in the word-sequence
-	int iNext;					// next table entry (to handle collisions)
-} WSHashEntry;
-
 // structure to keep the lexical unit history
 typedef struct _HistoryItem {
    int iLexUnitPron;			// lexical unit (including alternative pronunciations)
@@ -58,6 +60,7 @@ typedef struct _HistoryItem {
    int iPrev;					// previous history item
    int iActive;				// last time the item was active (part of an active token's history) (garbage collection)
    int iWGToken;				// best N paths that arrive at this word history item (each of them has a backpointer)
+   int iWordSequence;		// word sequence ending at this item (lattice generation, -1 if not computed yet)
 } HistoryItem;
 
 typedef vector<HistoryItem*> VHistoryItem;
@@ -100,6 +103,14 @@ typedef struct {
 	int iToken;							// active token
 } ActiveToken;
 
+// token activation fields of a network node (indexed by node)
+typedef struct {
+	int iActiveTokensCurrent;				// # active tokens
+	int iActiveTokensCurrentBase;			// array of active tokens (current time frame)
+	int iActiveTokensNext;					// # active tokens
+	int iActiveTokensNextBase;				// array of active tokens (next time frame)	
+} DNodeState;
+
 /**
 	@author daniel <dani.bolanos@gmail.com>
 */
@@ -121,6 +132,9 @@ class DynamicDecoderX {
 		int m_iNodes;
 		DNode *m_nodes;
 		
+		// search state of each network node (the network is shared, read-only)
+		DNodeState *m_nodeStates;
+		
 		// pruning parameters
 		int m_iMaxActiveNodes;				// maximum number of active arcs
 		int m_iMaxActiveNodesWE;			// maximum number of active arcs at word-ends
@@ -129,6 +143,24 @@ class DynamicDecoderX {
 		float m_fBeamWidthNodesWE;			// beam width for all arcs at word-ends
 		float m_fBeamWidthTokensNode;		// beam width for all tokens within an arc
 		
+		// adaptive beam (the word-end and within-arc beams keep their ratio to the arc beam)
+		BeamController *m_beamController;
+		float m_fBeamRatioNodesWE;
+		float m_fBeamRatioTokensNode;
+		
+		// frame skipping (emission probabilities of skipped frames are those of the last evaluated frame)
+		FrameSkipper *m_frameSkipper;
+		int m_iTimeEmission;					// time-stamp used to evaluate emission probabilities
+		
+		// emission probabilities computed ahead of time for a window of frames (NULL if disabled)
+		EmissionCache *m_emissionCache;
+		
+		// acoustic look-ahead used to decide whether word-initial arcs are activated (NULL if disabled)
+		AcousticLookAhead *m_acousticLookAhead;
+		
+		// performance counters and timers of the current utterance (NULL if disabled)
+		PerformanceProfile *m_profile;
+		
 		// scaling factor
 		float m_fLMScalingFactor;
 		
@@ -167,6 +199,12 @@ class DynamicDecoderX {
 		int m_iHistoryItemBegSentence;				// initial history item
 		int m_iHistoryItemAvailable;					//	next history item available to be used
 		int m_iTimeGarbageCollectionLast;			// last time frame the garbage collection was run
+		// incremental garbage collection: items in the common prefix of all active paths are frozen and never 
+		// visited again, only items allocated since the last frozen prefix (young items) are collected
+		int *m_iHistoryItemsYoung;						// young items in use
+		int m_iHistoryItemsYoungSize;					// # young items in use
+		int m_iHistoryItemsYoungLimit;				// # young items that triggers the next collection
+		int m_iHistoryItemsFrozen;						// # frozen items
 		// auxiliar arrays (used for token expansion)
 		int *m_iHistoryItemsAuxBuffer;
 		int *m_iHistoryItemsAux;
@@ -184,11 +222,8 @@ class DynamicDecoderX {
 		int m_iWGTokenAvailable;
 		int *m_iWordSequenceAux;
 				
-		// hash table for hashing word sequences
-		unsigned int m_iWSHashBuckets;		// # buckets in the hash table
-		unsigned int m_iWSHashEntries;		//	# entries in the hash table (#entries = #buckets + #unique word sequences)
-		WSHashEntry *m_wshashEntries;							// hash table
-		int m_iWSHashEntryCollisionAvailable;		// next available entry in the hash table to store collisions
+		// unique word sequences (lattice generation)
+		WordSequenceTrie *m_wordSequenceTrie;
 		
 		// utterance information
 		int m_iFeatureVectorsUtterance;	
@@ -199,6 +234,20 @@ class DynamicDecoderX {
 		// language model look-ahead
 		LMLookAhead *m_lmLookAhead;
 		
+		// return the search state of the given node
+		inline DNodeState *getNodeState(DNode *node) {
+		
+			return m_nodeStates+(node-m_nodes);
+		}
+		
+		// set the arc beam, the word-end and within-arc beams are scaled accordingly
+		inline void setBeamWidths(float fBeamWidthNodes) {
+		
+			m_fBeamWidthNodes = fBeamWidthNodes;
+			m_fBeamWidthNodesWE = fBeamWidthNodes*m_fBeamRatioNodesWE;
+			m_fBeamWidthTokensNode = fBeamWidthNodes*m_fBeamRatioTokensNode;
+		}
+		
 		// create a new token
 		inline int newToken() {	
 		
@@ -220,18 +269,21 @@ class DynamicDecoderX {
 		// return an unused history item
 		inline int newHistoryItem() {
 		
-			if (m_iHistoryItemAvailable == -1) {
+			// collect once the young generation is full so pauses do not grow with the utterance
+			if ((m_iHistoryItemAvailable == -1) || (m_iHistoryItemsYoungSize == m_iHistoryItemsYoungLimit)) {
 				if (m_bLatticeGeneration == false) {
 					historyItemGarbageCollection();
 				} else {
 					historyItemGarbageCollectionLattice(true,false);
 				}
-				assert(m_iHistoryItemAvailable != -1);
 			}
+			assert(m_iHistoryItemAvailable != -1);
 			
 			int iReturn = m_iHistoryItemAvailable;
 			m_historyItems[m_iHistoryItemAvailable].iWGToken = -1;
+			m_historyItems[m_iHistoryItemAvailable].iWordSequence = -1;
 			m_iHistoryItemAvailable = m_historyItems[m_iHistoryItemAvailable].iPrev; 
+			m_iHistoryItemsYoung[m_iHistoryItemsYoungSize++] = iReturn;
 		
 			return iReturn;
 		}
@@ -272,6 +324,16 @@ class DynamicDecoderX {
 		// regular expansion
 		void expand(VectorBase<float> &vFeatureVector, int t);
 		
+		// return the emission probability of the HMM-state (from the emission cache if enabled)
+		inline float computeEmissionProbability(HMMStateDecoding *state, float *fFeatures, int iTime) {
+		
+			if (m_emissionCache) {
+				return m_emissionCache->computeEmissionProbability(state,fFeatures,iTime);
+			}
+			
+			return state->computeEmissionProbability(fFeatures,iTime);
+		}
+		
 		// expand a series of tokens to a hmm-state
 		void expandToHMM(DNode *node, DArc *arcNext, VectorBase<float> &vFeatureVector, int t);
 		
@@ -287,6 +349,13 @@ class DynamicDecoderX {
 		
 		// marks unused history items as available
 		void historyItemGarbageCollection();
+		
+		// mark the history items in the path ending at the given item as active and update the most recent 
+		// item shared by all the paths marked so far
+		void markHistoryItems(int iHistoryItem, int &iItemsActive, int &iHistoryItemCommon);
+		
+		// grow the array of history items so it has the given number of available items
+		void growHistoryItems(int iAvailable);
 				
 		// marks unused history items as available (lattice generation)
 		void historyItemGarbageCollectionLattice(bool bRecycleHistoryItems, bool bRecycleWGTokens);
@@ -392,94 +461,35 @@ class DynamicDecoderX {
 			m_iWGTokenAvailable = iWGToken;
 		}		
 		
-		// hash a word sequence and returns a pointer to the bucket
+		// return the word sequence (interned) of a history item
+		// - ignores silence/filler symbols
+		// - ignores alternative pronunciations
+		// (only the prefix is cached, the item itself can be temporarily re-linked to another predecessor)
 		inline int hashWordSequence(HistoryItem *historyItem) {
 		
 			assert(historyItem);
-		
-			// apply the hash function and get the bucket (xor is commutative)
-			int i = 0;
-			int iAux;
-			int iEntry = 0;
-			HistoryItem *historyItemAux = historyItem;
-			do {
-				LexUnit *lexUnit = m_lexiconManager->getLexUnitPron(historyItemAux->iLexUnitPron);
-				iAux = lexUnit->iLexUnit;
-				// ignore silence and filler lexical units
-				if (lexUnit->iType == LEX_UNIT_TYPE_STANDARD) {
-					iAux <<= 8*i;
-					iEntry ^= iAux;
-					++i;
-					i %= sizeof(int);
-				}
-				if (historyItemAux->iPrev == -1) {
-					break;
-				}
-				historyItemAux = m_historyItems+historyItemAux->iPrev;
-			} while(1);
-			iEntry %= m_iWSHashBuckets;	
-			WSHashEntry &entry = m_wshashEntries[iEntry];
 			
-			// old entry
-			if (entry.iTime == -1) {
-				entry.iTime = m_iTimeCurrent;
-				entry.iNext = -1;
-				storeWordSequence(&entry,historyItem);
-				return iEntry;
-			} 
-			// hit
-			else if (compareWordSequencesStandard(&entry,historyItem)) {
-				return iEntry;
-			} 
-			// collision
-			else {
-				// collision: try to find a hit and otherwise append a new entry to the bucket
-				int *iEntryAux = &entry.iNext;
-				while(*iEntryAux != -1) {
-					// hit
-					if (compareWordSequencesStandard(m_wshashEntries+(*iEntryAux),historyItem)) {	
-						assert(*iEntryAux >= 0);
-						assert(*iEntryAux < (int)m_iWSHashEntries);
-						return *iEntryAux;
-					}
-					iEntryAux = &(m_wshashEntries+(*iEntryAux))->iNext;
-				}
-				
-				// the word sequence was not found, create it as a collision
-				*iEntryAux = m_iWSHashEntryCollisionAvailable;
-				assert(*iEntryAux != (int)m_iWSHashEntries);
-				(m_wshashEntries+(*iEntryAux))->iTime = m_iTimeCurrent;
-				storeWordSequence(m_wshashEntries+(*iEntryAux),historyItem); 
-				(m_wshashEntries+(*iEntryAux))->iNext = -1;
-				++m_iWSHashEntryCollisionAvailable;
-				return *iEntryAux;
+			int iWordSequence = WORD_SEQUENCE_EMPTY;
+			if (historyItem->iPrev != -1) {
+				iWordSequence = getWordSequence(historyItem->iPrev);
+			}
+			if (isStandard(historyItem->iLexUnitPron)) {
+				iWordSequence = m_wordSequenceTrie->extend(iWordSequence,
+					m_lexiconManager->getLexUnitNoPron(historyItem->iLexUnitPron));
 			}
+			
+			return iWordSequence;
 		}
 		
-		// copy a word sequence from the history-element ot 
-		inline void storeWordSequence(WSHashEntry *entry, HistoryItem *historyItem) {
+		// return the word sequence of a history item that is part of the history (it is cached in the item)
+		inline int getWordSequence(int iHistoryItem) {
 		
-			// (a) count lexical-units
-			entry->iLexUnits = 0;
-			int iHistoryItemAux = (int)(historyItem-m_historyItems);
-			do {
-				if (isStandard((iHistoryItemAux+m_historyItems)->iLexUnitPron)) {
-					entry->iLexUnits++;
-				}
-				iHistoryItemAux = (iHistoryItemAux+m_historyItems)->iPrev;
-			} while(iHistoryItemAux != -1);
+			HistoryItem *historyItem = m_historyItems+iHistoryItem;
+			if (historyItem->iWordSequence == -1) {
+				historyItem->iWordSequence = hashWordSequence(historyItem);
+			}
 			
-			// (b) copy lexical units
-			entry->iLexUnit = new int[entry->iLexUnits];
-			int iIndex = 0;
-			iHistoryItemAux = (int)(historyItem-m_historyItems);
-			do {
-				if (isStandard((iHistoryItemAux+m_historyItems)->iLexUnitPron)) {
-					entry->iLexUnit[iIndex++] = m_lexiconManager->getLexUnitPron((iHistoryItemAux+m_historyItems)->iLexUnitPron)->iLexUnit;
-				}
-				iHistoryItemAux = (iHistoryItemAux+m_historyItems)->iPrev;
-			} while(iHistoryItemAux != -1);
-			assert(iIndex == entry->iLexUnits);	
+			return historyItem->iWordSequence;
 		}
 		
 		// return whether the lexical unit is a silence or filler
@@ -488,38 +498,6 @@ class DynamicDecoderX {
 			return m_lexiconManager->isStandard(m_lexiconManager->getLexUnitPron(iLexUnitPron));
 		}
 		
-		// return whether two word sequences are identical 
-		// - ignores silence/filler symbols
-		// - ignores alternative pronunciations
-		inline bool compareWordSequencesStandard(WSHashEntry *entry, HistoryItem *historyItem) {
-			
-			int iHistoryItem = (int)(historyItem-m_historyItems);
-			int iIndex = 0;
-			
-			do {
-			
-				// get the next "real" lexical unit
-				while(iHistoryItem != -1) {
-					if (isStandard((iHistoryItem+m_historyItems)->iLexUnitPron)) {
-						break;
-					}
-					iHistoryItem = (iHistoryItem+m_historyItems)->iPrev;
-				}
-				
-				if (iHistoryItem == -1) {
-					return (iIndex == entry->iLexUnits);	
-				} else if (iIndex == entry->iLexUnits) {
-					return false;
-				} else if (entry->iLexUnit[iIndex++] != 
-					m_lexiconManager->getLexUnitNoPron((iHistoryItem+m_historyItems)->iLexUnitPron)) {
-					return false;
-				}
-				
-				iHistoryItem = (iHistoryItem+m_historyItems)->iPrev;
-				
-			} while(1);
-		}	
-		
 		// merge two word sequences by keeping the N best in wgToken1
 		bool mergeWordSequences(int iWGToken1, int iWGToken2);
 				
@@ -580,13 +558,10 @@ class DynamicDecoderX {
 			cout << "------------------------------------------------------" << endl;
 		}		
 		
-		// compute the load factor of the hash table containing unque word sequences (debugging)
-		float computeLoadFactorHashWordSequences(int *iBucketsUsed, int *iCollisions);		
-		
-		// shows hash-occupation information (debugging)
+		// shows hash-occupation information of the unique word sequences (debugging)
 		void printHashsStats();
 		
-		// print the hash-contents 
+		// print the unique word sequences (debugging)
 		void printHashContents();	
 		
 		// keeps the best history item for each unique word-sequence (auxiliar method)
@@ -630,6 +605,34 @@ class DynamicDecoderX {
 		// return the active lm-states at the current time (lm-state in active tokens)
 		void getActiveLMStates(map<int,bool> &mLMState);	
 		
+		// set the controller that adapts the beams after each frame (NULL for fixed beams)
+		void setBeamController(BeamController *beamController);
+		
+		// set the object that decides which frames get their emission probabilities evaluated (NULL for all)
+		inline void setFrameSkipper(FrameSkipper *frameSkipper) {
+		
+			m_frameSkipper = frameSkipper;
+		}
+		
+		// set the cache that computes emission probabilities for several frames at once (NULL to disable)
+		inline void setEmissionCache(EmissionCache *emissionCache) {
+		
+			m_emissionCache = emissionCache;
+		}
+		
+		// set the acoustic look-ahead applied to word-initial arcs (NULL to disable)
+		inline void setAcousticLookAhead(AcousticLookAhead *acousticLookAhead) {
+		
+			m_acousticLookAhead = acousticLookAhead;
+		}
+		
+		// set the profile that collects performance counters and timers (NULL to disable)
+		// the profile is reset at the beginning of each utterance
+		inline void setProfile(PerformanceProfile *profile) {
+		
+			m_profile = profile;
+		}
+		
 };
 
 };	// end-of-namespace
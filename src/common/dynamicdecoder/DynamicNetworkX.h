@@ -48,18 +48,13 @@ class TimeUtils;
 #define ARC_TYPE_HMM			1
 #define ARC_TYPE_WORD		2
 
-// network node: final node
+// network node: final node (topology only, the search state is kept by each decoder, see DNodeState)
 typedef struct _DNode {
 	unsigned char iType;						// node type (hmm|null)
 	unsigned char iDepth;					// node depth
 	bool bWordEnd;								// whether the node can act as an end-of word
 	char iIPIndex;								// insertion penalty (index within the array)
 	int iArcNext;								// first index of successor acrs
-	// token activation fields
-	int iActiveTokensCurrent;				// # active tokens
-	int iActiveTokensCurrentBase;			// array of active tokens (current time frame)
-	int iActiveTokensNext;					// # active tokens
-	int iActiveTokensNextBase;				// array of active tokens (next time frame)	
 } DNode;
 
 // network arc:
@@ -76,6 +71,8 @@ typedef struct _DArc {
 
 /**
 	@author daniel <dani.bolanos@gmail.com>
+	
+	The network is not modified during decoding, so a single instance can be shared across decoders.
 */
 class DynamicNetworkX {
 
@@ -87,6 +87,9 @@ void LMLookAhead::initialize() {
 float *LMLookAhead::computeLAScores(int iLMState) {
 
 	//return new float[1];
+	
+	BVC_PROFILE_TIMER_BEGIN(iCycles);
+	BVC_PROFILE_COUNT(PROFILE_COUNTER_LA_CACHE_MISSES,1);
 
 	float *fLAScores = new float[m_iVocabularySize+m_iLANodes];
 	
@@ -107,6 +110,8 @@ float *LMLookAhead::computeLAScores(int iLMState) {
 			//fLAScores[i] -= fLAScores[m_iLATree[i]];
 		}
 	}*/	
+	
+	BVC_PROFILE_TIMER_END(PROFILE_TIMER_LM_LOOKAHEAD,iCycles);
 
 	return fLAScores;
 }
@@ -133,6 +138,7 @@ float *LMLookAhead::getLAScores(int iLMState) {
 	else if (entry.iLMState == iLMState) {	
 		assert(entry.fLAScores);
 		++m_iCacheHits;
+		BVC_PROFILE_COUNT(PROFILE_COUNTER_LA_CACHE_HITS,1);
 		return entry.fLAScores;	
 	} 
 	// (3) collision, look for the lm-state in the list of collision-entries linked to the bucket-entry
@@ -149,6 +155,7 @@ float *LMLookAhead::getLAScores(int iLMState) {
 			if (entryAux.iLMState == iLMState) {
 				assert(entryAux.fLAScores);
 				++m_iCacheHits;
+				BVC_PROFILE_COUNT(PROFILE_COUNTER_LA_CACHE_HITS,1);
 				return entryAux.fLAScores;
 			}
 			iHashEntryAux = &entryAux.iNext;
@@ -20,17 +20,17 @@
 #ifndef LMLOOKAHEAD_H
 #define LMLOOKAHEAD_H
 
-class DynamicDecoderX;
-class DynamicNetworkX;
-class LexiconManager;
-class LMManager;
-
 using namespace std;
 
 #include <string>
 
 namespace Bavieca {
 
+class DynamicDecoderX;
+class DynamicNetworkX;
+class LexiconManager;
+class LMManager;
+
 // note: the hash table is organized so the first N entries of the table are the buckets and the
 //       last M entries are used to handle collisions using a linked list from the bucket-entries
 //       If S is the maximum number of elements the hash-table needs to hold, then M must be S-1
@@ -161,17 +161,15 @@ bool ContextModeling::clusterContextDependentUnits(MAccumulatorLogical &mAccumul
 		int iContextDecisionTrees = m_phoneSet->size()*NUMBER_HMM_STATES;
 		ContextDecisionTree **contextDecisionTrees = new ContextDecisionTree*[iContextDecisionTrees];
 		
-		// for each state
+		// (2.1) for each state get a linked list with the basephone accumulators and create the context decision tree
+		bool *bData = new bool[iContextDecisionTrees];
 		for(unsigned int iBasePhone = 0 ; iBasePhone < m_phoneSet->size() ; ++iBasePhone) {
 			for(int iState = 0 ; iState < NUMBER_HMM_STATES ; ++iState) {
 			
-				// (2.1) get a linked list with the basephone accumulators
-				double dOccupation = 0.0;
 				Accumulator *accumulator = NULL;
 				for(MAccumulatorLogical::iterator it = mAccumulators.begin() ; it != mAccumulators.end() ; ++it) {	
 					if ((it->second->getPhone() == iBasePhone) &&
 						 (it->second->getState() == iState)) {
-						dOccupation += it->second->getOccupation();
 						it->second->setNext(accumulator);
 						accumulator = it->second;
 					}
@@ -181,9 +179,58 @@ bool ContextModeling::clusterContextDependentUnits(MAccumulatorLogical &mAccumul
 				ContextDecisionTree *contextDecisionTree = new ContextDecisionTree(m_iDim,
 					m_iCovarianceModelling,m_phoneSet,m_iContextModelingOrderWW,accumulator,rules,iRules);
 				contextDecisionTrees[iBasePhone*NUMBER_HMM_STATES+iState] = contextDecisionTree;
+				bData[iBasePhone*NUMBER_HMM_STATES+iState] = (accumulator != NULL);
 				
+				// to make sure the user knows what is being done
+				if ((accumulator != NULL) && (m_phoneSet->isPhoneContextModeled(iBasePhone)) && 
+					((int)iBasePhone == m_phoneSet->getPhoneIndex(PHONETIC_SYMBOL_SILENCE)) && (iState == 0)) {
+					BVC_WARNING << "modeling context for phonetic symbol: " << PHONETIC_SYMBOL_SILENCE;
+				}
+			}
+		}
+		
+		// (2.2) cluster the trees, trees are independent from each other so they are clustered in parallel 
+		// (if enabled), results are kept per tree so the output does not depend on the scheduling
+		double *dLikelihoodRoot = new double[iContextDecisionTrees];
+		double *dOccupationRoot = new double[iContextDecisionTrees];
+		double *dLikelihoodAfterClustering = new double[iContextDecisionTrees];
+		int *iLeaves = new int[iContextDecisionTrees];
+		int *iLeavesData = new int[iContextDecisionTrees];
+		#pragma omp parallel for schedule(dynamic)
+		for(int iTree = 0 ; iTree < iContextDecisionTrees ; ++iTree) {
+		
+			ContextDecisionTree *contextDecisionTree = contextDecisionTrees[iTree];
+			dLikelihoodRoot[iTree] = 0.0;
+			dOccupationRoot[iTree] = 0.0;
+			dLikelihoodAfterClustering[iTree] = 0.0;
+			iLeaves[iTree] = 1;
+			iLeavesData[iTree] = 1;
+			if (bData[iTree] == false) {
+				continue;
+			}
+			
+			// compute the likelihood of the root node (context independent phone)
+			contextDecisionTree->computeLikelihoodRoot(&dLikelihoodRoot[iTree],&dOccupationRoot[iTree],*m_vCovarianceGlobal);
+			dLikelihoodAfterClustering[iTree] = dLikelihoodRoot[iTree];
+			
+			// clustering: only phones that need context dependency (not for example SIL, breath, noise, etc)
+			if (m_phoneSet->isPhoneContextModeled(iTree/NUMBER_HMM_STATES)) {
+				contextDecisionTree->clusterRoot(m_fMinimumClusterOccupation,m_fMinimumLikelihoodGainClustering);
+				// get the likelihood from the leaves of the node
+				dLikelihoodAfterClustering[iTree] = contextDecisionTree->computeTreeLikelihood();
+				iLeaves[iTree] = contextDecisionTree->countTreeLeaves();
+				iLeavesData[iTree] = contextDecisionTree->countTreeLeavesOccupancy();
+			}
+		}
+		
+		// (2.3) aggregate the results (in the original order)
+		for(unsigned int iBasePhone = 0 ; iBasePhone < m_phoneSet->size() ; ++iBasePhone) {
+			for(int iState = 0 ; iState < NUMBER_HMM_STATES ; ++iState) {
+			
+				int iTree = iBasePhone*NUMBER_HMM_STATES+iState;
+			
 				// check whether there is data to cluster the state
-				if (accumulator == NULL) {
+				if (bData[iTree] == false) {
 					iLeavesAccumulated++;
 					iLeavesAccumulatedWithoutData++;
 					// log message
@@ -191,48 +238,26 @@ bool ContextModeling::clusterContextDependentUnits(MAccumulatorLogical &mAccumul
 					continue;
 				}
 				
-				// compute the likelihood of the root node (context independent phone)
-				double dLikelihoodRoot = 0.0;
-				double dOccupationRoot = 0.0;
-				contextDecisionTree->computeLikelihoodRoot(&dLikelihoodRoot,&dOccupationRoot,*m_vCovarianceGlobal);
-				dLikelihoodAccumulated += dLikelihoodRoot;
-					
-				// clustering: only phones that need context dependency
-				double dLikelihoodAfterClustering = dLikelihoodRoot;
-				int iLeaves = 1;
-				int iLeavesData = 1;
-				if (m_phoneSet->isPhoneContextModeled(iBasePhone)) {
-	
-					// to make sure the user knows what is being done
-					if (((int)iBasePhone == m_phoneSet->getPhoneIndex(PHONETIC_SYMBOL_SILENCE)) && (iState == 0)) {
-						BVC_WARNING << "modeling context for phonetic symbol: " << PHONETIC_SYMBOL_SILENCE;
-					}
-					
-					contextDecisionTree->clusterRoot(m_fMinimumClusterOccupation,m_fMinimumLikelihoodGainClustering);
-					// get the likelihood from the leaves of the node
-					dLikelihoodAfterClustering = contextDecisionTree->computeTreeLikelihood();
-					dLikelihoodAccumulatedClustering += dLikelihoodAfterClustering;
-					iLeaves = contextDecisionTree->countTreeLeaves();
-					iLeavesData = contextDecisionTree->countTreeLeavesOccupancy();
-					iLeavesAccumulated += iLeaves;
-					iLeavesAccumulatedData += iLeavesData;	
-				}
-				// do not cluster: for example SIL, breath, noise, etc
-				else {
+				dLikelihoodAccumulated += dLikelihoodRoot[iTree];
+				dLikelihoodAccumulatedClustering += dLikelihoodAfterClustering[iTree];
+				iLeavesAccumulated += iLeaves[iTree];
+				iLeavesAccumulatedData += iLeavesData[iTree];	
 				
-					dLikelihoodAccumulatedClustering += dLikelihoodRoot;
-					iLeavesAccumulated++;
-					iLeavesAccumulatedData++;
-				}
-				double dPercentIncrease = 100.0*((dLikelihoodRoot-dLikelihoodAfterClustering)/dLikelihoodRoot);
+				double dPercentIncrease = 100.0*((dLikelihoodRoot[iTree]-dLikelihoodAfterClustering[iTree])/dLikelihoodRoot[iTree]);
 				char strInformation[1024+1];
 				sprintf(strInformation,"%s(%d) occ: %12.2f, likelihood: %16.4f -> %16.4f (%5.2f%%) %d %s",
-					m_phoneSet->getStrPhone(iBasePhone),iState,dOccupationRoot,dLikelihoodRoot,
-					dLikelihoodAfterClustering,dPercentIncrease,iLeavesData,
+					m_phoneSet->getStrPhone(iBasePhone),iState,dOccupationRoot[iTree],dLikelihoodRoot[iTree],
+					dLikelihoodAfterClustering[iTree],dPercentIncrease,iLeavesData[iTree],
 					Accumulator::getContextModelingOrder(m_iContextModelingOrderWW));
 				BVC_VERB << strInformation;
 			}
 		}
+		delete [] dLikelihoodRoot;
+		delete [] dOccupationRoot;
+		delete [] dLikelihoodAfterClustering;
+		delete [] iLeaves;
+		delete [] iLeavesData;
+		delete [] bData;
 		
 		assert(iLeavesAccumulated == (iLeavesAccumulatedData+iLeavesAccumulatedWithoutData));
 		
@@ -39,7 +39,7 @@ DTAccumulator::DTAccumulator(const char *strFilePhoneSet, const char *strFileCon
 			const char *strFolderLattices, float fScaleAM, float fScaleLM, const char *strFileAccumulatorsNum, 
 			const char *strFileAccumulatorsDen, const char *strObjectiveFunction, float fBoostingFactor,
 			bool bCanceledStatistics, float fForwardPruningBeam, float fBackwardPruningBeam, 
-			int iTrellisMaxSize, bool bTrellisCache, int iTrellisCacheMaxSize)
+			int iTrellisMaxSize, bool bTrellisCache, int iTrellisCacheMaxSize, int iTimeMargin)
 {
 	m_strFilePhoneSet = strFilePhoneSet;
 	m_strFileConfigurationFeatures = strFileConfigurationFeatures; 
@@ -62,6 +62,7 @@ DTAccumulator::DTAccumulator(const char *strFilePhoneSet, const char *strFileCon
 	m_iTrellisMaxSize = iTrellisMaxSize;
 	m_bTrellisCache = bTrellisCache;
 	m_iTrellisCacheMaxSize = iTrellisCacheMaxSize;
+	m_iTimeMargin = iTimeMargin;
 	
 	m_hmmManager = NULL;
 }
@@ -106,10 +107,10 @@ void DTAccumulator::initialize() {
 	m_hmmManager->getContextModelingOrderHMM(),m_hmmManager->getContextModelingOrderHMMCW());
 	
 	// create the Forward-Backward objects
-	// (a) numerator statistics
+	// (a) denominator statistics
 	m_forwardBackwardX = new ForwardBackwardX(m_phoneSet,m_lexiconManager,m_hmmManager,m_hmmManager,
 		m_fForwardPruningBeam,m_fBackwardPruningBeam,m_iTrellisMaxSize,m_bTrellisCache,m_iTrellisCacheMaxSize);
-	// (b) denominator statistics
+	// (b) numerator statistics
 	m_forwardBackward = new ForwardBackward(m_phoneSet,m_hmmManager,m_hmmManager,
 		m_fForwardPruningBeam,m_fBackwardPruningBeam,m_iTrellisMaxSize,m_bTrellisCache,m_iTrellisCacheMaxSize);
 	
@@ -271,8 +272,8 @@ void DTAccumulator::accumulate() {
 		
 		// get denominator statistics from the lattice
 		double dLikelihoodDen = -DBL_MAX;		
-		MOccupation *mOccupationDen = m_forwardBackward->processLattice(lattice,*mFeatures,m_fScaleAM,m_fScaleLM,
-			dLikelihoodDen,m_bMMI,m_fBoostingFactor,&strErrorCode);	
+		Alignment *alignmentDen = m_forwardBackwardX->processLattice(lattice,*mFeatures,m_fScaleAM,m_fScaleLM,
+			dLikelihoodDen,m_bMMI,m_fBoostingFactor,m_iTimeMargin,&strErrorCode);	
 		if (strcmp(strErrorCode,FB_RETURN_CODE_SUCCESS) != 0) {
 			BVC_WARNING << "unable to compute lattice occupation statistics (denominator): " << strErrorCode << ", " << strFileLattice;
 			delete alignmentNum;
@@ -284,11 +285,9 @@ void DTAccumulator::accumulate() {
 		
 		// perform statistics cancellation between numerator and denominator
 		if (m_bCanceledStatistics) {
-			statisticsCancellation(alignmentNum,mOccupationDen);
+			statisticsCancellation(alignmentNum,alignmentDen);
 		}
 		
-		Alignment *alignmentDen = ForwardBackward::getAlignment(mOccupationDen,mFeatures->getRows());
-		
 		// accumulate statistics for both numerator and denominator
 		accumulate(alignmentNum,*mFeatures,true);
 		accumulate(alignmentDen,*mFeatures,false);	
@@ -319,7 +318,6 @@ void DTAccumulator::accumulate() {
 		delete lattice;
 		delete alignmentNum;
 		delete alignmentDen;
-		delete mOccupationDen;
 		delete mFeatures;	
 		
 		// update the progress bar if necessary
@@ -370,18 +368,20 @@ void DTAccumulator::accumulate() {
 }
 
 // statistics cancellation (between numerator and denominator)
-void DTAccumulator::statisticsCancellation(Alignment *alignmentNum, MOccupation *mOccupationDen) {
+void DTAccumulator::statisticsCancellation(Alignment *alignmentNum, Alignment *alignmentDen) {
 
+	assert(alignmentNum->getFrames() == alignmentDen->getFrames());
 	for(unsigned int t=0 ; t < alignmentNum->getFrames() ; ++t) {
-		FrameAlignment *frameAlignment = alignmentNum->getFrameAlignment(t);
-		for(FrameAlignment::iterator it = frameAlignment->begin() ; it != frameAlignment->end() ; ++it) {
-			double dOccupationNum = (*it)->dOccupation;
-			MOccupation::iterator jt = mOccupationDen->find(pair<int,int>(t,(*it)->iHMMState));
-			if (jt != mOccupationDen->end()) {
-				double dOccupationDen = jt->second;
-				double dOccupationShared = min(dOccupationNum,dOccupationDen);
-				jt->second -= dOccupationShared;
-				(*it)->dOccupation -= dOccupationShared;
+		FrameAlignment *frameAlignmentNum = alignmentNum->getFrameAlignment(t);
+		FrameAlignment *frameAlignmentDen = alignmentDen->getFrameAlignment(t);
+		for(FrameAlignment::iterator it = frameAlignmentNum->begin() ; it != frameAlignmentNum->end() ; ++it) {
+			for(FrameAlignment::iterator jt = frameAlignmentDen->begin() ; jt != frameAlignmentDen->end() ; ++jt) {
+				if ((*jt)->iHMMState == (*it)->iHMMState) {
+					double dOccupationShared = min((*it)->dOccupation,(*jt)->dOccupation);
+					(*jt)->dOccupation -= dOccupationShared;
+					(*it)->dOccupation -= dOccupationShared;
+					break;
+				}
 			}
 		}
 	}
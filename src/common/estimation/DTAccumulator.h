@@ -61,6 +61,7 @@ class DTAccumulator {
 		int m_iTrellisMaxSize;
 		bool m_bTrellisCache;
 		int m_iTrellisCacheMaxSize;
+		int m_iTimeMargin;							// frames hmm-states can drift from the lattice alignment
 		
 		// boosted MMI
 		bool m_bMMI;
@@ -85,8 +86,8 @@ class DTAccumulator {
 		LexiconManager *m_lexiconManager;
 		MLFFile *m_mlfFile;
 		HMMManager *m_hmmManager;
-		ForwardBackwardX *m_forwardBackwardX;			// used for numerator statistics
-		ForwardBackward *m_forwardBackward;				// used for denominator statistics
+		ForwardBackwardX *m_forwardBackwardX;			// used for denominator statistics (lattice)
+		ForwardBackward *m_forwardBackward;				// used for numerator statistics (phone alignment)
 		
 		// optional lex units
 		VLexUnit m_vLexUnitOptional;
@@ -96,7 +97,7 @@ class DTAccumulator {
 		MAccumulatorPhysical m_mAccumulatorDen;
 		
 		// statistics cancellation (between numerator and denominator)
-		void statisticsCancellation(Alignment *alignmentNum, MOccupation *mOccupationDen);
+		void statisticsCancellation(Alignment *alignmentNum, Alignment *alignmentDen);
 		
 		// accumulate statistics
 		void accumulate(Alignment *alignment, MatrixBase<float> &mFeatures, bool bNumerator);
@@ -110,7 +111,7 @@ class DTAccumulator {
 			const char *strFolderLattices, float fScaleAM, float fScaleLM, const char *strFileAccumulatorsNum, 
 			const char *strFileAccumulatorsDen, const char *strObjectiveFunction, float fBoostingFactor,
 			bool bCanceledStatistics, float fForwardPruningBeam, float fBackwardPruningBeam, 
-			int iTrellisMaxSize, bool bTrellisCache, int iTrellisCacheMaxSize);
+			int iTrellisMaxSize, bool bTrellisCache, int iTrellisCacheMaxSize, int iTimeMargin);
 
 		// destructor
 		~DTAccumulator();
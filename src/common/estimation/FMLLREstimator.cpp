@@ -48,31 +48,128 @@ FMLLREstimator::~FMLLREstimator()
 // initialize the estimation
 void FMLLREstimator::initializeEstimation() {
 	
-	m_matrixG = new Matrix<double>*[m_iDim];
-	for(int i=0 ; i<m_iDim ; ++i) {
-		m_matrixG[i] = new Matrix<double>(m_iDim+1);
-		m_matrixG[i]->zero();
-	}
+	m_matrixG = new Matrix<double>(m_iDim,getPackedSize());
 	m_matrixK = new Matrix<double>(m_iDim,m_iDim+1);
-	m_matrixK->zero();
-	m_matrixAux = new Matrix<double>(m_iDim+1);
+	
+	// precompute the inverse covariances and the means multiplied by them (shared across frames)
+	int iGaussians = m_hmmManager->getNumberGaussianComponents();
+	m_dCovarianceInverse = new double[iGaussians*m_iDim];
+	m_dMeanCovarianceInverse = new double[iGaussians*m_iDim];
+	int iHMMStates = -1;
+	int iMixtureSizeMax = 0;
+	HMMStateDecoding *hmmStates = m_hmmManager->getHMMStatesDecoding(&iHMMStates);
+	for(int iHMMState = 0 ; iHMMState < iHMMStates ; ++iHMMState) {
+		int iComponents = -1;
+		GaussianDecoding *gaussians = hmmStates[iHMMState].getGaussians(iComponents);
+		iMixtureSizeMax = max(iMixtureSizeMax,iComponents);
+		for(int g = 0 ; g < iComponents ; ++g) {
+			assert(gaussians[g].iId < iGaussians);
+			double *dCovarianceInverse = m_dCovarianceInverse+gaussians[g].iId*m_iDim;
+			double *dMeanCovarianceInverse = m_dMeanCovarianceInverse+gaussians[g].iId*m_iDim;
+			for(int i=0 ; i < m_iDim ; ++i) {
+			#ifdef OPTIMIZED_COMPUTATION
+				dCovarianceInverse[i] = 2.0*gaussians[g].fCovariance[i];
+			#else
+				dCovarianceInverse[i] = 1.0/gaussians[g].fCovariance[i];
+			#endif
+				dMeanCovarianceInverse[i] = gaussians[g].fMean[i]*dCovarianceInverse[i];
+			}
+		}
+	}
+	m_dProbGaussian = new double[iMixtureSizeMax];
+	
+	// block of frames
+	m_iBlockFrames = 0;
+	m_matrixBlockObsEx = new Matrix<double>(FMLLR_BLOCK_SIZE,m_iDim+1);
+	m_matrixBlockOuter = new Matrix<double>(FMLLR_BLOCK_SIZE,getPackedSize());
+	m_matrixBlockG = new Matrix<double>(FMLLR_BLOCK_SIZE,m_iDim);
+	m_matrixBlockK = new Matrix<double>(FMLLR_BLOCK_SIZE,m_iDim);
 }
 
 // uninitialize the estimation
 void FMLLREstimator::uninitializeEstimation() {
 	
-	for(int i=0 ; i<m_iDim ; ++i) {
-		delete m_matrixG[i];
-	}
-	delete [] m_matrixG;
+	delete m_matrixG;
 	delete m_matrixK;
-	delete m_matrixAux;
+	delete [] m_dCovarianceInverse;
+	delete [] m_dMeanCovarianceInverse;
+	delete [] m_dProbGaussian;
+	delete m_matrixBlockObsEx;
+	delete m_matrixBlockOuter;
+	delete m_matrixBlockG;
+	delete m_matrixBlockK;
+}
+
+// add a frame to the block of frames pending to be accumulated, returns the extended observation vector
+double *FMLLREstimator::addFrame(VectorBase<float> &vFeatureVector) {
+
+	if (m_iBlockFrames == FMLLR_BLOCK_SIZE) {
+		flushBlock();
+	}
+	int iFrame = m_iBlockFrames++;
+	
+	// extended observation vector
+	double *dObsEx = m_matrixBlockObsEx->getRowData(iFrame);
+	dObsEx[0] = 1.0;
+	for(int i=0 ; i < m_iDim ; ++i) {
+		dObsEx[i+1] = vFeatureVector(i);
+	}
+	
+	// outer product (upper triangle)
+	double *dOuter = m_matrixBlockOuter->getRowData(iFrame);
+	for(int i=0 ; i <= m_iDim ; ++i) {
+		for(int j=i ; j <= m_iDim ; ++j) {
+			*dOuter++ = dObsEx[i]*dObsEx[j];
+		}
+	}
+	
+	// reset the weights
+	m_matrixBlockG->getRow(iFrame).zero();
+	m_matrixBlockK->getRow(iFrame).zero();
+	
+	return dObsEx;
+}
+
+// accumulate the block of frames into the statistics
+// G(i) += sum_t w_t(i)*x_t*x_t' and k(i) += sum_t v_t(i)*x_t are computed for all i at once as products
+// of the weight matrices and the matrices of (packed) outer products and observations of the block
+void FMLLREstimator::flushBlock() {
+
+	if (m_iBlockFrames == 0) {
+		return;
+	}
+
+	// G += WG' * Outer
+	cblas_dgemm(CblasRowMajor,CblasTrans,CblasNoTrans,m_iDim,getPackedSize(),m_iBlockFrames,
+		1.0,m_matrixBlockG->getData(),m_matrixBlockG->getStride(),
+		m_matrixBlockOuter->getData(),m_matrixBlockOuter->getStride(),
+		1.0,m_matrixG->getData(),m_matrixG->getStride());
+	
+	// K += WK' * ObsEx
+	cblas_dgemm(CblasRowMajor,CblasTrans,CblasNoTrans,m_iDim,m_iDim+1,m_iBlockFrames,
+		1.0,m_matrixBlockK->getData(),m_matrixBlockK->getStride(),
+		m_matrixBlockObsEx->getData(),m_matrixBlockObsEx->getStride(),
+		1.0,m_matrixK->getData(),m_matrixK->getStride());
+		
+	m_iBlockFrames = 0;
+}
+
+// get the G(i) matrix from the packed representation
+void FMLLREstimator::getMatrixG(int i, Matrix<double> &matrixG) {
+
+	double *dPacked = m_matrixG->getRowData(i);
+	for(int j=0 ; j <= m_iDim ; ++j) {
+		for(int k=j ; k <= m_iDim ; ++k) {
+			matrixG(j,k) = *dPacked;
+			matrixG(k,j) = *dPacked;
+			++dPacked;
+		}
+	}
 }
 
 // feed adaptation data from an alignment into the adaptation process
-// note: it is possible to accumulate statistics at the Gaussian component or at the transform level
-// - Gaussian component level: O(n^2) per Gaussian component
-// - Transform level: O(n^3) per transform + O(n) per Gaussian component
+// note: statistics are accumulated per frame (the contributions of all the Gaussian components the frame is 
+// aligned to are combined into weight vectors) and G(i) and k(i) are updated in blocks of frames
 void FMLLREstimator::feedAdaptationData(MatrixBase<float> &mFeatures, Alignment *alignment, double *dLikelihood) {
 
 	// sanity check
@@ -85,9 +182,8 @@ void FMLLREstimator::feedAdaptationData(MatrixBase<float> &mFeatures, Alignment
 		
 		VectorStatic<float> vFeatureVector = mFeatures.getRow(t);
 		
-		// extended observation vector
-		Vector<double> vObsEx(vFeatureVector);
-		vObsEx.appendFront(1.0);	
+		// add the frame to the block
+		addFrame(vFeatureVector);
 		
 		// for each HMM-state the observation is assigned to
 		FrameAlignment *frameAlignment = alignment->getFrameAlignment(t);
@@ -99,66 +195,27 @@ void FMLLREstimator::feedAdaptationData(MatrixBase<float> &mFeatures, Alignment
 				float fLikelihood = -FLT_MAX;
 				GaussianDecoding *gaussian = hmmStateDecoding->getBestScoringGaussian(vFeatureVector.getData(),&fLikelihood);
 				*dLikelihood += std::max<float>(fLikelihood,LOG_LIKELIHOOD_FLOOR);
-					
-				Vector<float> vCovariance(VectorStatic<float>(gaussian->fCovariance,m_iDim));		
-			#ifdef OPTIMIZED_COMPUTATION
-				vCovariance.mul(2.0);
-				vCovariance.invertElements();
-			#endif
-
-				// accumulate data for each G(i)
-				m_matrixAux->zero();
-				m_matrixAux->addVecMul(1.0,vObsEx,vObsEx);
-				for(int i=0 ; i < m_iDim; ++i) {
-					double dCovInv = 1.0/vCovariance(i);
-					m_matrixG[i]->add(dCovInv*1.0,*m_matrixAux);
-				}
-				
-				// accumulate data for each k(i)
-				for(int i=0 ; i < m_iDim ; ++i) {	
-					double dConstant = (gaussian->fMean[i]/vCovariance(i))*1.0;
-					m_matrixK->getRow(i).add(dConstant,vObsEx);
-				}	
+				addGaussian(gaussian->iId,1.0);
 			}
 			// (case 2) adaptation data is shared across all components (slightly more accurate)
 			else {			
-				double *dProbGaussian = new double[hmmStateDecoding->getGaussianComponents()];
 				double dProbTotal = 0.0;
 				for(int g=0 ; g < hmmStateDecoding->getGaussianComponents() ; ++g) {	
-					dProbGaussian[g] = exp(hmmStateDecoding->computeGaussianProbability(g,vFeatureVector.getData()));
-					dProbTotal += dProbGaussian[g];
-					assert((finite(dProbGaussian[g])) && (finite(dProbTotal)));	
+					m_dProbGaussian[g] = exp(hmmStateDecoding->computeGaussianProbability(g,vFeatureVector.getData()));
+					dProbTotal += m_dProbGaussian[g];
+					assert((finite(m_dProbGaussian[g])) && (finite(dProbTotal)));	
 				}
 				*dLikelihood += max(log(dProbTotal),LOG_LIKELIHOOD_FLOOR);
 				for(unsigned int iGaussian = 0 ; iGaussian < hmmStateDecoding->getMixtureSize() ; ++iGaussian) {
-				
 					GaussianDecoding *gaussian = hmmStateDecoding->getGaussian(iGaussian);	
-					double dGaussianOccupation = dProbGaussian[iGaussian]/dProbTotal;
-					
-					Vector<float> vCovariance(VectorStatic<float>(gaussian->fCovariance,m_iDim));		
-				#ifdef OPTIMIZED_COMPUTATION
-					vCovariance.mul(2.0);
-					vCovariance.invertElements();
-				#endif
-	
-					// accumulate data for each G(i)
-					m_matrixAux->zero();
-					m_matrixAux->addVecMul(1.0,vObsEx,vObsEx);
-					for(int i=0 ; i < m_iDim; ++i) {
-						double dCovInv = 1.0/vCovariance(i);
-						m_matrixG[i]->add(dCovInv*dGaussianOccupation,*m_matrixAux);
-					}
-					
-					// accumulate data for each k(i)
-					for(int i=0 ; i < m_iDim ; ++i) {	
-						double dConstant = (gaussian->fMean[i]/vCovariance(i))*dGaussianOccupation;
-						m_matrixK->getRow(i).add(dConstant,vObsEx);
-					}
+					addGaussian(gaussian->iId,m_dProbGaussian[iGaussian]/dProbTotal);
 				}
-				delete [] dProbGaussian;
 			}
 		}
 	}
+	
+	// accumulate the remaining frames
+	flushBlock();
 }
 
 // feed adaptation data from a batch file containing entries (rawFile alignmentFile)
@@ -250,7 +307,8 @@ Transform *FMLLREstimator::estimateTransform(Transform *transformInitial) {
 		
 			// invert G(i) (this is suboptimal, the inversion needs to be
 			// done just once then it can be reused across iterations)
-			Matrix<double> matrixGInverted(*m_matrixG[i]);
+			Matrix<double> matrixGInverted(m_iDim+1);
+			getMatrixG(i,matrixGInverted);
 			matrixGInverted.invert();
 			
 			// compute alpha (it implies solving a quadratic equation and selecting the solution
@@ -27,6 +27,9 @@
 
 namespace Bavieca {
 
+// number of frames accumulated before the statistics are updated (rank-k update)
+#define FMLLR_BLOCK_SIZE				256
+
 class Alignment;
 class PhoneSet;
 class HMMManager;
@@ -47,9 +50,48 @@ class FMLLREstimator {
 		float m_fOccupancyTotal;
 		
 		// estimation data
-		Matrix<double> **m_matrixG;
+		Matrix<double> *m_matrixG;				// G(i) matrices (one per row, upper triangle packed by rows)
 		Matrix<double> *m_matrixK;
-		Matrix<double> *m_matrixAux;
+		
+		// precomputed Gaussian data (indexed by Gaussian id)
+		double *m_dCovarianceInverse;			// inverse covariance
+		double *m_dMeanCovarianceInverse;		// mean multiplied by the inverse covariance
+		double *m_dProbGaussian;				// Gaussian probabilities (auxiliar)
+		
+		// block of frames pending to be accumulated
+		int m_iBlockFrames;
+		Matrix<double> *m_matrixBlockObsEx;		// extended observation vectors
+		Matrix<double> *m_matrixBlockOuter;		// outer products of the extended observation vectors (packed)
+		Matrix<double> *m_matrixBlockG;			// weights for each G(i) (sum of occupation times inverse covariance)
+		Matrix<double> *m_matrixBlockK;			// weights for each k(i)
+		
+		// return the size of an upper triangle packed by rows
+		int getPackedSize() {
+		
+			return ((m_iDim+1)*(m_iDim+2))/2;
+		}
+		
+		// add a frame to the block of frames pending to be accumulated
+		double *addFrame(VectorBase<float> &vFeatureVector);
+		
+		// add the occupation of a Gaussian (given its id) to the current frame of the block
+		void addGaussian(int iGaussian, double dOccupation) {
+		
+			double *dWeightG = m_matrixBlockG->getRowData(m_iBlockFrames-1);
+			double *dWeightK = m_matrixBlockK->getRowData(m_iBlockFrames-1);
+			double *dCovarianceInverse = m_dCovarianceInverse+iGaussian*m_iDim;
+			double *dMeanCovarianceInverse = m_dMeanCovarianceInverse+iGaussian*m_iDim;
+			for(int i=0 ; i < m_iDim ; ++i) {
+				dWeightG[i] += dOccupation*dCovarianceInverse[i];
+				dWeightK[i] += dOccupation*dMeanCovarianceInverse[i];
+			}
+		}
+		
+		// accumulate the block of frames into the statistics
+		void flushBlock();
+		
+		// get the G(i) matrix from the packed representation
+		void getMatrixG(int i, Matrix<double> &matrixG);
 
 	public:
 
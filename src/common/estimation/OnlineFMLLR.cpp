@@ -0,0 +1,317 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+#include <stdexcept>
+
+#include "Alignment.h"
+#include "BestPath.h"
+#include "FMLLREstimator.h"
+#include "HMMManager.h"
+#include "LogMessage.h"
+#include "MatrixStatic.h"
+#include "OnlineFMLLR.h"
+#include "PhoneSet.h"
+#include "Transform.h"
+#include "ViterbiX.h"
+
+namespace Bavieca {
+
+// constructor
+OnlineFMLLR::OnlineFMLLR(PhoneSet *phoneSet, LexiconManager *lexiconManager, const char *strFileModels, 
+	int iIterations, bool bBestComponentOnly, int iFramesUpdate) {
+
+	m_phoneSet = phoneSet;
+	m_lexiconManager = lexiconManager;
+	m_iFramesUpdate = iFramesUpdate;
+	m_iFramesPending = 0;
+	m_iFramesTotal = 0;
+	m_transformCurrent = NULL;
+	m_transformPending = NULL;
+	m_bUpdateRequested = false;
+	m_bStop = false;
+	
+	// load the acoustic models
+	m_hmmManager = new HMMManager(m_phoneSet,HMM_PURPOSE_EVALUATION);
+	m_hmmManager->load(strFileModels);
+	m_hmmManager->initializeDecoding();
+	m_iDim = m_hmmManager->getFeatureDim();
+	
+	m_viterbiX = new ViterbiX(m_phoneSet,m_lexiconManager,m_hmmManager,1000,2000,true,2000);
+	m_fmllrEstimator = new FMLLREstimator(m_phoneSet,m_hmmManager,iIterations,bBestComponentOnly);
+}
+
+// destructor
+OnlineFMLLR::~OnlineFMLLR() {
+
+	delete m_fmllrEstimator;
+	delete m_viterbiX;
+	delete m_hmmManager;
+	if (m_transformCurrent) {
+		delete m_transformCurrent;
+	}
+	if (m_transformPending) {
+		delete m_transformPending;
+	}
+}
+
+// initialize the adaptation (starts the adaptation thread)
+void OnlineFMLLR::initialize() {
+
+	m_fmllrEstimator->initializeEstimation();
+	m_bStop = false;
+
+#if defined __linux__ || defined __APPLE__ || __MINGW32__
+	pthread_mutex_init(&m_mutex,NULL);
+	pthread_cond_init(&m_condition,NULL);
+	if (pthread_create(&m_thread,NULL,OnlineFMLLR::run,this) != 0) {
+		BVC_ERROR << "unable to create the adaptation thread";
+	}
+#endif
+}
+
+// uninitialize the adaptation (stops the adaptation thread, queued utterances are discarded)
+void OnlineFMLLR::uninitialize() {
+
+#if defined __linux__ || defined __APPLE__ || __MINGW32__
+	lock();
+	m_bStop = true;
+	pthread_cond_signal(&m_condition);
+	unlock();
+	pthread_join(m_thread,NULL);
+	pthread_cond_destroy(&m_condition);
+	pthread_mutex_destroy(&m_mutex);
+#endif
+
+	for(LAdaptationUtterance::iterator it = m_lUtterances.begin() ; it != m_lUtterances.end() ; ++it) {
+		delete (*it)->mFeatures;
+		delete *it;
+	}
+	m_lUtterances.clear();
+	
+	m_fmllrEstimator->uninitializeEstimation();
+}
+
+#if defined __linux__ || defined __APPLE__ || __MINGW32__
+
+// thread entry point: process queued utterances and re-estimate the transform when needed
+void *OnlineFMLLR::run(void *data) {
+
+	OnlineFMLLR *onlineFMLLR = (OnlineFMLLR*)data;
+	
+	onlineFMLLR->lock();
+	while(true) {
+		while((onlineFMLLR->m_lUtterances.empty()) && (onlineFMLLR->m_bUpdateRequested == false) && 
+			(onlineFMLLR->m_bStop == false)) {
+			pthread_cond_wait(&onlineFMLLR->m_condition,&onlineFMLLR->m_mutex);
+		}
+		if (onlineFMLLR->m_bStop) {
+			break;
+		}
+		// process the next utterance
+		if (onlineFMLLR->m_lUtterances.empty() == false) {
+			AdaptationUtterance *utterance = onlineFMLLR->m_lUtterances.front();
+			onlineFMLLR->m_lUtterances.pop_front();
+			onlineFMLLR->unlock();
+			onlineFMLLR->accumulate(utterance);
+			onlineFMLLR->lock();
+		} 
+		// re-estimate the transform (once all the queued utterances are processed)
+		else {
+			onlineFMLLR->m_bUpdateRequested = false;
+			onlineFMLLR->unlock();
+			onlineFMLLR->estimate();
+			onlineFMLLR->lock();
+		}
+	}
+	onlineFMLLR->unlock();
+	
+	return NULL;
+}
+
+#endif
+
+// queue an utterance for adaptation
+void OnlineFMLLR::queue(AdaptationUtterance *utterance) {
+
+#if defined __linux__ || defined __APPLE__ || __MINGW32__
+	lock();
+	if (m_lUtterances.size() >= ONLINE_FMLLR_MAX_QUEUED_UTTERANCES) {
+		unlock();
+		BVC_WARNING << "too many utterances waiting for adaptation, utterance discarded";
+		delete utterance->mFeatures;
+		delete utterance;
+		return;
+	}
+	m_lUtterances.push_back(utterance);
+	pthread_cond_signal(&m_condition);
+	unlock();
+#else
+	// no adaptation thread: the utterance is processed right away
+	accumulate(utterance);
+	if (m_bUpdateRequested) {
+		m_bUpdateRequested = false;
+		estimate();
+	}
+#endif
+}
+
+// accumulate adaptation statistics from an utterance
+void OnlineFMLLR::accumulate(AdaptationUtterance *utterance) {
+
+	try {
+	
+		// align the utterance against its transcription
+		VLexUnit vLexUnitOptional;
+		vLexUnitOptional.push_back(m_lexiconManager->getLexUnitSilence());
+		double dLikelihood = 0.0;
+		int iErrorCode = UTTERANCE_PROCESSED_SUCCESSFULLY;
+		Alignment *alignment = m_viterbiX->processUtterance(utterance->vLexUnit,false,vLexUnitOptional,
+			*utterance->mFeatures,&dLikelihood,iErrorCode);
+		if (alignment != NULL) {
+			
+			// accumulate statistics
+			double dLikelihoodAdaptation = 0.0;
+			m_fmllrEstimator->feedAdaptationData(*utterance->mFeatures,alignment,&dLikelihoodAdaptation);
+			m_iFramesPending += utterance->mFeatures->getRows();
+			m_iFramesTotal += utterance->mFeatures->getRows();
+			delete alignment;
+			
+			// re-estimate the transform if enough data was seen since the last estimation
+			if (m_iFramesPending >= m_iFramesUpdate) {
+				estimate();
+			}
+		} else {
+			BVC_VERB << "unable to align the adaptation utterance (error code: " << iErrorCode << ")";
+		}
+		
+	} catch (std::runtime_error &e) {
+		BVC_WARNING << "unable to use the utterance for adaptation: " << e.what();
+	}
+	
+	delete utterance->mFeatures;
+	delete utterance;
+}
+
+// re-estimate the transform and make it available to the decoding thread
+void OnlineFMLLR::estimate() {
+
+	if (m_iFramesTotal == 0) {
+		return;
+	}
+
+	Transform *transform = NULL;
+	try {
+		transform = m_fmllrEstimator->estimateTransform(NULL);
+	} catch (std::runtime_error &e) {
+		BVC_WARNING << "unable to estimate the adaptation transform: " << e.what();
+		return;
+	}
+	m_iFramesPending = 0;
+	
+	// swap the pending transform
+	lock();
+	if (m_transformPending) {
+		delete m_transformPending;
+	}
+	m_transformPending = transform;
+	unlock();
+	
+	BVC_VERB << "fMLLR transform updated (" << m_iFramesTotal << " adaptation frames)";
+}
+
+// signal the beginning of an utterance, returns the transform to apply to its features (or NULL)
+Transform *OnlineFMLLR::beginUtterance() {
+
+	// pick up the most recent transform
+	lock();
+	if (m_transformPending) {
+		if (m_transformCurrent) {
+			delete m_transformCurrent;
+		}
+		m_transformCurrent = m_transformPending;
+		m_transformPending = NULL;
+	}
+	unlock();
+	
+	m_vFeaturesUtterance.clear();
+	m_vLexUnitUtterance.clear();
+	
+	return m_transformCurrent;
+}
+
+// append (unadapted) features to the current utterance
+void OnlineFMLLR::addFeatures(MatrixBase<float> &mFeatures) {
+
+	assert((int)mFeatures.getCols() == m_iDim);
+	for(unsigned int i=0 ; i < mFeatures.getRows() ; ++i) {
+		float *fFeatures = mFeatures.getRowData(i);
+		m_vFeaturesUtterance.insert(m_vFeaturesUtterance.end(),fFeatures,fFeatures+m_iDim);
+	}
+}
+
+// set the best path of the current utterance (the transcription used for adaptation)
+void OnlineFMLLR::setBestPath(BestPath *bestPath) {
+
+	m_vLexUnitUtterance.clear();
+	LBestPathElement *lBestPathElements = bestPath->getBestPathElements();
+	for(LBestPathElement::iterator it = lBestPathElements->begin() ; it != lBestPathElements->end() ; ++it) {
+		if ((m_lexiconManager->isStandard((*it)->lexUnit) || m_lexiconManager->isFiller((*it)->lexUnit)) &&
+			((*it)->lexUnit != m_lexiconManager->getLexUnitSilence())) {
+			m_vLexUnitUtterance.push_back((*it)->lexUnit);
+		}
+	}
+}
+
+// signal the end of the current utterance, it is queued for adaptation if a best path is available
+void OnlineFMLLR::endUtterance() {
+
+	if ((m_vLexUnitUtterance.empty() == false) && (m_vFeaturesUtterance.empty() == false)) {
+		MatrixStatic<float> mFeatures(&m_vFeaturesUtterance[0],
+			(unsigned int)(m_vFeaturesUtterance.size()/m_iDim),m_iDim);
+		feed(mFeatures,m_vLexUnitUtterance);
+	}
+	m_vFeaturesUtterance.clear();
+	m_vLexUnitUtterance.clear();
+}
+
+// feed an utterance with a known transcription (supervised adaptation)
+void OnlineFMLLR::feed(MatrixBase<float> &mFeatures, VLexUnit &vLexUnit) {
+
+	AdaptationUtterance *utterance = new AdaptationUtterance;
+	utterance->mFeatures = new Matrix<float>(mFeatures);
+	utterance->vLexUnit = vLexUnit;
+	queue(utterance);
+}
+
+// request a re-estimation of the transform using all data fed so far
+void OnlineFMLLR::update() {
+
+	lock();
+	m_bUpdateRequested = true;
+#if defined __linux__ || defined __APPLE__ || __MINGW32__
+	pthread_cond_signal(&m_condition);
+#endif
+	unlock();
+
+#if !(defined __linux__ || defined __APPLE__ || __MINGW32__)
+	m_bUpdateRequested = false;
+	estimate();
+#endif
+}
+
+};	// end-of-namespace
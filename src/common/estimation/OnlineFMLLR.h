@@ -0,0 +1,163 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#ifndef ONLINEFMLLR_H
+#define ONLINEFMLLR_H
+
+using namespace std;
+
+#include <list>
+#include <vector>
+
+#if defined __linux__ || defined __APPLE__ || __MINGW32__
+#include <pthread.h>
+#endif
+
+#include "LexiconManager.h"
+#include "Matrix.h"
+
+namespace Bavieca {
+
+class BestPath;
+class FMLLREstimator;
+class HMMManager;
+class PhoneSet;
+class Transform;
+class ViterbiX;
+
+// default number of adaptation frames between consecutive transform re-estimations
+#define ONLINE_FMLLR_FRAMES_UPDATE_DEFAULT			1000
+// maximum number of utterances waiting to be processed (utterances beyond this are not used)
+#define ONLINE_FMLLR_MAX_QUEUED_UTTERANCES			20
+
+// utterance waiting to be used for adaptation
+typedef struct {
+	Matrix<float> *mFeatures;			// unadapted feature vectors
+	VLexUnit vLexUnit;					// transcription (decoder's best path or reference)
+} AdaptationUtterance;
+
+typedef list<AdaptationUtterance*> LAdaptationUtterance;
+
+// online (incremental) fMLLR speaker adaptation for live decoding sessions:
+// - each utterance is aligned against its transcription (typically the best path) 
+// - fMLLR statistics are accumulated incrementally across utterances
+// - the transform is periodically re-estimated on a background thread
+// - the new transform is swapped in at the beginning of the next utterance, features are 
+//   transformed so the acoustic models are never modified and decoding does not stall
+
+/**
+	@author daniel <dani.bolanos@gmail.com>
+*/
+class OnlineFMLLR {
+
+	private:
+	
+		PhoneSet *m_phoneSet;
+		LexiconManager *m_lexiconManager;
+		HMMManager *m_hmmManager;					// acoustic models (own copy, emission caches are not shared)
+		ViterbiX *m_viterbiX;
+		FMLLREstimator *m_fmllrEstimator;
+		int m_iDim;
+		int m_iFramesUpdate;						// adaptation frames between transform re-estimations
+		int m_iFramesPending;						// adaptation frames since the last re-estimation
+		int m_iFramesTotal;							// adaptation frames accumulated so far
+		
+		// current utterance
+		vector<float> m_vFeaturesUtterance;			// unadapted feature vectors
+		VLexUnit m_vLexUnitUtterance;				// best path
+		
+		// transforms
+		Transform *m_transformCurrent;				// transform in use (only accessed by the decoding thread)
+		Transform *m_transformPending;				// newly estimated transform not in use yet
+		
+		// utterances waiting to be processed
+		LAdaptationUtterance m_lUtterances;
+		bool m_bUpdateRequested;
+		bool m_bStop;
+		
+	#if defined __linux__ || defined __APPLE__ || __MINGW32__
+		pthread_t m_thread;
+		pthread_mutex_t m_mutex;
+		pthread_cond_t m_condition;
+		
+		// thread entry point
+		static void *run(void *data);
+	#endif
+		
+		// lock/unlock the data shared with the adaptation thread
+		void lock() {
+		
+		#if defined __linux__ || defined __APPLE__ || __MINGW32__
+			pthread_mutex_lock(&m_mutex);
+		#endif
+		}
+		
+		void unlock() {
+		
+		#if defined __linux__ || defined __APPLE__ || __MINGW32__
+			pthread_mutex_unlock(&m_mutex);
+		#endif
+		}
+		
+		// queue an utterance for adaptation
+		void queue(AdaptationUtterance *utterance);
+		
+		// accumulate adaptation statistics from an utterance
+		void accumulate(AdaptationUtterance *utterance);
+		
+		// re-estimate the transform and make it available to the decoding thread
+		void estimate();
+
+	public:
+
+		// constructor
+		OnlineFMLLR(PhoneSet *phoneSet, LexiconManager *lexiconManager, const char *strFileModels, 
+			int iIterations, bool bBestComponentOnly, int iFramesUpdate);
+
+		// destructor
+		~OnlineFMLLR();
+		
+		// initialize the adaptation (starts the adaptation thread)
+		void initialize();
+		
+		// uninitialize the adaptation (stops the adaptation thread, queued utterances are discarded)
+		void uninitialize();
+		
+		// signal the beginning of an utterance, returns the transform to apply to its features (or NULL)
+		Transform *beginUtterance();
+		
+		// append (unadapted) features to the current utterance
+		void addFeatures(MatrixBase<float> &mFeatures);
+		
+		// set the best path of the current utterance (the transcription used for adaptation)
+		void setBestPath(BestPath *bestPath);
+		
+		// signal the end of the current utterance, it is queued for adaptation if a best path is available
+		void endUtterance();
+		
+		// feed an utterance with a known transcription (supervised adaptation)
+		void feed(MatrixBase<float> &mFeatures, VLexUnit &vLexUnit);
+		
+		// request a re-estimation of the transform using all data fed so far
+		void update();
+};
+
+};	// end-of-namespace
+
+#endif
@@ -346,9 +346,55 @@ int RegressionTree::countLeaves(RTNode *rtNode) {
 	}
 }
 
-// perform k-means to split a tree-node
-// note: it returns the new tree-nodes as children of the given tree-node
-bool RegressionTree::kMeansClustering(RTNode *cluster, int iMinimumComponentsCluster) {
+// gather the means of the Gaussian components in the cluster into contiguous memory (one row per component)
+void RegressionTree::gatherMeans(RTNode *cluster, Matrix<float> &mMeans) {
+
+	assert(mMeans.getRows() == cluster->vGaussian.size());
+	for(unsigned int i=0 ; i < cluster->vGaussian.size() ; ++i) {
+		memcpy(mMeans.getData()+i*mMeans.getStride(),cluster->vGaussian[i]->fMean,m_iDim*sizeof(float));
+	}
+}
+
+// compute the weighted euclidean distance from a point to both centroids (uses SSE if available)
+void RegressionTree::computeDistanceCentroids(float *fX, float *fCentroid1, float *fCentroid2, float *fWeight, 
+	float &fDistance1, float &fDistance2) {
+
+	int i = 0;
+	float fAcc1 = 0.0;
+	float fAcc2 = 0.0;
+#ifdef __SSE__
+	__m128 acc1 = _mm_setzero_ps();
+	__m128 acc2 = _mm_setzero_ps();
+	for( ; i+4 <= m_iDim ; i += 4) {
+		__m128 x = _mm_loadu_ps(fX+i);
+		__m128 w = _mm_loadu_ps(fWeight+i);
+		__m128 d1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(fCentroid1+i),x),w);
+		__m128 d2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(fCentroid2+i),x),w);
+		acc1 = _mm_add_ps(acc1,_mm_mul_ps(d1,d1));
+		acc2 = _mm_add_ps(acc2,_mm_mul_ps(d2,d2));
+	}
+	float fTmp[4];
+	_mm_storeu_ps(fTmp,acc1);
+	fAcc1 = fTmp[0]+fTmp[1]+fTmp[2]+fTmp[3];
+	_mm_storeu_ps(fTmp,acc2);
+	fAcc2 = fTmp[0]+fTmp[1]+fTmp[2]+fTmp[3];
+#endif
+	for( ; i < m_iDim ; ++i) {
+		float fAux1 = (fCentroid1[i]-fX[i])*fWeight[i];
+		float fAux2 = (fCentroid2[i]-fX[i])*fWeight[i];
+		fAcc1 += fAux1*fAux1;
+		fAcc2 += fAux2*fAux2;
+	}
+	
+	fDistance1 = fAcc1/((float)m_iDim);
+	fDistance2 = fAcc2/((float)m_iDim);
+}
+
+// perform k-means (k=2) on the means of the Gaussian components in the cluster, the assignment 
+// is kept in m_iGaussianBaseClass
+// note: the assignment step runs in parallel, per-thread statistics are reduced in thread order
+int RegressionTree::kMeans(RTNode *cluster, Matrix<float> &mMeans, float *fDistortion1, float *fDistortion2, 
+	int *iClusterElements1, int *iClusterElements2) {
 
 	float *fCentroid1 = new float[m_iDim];
 	float *fCentroid2 = new float[m_iDim];
@@ -363,70 +409,127 @@ bool RegressionTree::kMeansClustering(RTNode *cluster, int iMinimumComponentsClu
 	
 	// (1.2) choose a different point as the second centroid
 	float *fWeight = computeWeight(cluster);
-	float *fCentroidAux = NULL;
 	int iIndex2;
 	do {
 		iIndex2 = getRandomNumber(0,iGaussians-1);
 	} while(iIndex1 == iIndex2);
-	fCentroidAux = cluster->vGaussian[iIndex2]->fMean;	
-	assert(fCentroidAux != NULL);
 	for(int i=0 ; i<m_iDim ; ++i) {
-		fCentroid2[i] = fCentroidAux[i];
+		fCentroid2[i] = cluster->vGaussian[iIndex2]->fMean[i];
 	}
 	
+	int iThreads = getThreads();
+	double *dAccumulatorThread = new double[iThreads*2*m_iDim];
+	float *fDistortionThread = new float[iThreads*2];
+	int *iElementsThread = new int[iThreads*2];
 	int iIterations = 0;
-	float fDistortion1 = 0.0;
-	float fDistortion2 = 0.0;
 	float fDistortionPrevious = 0.0;
 	float fDistortionCurrent = 0.0;
 	double *dAccumulator1 = new double[m_iDim];
 	double *dAccumulator2 = new double[m_iDim];
-	int iClusterElements1 = 0;
-	int iClusterElements2 = 0;	
 	
 	// (2) iterative process assignment/update
 	do {
 		// initialization
-		fDistortion1 = 0.0;
-		fDistortion2 = 0.0;
-		for(int i=0;i<m_iDim;++i) {
-			dAccumulator1[i] = 0.0;
-			dAccumulator2[i] = 0.0;
+		for(int i=0 ; i < iThreads*2*m_iDim ; ++i) {
+			dAccumulatorThread[i] = 0.0;
+		}
+		for(int i=0 ; i < iThreads*2 ; ++i) {
+			fDistortionThread[i] = 0.0;
+			iElementsThread[i] = 0;
 		}
-		iClusterElements1 = 0;
-		iClusterElements2 = 0;
 		fDistortionPrevious = fDistortionCurrent;
 		// assignment step: assign each gaussian to the closest cluster
-		for(VGaussianDecoding::iterator it = cluster->vGaussian.begin() ; it != cluster->vGaussian.end() ; ++it) {
-			float fDistance1 = euclideanDistance(fCentroid1,(*it)->fMean,fWeight);
-			float fDistance2 = euclideanDistance(fCentroid2,(*it)->fMean,fWeight);
-			if (fDistance1 < fDistance2) {	
-				m_iGaussianBaseClass[(*it)->iId] = 0;
-				fDistortion1 += fDistance1;
-				for(int i=0;i<m_iDim;++i) {
-					dAccumulator1[i] += (*it)->fMean[i];
-				}	
-				iClusterElements1++;
-			} else {
-				m_iGaussianBaseClass[(*it)->iId] = 1;
-				fDistortion2 += fDistance2;
-				for(int i=0;i<m_iDim;++i) {
-					dAccumulator2[i] += (*it)->fMean[i];
+		#pragma omp parallel num_threads(iThreads)
+		{
+			int iThread = getThreadId();
+			double *dAccumulatorAux1 = dAccumulatorThread+iThread*2*m_iDim;
+			double *dAccumulatorAux2 = dAccumulatorAux1+m_iDim;
+			float fDistortionAux1 = 0.0;
+			float fDistortionAux2 = 0.0;
+			int iElementsAux1 = 0;
+			int iElementsAux2 = 0;
+			#pragma omp for schedule(static)
+			for(int iGaussian = 0 ; iGaussian < iGaussians ; ++iGaussian) {
+				float *fMean = mMeans.getData()+iGaussian*mMeans.getStride();
+				float fDistance1,fDistance2;
+				computeDistanceCentroids(fMean,fCentroid1,fCentroid2,fWeight,fDistance1,fDistance2);
+				if (fDistance1 < fDistance2) {	
+					m_iGaussianBaseClass[cluster->vGaussian[iGaussian]->iId] = 0;
+					fDistortionAux1 += fDistance1;
+					for(int i=0;i<m_iDim;++i) {
+						dAccumulatorAux1[i] += fMean[i];
+					}	
+					iElementsAux1++;
+				} else {
+					m_iGaussianBaseClass[cluster->vGaussian[iGaussian]->iId] = 1;
+					fDistortionAux2 += fDistance2;
+					for(int i=0;i<m_iDim;++i) {
+						dAccumulatorAux2[i] += fMean[i];
+					}	
+					iElementsAux2++;
 				}	
-				iClusterElements2++;
-			}	
+			}
+			fDistortionThread[iThread*2] = fDistortionAux1;
+			fDistortionThread[iThread*2+1] = fDistortionAux2;
+			iElementsThread[iThread*2] = iElementsAux1;
+			iElementsThread[iThread*2+1] = iElementsAux2;
+		}
+		// reduce the per-thread statistics
+		*fDistortion1 = 0.0;
+		*fDistortion2 = 0.0;
+		*iClusterElements1 = 0;
+		*iClusterElements2 = 0;
+		for(int i=0;i<m_iDim;++i) {
+			dAccumulator1[i] = 0.0;
+			dAccumulator2[i] = 0.0;
+		}
+		for(int iThread = 0 ; iThread < iThreads ; ++iThread) {
+			*fDistortion1 += fDistortionThread[iThread*2];
+			*fDistortion2 += fDistortionThread[iThread*2+1];
+			*iClusterElements1 += iElementsThread[iThread*2];
+			*iClusterElements2 += iElementsThread[iThread*2+1];
+			for(int i=0;i<m_iDim;++i) {
+				dAccumulator1[i] += dAccumulatorThread[iThread*2*m_iDim+i];
+				dAccumulator2[i] += dAccumulatorThread[iThread*2*m_iDim+m_iDim+i];
+			}
 		}
 		// update step: update the centroids
 		for(int i=0;i<m_iDim;++i) {
-			fCentroid1[i] = (float)(dAccumulator1[i]/((float)iClusterElements1));
-			fCentroid2[i] = (float)(dAccumulator2[i]/((float)iClusterElements2));
+			fCentroid1[i] = (float)(dAccumulator1[i]/((float)*iClusterElements1));
+			fCentroid2[i] = (float)(dAccumulator2[i]/((float)*iClusterElements2));
 		}		
 		++iIterations;
-		//printf("iteration: %d distortion: %f (%d %d)\n",iIterations,fDistortion1+fDistortion2,iClusterElements1,iClusterElements2);
-		fDistortionCurrent = fDistortion1+fDistortion2;
+		fDistortionCurrent = *fDistortion1+*fDistortion2;
 	} while(fDistortionPrevious != fDistortionCurrent);
 	
-	//printf("iteration: %d distortion: %f (%d %d)\n",iIterations,fDistortion1+fDistortion2,iClusterElements1,iClusterElements2);
+	delete [] fWeight;
+	delete [] fCentroid1;
+	delete [] fCentroid2;
+	delete [] dAccumulator1;
+	delete [] dAccumulator2;
+	delete [] dAccumulatorThread;
+	delete [] fDistortionThread;
+	delete [] iElementsThread;
+	
+	return iIterations;
+}
+
+// perform k-means to split a tree-node
+// note: it returns the new tree-nodes as children of the given tree-node
+bool RegressionTree::kMeansClustering(RTNode *cluster, int iMinimumComponentsCluster) {
+
+	// gather the Gaussian means
+	Matrix<float> mMeans((unsigned int)cluster->vGaussian.size(),m_iDim);
+	gatherMeans(cluster,mMeans);
+	
+	// k-means clustering
+	float fDistortion1 = 0.0;
+	float fDistortion2 = 0.0;
+	int iClusterElements1 = 0;
+	int iClusterElements2 = 0;	
+	kMeans(cluster,mMeans,&fDistortion1,&fDistortion2,&iClusterElements1,&iClusterElements2);
+	
+	//printf("distortion: %f (%d %d)\n",fDistortion1+fDistortion2,iClusterElements1,iClusterElements2);
 	
 	// check that both clusters have enough number of elements
 	if ((iClusterElements1 < iMinimumComponentsCluster) || 
@@ -468,36 +571,45 @@ bool RegressionTree::kMeansClustering(RTNode *cluster, int iMinimumComponentsClu
 		}
 	}
 	cluster->vGaussian.clear();
-	
-	delete [] fWeight;
-	delete [] fCentroid1;
-	delete [] fCentroid2;
-	delete [] dAccumulator1;
-	delete [] dAccumulator2;
 		
 	return true;
 }
 
-// compute P(x|A)	
-float RegressionTree::computeClusterLikelihood(float *fMean, float *fCovariance, float *fX) {
+// compute the inverse covariance of a cluster and the normalization factor of its likelihood
+double RegressionTree::computeClusterNormalization(float *fCovariance, float *fCovarianceInverse) {
+
+	double dConstant = pow(PI_NUMBER*2.0,((double)m_iDim)/2.0);
 	
-	double dAcc,dDeterminant;
-	float fProbability = 0.0;
+	double dDeterminant = 1.0;
+	for(int i = 0 ; i < m_iDim ; ++i) {
+		dDeterminant *= fCovariance[i];
+		fCovarianceInverse[i] = (float)(1.0/fCovariance[i]);
+	}
 	
-	double dConstant = pow(PI_NUMBER*2.0,((double)m_iDim)/2.0);
+	return 1.0/(dConstant*pow(dDeterminant,0.5));
+}
+
+// compute P(x|A) from the precomputed inverse covariance and normalization factor (uses SSE if available)
+float RegressionTree::computeClusterLikelihood(float *fMean, float *fCovarianceInverse, double dNormalization, 
+	float *fX) {
 	
-	dDeterminant = 1.0;
+	int i = 0;
 	double dExponent = 0.0;
-	
-	for(int j = 0 ; j < m_iDim ; ++j) {
-		// compute the determinant of the covariance matrix
-		dDeterminant *= fCovariance[j];
-		// compute the numerator
-		dAcc = fX[j]-fMean[j];
-		dExponent += dAcc*dAcc*(1.0/fCovariance[j]);
+#ifdef __SSE__
+	__m128 acc = _mm_setzero_ps();
+	for( ; i+4 <= m_iDim ; i += 4) {
+		__m128 d = _mm_sub_ps(_mm_loadu_ps(fX+i),_mm_loadu_ps(fMean+i));
+		acc = _mm_add_ps(acc,_mm_mul_ps(_mm_mul_ps(d,d),_mm_loadu_ps(fCovarianceInverse+i)));
+	}
+	float fTmp[4];
+	_mm_storeu_ps(fTmp,acc);
+	dExponent = fTmp[0]+fTmp[1]+fTmp[2]+fTmp[3];
+#endif
+	for( ; i < m_iDim ; ++i) {
+		double dAcc = fX[i]-fMean[i];
+		dExponent += dAcc*dAcc*fCovarianceInverse[i];
 	}		
-	dDeterminant = pow(dDeterminant,0.5);
-	fProbability = (float)(exp(-0.5*dExponent)/(dConstant*dDeterminant));
+	float fProbability = (float)(exp(-0.5*dExponent)*dNormalization);
 	
 	// floor the likelihood
 	if (fProbability < EM_MINIMUM_LIKELIHOOD) {
@@ -517,87 +629,17 @@ float RegressionTree::computeClusterLikelihood(float *fMean, float *fCovariance,
 // note: it returns the new tree-nodes as children of the given tree-node
 bool RegressionTree::expectationMaximizationClustering(RTNode *cluster, int iMinimumComponentsCluster) {
 
-	// (1) k-means clustering (it is used to initialize the clusters in order to speed up the EM convergence)	
-	float *fCentroid1 = new float[m_iDim];
-	float *fCentroid2 = new float[m_iDim];
-
-	// (1.1) get the initial centroids
-	// choose a random point as the first centroid
+	// gather the Gaussian means
 	int iGaussians = (int)cluster->vGaussian.size();
-	int iIndex1 = getRandomNumber(0,iGaussians-1);
-	for(int i=0 ; i<m_iDim ; ++i) {
-		fCentroid1[i] = cluster->vGaussian[iIndex1]->fMean[i];
-	}
-	
-	// choose a different point as the second centroid
-	float *fWeight = computeWeight(cluster);
-	float *fCentroidAux = NULL;
-	int iIndex2;
-	do {
-		iIndex2 = getRandomNumber(0,iGaussians-1);
-	} while(iIndex1 == iIndex2);	
-	fCentroidAux = cluster->vGaussian[iIndex2]->fMean;	
-	assert(fCentroidAux != NULL);
-	for(int i=0 ; i<m_iDim ; ++i) {
-		fCentroid2[i] = fCentroidAux[i];
-	}
-	
-	int iIterations = 0;
+	Matrix<float> mMeans(iGaussians,m_iDim);
+	gatherMeans(cluster,mMeans);
+
+	// (1) k-means clustering (it is used to initialize the clusters in order to speed up the EM convergence)	
 	float fDistortion1 = 0.0;
 	float fDistortion2 = 0.0;
-	float fDistortionPrevious = 0.0;
-	float fDistortionCurrent = 0.0;
-	double *dAccumulator1 = new double[m_iDim];
-	double *dAccumulator2 = new double[m_iDim];
 	int iClusterElements1 = 0;
 	int iClusterElements2 = 0;	
-	
-	// (1.2) iterative process assignment/update
-	do {
-		// initialization
-		fDistortion1 = 0.0;
-		fDistortion2 = 0.0;
-		for(int i=0;i<m_iDim;++i) {
-			dAccumulator1[i] = 0.0;
-			dAccumulator2[i] = 0.0;
-		}
-		iClusterElements1 = 0;
-		iClusterElements2 = 0;
-		fDistortionPrevious = fDistortionCurrent;
-		// assignment step: assign each gaussian to the closest cluster
-		for(VGaussianDecoding::iterator it = cluster->vGaussian.begin() ; it != cluster->vGaussian.end() ; ++it) {
-			float fDistance1 = euclideanDistance(fCentroid1,(*it)->fMean,fWeight);
-			float fDistance2 = euclideanDistance(fCentroid2,(*it)->fMean,fWeight);
-			if (fDistance1 < fDistance2) {
-				m_iGaussianBaseClass[(*it)->iId] = 0;
-				fDistortion1 += fDistance1;
-				for(int i=0;i<m_iDim;++i) {
-					dAccumulator1[i] += (*it)->fMean[i];
-				}	
-				iClusterElements1++;
-			} else {
-				m_iGaussianBaseClass[(*it)->iId] = 1;
-				fDistortion2 += fDistance2;
-				for(int i=0;i<m_iDim;++i) {
-					dAccumulator2[i] += (*it)->fMean[i];
-				}	
-				iClusterElements2++;
-			}	
-		}
-		// update step: update the centroids
-		for(int i=0;i<m_iDim;++i) {
-			fCentroid1[i] = (float)(dAccumulator1[i]/((float)iClusterElements1));
-			fCentroid2[i] = (float)(dAccumulator2[i]/((float)iClusterElements2));
-		}		
-		++iIterations;
-		//printf("iteration: %d distortion: %f (%d %d)\n",iIterations,fDistortion1+fDistortion2,iClusterElements1,iClusterElements2);
-		fDistortionCurrent = fDistortion1+fDistortion2;
-		
-	} while(fDistortionPrevious != fDistortionCurrent);
-	
-	delete [] fCentroid1;
-	delete [] fCentroid2;
-	delete [] fWeight;
+	kMeans(cluster,mMeans,&fDistortion1,&fDistortion2,&iClusterElements1,&iClusterElements2);
 	
 	// (2) initialize the mean and covariance to the cluster's, and compute the priors using the cluster elements count
 
@@ -606,6 +648,8 @@ bool RegressionTree::expectationMaximizationClustering(RTNode *cluster, int iMin
 	float *fMean2 = new float[m_iDim];
 	float *fCovariance1 = new float[m_iDim];	
 	float *fCovariance2 = new float[m_iDim];
+	float *fCovarianceInverse1 = new float[m_iDim];	
+	float *fCovarianceInverse2 = new float[m_iDim];
 	
 	// compute the initial priors
 	float fPrior1 = ((float)iClusterElements1)/((float)(iClusterElements1+iClusterElements2));
@@ -658,7 +702,13 @@ bool RegressionTree::expectationMaximizationClustering(RTNode *cluster, int iMin
 	float fLikelihoodGlobal1 = 0.0;
 	float fLikelihoodGlobal2 = 0.0;
 	
-	iIterations = 0;
+	// per-thread statistics
+	int iThreads = getThreads();
+	double *dStatisticsThread = new double[iThreads*4*m_iDim];
+	float *fStatisticsThread = new float[iThreads*5];
+	int *iElementsThread = new int[iThreads*2];
+	
+	int iIterations = 0;
 	do {
 	
 		fLikelihoodGlobalPrev = fLikelihoodGlobal;
@@ -673,55 +723,108 @@ bool RegressionTree::expectationMaximizationClustering(RTNode *cluster, int iMin
 		iElements1 = 0;
 		iElements2 = 0;
 		
-		for(int i=0 ; i<m_iDim ;++i) {
-			dObservation1[i] = 0.0;
-			dObservationSquare1[i] = 0.0;
-			dObservation2[i] = 0.0;
-			dObservationSquare2[i] = 0.0;
+		for(int i=0 ; i<iThreads*4*m_iDim ;++i) {
+			dStatisticsThread[i] = 0.0;
 		}	
+		for(int i=0 ; i<iThreads*5 ;++i) {
+			fStatisticsThread[i] = 0.0;
+		}	
+		for(int i=0 ; i<iThreads*2 ;++i) {
+			iElementsThread[i] = 0;
+		}
 		
-		float fResponsibility1;
-		float fResponsibility2;
+		// precompute the inverse covariances and normalization factors
+		double dNormalization1 = computeClusterNormalization(fCovariance1,fCovarianceInverse1);
+		double dNormalization2 = computeClusterNormalization(fCovariance2,fCovarianceInverse2);
 
 		// assignment step: there is a soft assignment of each gaussian to every cluster
-		for(VGaussianDecoding::iterator it = cluster->vGaussian.begin() ; it != cluster->vGaussian.end() ; ++it) {
-		
-			// compute the log-likelihood of the point
-			float fLikelihood1 = computeClusterLikelihood(fMean1,fCovariance1,(*it)->fMean);
-			float fLikelihood2 = computeClusterLikelihood(fMean2,fCovariance2,(*it)->fMean);	
-		
-			// compute the probability that the point (a gaussian mean) belongs to each cluster
-			fResponsibility1 = (fPrior1*fLikelihood1)/(fPrior1*fLikelihood1+fPrior2*fLikelihood2);
-			fResponsibility2 = 1.0f-fResponsibility1;
+		#pragma omp parallel num_threads(iThreads)
+		{
+			int iThread = getThreadId();
+			double *dObservationAux1 = dStatisticsThread+iThread*4*m_iDim;
+			double *dObservationSquareAux1 = dObservationAux1+m_iDim;
+			double *dObservationAux2 = dObservationAux1+2*m_iDim;
+			double *dObservationSquareAux2 = dObservationAux1+3*m_iDim;
+			float fOccupationAux1 = 0.0;
+			float fOccupationAux2 = 0.0;
+			float fLikelihoodAux = 0.0;
+			float fLikelihoodAux1 = 0.0;
+			float fLikelihoodAux2 = 0.0;
+			int iElementsAux1 = 0;
+			int iElementsAux2 = 0;
+			#pragma omp for schedule(static)
+			for(int iGaussian = 0 ; iGaussian < iGaussians ; ++iGaussian) {
 			
-			assert(fResponsibility1 <= 1.0f);
-			assert(fResponsibility1 >= 0.0f);
+				float *fMean = mMeans.getData()+iGaussian*mMeans.getStride();
+		
+				// compute the log-likelihood of the point
+				float fLikelihood1 = computeClusterLikelihood(fMean1,fCovarianceInverse1,dNormalization1,fMean);
+				float fLikelihood2 = computeClusterLikelihood(fMean2,fCovarianceInverse2,dNormalization2,fMean);	
 			
-			// accumulate data
-			for(int i=0 ; i<m_iDim ; ++i) {
-				dObservation1[i] += fResponsibility1*(*it)->fMean[i];
-				dObservationSquare1[i] += fResponsibility1*((*it)->fMean[i]*(*it)->fMean[i]);
-				dObservation2[i] += fResponsibility2*(*it)->fMean[i];
-				dObservationSquare2[i] += fResponsibility2*((*it)->fMean[i]*(*it)->fMean[i]);
+				// compute the probability that the point (a gaussian mean) belongs to each cluster
+				float fResponsibility1 = (fPrior1*fLikelihood1)/(fPrior1*fLikelihood1+fPrior2*fLikelihood2);
+				float fResponsibility2 = 1.0f-fResponsibility1;
+				
+				assert(fResponsibility1 <= 1.0f);
+				assert(fResponsibility1 >= 0.0f);
+				
+				// accumulate data
+				for(int i=0 ; i<m_iDim ; ++i) {
+					dObservationAux1[i] += fResponsibility1*fMean[i];
+					dObservationSquareAux1[i] += fResponsibility1*(fMean[i]*fMean[i]);
+					dObservationAux2[i] += fResponsibility2*fMean[i];
+					dObservationSquareAux2[i] += fResponsibility2*(fMean[i]*fMean[i]);
+				}
+				
+				// accumulate occupation
+				fOccupationAux1 += fResponsibility1;
+				fOccupationAux2 += fResponsibility2;
+				
+				// compute the likelihood of the datapoint
+				float fLikelihoodPoint = log(fPrior1*fLikelihood1+fPrior2*fLikelihood2);
+				
+				if (fResponsibility1 > fResponsibility2) {
+					fLikelihoodAux1 += fLikelihoodPoint;
+					m_iGaussianBaseClass[cluster->vGaussian[iGaussian]->iId] = 0;
+					++iElementsAux1;
+				} else {
+					fLikelihoodAux2 += fLikelihoodPoint;
+					m_iGaussianBaseClass[cluster->vGaussian[iGaussian]->iId] = 1;
+					++iElementsAux2;
+				}
+				fLikelihoodAux += fLikelihoodPoint;
 			}
-			
-			// accumulate occupation
-			fOccupation1 += fResponsibility1;
-			fOccupation2 += fResponsibility2;
-			
-			// compute the likelihood of the datapoint
-			float fLikelihoodPoint = log(fPrior1*fLikelihood1+fPrior2*fLikelihood2);
-			
-			if (fResponsibility1 > fResponsibility2) {
-				fLikelihoodGlobal1 += fLikelihoodPoint;
-				m_iGaussianBaseClass[(*it)->iId] = 0;
-				++iElements1;
-			} else {
-				fLikelihoodGlobal2 += fLikelihoodPoint;
-				m_iGaussianBaseClass[(*it)->iId] = 1;
-				++iElements2;
+			fStatisticsThread[iThread*5] = fOccupationAux1;
+			fStatisticsThread[iThread*5+1] = fOccupationAux2;
+			fStatisticsThread[iThread*5+2] = fLikelihoodAux;
+			fStatisticsThread[iThread*5+3] = fLikelihoodAux1;
+			fStatisticsThread[iThread*5+4] = fLikelihoodAux2;
+			iElementsThread[iThread*2] = iElementsAux1;
+			iElementsThread[iThread*2+1] = iElementsAux2;
+		}
+		
+		// reduce the per-thread statistics
+		for(int i=0 ; i<m_iDim ;++i) {
+			dObservation1[i] = 0.0;
+			dObservationSquare1[i] = 0.0;
+			dObservation2[i] = 0.0;
+			dObservationSquare2[i] = 0.0;
+		}
+		for(int iThread = 0 ; iThread < iThreads ; ++iThread) {
+			double *dStatistics = dStatisticsThread+iThread*4*m_iDim;
+			for(int i=0 ; i<m_iDim ;++i) {
+				dObservation1[i] += dStatistics[i];
+				dObservationSquare1[i] += dStatistics[m_iDim+i];
+				dObservation2[i] += dStatistics[2*m_iDim+i];
+				dObservationSquare2[i] += dStatistics[3*m_iDim+i];
 			}
-			fLikelihoodGlobal += fLikelihoodPoint;
+			fOccupation1 += fStatisticsThread[iThread*5];
+			fOccupation2 += fStatisticsThread[iThread*5+1];
+			fLikelihoodGlobal += fStatisticsThread[iThread*5+2];
+			fLikelihoodGlobal1 += fStatisticsThread[iThread*5+3];
+			fLikelihoodGlobal2 += fStatisticsThread[iThread*5+4];
+			iElements1 += iElementsThread[iThread*2];
+			iElements2 += iElementsThread[iThread*2+1];
 		}
 		
 		//printf("global likelihood: %12.2f\n",fLikelihoodGlobal);
@@ -749,13 +852,16 @@ bool RegressionTree::expectationMaximizationClustering(RTNode *cluster, int iMin
 	delete [] dObservationSquare1;
 	delete [] dObservation2;
 	delete [] dObservationSquare2;
-	delete [] dAccumulator1;
-	delete [] dAccumulator2;
+	delete [] dStatisticsThread;
+	delete [] fStatisticsThread;
+	delete [] iElementsThread;
 	
 	delete [] fMean1;
 	delete [] fMean2;
 	delete [] fCovariance1;
 	delete [] fCovariance2;
+	delete [] fCovarianceInverse1;
+	delete [] fCovarianceInverse2;
 	
 	// check that both clusters have enough number of elements
 	if ((iElements1 < iMinimumComponentsCluster) || 
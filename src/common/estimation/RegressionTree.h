@@ -199,12 +199,42 @@ class RegressionTree {
 		// counts the number of leaves in the tree (recursively)
 		int countLeaves(RTNode *rtNode);	
 		
+		// return the number of threads available for the clustering
+		int getThreads() {
+		
+		#ifdef _OPENMP
+			return omp_get_max_threads();
+		#else
+			return 1;
+		#endif
+		}
+		
+		// return the index of the calling thread
+		int getThreadId() {
+		
+		#ifdef _OPENMP
+			return omp_get_thread_num();
+		#else
+			return 0;
+		#endif
+		}
+		
+		// gather the means of the Gaussian components in the cluster into contiguous memory
+		void gatherMeans(RTNode *cluster, Matrix<float> &mMeans);
+		
+		// perform k-means (k=2) on the Gaussian means of the cluster, returns the number of iterations
+		int kMeans(RTNode *cluster, Matrix<float> &mMeans, float *fDistortion1, float *fDistortion2, 
+			int *iClusterElements1, int *iClusterElements2);
+		
 		// perform k-means to split a tree-node
 		// note: it returns the new tree-nodes as children of the given tree-node
 		bool kMeansClustering(RTNode *rtNode, int iMinimumComponentsCluster);
 		
+		// compute the inverse covariance of a cluster and the normalization factor of its likelihood
+		double computeClusterNormalization(float *fCovariance, float *fCovarianceInverse);
+		
 		// compute P(x|A)	
-		float computeClusterLikelihood(float *fMean, float *fCovariance, float *fX);
+		float computeClusterLikelihood(float *fMean, float *fCovarianceInverse, double dNormalization, float *fX);
 		
 		// perform EM clustering to split a tree-node
 		// note: it returns the new tree-nodes as children of the given tree-node
@@ -213,23 +243,9 @@ class RegressionTree {
 		// compute the weight vector for the computation of the weighted euclidean distance
 		float *computeWeight(RTNode *rtNode);
 		
-		// compute the euclidean distance between two vectors
-		// note: weight is optional
-		float euclideanDistance(float *fV1, float *fV2, float *fW = NULL) {
-		
-			float fAcc = 0.0;
-			float fAux;
-			for(int i=0 ; i<m_iDim ; ++i) {
-				fAux = fV1[i]-fV2[i];
-				if (fW) {
-					fAux *= fW[i];
-				}
-				fAcc += fAux*fAux;
-			}
-			fAcc /= ((float)m_iDim);
-			
-			return fAcc;
-		}	
+		// compute the weighted euclidean distance from a point to both centroids
+		void computeDistanceCentroids(float *fX, float *fCentroid1, float *fCentroid2, float *fWeight, 
+			float &fDistance1, float &fDistance2);
 		
 		// print the regression tree
 		void print();
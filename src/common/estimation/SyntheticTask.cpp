@@ -0,0 +1,400 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#include "SyntheticTask.h"
+#include "FileOutput.h"
+#include "FileUtils.h"
+#include "Gaussian.h"
+#include "GaussianMixture.h"
+#include "HMMManager.h"
+#include "HMMState.h"
+#include "LexiconManager.h"
+#include "LogMessage.h"
+#include "PhoneSet.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace Bavieca {
+
+// constructor
+SyntheticTask::SyntheticTask(const char *strFolder, int iPhones, int iWords, int iGaussians, unsigned int iSeed) {
+
+	m_strFolder = strFolder;
+	m_iPhones = iPhones;
+	m_iWords = iWords;
+	m_iGaussians = iGaussians;
+	m_iRandom = iSeed;
+	m_fMean = NULL;
+	m_fStd = NULL;
+}
+
+// destructor
+SyntheticTask::~SyntheticTask() {
+
+	if (m_fMean) {
+		delete [] m_fMean;
+		delete [] m_fStd;
+	}
+}
+
+// create the task files in the folder
+void SyntheticTask::create() {
+
+	if (FileUtils::createFolder(m_strFolder.c_str()) != RETURN_CODE_SUCCESS) {
+		BVC_ERROR << "unable to create the folder: " << m_strFolder;
+	}
+
+	// the order matters: the language model needs the lexicon and the lexicon needs the phone set
+	createPhoneSet();
+	createLexicon();
+	createLanguageModel();
+	createFeatureConfiguration();
+	createAcousticModels();
+	
+	BVC_VERB << "synthetic task created at: " << m_strFolder << " (phones: " << m_iPhones << 
+		", words: " << m_iWords << ", Gaussians/state: " << m_iGaussians << ")";
+}
+
+// return the name of a phone (index 0 is silence)
+string SyntheticTask::getPhoneName(int iPhone) {
+
+	if (iPhone == 0) {
+		return PHONETIC_SYMBOL_SILENCE;
+	}
+	ostringstream oss;
+	oss << "P" << setw(3) << setfill('0') << iPhone;
+	return oss.str();
+}
+
+// return the name of a word
+string SyntheticTask::getWordName(int iWord) {
+
+	ostringstream oss;
+	oss << "W" << setw(6) << setfill('0') << iWord;
+	return oss.str();
+}
+
+// create the phone set
+void SyntheticTask::createPhoneSet() {
+
+	FileOutput file(getFilePhoneSet().c_str(),false);
+	file.open();
+	file.getStream() << "# synthetic phone set" << endl;
+	for(int i=0 ; i <= m_iPhones ; ++i) {
+		file.getStream() << getPhoneName(i) << endl;
+	}
+	file.close();
+}
+
+// create the lexicon (pronunciations of 2 to 6 phones)
+void SyntheticTask::createLexicon() {
+
+	m_vPronunciation.clear();
+	FileOutput file(getFileLexicon().c_str(),false);
+	file.open();
+	file.getStream() << LEX_UNIT_SILENCE_SYMBOL << "\t" << PHONETIC_SYMBOL_SILENCE << endl;
+	for(int i=0 ; i < m_iWords ; ++i) {
+		vector<int> vPhones;
+		int iPhones = 2+random(5);
+		file.getStream() << getWordName(i) << "\t";
+		for(int j=0 ; j < iPhones ; ++j) {
+			vPhones.push_back(1+random(m_iPhones));
+			file.getStream() << getPhoneName(vPhones.back()) << ((j < iPhones-1) ? " " : "");
+		}
+		file.getStream() << endl;
+		m_vPronunciation.push_back(vPhones);
+	}
+	file.close();
+}
+
+// create a bigram language model in ARPA format
+// - unigrams follow a Zipf distribution
+// - each history has a few explicit successors that keep most of the probability mass
+void SyntheticTask::createLanguageModel() {
+
+	// n-grams need to be sorted by lexical unit id
+	PhoneSet phoneSet(getFilePhoneSet().c_str());
+	phoneSet.load();
+	LexiconManager lexiconManager(getFileLexicon().c_str(),&phoneSet);
+	lexiconManager.load();
+	
+	// words are represented by their index, sentence markers by m_iWords (<s>) and m_iWords+1 (</s>)
+	int iBegSentence = m_iWords;
+	int iEndSentence = m_iWords+1;
+	vector<string> vName;
+	vector<int> vId;
+	for(int i=0 ; i < m_iWords ; ++i) {
+		vName.push_back(getWordName(i));
+	}
+	vName.push_back(LEX_UNIT_BEG_SENTENCE);
+	vName.push_back(LEX_UNIT_END_SENTENCE);
+	for(unsigned int i=0 ; i < vName.size() ; ++i) {
+		vId.push_back(lexiconManager.getLexUnitId(vName[i].c_str()));
+		assert(vId.back() != -1);
+	}
+	
+	// unigrams
+	vector<pair<int,int> > vUnigrams;
+	double dNorm = 0.0;
+	for(int i=0 ; i < m_iWords ; ++i) {
+		dNorm += 1.0/(i+1.0);
+	}
+	for(int i=0 ; i < m_iWords+2 ; ++i) {
+		vUnigrams.push_back(pair<int,int>(vId[i],i));
+	}
+	sort(vUnigrams.begin(),vUnigrams.end());
+	
+	// bigrams: (history, successor)
+	m_vSuccessors.clear();
+	m_vSuccessors.resize(m_iWords+1);
+	vector<pair<pair<int,int>,pair<int,int> > > vBigrams;
+	for(int i=0 ; i <= m_iWords ; ++i) {
+		for(int j=0 ; j < SYNTHETIC_TASK_SUCCESSORS ; ++j) {
+			int iSuccessor = random(m_iWords);
+			if (find(m_vSuccessors[i].begin(),m_vSuccessors[i].end(),iSuccessor) == m_vSuccessors[i].end()) {
+				m_vSuccessors[i].push_back(iSuccessor);
+			}
+		}
+		vector<int> vSuccessors(m_vSuccessors[i]);
+		if (i != iBegSentence) {
+			vSuccessors.push_back(iEndSentence);
+		}
+		for(unsigned int j=0 ; j < vSuccessors.size() ; ++j) {
+			vBigrams.push_back(pair<pair<int,int>,pair<int,int> >(pair<int,int>(vId[i],vId[vSuccessors[j]]),
+				pair<int,int>(i,vSuccessors[j])));
+		}
+	}
+	sort(vBigrams.begin(),vBigrams.end());
+	
+	FileOutput file(getFileLanguageModel().c_str(),false);
+	file.open();
+	ostream &os = file.getStream();
+	os << "\\data\\" << endl;
+	os << "ngram 1=" << vUnigrams.size() << endl;
+	os << "ngram 2=" << vBigrams.size() << endl;
+	os << endl << "\\1-grams:" << endl;
+	for(unsigned int i=0 ; i < vUnigrams.size() ; ++i) {
+		int iWord = vUnigrams[i].second;
+		float fProb = -99.0;
+		if (iWord == iEndSentence) {
+			fProb = log10(0.05);
+		} else if (iWord != iBegSentence) {
+			fProb = (float)log10(0.95/((iWord+1.0)*dNorm));
+		}
+		os << FLT(8,4) << fProb << "\t" << vName[iWord];
+		if (iWord != iEndSentence) {
+			os << "\t" << FLT(8,4) << log10(0.4);
+		}
+		os << endl;
+	}
+	os << endl << "\\2-grams:" << endl;
+	for(unsigned int i=0 ; i < vBigrams.size() ; ++i) {
+		int iHistory = vBigrams[i].second.first;
+		int iWord = vBigrams[i].second.second;
+		// explicit successors keep 60% of the mass
+		float fProb = (float)log10(0.6/(m_vSuccessors[iHistory].size()+((iHistory != iBegSentence) ? 1 : 0)));
+		os << FLT(8,4) << fProb << "\t" << vName[iHistory] << " " << vName[iWord] << endl;
+	}
+	os << endl << "\\end\\" << endl;
+	file.close();
+}
+
+// create the feature configuration (MFCC, 39 coefficients)
+void SyntheticTask::createFeatureConfiguration() {
+
+	FileOutput file(getFileFeatureConfiguration().c_str(),false);
+	file.open();
+	ostream &os = file.getStream();
+	os << "waveform.samplingRate = 16000" << endl;
+	os << "waveform.sampleSize = 16" << endl;
+	os << "dcRemoval = yes" << endl;
+	os << "preemphasis = yes" << endl;
+	os << "window.width = 20" << endl;
+	os << "window.shift = 10" << endl;
+	os << "window.tapering = Hamming" << endl;
+	os << "features.type = mfcc" << endl;
+	os << "filterbank.frequency.min = 0" << endl;
+	os << "filterbank.frequency.max = 8000" << endl;
+	os << "filterbank.filters = 20" << endl;
+	os << "cepstralCoefficients = 12" << endl;
+	os << "energy = yes" << endl;
+	os << "derivatives.order = 2" << endl;
+	os << "derivatives.delta = 2" << endl;
+	file.close();
+}
+
+// create monophone acoustic models with random Gaussian mixtures
+// (the Gaussians of an HMM-state are spread around a random center)
+void SyntheticTask::createAcousticModels() {
+
+	int iDim = SYNTHETIC_TASK_DIMENSIONALITY;
+	int iHMMStates = (m_iPhones+1)*NUMBER_HMM_STATES;
+	m_fMean = new float[iHMMStates*m_iGaussians*iDim];
+	m_fStd = new float[iHMMStates*m_iGaussians*iDim];
+
+	PhoneSet phoneSet(getFilePhoneSet().c_str());
+	phoneSet.load();
+	HMMManager hmmManager(&phoneSet,HMM_PURPOSE_ESTIMATION);
+	hmmManager.createSingleGaussianMonophoneModelsPrototype(iDim,COVARIANCE_MODELLING_TYPE_DIAGONAL,m_iGaussians);
+	
+	int iHMMStatesManager = -1;
+	HMMState **hmmStates = hmmManager.getHMMStates(&iHMMStatesManager);
+	assert(iHMMStatesManager == iHMMStates);
+	float *fCenter = new float[iDim];
+	for(int i=0 ; i < iHMMStates ; ++i) {
+		// the phone index in the phone set may differ from the one used to create it
+		int iPhone = phoneSet.getPhoneIndex(getPhoneName(i/NUMBER_HMM_STATES).c_str());
+		assert(iPhone != -1);
+		HMMState *hmmState = hmmStates[iPhone*NUMBER_HMM_STATES+(i%NUMBER_HMM_STATES)];
+		for(int d=0 ; d < iDim ; ++d) {
+			fCenter[d] = 2.0f*randomNormal();
+		}
+		for(int g=0 ; g < m_iGaussians ; ++g) {
+			Gaussian *gaussian = hmmState->getMixture()(g);
+			float *fMean = m_fMean+(i*m_iGaussians+g)*iDim;
+			float *fStd = m_fStd+(i*m_iGaussians+g)*iDim;
+			for(int d=0 ; d < iDim ; ++d) {
+				fMean[d] = fCenter[d]+0.5f*randomNormal();
+				fStd[d] = 0.5f+0.5f*random();
+				gaussian->mean()(d) = fMean[d];
+				gaussian->covarianceDiag()(d) = fStd[d]*fStd[d];
+			}
+			gaussian->weight() = 1.0f/((float)m_iGaussians);
+		}
+	}
+	delete [] fCenter;
+	
+	hmmManager.setSingleGaussian(m_iGaussians == 1);
+	hmmManager.setInitialized(true);
+	hmmManager.store(getFileAcousticModels().c_str());
+}
+
+// sample feature vectors for an HMM-state (phone index as used to create the models)
+void SyntheticTask::sample(Matrix<float> &mFeatures, int &iFrame, int iPhone, int iState, int iFrames) {
+
+	int iDim = SYNTHETIC_TASK_DIMENSIONALITY;
+	int iHMMState = iPhone*NUMBER_HMM_STATES+iState;
+	for(int t=0 ; t < iFrames ; ++t, ++iFrame) {
+		int g = random(m_iGaussians);
+		float *fMean = m_fMean+(iHMMState*m_iGaussians+g)*iDim;
+		float *fStd = m_fStd+(iHMMState*m_iGaussians+g)*iDim;
+		for(int d=0 ; d < iDim ; ++d) {
+			mFeatures(iFrame,d) = fMean[d]+fStd[d]*randomNormal();
+		}
+	}
+}
+
+// generate an utterance, returns the feature vectors and the transcription
+// - words follow the explicit bigrams most of the time
+// - HMM-states last from 2 to 5 frames and the utterance is surrounded by silence
+Matrix<float> *SyntheticTask::generateUtterance(int iWords, string &strTranscription) {
+
+	assert(m_fMean);
+
+	// (1) word sequence and segmentation into (phone,state,frames)
+	vector<int> vSegments;
+	ostringstream oss;
+	int iFrames = 0;
+	int iWordPrev = m_iWords;
+	for(int i=-1 ; i <= iWords ; ++i) {
+		// silence at the edges of the utterance
+		if ((i == -1) || (i == iWords)) {
+			for(int s=0 ; s < NUMBER_HMM_STATES ; ++s) {
+				vSegments.push_back(0);
+				vSegments.push_back(s);
+				vSegments.push_back(5+random(6));
+				iFrames += vSegments.back();
+			}
+			continue;
+		}
+		int iWord = ((random() < 0.8) && (!m_vSuccessors[iWordPrev].empty())) ? 
+			m_vSuccessors[iWordPrev][random(m_vSuccessors[iWordPrev].size())] : random(m_iWords);
+		oss << ((i > 0) ? " " : "") << getWordName(iWord);
+		for(unsigned int j=0 ; j < m_vPronunciation[iWord].size() ; ++j) {
+			for(int s=0 ; s < NUMBER_HMM_STATES ; ++s) {
+				vSegments.push_back(m_vPronunciation[iWord][j]);
+				vSegments.push_back(s);
+				vSegments.push_back(2+random(4));
+				iFrames += vSegments.back();
+			}
+		}
+		iWordPrev = iWord;
+	}
+	strTranscription = oss.str();
+	
+	// (2) sample the feature vectors
+	Matrix<float> *mFeatures = new Matrix<float>(iFrames,SYNTHETIC_TASK_DIMENSIONALITY);
+	int iFrame = 0;
+	for(unsigned int i=0 ; i < vSegments.size() ; i += 3) {
+		sample(*mFeatures,iFrame,vSegments[i],vSegments[i+1],vSegments[i+2]);
+	}
+	assert(iFrame == iFrames);
+	
+	return mFeatures;
+}
+
+// generate audio samples (16kHz, 16 bits): a tone with random pitch changes plus noise
+short *SyntheticTask::generateAudio(int iSamples) {
+
+	short *sSamples = new short[iSamples];
+	float fPhase = 0.0;
+	float fFrequency = 100.0;
+	for(int i=0 ; i < iSamples ; ++i) {
+		if (i%1600 == 0) {
+			fFrequency = 100.0f+300.0f*random();
+		}
+		fPhase += 2.0f*(float)PI_NUMBER*fFrequency/16000.0f;
+		sSamples[i] = (short)(3000.0f*sin(fPhase)+500.0f*randomNormal());
+	}
+	
+	return sSamples;
+}
+
+// return the phone set file
+string SyntheticTask::getFilePhoneSet() {
+
+	return m_strFolder+PATH_SEPARATOR+"phoneset.txt";
+}
+
+// return the lexicon file
+string SyntheticTask::getFileLexicon() {
+
+	return m_strFolder+PATH_SEPARATOR+"lexicon.txt";
+}
+
+// return the language model file
+string SyntheticTask::getFileLanguageModel() {
+
+	return m_strFolder+PATH_SEPARATOR+"lm.arpa";
+}
+
+// return the feature configuration file
+string SyntheticTask::getFileFeatureConfiguration() {
+
+	return m_strFolder+PATH_SEPARATOR+"features.cfg";
+}
+
+// return the acoustic models file
+string SyntheticTask::getFileAcousticModels() {
+
+	return m_strFolder+PATH_SEPARATOR+"models.bin";
+}
+
+};	// end-of-namespace
@@ -0,0 +1,132 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#ifndef SYNTHETICTASK_H
+#define SYNTHETICTASK_H
+
+using namespace std;
+
+#include <string>
+#include <algorithm>
+#include <vector>
+
+#include "Global.h"
+#include "Matrix.h"
+
+namespace Bavieca {
+
+// feature dimensionality of the synthetic task (12 cepstral coefficients + energy + 2 derivatives)
+#define SYNTHETIC_TASK_DIMENSIONALITY				39
+
+// default size of the synthetic task
+#define SYNTHETIC_TASK_PHONES_DEFAULT				40
+#define SYNTHETIC_TASK_WORDS_DEFAULT				5000
+#define SYNTHETIC_TASK_GAUSSIANS_DEFAULT			16
+#define SYNTHETIC_TASK_SUCCESSORS					20		// word successors with an explicit bigram
+
+/**
+	@author daniel <dani.bolanos@gmail.com>
+	
+	Synthetic recognition task for benchmarking: a phone set, a lexicon, a bigram ARPA language model, 
+	a feature configuration and monophone acoustic models with random Gaussian mixtures. Utterances are 
+	generated by sampling feature vectors from the acoustic models along random word sequences, so the 
+	decoder faces a realistic search problem and the transcription is known. The same seed produces the 
+	same task on every platform (it does not rely on rand()).
+*/
+class SyntheticTask {
+
+	private:
+	
+		string m_strFolder;					// folder where the task files are created
+		int m_iPhones;							// number of phones (silence not included)
+		int m_iWords;							// vocabulary size
+		int m_iGaussians;						// Gaussian components per HMM-state
+		unsigned int m_iRandom;				// state of the random number generator
+		
+		// model parameters used to sample feature vectors [phone x state x Gaussian x dimension]
+		float *m_fMean;
+		float *m_fStd;
+		
+		// pronunciations and successors of each word
+		vector<vector<int> > m_vPronunciation;
+		vector<vector<int> > m_vSuccessors;
+		
+		// uniform random number in [0,1)
+		inline float random() {
+		
+			m_iRandom = m_iRandom*1664525u+1013904223u;
+			return ((float)(m_iRandom >> 8))/16777216.0f;
+		}
+		
+		// random integer in [0,iMax)
+		inline int random(int iMax) {
+		
+			return std::min((int)(random()*iMax),iMax-1);
+		}
+		
+		// standard normal random number (Box-Muller)
+		inline float randomNormal() {
+		
+			float fU1 = std::max(random(),1.0e-7f);
+			float fU2 = random();
+			return sqrt(-2.0f*log(fU1))*cos(2.0f*(float)PI_NUMBER*fU2);
+		}
+		
+		// return the name of a phone/word
+		string getPhoneName(int iPhone);
+		string getWordName(int iWord);
+		
+		// create the files
+		void createPhoneSet();
+		void createLexicon();
+		void createLanguageModel();
+		void createFeatureConfiguration();
+		void createAcousticModels();
+		
+		// sample feature vectors for an HMM-state
+		void sample(Matrix<float> &mFeatures, int &iFrame, int iPhone, int iState, int iFrames);
+
+	public:
+
+		// constructor
+		SyntheticTask(const char *strFolder, int iPhones, int iWords, int iGaussians, unsigned int iSeed);
+
+		// destructor
+		~SyntheticTask();
+		
+		// create the task files in the folder
+		void create();
+		
+		// generate an utterance, returns the feature vectors and the transcription
+		Matrix<float> *generateUtterance(int iWords, string &strTranscription);
+		
+		// generate audio samples (16kHz, 16 bits) 
+		short *generateAudio(int iSamples);
+		
+		// return the task files
+		string getFilePhoneSet();
+		string getFileLexicon();
+		string getFileLanguageModel();
+		string getFileFeatureConfiguration();
+		string getFileAcousticModels();
+};
+
+};	// end-of-namespace
+
+#endif
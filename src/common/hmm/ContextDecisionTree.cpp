@@ -428,26 +428,42 @@ void ContextDecisionTree::clusterNode(DTNode *node, float fMinimumClusterOccupat
 	Rule *ruleBest = NULL;
 	int iRuleBest = -1;
 	
-	// (1) apply all the available rules and keep the best rule
-	for(int iRule = 0 ; iRule < node->iRules ; ++iRule) {
-		if (node->rules[iRule] == NULL) {
-			continue;
-		}
-		// positive answer
-		bool bYes = computeLikelihoodRule(node,node->rules[iRule],true,&dLikelihoodRuleYes,&dOccupationRuleYes,fMinimumClusterOccupation);
-		if (bYes == false) {
-			continue;
+	// (1) apply all the available rules (in parallel if enabled), each rule is evaluated on the node statistics
+	// gathered into contiguous memory
+	DTNodeStatistics statistics;
+	gatherStatistics(node,statistics);
+	DTSplit *splits = new DTSplit[node->iRules];
+	#pragma omp parallel
+	{
+		// thread-local work vectors
+		Vector<double> vObservation(m_iDim);
+		Vector<double> vObservationSquare(m_iDim);
+		Vector<double> vMean(m_iDim);
+		Vector<double> vCovariance(m_iDim);
+		#pragma omp for schedule(dynamic)
+		for(int iRule = 0 ; iRule < node->iRules ; ++iRule) {
+			if (node->rules[iRule] == NULL) {
+				splits[iRule].bApplicable = false;
+				continue;
+			}
+			evaluateRule(node,node->rules[iRule],statistics,fMinimumClusterOccupation,vObservation,
+				vObservationSquare,vMean,vCovariance,splits[iRule]);
 		}
-		// negative answer
-		bool bNo = computeLikelihoodRule(node,node->rules[iRule],false,&dLikelihoodRuleNo,&dOccupationRuleNo,fMinimumClusterOccupation);
-		if (bNo == false) {
+	}
+	delete [] statistics.accumulators;
+	delete [] statistics.dObservation;
+	delete [] statistics.dObservationSquare;
+	delete [] statistics.dOccupation;
+	
+	// (2) keep the best rule (rules are visited in order so ties are resolved as in the serial search)
+	for(int iRule = 0 ; iRule < node->iRules ; ++iRule) {
+		if (splits[iRule].bApplicable == false) {
 			continue;
 		}
-		/*bool b = computeLikelihoodRule(node,node->rules[iRule],&fLikelihoodRuleYes,&fLikelihoodRuleNo,&fOccupationRuleYes,&fOccupationRuleNo,fMinimumClusterOccupation,fCovarianceGlobal);
-		if (b == false) {
-			continue;
-		}*/
-		//printf("rule likelihood: %.4f (%.4f %.4f)\n",node->fLikelihood,fLikelihoodRuleYes,fLikelihoodRuleNo);
+		dLikelihoodRuleYes = splits[iRule].dLikelihoodYes;
+		dLikelihoodRuleNo = splits[iRule].dLikelihoodNo;
+		dOccupationRuleYes = splits[iRule].dOccupationYes;
+		dOccupationRuleNo = splits[iRule].dOccupationNo;
 		// keep the best rule
 		if ((dLikelihoodRuleYes + dLikelihoodRuleNo) > dLikelihoodRuleBest) {	
 			dLikelihoodRuleBest = (dLikelihoodRuleYes + dLikelihoodRuleNo);
@@ -459,8 +475,9 @@ void ContextDecisionTree::clusterNode(DTNode *node, float fMinimumClusterOccupat
 			iRuleBest = iRule;
 		}
 	}
+	delete [] splits;
 	
-	// (2) apply the best split if it is good enough and continue with the clustering, otherwise end it
+	// (3) apply the best split if it is good enough and continue with the clustering, otherwise end it
 	
 	// if no rule could be applied, end the clustering
 	if (ruleBest == NULL) {
@@ -551,6 +568,76 @@ void ContextDecisionTree::clusterNode(DTNode *node, float fMinimumClusterOccupat
 	// (3) additionally, when the number of leaves reaches a certain maximum value
 }
 
+// gather the statistics of the accumulators in the node
+void ContextDecisionTree::gatherStatistics(DTNode *node, DTNodeStatistics &statistics) {
+
+	statistics.iAccumulators = 0;
+	for(Accumulator *accumulator = node->accumulator ; accumulator != NULL ; accumulator = accumulator->getNext()) {
+		++statistics.iAccumulators;
+	}
+	statistics.accumulators = new Accumulator*[statistics.iAccumulators];
+	statistics.dObservation = new double[statistics.iAccumulators*m_iDim];
+	statistics.dObservationSquare = new double[statistics.iAccumulators*m_iDim];
+	statistics.dOccupation = new double[statistics.iAccumulators];
+	int iAccumulator = 0;
+	for(Accumulator *accumulator = node->accumulator ; accumulator != NULL ; accumulator = accumulator->getNext()) {
+		statistics.accumulators[iAccumulator] = accumulator;
+		memcpy(statistics.dObservation+iAccumulator*m_iDim,accumulator->getObservation().getData(),m_iDim*sizeof(double));
+		memcpy(statistics.dObservationSquare+iAccumulator*m_iDim,accumulator->getObservationSquareDiag().getData(),
+			m_iDim*sizeof(double));
+		statistics.dOccupation[iAccumulator] = accumulator->getOccupation();
+		++iAccumulator;
+	}
+}
+
+// evaluate a rule using the gathered node statistics (thread-safe, the result is identical to that of 
+// computeLikelihoodRule since the statistics are added up in the same order)
+void ContextDecisionTree::evaluateRule(DTNode *node, Rule *rule, DTNodeStatistics &statistics, 
+	float fMinimumClusterOccupation, Vector<double> &vObservation, Vector<double> &vObservationSquare, 
+	Vector<double> &vMean, Vector<double> &vCovariance, DTSplit &split) {
+
+	split.bApplicable = false;
+	
+	// positive answer first, then negative answer
+	for(int iAnswer = 0 ; iAnswer < 2 ; ++iAnswer) {
+	
+		bool bAnswer = (iAnswer == 0);
+		
+		// (1) accumulate data for the new cluster
+		vObservation.zero();
+		vObservationSquare.zero();
+		double dOccupation = 0.0;
+		for(int i=0 ; i < statistics.iAccumulators ; ++i) {
+			if (question(rule,statistics.accumulators[i]) == bAnswer) {
+				double *dObservation = statistics.dObservation+i*m_iDim;
+				double *dObservationSquare = statistics.dObservationSquare+i*m_iDim;
+				for(int j=0 ; j < m_iDim ; ++j) {
+					vObservation(j) += dObservation[j];
+					vObservationSquare(j) += dObservationSquare[j];
+				}
+				dOccupation += statistics.dOccupation[i];
+			}
+		}
+		bAnswer ? split.dOccupationYes = dOccupation : split.dOccupationNo = dOccupation;
+		// check minimum and maximum occupation 
+		if ((dOccupation < fMinimumClusterOccupation) || 
+			(dOccupation > (node->dOccupation-fMinimumClusterOccupation))) {
+			return;
+		}
+		
+		// (2) compute the mean and covariance of the new cluster	
+		vMean.mul(1.0/dOccupation,vObservation);	
+		vCovariance.mul(1.0/dOccupation,vObservationSquare);
+		vCovariance.addSquare(-1.0,vMean);
+		
+		// (3) compute the likelihood of the new cluster
+		double dLikelihood = computeLikelihoodCluster(dOccupation,vCovariance);
+		bAnswer ? split.dLikelihoodYes = dLikelihood : split.dLikelihoodNo = dLikelihood;
+	}
+	
+	split.bApplicable = true;
+}
+
 // compute the likelihood of a cluster of context dependent units 
 void ContextDecisionTree::computeLikelihoodCluster(DTNode *node, double *dLikelihoodCluster, double *dOccupationCluster, Vector<float> &vCovarianceGlobal) {
 
@@ -71,6 +71,25 @@ typedef struct _DTNode {
 
 typedef list<DTNode*> LDTNode;
 
+// sufficient statistics of the accumulators in a node, gathered into contiguous memory (in list order) so 
+// the rules can be evaluated in parallel
+typedef struct {
+	int iAccumulators;					// number of accumulators in the node
+	Accumulator **accumulators;		// accumulators (same order as in the node list)
+	double *dObservation;				// first order statistics (one row per accumulator)
+	double *dObservationSquare;		// second order statistics (one row per accumulator)
+	double *dOccupation;					// occupation of each accumulator
+} DTNodeStatistics;
+
+// result of applying a rule to a node
+typedef struct {
+	bool bApplicable;						// whether both clusters have enough data
+	double dLikelihoodYes;
+	double dLikelihoodNo;
+	double dOccupationYes;
+	double dOccupationNo;
+} DTSplit;
+
 /**
 	@author daniel <dani.bolanos@gmail.com>
 */
@@ -126,6 +145,15 @@ class ContextDecisionTree {
 		// check tree consistency
 		bool checkConsistency(DTNode *node);
 		
+		// gather the statistics of the accumulators in the node
+		void gatherStatistics(DTNode *node, DTNodeStatistics &statistics);
+		
+		// evaluate a rule using the gathered node statistics (thread-safe, the result is identical to that of 
+		// computeLikelihoodRule)
+		void evaluateRule(DTNode *node, Rule *rule, DTNodeStatistics &statistics, float fMinimumClusterOccupation, 
+			Vector<double> &vObservation, Vector<double> &vObservationSquare, Vector<double> &vMean, 
+			Vector<double> &vCovariance, DTSplit &split);
+		
 	public:
 
 		// constructor
@@ -0,0 +1,331 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#include "GaussianQuantizer.h"
+#include "HMMManager.h"
+#include "LogMessage.h"
+
+#include <iomanip>
+#include <limits.h>
+#include <string.h>
+
+// support for SIMD instructions (integer)
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace Bavieca {
+
+// constructor
+GaussianQuantizer::GaussianQuantizer(HMMManager *hmmManager, int iType) {
+
+	assert((iType == GAUSSIAN_QUANTIZATION_INT8) || (iType == GAUSSIAN_QUANTIZATION_INT16));
+
+	m_hmmManager = hmmManager;
+	m_iType = iType;
+	m_iDim = m_hmmManager->getFeatureDim();
+	m_iDimPadded = ((m_iDim+GAUSSIAN_QUANTIZATION_BLOCK-1)/GAUSSIAN_QUANTIZATION_BLOCK)*GAUSSIAN_QUANTIZATION_BLOCK;
+	m_iHMMStates = 0;
+	m_iGaussians = 0;
+	m_iGaussianOffset = NULL;
+	m_fConstant = NULL;
+	m_cParameters = NULL;
+	m_iBytesGaussian = 2*m_iDimPadded*((m_iType == GAUSSIAN_QUANTIZATION_INT8) ? sizeof(char) : sizeof(short));
+	m_fMeanOffset = new float[m_iDimPadded];
+	m_fMeanScale = new float[m_iDimPadded];
+	m_fPrecisionOffset = new float[m_iDimPadded];
+	m_fPrecisionScale = new float[m_iDimPadded];
+	m_fFeatures = new float[m_iDimPadded];
+	m_iTime = -1;
+	m_fErrorMean = 0.0;
+	m_fErrorPrecision = 0.0;
+}
+
+// destructor
+GaussianQuantizer::~GaussianQuantizer() {
+
+	if (m_cParameters) {
+		delete [] m_iGaussianOffset;
+		delete [] m_fConstant;
+		delete [] m_cParameters;
+	}
+	delete [] m_fMeanOffset;
+	delete [] m_fMeanScale;
+	delete [] m_fPrecisionOffset;
+	delete [] m_fPrecisionScale;
+	delete [] m_fFeatures;
+}
+
+// return the quantization type from its string representation
+int GaussianQuantizer::getType(const char *strType) {
+
+	if (strcmp(strType,STR_GAUSSIAN_QUANTIZATION_NONE) == 0) {
+		return GAUSSIAN_QUANTIZATION_NONE;
+	} else if (strcmp(strType,STR_GAUSSIAN_QUANTIZATION_INT8) == 0) {
+		return GAUSSIAN_QUANTIZATION_INT8;
+	} else if (strcmp(strType,STR_GAUSSIAN_QUANTIZATION_INT16) == 0) {
+		return GAUSSIAN_QUANTIZATION_INT16;
+	} else {
+		BVC_ERROR << "unknown Gaussian quantization type: " << strType;
+	}
+	
+	return -1;
+}
+
+// return the string representation of the quantization type
+const char *GaussianQuantizer::getStrType(int iType) {
+
+	switch(iType) {
+		case GAUSSIAN_QUANTIZATION_INT8: return STR_GAUSSIAN_QUANTIZATION_INT8;
+		case GAUSSIAN_QUANTIZATION_INT16: return STR_GAUSSIAN_QUANTIZATION_INT16;
+		default: return STR_GAUSSIAN_QUANTIZATION_NONE;
+	}
+}
+
+// quantize the Gaussian parameters (HMMs need to be initialized for decoding)
+void GaussianQuantizer::build() {
+
+	assert(m_cParameters == NULL);
+
+	HMMStateDecoding *hmmStates = m_hmmManager->getHMMStatesDecoding(&m_iHMMStates);
+	
+	// gather the Gaussian components
+	m_iGaussianOffset = new int[m_iHMMStates+1];
+	m_iGaussians = 0;
+	for(int i=0 ; i < m_iHMMStates ; ++i) {
+		m_iGaussianOffset[i] = m_iGaussians;
+		m_iGaussians += hmmStates[i].getGaussianComponents();
+	}
+	m_iGaussianOffset[m_iHMMStates] = m_iGaussians;
+	GaussianDecoding **gaussians = new GaussianDecoding*[m_iGaussians];
+	for(int i=0 ; i < m_iHMMStates ; ++i) {
+		int iComponents = 0;
+		GaussianDecoding *gaussiansState = hmmStates[i].getGaussians(iComponents);
+		for(int j=0 ; j < iComponents ; ++j) {
+			gaussians[m_iGaussianOffset[i]+j] = gaussiansState+j;
+		}
+	}
+	
+	// the precision is kept as the inverted standard deviation expressed in the units of the mean grid,
+	// so that the distance only needs one subtraction and one product per dimension
+	// (covariances are already inverted and divided by two)
+	float fIntegerMax = (m_iType == GAUSSIAN_QUANTIZATION_INT8) ? (float)SCHAR_MAX : (float)SHRT_MAX;
+	for(int j=0 ; j < m_iDimPadded ; ++j) {
+		
+		// padding: contributes nothing to the distance
+		if (j >= m_iDim) {
+			m_fMeanOffset[j] = 0.0;
+			m_fMeanScale[j] = 1.0;
+			m_fPrecisionOffset[j] = 0.0;
+			m_fPrecisionScale[j] = 0.0;
+			continue;
+		}
+	
+		// means
+		float fMin = FLT_MAX;
+		float fMax = -FLT_MAX;
+		for(int i=0 ; i < m_iGaussians ; ++i) {
+			fMin = min(fMin,gaussians[i]->fMean[j]);
+			fMax = max(fMax,gaussians[i]->fMean[j]);
+		}
+		m_fMeanOffset[j] = (fMax+fMin)/2.0f;
+		m_fMeanScale[j] = (fMax > fMin) ? (fMax-fMin)/(2.0f*fIntegerMax) : 1.0f;
+		
+		// precisions
+		fMin = FLT_MAX;
+		fMax = -FLT_MAX;
+		for(int i=0 ; i < m_iGaussians ; ++i) {
+			float fPrecision = sqrt(gaussians[i]->fCovariance[j])*m_fMeanScale[j];
+			fMin = min(fMin,fPrecision);
+			fMax = max(fMax,fPrecision);
+		}
+		m_fPrecisionOffset[j] = (fMax+fMin)/2.0f;
+		m_fPrecisionScale[j] = (fMax > fMin) ? (fMax-fMin)/(2.0f*fIntegerMax) : 1.0f;
+	}
+	
+	// quantize the parameters
+	m_fConstant = new float[m_iGaussians];
+	m_cParameters = new char[m_iGaussians*m_iBytesGaussian];
+	memset(m_cParameters,0,m_iGaussians*m_iBytesGaussian);
+	double dErrorMean = 0.0;
+	double dErrorPrecision = 0.0;
+	for(int i=0 ; i < m_iGaussians ; ++i) {
+		m_fConstant[i] = gaussians[i]->fConstant;
+		signed char *cParameters = (signed char*)(m_cParameters+i*m_iBytesGaussian);
+		short *sParameters = (short*)(m_cParameters+i*m_iBytesGaussian);
+		for(int j=0 ; j < m_iDim ; ++j) {
+			float fStdInv = sqrt(gaussians[i]->fCovariance[j]);
+			float fMean = (gaussians[i]->fMean[j]-m_fMeanOffset[j])/m_fMeanScale[j];
+			float fStdQ = (fStdInv*m_fMeanScale[j]-m_fPrecisionOffset[j])/m_fPrecisionScale[j];
+			fMean = max(-fIntegerMax,min(fIntegerMax,floor(fMean+0.5f)));
+			fStdQ = max(-fIntegerMax,min(fIntegerMax,floor(fStdQ+0.5f)));
+			if (m_iType == GAUSSIAN_QUANTIZATION_INT8) {
+				cParameters[j] = (signed char)fMean;
+				cParameters[m_iDimPadded+j] = (signed char)fStdQ;
+			} else {
+				sParameters[j] = (short)fMean;
+				sParameters[m_iDimPadded+j] = (short)fStdQ;
+			}
+			// quantization errors: mean error in standard deviations and relative precision error
+			float fMeanDQ = m_fMeanOffset[j]+m_fMeanScale[j]*fMean;
+			float fStdInvDQ = (m_fPrecisionOffset[j]+m_fPrecisionScale[j]*fStdQ)/m_fMeanScale[j];
+			dErrorMean += fabs(gaussians[i]->fMean[j]-fMeanDQ)*fStdInv*sqrt(2.0);
+			dErrorPrecision += fabs(fStdInvDQ-fStdInv)/fStdInv;
+		}
+	}
+	m_fErrorMean = (float)(dErrorMean/((double)(m_iGaussians*m_iDim)));
+	m_fErrorPrecision = (float)(dErrorPrecision/((double)(m_iGaussians*m_iDim)));
+	
+	delete [] gaussians;
+}
+
+// map the feature vector onto the grid of the means
+void GaussianQuantizer::mapFeatures(float *fFeatures) {
+
+	for(int j=0 ; j < m_iDim ; ++j) {
+		m_fFeatures[j] = (fFeatures[j]-m_fMeanOffset[j])/m_fMeanScale[j];
+	}
+	for(int j=m_iDim ; j < m_iDimPadded ; ++j) {
+		m_fFeatures[j] = 0.0;
+	}
+}
+
+#ifdef __SSE2__
+
+// accumulate the weighted distance for a block of 8 dimensions given the widened means and precisions
+static inline __m128 accumulateBlock(__m128i mean, __m128i precision, const float *fFeatures, 
+	const float *fPrecisionOffset, const float *fPrecisionScale, __m128 acc) {
+
+	// sign extension from 16 to 32 bits
+	__m128 meanLo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(mean,mean),16));
+	__m128 meanHi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(mean,mean),16));
+	__m128 precLo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(precision,precision),16));
+	__m128 precHi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(precision,precision),16));
+	
+	precLo = _mm_add_ps(_mm_loadu_ps(fPrecisionOffset),_mm_mul_ps(_mm_loadu_ps(fPrecisionScale),precLo));
+	precHi = _mm_add_ps(_mm_loadu_ps(fPrecisionOffset+4),_mm_mul_ps(_mm_loadu_ps(fPrecisionScale+4),precHi));
+	__m128 diffLo = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(fFeatures),meanLo),precLo);
+	__m128 diffHi = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(fFeatures+4),meanHi),precHi);
+	acc = _mm_add_ps(acc,_mm_mul_ps(diffLo,diffLo));
+	acc = _mm_add_ps(acc,_mm_mul_ps(diffHi,diffHi));
+	
+	return acc;
+}
+
+// horizontal sum
+static inline float sumBlock(__m128 acc) {
+
+	float f[4];
+	_mm_storeu_ps(f,acc);
+	
+	return f[0]+f[1]+f[2]+f[3];
+}
+
+#endif
+
+// return the weighted distance between the mapped features and a Gaussian (int8)
+inline float GaussianQuantizer::computeDistanceInt8(const signed char *cParameters) {
+
+#ifdef __SSE2__
+	__m128 acc = _mm_setzero_ps();
+	for(int j=0 ; j < m_iDimPadded ; j += GAUSSIAN_QUANTIZATION_BLOCK) {
+		// sign extension from 8 to 16 bits
+		__m128i mean = _mm_loadl_epi64((const __m128i*)(cParameters+j));
+		__m128i precision = _mm_loadl_epi64((const __m128i*)(cParameters+m_iDimPadded+j));
+		mean = _mm_srai_epi16(_mm_unpacklo_epi8(mean,mean),8);
+		precision = _mm_srai_epi16(_mm_unpacklo_epi8(precision,precision),8);
+		acc = accumulateBlock(mean,precision,m_fFeatures+j,m_fPrecisionOffset+j,m_fPrecisionScale+j,acc);
+	}
+	
+	return sumBlock(acc);
+#else
+	float fDistance = 0.0;
+	for(int j=0 ; j < m_iDim ; ++j) {
+		float fDiff = (m_fFeatures[j]-cParameters[j])*
+			(m_fPrecisionOffset[j]+m_fPrecisionScale[j]*cParameters[m_iDimPadded+j]);
+		fDistance += fDiff*fDiff;
+	}
+	
+	return fDistance;
+#endif
+}
+
+// return the weighted distance between the mapped features and a Gaussian (int16)
+inline float GaussianQuantizer::computeDistanceInt16(const short *sParameters) {
+
+#ifdef __SSE2__
+	__m128 acc = _mm_setzero_ps();
+	for(int j=0 ; j < m_iDimPadded ; j += GAUSSIAN_QUANTIZATION_BLOCK) {
+		__m128i mean = _mm_loadu_si128((const __m128i*)(sParameters+j));
+		__m128i precision = _mm_loadu_si128((const __m128i*)(sParameters+m_iDimPadded+j));
+		acc = accumulateBlock(mean,precision,m_fFeatures+j,m_fPrecisionOffset+j,m_fPrecisionScale+j,acc);
+	}
+	
+	return sumBlock(acc);
+#else
+	float fDistance = 0.0;
+	for(int j=0 ; j < m_iDim ; ++j) {
+		float fDiff = (m_fFeatures[j]-sParameters[j])*
+			(m_fPrecisionOffset[j]+m_fPrecisionScale[j]*sParameters[m_iDimPadded+j]);
+		fDistance += fDiff*fDiff;
+	}
+	
+	return fDistance;
+#endif
+}
+
+// return the log-likelihood of the HMM-state for the given feature vector (nearest-neighbor approximation)
+// only the given components are evaluated if a shortlist is given
+float GaussianQuantizer::computeLogLikelihood(int iHMMState, float *fFeatures, int iTime, 
+	unsigned short *iShortlist, int iGaussians) {
+
+	if (iTime != m_iTime) {
+		mapFeatures(fFeatures);
+		m_iTime = iTime;
+	}
+	
+	int iGaussianFirst = m_iGaussianOffset[iHMMState];
+	float fLogLikelihood = LOG_LIKELIHOOD_FLOOR;
+	if (m_iType == GAUSSIAN_QUANTIZATION_INT8) {
+		for(int i=0 ; i < iGaussians ; ++i) {
+			int iGaussian = iGaussianFirst + (iShortlist ? iShortlist[i] : i);
+			float fDistance = computeDistanceInt8((const signed char*)(m_cParameters+iGaussian*m_iBytesGaussian));
+			fLogLikelihood = max(m_fConstant[iGaussian]-fDistance,fLogLikelihood);
+		}
+	} else {
+		for(int i=0 ; i < iGaussians ; ++i) {
+			int iGaussian = iGaussianFirst + (iShortlist ? iShortlist[i] : i);
+			float fDistance = computeDistanceInt16((const short*)(m_cParameters+iGaussian*m_iBytesGaussian));
+			fLogLikelihood = max(m_fConstant[iGaussian]-fDistance,fLogLikelihood);
+		}
+	}
+	
+	return fLogLikelihood;
+}
+
+// print information about the quantization
+void GaussianQuantizer::print() {
+
+	BVC_INFORMATION << "Gaussian quantization: " << getStrType(m_iType) << ", " << m_iGaussians << 
+		" Gaussian components, " << getMemoryUsage()/1024 << " KB (unquantized: " << 
+		(m_iGaussians*sizeof(GaussianDecoding))/1024 << " KB), average error: means " << FLT(8,4) << 
+		m_fErrorMean << " std. deviations, precisions " << FLT(8,4) << m_fErrorPrecision*100.0f << "%";
+}
+
+};	// end-of-namespace
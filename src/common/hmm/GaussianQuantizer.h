@@ -0,0 +1,132 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#ifndef GAUSSIANQUANTIZER_H
+#define GAUSSIANQUANTIZER_H
+
+using namespace std;
+
+#include <algorithm>
+
+#include "Global.h"
+
+namespace Bavieca {
+
+class HMMManager;
+
+// quantization of the Gaussian parameters
+#define GAUSSIAN_QUANTIZATION_NONE				0
+#define GAUSSIAN_QUANTIZATION_INT8				1
+#define GAUSSIAN_QUANTIZATION_INT16				2
+
+#define STR_GAUSSIAN_QUANTIZATION_NONE			"none"
+#define STR_GAUSSIAN_QUANTIZATION_INT8			"int8"
+#define STR_GAUSSIAN_QUANTIZATION_INT16		"int16"
+
+// the dimensionality is padded to a multiple of this value (8 values per SIMD load)
+#define GAUSSIAN_QUANTIZATION_BLOCK				8
+
+/**
+	@author daniel <dani.bolanos@gmail.com>
+	
+	Compact copy of the decoding Gaussians in which means and inverted standard deviations are stored 
+	as 8 or 16 bit integers using an affine quantizer per dimension. The feature vector is mapped once 
+	per frame onto the grid of the means, so the kernel only needs to widen the integers and accumulate 
+	in single precision, which reduces the memory traffic of the emission computation by 2x or 4x.
+*/
+class GaussianQuantizer {
+
+	private:
+	
+		HMMManager *m_hmmManager;
+		int m_iType;						// quantization type (int8/int16)
+		int m_iDim;							// feature dimensionality
+		int m_iDimPadded;					// feature dimensionality padded to the SIMD block
+		int m_iHMMStates;					// number of HMM-states
+		int m_iGaussians;					// number of Gaussian components in the system
+		int *m_iGaussianOffset;			// index of the first Gaussian of each HMM-state [HMM-state + 1]
+		float *m_fConstant;				// Gaussian constants (log-weight and normalization factor)
+		char *m_cParameters;				// quantized means followed by quantized precisions [Gaussian]
+		int m_iBytesGaussian;			// bytes used by the parameters of each Gaussian
+		
+		// affine quantizers per dimension: value = offset + scale x integer
+		float *m_fMeanOffset;
+		float *m_fMeanScale;
+		float *m_fPrecisionOffset;
+		float *m_fPrecisionScale;
+		
+		// feature vector mapped onto the grid of the means for the current frame
+		float *m_fFeatures;
+		int m_iTime;
+		
+		// quantization errors (computed at build time)
+		float m_fErrorMean;
+		float m_fErrorPrecision;
+		
+		// map the feature vector onto the grid of the means
+		void mapFeatures(float *fFeatures);
+		
+		// return the weighted distance between the mapped features and a Gaussian (int8)
+		inline float computeDistanceInt8(const signed char *cParameters);
+		
+		// return the weighted distance between the mapped features and a Gaussian (int16)
+		inline float computeDistanceInt16(const short *sParameters);
+
+	public:
+
+		// constructor
+		GaussianQuantizer(HMMManager *hmmManager, int iType);
+
+		// destructor
+		~GaussianQuantizer();
+		
+		// return the quantization type from its string representation
+		static int getType(const char *strType);
+		
+		// return the string representation of the quantization type
+		static const char *getStrType(int iType);
+		
+		// quantize the Gaussian parameters (HMMs need to be initialized for decoding)
+		void build();
+		
+		// reset the feature cache
+		inline void resetTimeStamp() {
+		
+			m_iTime = -1;
+		}
+		
+		// return the log-likelihood of the HMM-state for the given feature vector (nearest-neighbor approximation)
+		// only the given components are evaluated if a shortlist is given
+		float computeLogLikelihood(int iHMMState, float *fFeatures, int iTime, unsigned short *iShortlist, 
+			int iGaussians);
+		
+		// return the memory used by the quantized parameters (in bytes)
+		inline int getMemoryUsage() {
+		
+			return m_iGaussians*(m_iBytesGaussian+sizeof(float));
+		}
+		
+		// print information about the quantization
+		void print();
+
+};
+
+};	// end-of-namespace
+
+#endif
@@ -0,0 +1,327 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#include "GaussianSelector.h"
+#include "FileInput.h"
+#include "FileOutput.h"
+#include "HMMManager.h"
+#include "IOBase.h"
+#include "LogMessage.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+#include <vector>
+
+namespace Bavieca {
+
+// constructor
+GaussianSelector::GaussianSelector(HMMManager *hmmManager) {
+
+	m_hmmManager = hmmManager;
+	m_iDim = m_hmmManager->getFeatureDim();
+	HMMStateDecoding *hmmStates = m_hmmManager->getHMMStatesDecoding(&m_iHMMStates);
+	m_iGaussians = 0;
+	for(int i=0 ; i < m_iHMMStates ; ++i) {
+		m_iGaussians += hmmStates[i].getGaussianComponents();
+	}
+	m_iCodewords = 0;
+	m_fCodewords = NULL;
+	m_fWeight = NULL;
+	m_iShortlistOffset = NULL;
+	m_iShortlists = NULL;
+	m_iShortlistElements = 0;
+	m_iTime = -1;
+	m_iCodeword = -1;
+}
+
+// destructor
+GaussianSelector::~GaussianSelector() {
+
+	if (m_fCodewords) {
+		delete [] m_fCodewords;
+		delete [] m_fWeight;
+		delete [] m_iShortlistOffset;
+		delete [] m_iShortlists;
+	}
+}
+
+// allocate memory for the codebook
+void GaussianSelector::allocateCodebook() {
+
+	assert(m_fCodewords == NULL);
+	m_fCodewords = new float[m_iCodewords*m_iDim];
+	m_fWeight = new float[m_iDim];
+	m_iShortlistOffset = new int[m_iHMMStates*m_iCodewords+1];
+}
+
+// return the codeword closest to the given vector
+int GaussianSelector::getNearestCodeword(float *fFeatures) {
+
+	int iCodeword = -1;
+	float fDistanceBest = FLT_MAX;
+	for(int i=0 ; i < m_iCodewords ; ++i) {
+		float *fCodeword = m_fCodewords+i*m_iDim;
+		float fDistance = 0.0;
+		for(int j=0 ; j < m_iDim ; ++j) {
+			float fDiff = fFeatures[j]-fCodeword[j];
+			fDistance += fDiff*fDiff*m_fWeight[j];
+		}
+		if (fDistance < fDistanceBest) {
+			fDistanceBest = fDistance;
+			iCodeword = i;
+		}
+	}
+	
+	return iCodeword;
+}
+
+// build the codebook and the shortlists (HMMs need to be initialized for decoding)
+void GaussianSelector::build(int iCodewords, float fThreshold, int iFloor) {
+
+	assert(iCodewords > 0);
+	assert(iFloor >= 1);
+	
+	HMMStateDecoding *hmmStates = m_hmmManager->getHMMStatesDecoding(&m_iHMMStates);
+	
+	// gather the Gaussian components
+	GaussianDecoding **gaussians = new GaussianDecoding*[m_iGaussians];
+	int iGaussian = 0;
+	for(int i=0 ; i < m_iHMMStates ; ++i) {
+		int iComponents = 0;
+		GaussianDecoding *gaussiansState = hmmStates[i].getGaussians(iComponents);
+		if (iComponents > USHRT_MAX) {
+			BVC_ERROR << "mixture size not supported for Gaussian selection: " << iComponents;
+		}
+		for(int j=0 ; j < iComponents ; ++j) {
+			gaussians[iGaussian++] = gaussiansState+j;
+		}
+	}
+	assert(iGaussian == m_iGaussians);
+	
+	m_iCodewords = min(iCodewords,m_iGaussians);
+	allocateCodebook();
+	
+	// the distance to the codewords is weighted by the average inverted covariance
+	for(int j=0 ; j < m_iDim ; ++j) {
+		double dAcc = 0.0;
+		for(int i=0 ; i < m_iGaussians ; ++i) {
+			dAcc += gaussians[i]->fCovariance[j];
+		}
+		m_fWeight[j] = (float)(dAcc/((double)m_iGaussians));
+	}
+	
+	// (1) build the codebook using k-means on the Gaussian means
+	
+	// initial codewords: means evenly spaced across the system
+	for(int i=0 ; i < m_iCodewords ; ++i) {
+		GaussianDecoding *gaussian = gaussians[(int)((((long long)i)*m_iGaussians)/m_iCodewords)];
+		memcpy(m_fCodewords+i*m_iDim,gaussian->fMean,m_iDim*sizeof(float));
+	}
+	
+	int *iAssignment = new int[m_iGaussians];
+	for(int i=0 ; i < m_iGaussians ; ++i) {
+		iAssignment[i] = -1;
+	}
+	double *dAccumulator = new double[m_iCodewords*m_iDim];
+	int *iElements = new int[m_iCodewords];
+	for(int iIteration = 0 ; iIteration < GAUSSIAN_SELECTION_KMEANS_ITERATIONS ; ++iIteration) {
+	
+		// assignment step
+		int iChanges = 0;
+		double dDistortion = 0.0;
+		#pragma omp parallel for schedule(static) reduction(+:iChanges,dDistortion)
+		for(int i=0 ; i < m_iGaussians ; ++i) {
+			int iCodeword = getNearestCodeword(gaussians[i]->fMean);
+			float *fCodeword = m_fCodewords+iCodeword*m_iDim;
+			for(int j=0 ; j < m_iDim ; ++j) {
+				float fDiff = gaussians[i]->fMean[j]-fCodeword[j];
+				dDistortion += fDiff*fDiff*m_fWeight[j];
+			}
+			if (iCodeword != iAssignment[i]) {
+				iAssignment[i] = iCodeword;
+				++iChanges;
+			}
+		}
+		BVC_VERB << "k-means iteration: " << setw(3) << iIteration << " distortion: " << FLT(14,4) << 
+			dDistortion/((double)m_iGaussians) << " changes: " << iChanges;
+		if (iChanges == 0) {
+			break;
+		}
+		
+		// update step (empty clusters keep their codeword)
+		for(int i=0 ; i < m_iCodewords*m_iDim ; ++i) {
+			dAccumulator[i] = 0.0;
+		}
+		for(int i=0 ; i < m_iCodewords ; ++i) {
+			iElements[i] = 0;
+		}
+		for(int i=0 ; i < m_iGaussians ; ++i) {
+			double *dAccumulatorCodeword = dAccumulator+iAssignment[i]*m_iDim;
+			for(int j=0 ; j < m_iDim ; ++j) {
+				dAccumulatorCodeword[j] += gaussians[i]->fMean[j];
+			}
+			++iElements[iAssignment[i]];
+		}
+		for(int i=0 ; i < m_iCodewords ; ++i) {
+			if (iElements[i] > 0) {
+				for(int j=0 ; j < m_iDim ; ++j) {
+					m_fCodewords[i*m_iDim+j] = (float)(dAccumulator[i*m_iDim+j]/((double)iElements[i]));
+				}
+			}
+		}
+	}
+	delete [] dAccumulator;
+	delete [] iElements;
+	delete [] iAssignment;
+	delete [] gaussians;
+	
+	// (2) build the shortlists: components scoring within the threshold of the best component of 
+	// the state at the codeword, at least iFloor components are kept
+	vector<unsigned short> *vShortlist = new vector<unsigned short>[m_iHMMStates];
+	#pragma omp parallel for schedule(dynamic)
+	for(int i=0 ; i < m_iHMMStates ; ++i) {
+		int iComponents = 0;
+		GaussianDecoding *gaussiansState = hmmStates[i].getGaussians(iComponents);
+		vector<pair<float,int> > vScore(iComponents);
+		for(int k=0 ; k < m_iCodewords ; ++k) {
+			float *fCodeword = m_fCodewords+k*m_iDim;
+			// score each component at the codeword
+			for(int g=0 ; g < iComponents ; ++g) {
+				float fAcc = gaussiansState[g].fConstant;
+				for(int j=0 ; j < m_iDim ; ++j) {
+					float fDiff = fCodeword[j]-gaussiansState[g].fMean[j];
+					fAcc -= fDiff*fDiff*gaussiansState[g].fCovariance[j];
+				}
+				vScore[g].first = -fAcc;
+				vScore[g].second = g;
+			}
+			sort(vScore.begin(),vScore.end());
+			float fThresholdScore = vScore[0].first+fThreshold;
+			for(int g=0 ; g < iComponents ; ++g) {
+				if ((g >= iFloor) && (vScore[g].first > fThresholdScore)) {
+					break;
+				}
+				vShortlist[i].push_back((unsigned short)vScore[g].second);
+			}
+			// mark the end of the shortlist for this codeword
+			vShortlist[i].push_back(USHRT_MAX);
+		}
+	}
+	
+	// gather the shortlists into contiguous memory
+	m_iShortlistElements = 0;
+	for(int i=0 ; i < m_iHMMStates ; ++i) {
+		m_iShortlistElements += vShortlist[i].size()-m_iCodewords;
+	}
+	m_iShortlists = new unsigned short[m_iShortlistElements];
+	int iElement = 0;
+	for(int i=0 ; i < m_iHMMStates ; ++i) {
+		int k = 0;
+		m_iShortlistOffset[i*m_iCodewords] = iElement;
+		for(vector<unsigned short>::iterator it = vShortlist[i].begin() ; it != vShortlist[i].end() ; ++it) {
+			if (*it == USHRT_MAX) {
+				m_iShortlistOffset[i*m_iCodewords+(++k)] = iElement;
+			} else {
+				m_iShortlists[iElement++] = *it;
+			}
+		}
+		assert(k == m_iCodewords);
+	}
+	assert(iElement == m_iShortlistElements);
+	delete [] vShortlist;
+	
+	m_iTime = -1;
+}
+
+// load the codebook and the shortlists from a file
+void GaussianSelector::load(const char *strFile) {
+
+	try {
+	
+		FileInput file(strFile,true);
+		file.open();
+		
+		int iDim = -1;
+		int iHMMStates = -1;
+		int iGaussians = -1;
+		IOBase::read(file.getStream(),&iDim);
+		IOBase::read(file.getStream(),&iHMMStates);
+		IOBase::read(file.getStream(),&iGaussians);
+		if ((iDim != m_iDim) || (iHMMStates != m_iHMMStates) || (iGaussians != m_iGaussians)) {
+			BVC_ERROR << "Gaussian selection data in " << strFile << " does not match the acoustic models";
+		}
+		IOBase::read(file.getStream(),&m_iCodewords);
+		IOBase::read(file.getStream(),&m_iShortlistElements);
+		allocateCodebook();
+		m_iShortlists = new unsigned short[m_iShortlistElements];
+		IOBase::readBytes(file.getStream(),reinterpret_cast<char*>(m_fWeight),m_iDim*sizeof(float));
+		IOBase::readBytes(file.getStream(),reinterpret_cast<char*>(m_fCodewords),m_iCodewords*m_iDim*sizeof(float));
+		IOBase::readBytes(file.getStream(),reinterpret_cast<char*>(m_iShortlistOffset),
+			(m_iHMMStates*m_iCodewords+1)*sizeof(int));
+		IOBase::readBytes(file.getStream(),reinterpret_cast<char*>(m_iShortlists),
+			m_iShortlistElements*sizeof(unsigned short));
+		
+		file.close();
+		
+	} catch (std::runtime_error) {
+		BVC_ERROR << "unable to load the Gaussian selection data from file: " << strFile;
+	}
+	
+	m_iTime = -1;
+}
+
+// store the codebook and the shortlists into a file
+void GaussianSelector::store(const char *strFile) {
+
+	assert(m_fCodewords);
+
+	try {
+	
+		FileOutput file(strFile,true);
+		file.open();
+		
+		IOBase::write(file.getStream(),m_iDim);
+		IOBase::write(file.getStream(),m_iHMMStates);
+		IOBase::write(file.getStream(),m_iGaussians);
+		IOBase::write(file.getStream(),m_iCodewords);
+		IOBase::write(file.getStream(),m_iShortlistElements);
+		IOBase::writeBytes(file.getStream(),reinterpret_cast<char*>(m_fWeight),m_iDim*sizeof(float));
+		IOBase::writeBytes(file.getStream(),reinterpret_cast<char*>(m_fCodewords),m_iCodewords*m_iDim*sizeof(float));
+		IOBase::writeBytes(file.getStream(),reinterpret_cast<char*>(m_iShortlistOffset),
+			(m_iHMMStates*m_iCodewords+1)*sizeof(int));
+		IOBase::writeBytes(file.getStream(),reinterpret_cast<char*>(m_iShortlists),
+			m_iShortlistElements*sizeof(unsigned short));
+		
+		file.close();
+		
+	} catch (std::runtime_error) {
+		BVC_ERROR << "unable to store the Gaussian selection data to file: " << strFile;
+	}
+}
+
+// print information about the codebook and the shortlists
+void GaussianSelector::print() {
+
+	BVC_INFORMATION << "Gaussian selection: " << m_iCodewords << " codewords, " << m_iHMMStates << 
+		" HMM-states, average shortlist size: " << FLT(8,2) << getShortlistSizeAverage() << 
+		" (average mixture size: " << FLT(8,2) << ((float)m_iGaussians)/((float)m_iHMMStates) << ")";
+}
+
+};	// end-of-namespace
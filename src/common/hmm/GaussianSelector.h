@@ -0,0 +1,116 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#ifndef GAUSSIANSELECTOR_H
+#define GAUSSIANSELECTOR_H
+
+#include "Global.h"
+
+namespace Bavieca {
+
+class HMMManager;
+class HMMStateDecoding;
+
+// k-means iterations used to build the codebook
+#define GAUSSIAN_SELECTION_KMEANS_ITERATIONS		20
+
+/**
+	@author daniel <dani.bolanos@gmail.com>
+	
+	Gaussian selection based on vector quantization. A codebook is built over the means of all the 
+	Gaussian components in the system and for each HMM-state and codeword a shortlist keeps the components 
+	that score within a threshold of the best component of the state at the codeword. At decoding time 
+	the codeword closest to each feature vector is found once and each HMM-state only evaluates its 
+	shortlist for that codeword.
+*/
+class GaussianSelector {
+
+	private:
+	
+		HMMManager *m_hmmManager;
+		int m_iDim;							// feature dimensionality
+		int m_iHMMStates;					// number of HMM-states
+		int m_iGaussians;					// number of Gaussian components in the system
+		int m_iCodewords;					// codebook size
+		float *m_fCodewords;				// codewords [codeword x dimension]
+		float *m_fWeight;					// weight of each dimension in the distance to the codewords
+		int *m_iShortlistOffset;		// shortlist offsets [HMM-state x codeword + 1]
+		unsigned short *m_iShortlists;// shortlists (indices of Gaussian components within the mixture)
+		int m_iShortlistElements;		// total number of elements in the shortlists
+		
+		// codeword for the current frame
+		int m_iTime;
+		int m_iCodeword;
+		
+		// return the codeword closest to the given vector
+		int getNearestCodeword(float *fFeatures);
+		
+		// allocate memory for the codebook
+		void allocateCodebook();
+
+	public:
+
+		// constructor
+		GaussianSelector(HMMManager *hmmManager);
+
+		// destructor
+		~GaussianSelector();
+		
+		// build the codebook and the shortlists (HMMs need to be initialized for decoding)
+		void build(int iCodewords, float fThreshold, int iFloor);
+		
+		// load the codebook and the shortlists from a file
+		void load(const char *strFile);
+		
+		// store the codebook and the shortlists into a file
+		void store(const char *strFile);
+		
+		// reset the codeword cache
+		inline void resetTimeStamp() {
+		
+			m_iTime = -1;
+		}
+		
+		// return the shortlist of the given HMM-state for the given feature vector
+		inline unsigned short *getShortlist(int iHMMState, float *fFeatures, int iTime, int *iGaussians) {
+		
+			if (iTime != m_iTime) {
+				m_iCodeword = getNearestCodeword(fFeatures);
+				m_iTime = iTime;
+			}
+			int *iOffset = m_iShortlistOffset+iHMMState*m_iCodewords+m_iCodeword;
+			*iGaussians = iOffset[1]-iOffset[0];
+			
+			return m_iShortlists+iOffset[0];
+		}
+		
+		// return the average shortlist size
+		inline float getShortlistSizeAverage() {
+		
+			return ((float)m_iShortlistElements)/((float)(m_iHMMStates*m_iCodewords));
+		}
+		
+		// print information about the codebook and the shortlists
+		void print();
+
+};
+
+};	// end-of-namespace
+
+#endif
@@ -18,6 +18,8 @@
 
 
 #include "ContextDecisionTree.h"
+#include "GaussianQuantizer.h"
+#include "GaussianSelector.h"
 #include "HMMManager.h"
 #include "PhoneSet.h"
 #include "PhoneticRulesManager.h"
@@ -60,6 +62,10 @@ HMMManager::HMMManager(PhoneSet *phoneSet, unsigned char iPurpose)
 	
 	// feature dimensionality
 	m_iDim = -1;
+	
+	// Gaussian selection
+	m_gaussianSelector = NULL;
+	m_gaussianQuantizer = NULL;
 }
 
 // destructor
@@ -588,6 +594,12 @@ void HMMManager::resetHMMEmissionProbabilityComputation() {
 		for(int i=0 ; i<m_iHMMStates ; ++i) {
 			m_hmmStatesDecoding[i].resetTimeStamp();
 		}	
+		if (m_gaussianSelector) {
+			m_gaussianSelector->resetTimeStamp();
+		}
+		if (m_gaussianQuantizer) {
+			m_gaussianQuantizer->resetTimeStamp();
+		}
 	}
 }
 
@@ -605,6 +617,12 @@ void HMMManager::resetHMMEmissionProbabilityComputation(VHMMStateDecoding &vHMMS
 	for(VHMMStateDecoding::iterator it = vHMMStateDecoding.begin() ; it != vHMMStateDecoding.end() ; ++it) {
 		(*it)->resetTimeStamp();
 	}
+	if (m_gaussianSelector) {
+		m_gaussianSelector->resetTimeStamp();
+	}
+	if (m_gaussianQuantizer) {
+		m_gaussianQuantizer->resetTimeStamp();
+	}
 }
 
 // print models information
@@ -644,6 +662,34 @@ void HMMManager::initializeDecoding() {
 	}
 }
 
+// attach a Gaussian selector to the HMM-states (NULL to evaluate all the components)
+void HMMManager::setGaussianSelector(GaussianSelector *gaussianSelector) {
+
+	assert(m_iPurpose == HMM_PURPOSE_EVALUATION);
+	
+	m_gaussianSelector = gaussianSelector;
+	if (m_gaussianSelector) {
+		m_gaussianSelector->resetTimeStamp();
+	}
+	for(int i=0 ; i<m_iHMMStates ; ++i) {
+		m_hmmStatesDecoding[i].setGaussianSelector(gaussianSelector);
+	}
+}
+
+// attach quantized Gaussian parameters to the HMM-states (NULL to use the original parameters)
+void HMMManager::setGaussianQuantizer(GaussianQuantizer *gaussianQuantizer) {
+
+	assert(m_iPurpose == HMM_PURPOSE_EVALUATION);
+	
+	m_gaussianQuantizer = gaussianQuantizer;
+	if (m_gaussianQuantizer) {
+		m_gaussianQuantizer->resetTimeStamp();
+	}
+	for(int i=0 ; i<m_iHMMStates ; ++i) {
+		m_hmmStatesDecoding[i].setGaussianQuantizer(gaussianQuantizer);
+	}
+}
+
 // precompute constants to speed-up emission probability computation
 void HMMManager::precomputeConstants() {
 
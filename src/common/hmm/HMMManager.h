@@ -32,6 +32,8 @@ using namespace std;
 namespace Bavieca {
 
 class ContextDecisionTree;
+class GaussianQuantizer;
+class GaussianSelector;
 class PhoneSet;
 class PhoneticRulesManager;
 class Transform;
@@ -98,6 +100,10 @@ class HMMManager {
 		// version of the hmmsystem that created the models
 		int m_iSystemVersion;
 		
+		// Gaussian selection (evaluation)
+		GaussianSelector *m_gaussianSelector;
+		GaussianQuantizer *m_gaussianQuantizer;
+		
 	public:
 	
 		// constructor
@@ -308,6 +314,12 @@ class HMMManager {
 		// initialize HMM-states for decoding
 		void initializeDecoding();
 		
+		// attach a Gaussian selector to the HMM-states (NULL to evaluate all the components)
+		void setGaussianSelector(GaussianSelector *gaussianSelector);
+		
+		// attach quantized Gaussian parameters to the HMM-states (NULL to use the original parameters)
+		void setGaussianQuantizer(GaussianQuantizer *gaussianQuantizer);
+		
 		inline void setSingleGaussian(bool b) {
 		
 			m_bSingleGaussian = b;
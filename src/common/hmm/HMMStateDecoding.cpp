@@ -19,6 +19,8 @@
 
 #include "FileInput.h"
 #include "FileOutput.h"
+#include "GaussianQuantizer.h"
+#include "GaussianSelector.h"
 #include "HMMStateDecoding.h"
 #include "IOBase.h"
 #include "PhoneSet.h"
@@ -36,6 +38,8 @@ HMMStateDecoding::HMMStateDecoding(int iDim, PhoneSet *phoneSet, int iId)
 	m_iId = iId;
 	m_gaussians = NULL;
 	m_bCovarianceOriginal = true;
+	m_gaussianSelector = NULL;
+	m_gaussianQuantizer = NULL;
 }
 
 // constructor
@@ -51,6 +55,8 @@ HMMStateDecoding::HMMStateDecoding(int iDim, PhoneSet *phoneSet, unsigned char i
 	m_iGaussianComponents = iGaussians;
 	m_gaussians = gaussians;
 	m_bCovarianceOriginal = true;	
+	m_gaussianSelector = NULL;
+	m_gaussianQuantizer = NULL;
 }
 
 
@@ -61,6 +67,8 @@ HMMStateDecoding::HMMStateDecoding()
 	m_phoneSet = NULL;
 	m_iId = -1;
 	m_gaussians = NULL;
+	m_gaussianSelector = NULL;
+	m_gaussianQuantizer = NULL;
 }
 
 // set initial parameters
@@ -186,6 +194,26 @@ void HMMStateDecoding::load(FileInput &file) {
 	m_bCovarianceOriginal = true;
 }
 
+// computes the emission probability of the state given the feature vector (recording performance counters)
+float HMMStateDecoding::computeEmissionProbabilityProfiled(float *fFeatures, int iTime) {
+
+	if (iTime == m_iTimestamp) {
+		BVC_PROFILE_COUNT(PROFILE_COUNTER_EMISSION_CACHE_HITS,1);
+		return m_fProbabilityCached;
+	}
+	
+	BVC_PROFILE_TIMER_BEGIN(iCycles);
+	BVC_PROFILE_COUNT(PROFILE_COUNTER_EMISSIONS_COMPUTED,1);
+	// components evaluated through a shortlist are counted where the shortlist is known
+	if (m_gaussianSelector == NULL) {
+		BVC_PROFILE_COUNT(PROFILE_COUNTER_GAUSSIANS_EVALUATED,m_iGaussianComponents);
+	}
+	float fScore = computeEmissionProbabilityDispatch(fFeatures,iTime);
+	BVC_PROFILE_TIMER_END(PROFILE_TIMER_EMISSION,iCycles);
+	
+	return fScore;
+}
+
 // computes the emission probability of the state given the feature vector ("brute force")
 // each of the gaussians is a multivariate normal distribution
 float HMMStateDecoding::computeEmissionProbabilityBruteForce(float *fFeatures, int iTime) {
@@ -382,6 +410,122 @@ float HMMStateDecoding::computeEmissionProbabilityNearestNeighborPDE(float *fFea
 	return fLogLikelihood;
 }
 
+// computes the emission probability of the state given the feature vector 
+// uses nearest-neighbor approximation
+// only the components in the shortlist of the codeword closest to the feature vector are evaluated
+float HMMStateDecoding::computeEmissionProbabilityGaussianSelection(float *fFeatures, int iTime) {
+
+	if (iTime == m_iTimestamp) {	
+		return m_fProbabilityCached;
+	}
+	
+	int iGaussians = 0;
+	unsigned short *iShortlist = m_gaussianSelector->getShortlist(m_iId,fFeatures,iTime,&iGaussians);
+	BVC_PROFILE_COUNT(PROFILE_COUNTER_GAUSSIANS_EVALUATED,iGaussians);
+	
+	float fLogLikelihood = LOG_LIKELIHOOD_FLOOR;
+	for(int i = 0 ; i < iGaussians ; ++i) {
+	
+		GaussianDecoding *gaussian = m_gaussians+iShortlist[i];
+		float *fMean = gaussian->fMean;
+		float *fCovariance = gaussian->fCovariance;
+		float fAcc = gaussian->fConstant;
+		for(int j = 0 ; j < DIMENSIONALITY ; ++j) {
+			fAcc -= (fFeatures[j]-fMean[j])*(fFeatures[j]-fMean[j])*fCovariance[j];
+		}
+		fLogLikelihood = max(fAcc,fLogLikelihood);
+	}
+	
+	// cache the probability
+	m_iTimestamp = iTime;
+	m_fProbabilityCached = fLogLikelihood;
+	
+	return fLogLikelihood;
+}
+
+// computes the emission probability of the state given the feature vector 
+// uses nearest-neighbor approximation
+// uses the quantized Gaussian parameters (and the shortlist if Gaussian selection is enabled)
+float HMMStateDecoding::computeEmissionProbabilityQuantized(float *fFeatures, int iTime) {
+
+	if (iTime == m_iTimestamp) {	
+		return m_fProbabilityCached;
+	}
+	
+	int iGaussians = m_iGaussianComponents;
+	unsigned short *iShortlist = NULL;
+	if (m_gaussianSelector) {
+		iShortlist = m_gaussianSelector->getShortlist(m_iId,fFeatures,iTime,&iGaussians);
+		BVC_PROFILE_COUNT(PROFILE_COUNTER_GAUSSIANS_EVALUATED,iGaussians);
+	}
+	float fLogLikelihood = m_gaussianQuantizer->computeLogLikelihood(m_iId,fFeatures,iTime,iShortlist,iGaussians);
+	
+	// cache the probability
+	m_iTimestamp = iTime;
+	m_fProbabilityCached = fLogLikelihood;
+	
+	return fLogLikelihood;
+}
+
+// computes the emission probability of the state for several consecutive feature vectors at once
+// uses nearest-neighbor approximation
+// the parameters of each Gaussian are loaded only once and kept in registers while the frames are scored
+void HMMStateDecoding::computeEmissionProbabilityBatch(float *fFeatures, int iStride, int iFrames, float *fScores) {
+
+	for(int f=0 ; f < iFrames ; ++f) {
+		fScores[f] = LOG_LIKELIHOOD_FLOOR;
+	}
+
+#ifdef __SSE__
+	// 39 = 9 x 4 + 3
+	__m128 mean[10];
+	__m128 cov[10];
+	__m128 tmp;
+	__m128 ans;
+	float tmpf[4];
+	
+	for(int iGaussian = 0 ; iGaussian < m_iGaussianComponents ; ++iGaussian) {
+	
+		float *fMean = m_gaussians[iGaussian].fMean;
+		float *fCovariance = m_gaussians[iGaussian].fCovariance;	
+		for(int i=0 ; i < 9 ; ++i) {
+			mean[i] = _mm_load_ps(fMean+4*i);
+			cov[i] = _mm_load_ps(fCovariance+4*i);
+		}
+		mean[9] = _mm_set_ps(0, fMean[38], fMean[37], fMean[36]);
+		cov[9] = _mm_set_ps(0, fCovariance[38], fCovariance[37], fCovariance[36]);
+		
+		for(int f=0 ; f < iFrames ; ++f) {
+			float *fObs = fFeatures+f*iStride;
+			ans = _mm_setzero_ps();
+			for(int i=0 ; i < 9 ; ++i) {
+				tmp = _mm_sub_ps(_mm_loadu_ps(fObs+4*i),mean[i]);
+				ans = _mm_add_ps(ans,_mm_mul_ps(_mm_mul_ps(tmp,tmp),cov[i]));
+			}
+			tmp = _mm_sub_ps(_mm_set_ps(0, fObs[38], fObs[37], fObs[36]),mean[9]);
+			ans = _mm_add_ps(ans,_mm_mul_ps(_mm_mul_ps(tmp,tmp),cov[9]));
+			_mm_storeu_ps(tmpf,ans);
+			float fAcc = m_gaussians[iGaussian].fConstant-(tmpf[0]+tmpf[1]+tmpf[2]+tmpf[3]);
+			fScores[f] = max(fAcc,fScores[f]);
+		}
+	}
+#else
+	for(int iGaussian = 0 ; iGaussian < m_iGaussianComponents ; ++iGaussian) {
+	
+		float *fMean = m_gaussians[iGaussian].fMean;
+		float *fCovariance = m_gaussians[iGaussian].fCovariance;	
+		for(int f=0 ; f < iFrames ; ++f) {
+			float *fObs = fFeatures+f*iStride;
+			float fAcc = m_gaussians[iGaussian].fConstant;
+			for(int i=0 ; i < DIMENSIONALITY ; ++i) {
+				fAcc -= (fObs[i]-fMean[i])*(fObs[i]-fMean[i])*fCovariance[i];
+			}
+			fScores[f] = max(fAcc,fScores[f]);
+		}
+	}
+#endif
+}
+
 // computes the emission probability of the state given the feature vector 
 // uses nearest-neighbor approximation
 // uses SIMD instructions (SSE) (sse support must be enabled during compilation!)
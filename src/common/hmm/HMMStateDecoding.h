@@ -50,11 +50,14 @@ using namespace std;
 #endif
 
 #include "Global.h"
+#include "PerformanceProfile.h"
 
 namespace Bavieca {
 
 class FileInput;
 class FileOutput;
+class GaussianQuantizer;
+class GaussianSelector;
 class IOBase;
 class PhoneSet;
 
@@ -126,6 +129,22 @@ class HMMStateDecoding {
 		// whether the covariance was modified to accelerate the computation of emission probabilities
 		bool m_bCovarianceOriginal;
 		
+		// Gaussian selection (NULL if all the components are evaluated)
+		GaussianSelector *m_gaussianSelector;
+		
+		// quantized Gaussian parameters (NULL if the original parameters are used)
+		GaussianQuantizer *m_gaussianQuantizer;
+		
+		// computes the emission probability of the state given the feature vector 
+		// uses nearest-neighbor approximation
+		// uses the quantized Gaussian parameters (and the shortlist if Gaussian selection is enabled)
+		float computeEmissionProbabilityQuantized(float *fFeatures, int iTime);
+		
+		// computes the emission probability of the state given the feature vector 
+		// uses nearest-neighbor approximation
+		// only the components in the shortlist of the codeword closest to the feature vector are evaluated
+		float computeEmissionProbabilityGaussianSelection(float *fFeatures, int iTime);
+		
 		// computes the emission probability of the state given the feature vector ("brute force")
 		float computeEmissionProbabilityBruteForce(float *fFeatures, int iTime);
 		
@@ -192,6 +211,20 @@ class HMMStateDecoding {
 		
 			m_iTimestamp = -1;
 		}
+		
+		// set the Gaussian selector (NULL to evaluate all the components)
+		inline void setGaussianSelector(GaussianSelector *gaussianSelector) {
+		
+			m_gaussianSelector = gaussianSelector;
+			m_iTimestamp = -1;
+		}
+		
+		// set the quantized Gaussian parameters (NULL to use the original parameters)
+		inline void setGaussianQuantizer(GaussianQuantizer *gaussianQuantizer) {
+		
+			m_gaussianQuantizer = gaussianQuantizer;
+			m_iTimestamp = -1;
+		}
 				
 		inline unsigned char getPhone() {
 		
@@ -260,6 +293,26 @@ class HMMStateDecoding {
 		// computes the emission probability of the state given the feature vector
 		inline float computeEmissionProbability(float *fFeatures, int iTime) {
 		
+		#ifdef BVC_PROFILING_ENABLED
+			if (PerformanceProfile::getCurrent()) {
+				return computeEmissionProbabilityProfiled(fFeatures,iTime);
+			}
+		#endif
+			return computeEmissionProbabilityDispatch(fFeatures,iTime);
+		}
+		
+		// computes the emission probability of the state given the feature vector (recording performance counters)
+		float computeEmissionProbabilityProfiled(float *fFeatures, int iTime);
+		
+		// computes the emission probability of the state given the feature vector using the configured method
+		inline float computeEmissionProbabilityDispatch(float *fFeatures, int iTime) {
+		
+			if (m_gaussianQuantizer) {
+				return computeEmissionProbabilityQuantized(fFeatures,iTime);
+			}
+			if (m_gaussianSelector) {
+				return computeEmissionProbabilityGaussianSelection(fFeatures,iTime);
+			}
 		#ifdef __AVX__
 			return computeEmissionProbabilityNearestNeighborAVX(fFeatures,iTime);
 		#elif __SSE__
@@ -269,6 +322,10 @@ class HMMStateDecoding {
 		#endif
 		}
 		
+		// computes the emission probability of the state for several consecutive feature vectors at once
+		// (uses nearest-neighbor approximation, the parameters of each Gaussian are loaded only once)
+		void computeEmissionProbabilityBatch(float *fFeatures, int iStride, int iFrames, float *fScores);
+		
 		// return the best scoring gaussian for a given feature vector
 		GaussianDecoding *getBestScoringGaussian(float *fFeatures, float *fScore);	
 			
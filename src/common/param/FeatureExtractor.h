@@ -328,6 +328,16 @@ class FeatureExtractor {
 		#endif	
 		}
 		
+		// return the maximum number of feature vectors that extractFeaturesStream can produce from the given samples
+		unsigned int getFeatureVectorsStreamMax(unsigned int iSamples) {
+		
+			unsigned int iSamplesAll = (m_iSamplesStream > 0) ? iSamples+m_iSamplesUsefulPrev : iSamples;
+			if (iSamplesAll < m_iSamplesFrame) {
+				return 0;
+			}
+			return 1+(iSamplesAll-m_iSamplesFrame)/m_iSamplesSkip;
+		}
+		
 		// reset the stream for stream based feature extraction
 		void resetStream() {
 		
@@ -31,7 +31,7 @@ namespace Bavieca {
 
 // constructor
 SADModule::SADModule(PhoneSet *phoneSet, HMMManager *hmmManager, int iMaxGaussianComponentsSilence,
-	int iMaxGaussianComponentsSpeech, float fPenaltySilenceToSpeech, int iFramesPadding) {
+	int iMaxGaussianComponentsSpeech, float fPenaltySilenceToSpeech, int iFramesPadding, int iFramesLatency) {
 	
 	m_phoneSet = phoneSet;
 	m_hmmManager = hmmManager;
@@ -41,7 +41,13 @@ SADModule::SADModule(PhoneSet *phoneSet, HMMManager *hmmManager, int iMaxGaussia
 	m_hmmStateSpeech = NULL;
 	m_fPenaltySilenceToSpeech = fPenaltySilenceToSpeech;
 	m_iFramesPadding = iFramesPadding;
+	m_iFramesLatency = (iFramesLatency == -1) ? -1 : max(iFramesLatency,SAD_LATENCY_MIN);
 	m_iDim = m_hmmManager->getFeatureDim();
+	m_iTimeFrame = 0;
+	m_iBackpointers = NULL;
+	m_iPath = NULL;
+	m_iRingFrames = 0;
+	m_bFinished = false;
 	
 	assert(m_iMaxGaussianComponentsSpeech > 0);
 }
@@ -54,6 +60,8 @@ SADModule::~SADModule() {
 		delete m_hmmStateSilence;
 		delete m_hmmStateSpeech;
 	}
+	delete [] m_iBackpointers;
+	delete [] m_iPath;
 }
 
 // initialize the SAD system
@@ -197,243 +205,385 @@ VSpeechSegment *SADModule::load(const char *strFile) {
 // initializes a SAD session
 void SADModule::beginSession() {
 
-	m_iTimeFrame = 0; 
+	m_iTimeFrame = 0;
+	m_iFrameDecided = 0;
+	m_bFinished = false;
+	m_iTypeLast = UCHAR_MAX;
+	m_iFrameSpeechEnd = -1;
+	m_iFrameSpeechEndPadded = -1;
+	m_iFramesSilence = 0;
+	m_vSpeechEvent.clear();
+	
+	// the ring buffer has room for the maximum latency
+	int iRingFrames = (m_iFramesLatency == -1) ? SAD_RING_FRAMES_INITIAL : m_iFramesLatency;
+	if ((m_iBackpointers == NULL) || (m_iRingFrames != iRingFrames)) {
+		delete [] m_iBackpointers;
+		delete [] m_iPath;
+		m_iRingFrames = iRingFrames;
+		m_iBackpointers = new unsigned char[m_iRingFrames*2*HMM_STATES_CLASS];
+		m_iPath = new unsigned char[m_iRingFrames+1];
+	}
 }
 
 // process the given features
 void SADModule::processFeatures(MatrixBase<float> &mFeatures) {
 
-	for(unsigned int i=0 ; i < mFeatures.getRows() ; ++i) {
-		m_grid.push_back(new GridElementSAD[2*HMM_STATES_CLASS]);	
+	if (m_bFinished) {
+		BVC_ERROR << "the SAD session is over, no more features can be processed";
+	}
+	if (mFeatures.getRows() == 0) {
+		return;
 	}
 
-	// reset time-stamps to prevent getting scores from the cache
-	m_hmmStateSilence->resetTimeStamp();
-	m_hmmStateSpeech->resetTimeStamp();
-	unsigned int iTimeFrameLast = m_iTimeFrame+mFeatures.getRows();
+	// compute the emission scores for the whole batch of features
+	m_vScoresSilence.resize(mFeatures.getRows());
+	m_vScoresSpeech.resize(mFeatures.getRows());
+	m_hmmStateSilence->computeEmissionProbabilityBatch(mFeatures.getData(),mFeatures.getStride(),
+		mFeatures.getRows(),&m_vScoresSilence[0]);
+	m_hmmStateSpeech->computeEmissionProbabilityBatch(mFeatures.getData(),mFeatures.getStride(),
+		mFeatures.getRows(),&m_vScoresSpeech[0]);
+	
+	unsigned int iFeatureVector = 0;
 	
 	// first time frame?
 	if (m_iTimeFrame == 0) {
 	
-		// allocate memory for the grid
 		for(unsigned int i=0 ; i < 2*HMM_STATES_CLASS ; ++i) {
-			m_grid[0][i].fScore = -FLT_MAX ;
-			m_grid[0][i].iPrev = -1; 
+			m_fScores[i] = -FLT_MAX;
 		}
-				
 		// initialize the first states
-		m_grid[0][0].fScore = m_hmmStateSilence->computeEmissionProbability(mFeatures.getRowData(0),0);
-		m_grid[0][HMM_STATES_CLASS].fScore = m_hmmStateSpeech->computeEmissionProbability(mFeatures.getRowData(0),0) + m_fPenaltySilenceToSpeech;
-		m_iTimeFrame++;
+		m_fScores[0] = m_vScoresSilence[0];
+		m_fScores[HMM_STATES_CLASS] = m_vScoresSpeech[0] + m_fPenaltySilenceToSpeech;
+		++m_iTimeFrame;
+		++iFeatureVector;
 	}
 	
-	// fill the grid
-	int iPrevSelf = -1;
-	int iPrevLeft = -1;
-	int iFeatureVector = 1;
-	for(unsigned int i=m_iTimeFrame ; i < iTimeFrameLast ; ++i,++m_iTimeFrame, ++iFeatureVector) {
+	// fill the trellis
+	float fScores[2*HMM_STATES_CLASS];
+	for( ; iFeatureVector < mFeatures.getRows() ; ++iFeatureVector, ++m_iTimeFrame) {
+	
+		int i = m_iTimeFrame;
+		makeRoom(i);
+		unsigned char *iBackpointers = getBackpointers(i);
+		
+		for(unsigned int j=0 ; j < 2*HMM_STATES_CLASS ; ++j) {
 		
-		// silence states (all of them share the same mixture)		
-		float fSilenceScore = -FLT_MAX;
-		fSilenceScore = m_hmmStateSilence->computeEmissionProbability(mFeatures.getRowData(iFeatureVector),i);	
-		for(unsigned int j=0 ; j < HMM_STATES_CLASS ; ++j) {
-					
+			// silence states share the same mixture, so do speech states
+			unsigned int iFirst = (j < HMM_STATES_CLASS) ? 0 : HMM_STATES_CLASS;
+			float fEmissionScore = (j < HMM_STATES_CLASS) ? m_vScoresSilence[iFeatureVector] : m_vScoresSpeech[iFeatureVector];
 			float fLeft = -FLT_MAX;
 			float fSelf = -FLT_MAX;
+			int iPrevLeft = SAD_STATE_NONE;
 			// self transition
-			if (j < i) {
-				fSelf = m_grid[i-1][j].fScore;
-				iPrevSelf = j;
+			if ((int)(j-iFirst) < i) {
+				fSelf = m_fScores[j];
 			}
-			// left to right silence to silence transition
-			if ((j > 0) && (i > 0)) {
-				fLeft = m_grid[i-1][j-1].fScore;
+			// left to right transition within the class
+			if (j > iFirst) {
+				fLeft = m_fScores[j-1];
 				iPrevLeft = j-1;
-			} 
-			// left to right speech to silence transition
-			else if ((j == 0) && (i >= HMM_STATES_CLASS)) {
-				fLeft = m_grid[i-1][2*HMM_STATES_CLASS-1].fScore;
-				iPrevLeft = (2*HMM_STATES_CLASS)-1;	
 			}
-			// get the best backtrace at time t	
+			// left to right transition from the other class (speech to silence or silence to speech)
+			else if (i >= HMM_STATES_CLASS) {
+				if (j == 0) {
+					fLeft = m_fScores[2*HMM_STATES_CLASS-1];
+					iPrevLeft = 2*HMM_STATES_CLASS-1;
+				} else {
+					fLeft = m_fScores[HMM_STATES_CLASS-1];
+					if (fLeft > -FLT_MAX) {
+						fLeft += m_fPenaltySilenceToSpeech;
+					}
+					iPrevLeft = HMM_STATES_CLASS-1;
+				}
+			}
+			// get the best backtrace at time t
 			if (fLeft > fSelf) {
-				m_grid[i][j].fScore = fLeft+fSilenceScore;
-				m_grid[i][j].iPrev = iPrevLeft;
+				fScores[j] = fLeft+fEmissionScore;
+				iBackpointers[j] = iPrevLeft;
+			} else if (fSelf > -FLT_MAX) {
+				fScores[j] = fSelf+fEmissionScore;
+				iBackpointers[j] = j;
 			} else {
-				m_grid[i][j].fScore = fSelf+fSilenceScore;
-				m_grid[i][j].iPrev = iPrevSelf;
-			}	
+				fScores[j] = -FLT_MAX;
+				iBackpointers[j] = SAD_STATE_NONE;
+			}
 		}
 		
-		// speech states (all of them share the same mixture)
-		float fSpeechScore = -FLT_MAX;
-		fSpeechScore = m_hmmStateSpeech->computeEmissionProbability(mFeatures.getRowData(iFeatureVector),i);	
-		for(unsigned int j=0 ; j < HMM_STATES_CLASS ; ++j) {
-					
-			float fLeft = -FLT_MAX;
-			float fSelf = -FLT_MAX;
-			// self transition
-			if (j < i) {
-				fSelf = m_grid[i-1][j+HMM_STATES_CLASS].fScore;
-				iPrevSelf = j+HMM_STATES_CLASS;
-			}
-			// left to right silence to silence transition
-			if ((j > 0) && (i > 0)) {
-				fLeft = m_grid[i-1][j+HMM_STATES_CLASS-1].fScore;
-				iPrevLeft = j-1+HMM_STATES_CLASS;
-			} 
-			// left to right silence to speech transition
-			else if ((j == 0) && (i >= HMM_STATES_CLASS)) {
-				fLeft = m_grid[i-1][HMM_STATES_CLASS-1].fScore + m_fPenaltySilenceToSpeech;	
-				iPrevLeft = HMM_STATES_CLASS-1;
+		// keep scores close to zero so precision is not lost in long sessions
+		float fBest = -FLT_MAX;
+		for(unsigned int j=0 ; j < 2*HMM_STATES_CLASS ; ++j) {
+			fBest = max(fBest,fScores[j]);
+		}
+		for(unsigned int j=0 ; j < 2*HMM_STATES_CLASS ; ++j) {
+			m_fScores[j] = (fScores[j] > -FLT_MAX) ? fScores[j]-fBest : -FLT_MAX;
+		}
+	}
+	
+	// partial traceback: decide the frames on which all the paths alive agree
+	unsigned char iState = SAD_STATE_NONE;
+	int iFrame = getDecisionFrame(&iState);
+	if (iFrame != -1) {
+		decide(iFrame,iState);
+	}
+}
+
+// make room in the ring buffer for the back-pointers of the given frame
+void SADModule::makeRoom(int iFrame) {
+
+	// back-pointers are needed for the frames after the last frame decided
+	if (iFrame-m_iFrameDecided <= m_iRingFrames) {
+		return;
+	}
+	
+	// try to decide frames
+	unsigned char iState = SAD_STATE_NONE;
+	int iFrameDecision = getDecisionFrame(&iState);
+	if (iFrameDecision != -1) {
+		decide(iFrameDecision,iState);
+		if (iFrame-m_iFrameDecided <= m_iRingFrames) {
+			return;
+		}
+	}
+	
+	// no limit on the latency: grow the ring buffer
+	if (m_iFramesLatency == -1) {
+		int iRingFrames = 2*m_iRingFrames;
+		unsigned char *iBackpointers = new unsigned char[iRingFrames*2*HMM_STATES_CLASS];
+		for(int i=m_iFrameDecided+1 ; i < iFrame ; ++i) {
+			memcpy(iBackpointers+(i%iRingFrames)*(2*HMM_STATES_CLASS),getBackpointers(i),
+				2*HMM_STATES_CLASS*sizeof(unsigned char));
+		}
+		delete [] m_iBackpointers;
+		delete [] m_iPath;
+		m_iBackpointers = iBackpointers;
+		m_iRingFrames = iRingFrames;
+		m_iPath = new unsigned char[m_iRingFrames+1];
+		return;
+	}
+	
+	// maximum latency reached: decide the older half of the pending frames using the best path, paths 
+	// alive that disagree with it on those frames are pruned
+	int iFrameForced = m_iTimeFrame-1-(m_iFramesLatency/2);
+	assert(iFrameForced >= m_iFrameDecided);
+	unsigned char iStates[2*HMM_STATES_CLASS];
+	bool bAgree[2*HMM_STATES_CLASS];
+	int iBest = -1;
+	for(unsigned int j=0 ; j < 2*HMM_STATES_CLASS ; ++j) {
+		iStates[j] = (m_fScores[j] > -FLT_MAX) ? j : SAD_STATE_NONE;
+		bAgree[j] = (iStates[j] != SAD_STATE_NONE);
+		if (bAgree[j] && ((iBest == -1) || (m_fScores[j] > m_fScores[iBest]))) {
+			iBest = j;
+		}
+	}
+	assert(iBest != -1);
+	for(int i=m_iTimeFrame-1 ; i >= m_iFrameDecided ; --i) {
+		if (i <= iFrameForced) {
+			for(unsigned int j=0 ; j < 2*HMM_STATES_CLASS ; ++j) {
+				if (bAgree[j] && ((iStates[j] >= HMM_STATES_CLASS) != (iStates[iBest] >= HMM_STATES_CLASS))) {
+					bAgree[j] = false;
+				}
 			}
-			// get the best backtrace at time t	
-			if (fLeft > fSelf) {
-				m_grid[i][j+HMM_STATES_CLASS].fScore = fLeft+fSpeechScore;
-				m_grid[i][j+HMM_STATES_CLASS].iPrev = iPrevLeft;
-			} else {
-				m_grid[i][j+HMM_STATES_CLASS].fScore = fSelf+fSpeechScore;
-				m_grid[i][j+HMM_STATES_CLASS].iPrev = iPrevSelf;
+		}
+		if (i > m_iFrameDecided) {
+			unsigned char *iBackpointers = getBackpointers(i);
+			for(unsigned int j=0 ; j < 2*HMM_STATES_CLASS ; ++j) {
+				if (bAgree[j]) {
+					iStates[j] = iBackpointers[iStates[j]];
+				}
 			}
 		}
 	}
+	for(unsigned int j=0 ; j < 2*HMM_STATES_CLASS ; ++j) {
+		if (bAgree[j] == false) {
+			m_fScores[j] = -FLT_MAX;
+		}
+	}
+	decide(iFrameForced,iBest);
+	assert(iFrame-m_iFrameDecided <= m_iRingFrames);
 }
 
-// recover speech segments by doing back-tracking on the grid
-void SADModule::recoverSpeechSegments(VSpeechSegment &vSpeechSegment) {
+// return the last frame up to which all the paths alive agree on the type of audio (-1 if none), only the 
+// type of audio needs to be decided so paths do not need to converge to the same state
+int SADModule::getDecisionFrame(unsigned char *iState) {
 
-	// not enough features: return no speech segment
-	if (m_iTimeFrame < HMM_STATES_CLASS) {		
-		BVC_ERROR << "insufficient number of features, minimum number required: " << HMM_STATES_CLASS;
+	// states alive at the last frame
+	unsigned char iStates[2*HMM_STATES_CLASS];
+	int iStatesAlive = 0;
+	for(unsigned int j=0 ; j < 2*HMM_STATES_CLASS ; ++j) {
+		if (m_fScores[j] > -FLT_MAX) {
+			iStates[iStatesAlive++] = j;
+		}
 	}
-
-	// recover the best sequence of states doing back-tracking
-	GridElementSAD *elementAux = NULL;
-	SpeechSegment *segment = new SpeechSegment;
-	unsigned char iTypeCurrent = UCHAR_MAX;
-	
-	GridElementSAD *elementLastSilence = &m_grid.back()[HMM_STATES_CLASS-1];
-	GridElementSAD *elementLastSpeech = &m_grid.back()[2*HMM_STATES_CLASS-1];
-	// last state: silence
-	if (elementLastSilence->fScore > elementLastSpeech->fScore) {
-		iTypeCurrent = AUDIO_SEGMENT_SILENCE;
-		elementAux = elementLastSilence;
-	} 
-	// last state: speech
-	else {
-		iTypeCurrent = AUDIO_SEGMENT_SPEECH;
-		elementAux = elementLastSpeech;
-	}	
-	segment->iFrameEnd = m_iTimeFrame-1;
-	
-	unsigned int iFrame = m_iTimeFrame-2;
-	while(elementAux->iPrev != -1) {
-		unsigned char iTypeBack;
-		(elementAux->iPrev >= HMM_STATES_CLASS) ? iTypeBack = AUDIO_SEGMENT_SPEECH : iTypeBack = AUDIO_SEGMENT_SILENCE;
-		if (iTypeBack != iTypeCurrent) {
-			segment->iFrameStart = iFrame+1;
-			assert((segment->iFrameEnd-segment->iFrameStart) >= (HMM_STATES_CLASS-1));
-			if (iTypeCurrent == AUDIO_SEGMENT_SPEECH) {
-				vSpeechSegment.push_back(segment);
-			} else {
-				delete segment;
+	assert(iStatesAlive > 0);
+	*iState = iStates[0];
+	
+	// go back in time looking for the earliest frame at which the paths disagree
+	int iFrameDisagree = m_iTimeFrame;
+	for(int i=m_iTimeFrame-1 ; i >= m_iFrameDecided ; --i) {
+		bool bSpeech = (iStates[0] >= HMM_STATES_CLASS);
+		for(int j=1 ; j < iStatesAlive ; ++j) {
+			if ((iStates[j] >= HMM_STATES_CLASS) != bSpeech) {
+				iFrameDisagree = i;
+				break;
+			}
+		}
+		if (i > m_iFrameDecided) {
+			unsigned char *iBackpointers = getBackpointers(i);
+			for(int j=0 ; j < iStatesAlive ; ++j) {
+				iStates[j] = iBackpointers[iStates[j]];
+				assert(iStates[j] != SAD_STATE_NONE);
 			}
-			segment = newSpeechSegment(-1,iFrame);
-			iTypeCurrent = iTypeBack;
 		}
-		elementAux = &m_grid[iFrame-1][elementAux->iPrev];
-		--iFrame;
-	} 
-	segment->iFrameStart = 0;
-	assert((segment->iFrameEnd-segment->iFrameStart) >= (HMM_STATES_CLASS-1));
-	if (iTypeCurrent == AUDIO_SEGMENT_SPEECH) {
-		vSpeechSegment.push_back(segment);
-	} else {
-		delete segment;
 	}
 	
-	// reverse the elements in the vector
-	for(unsigned int i=0 ; i < vSpeechSegment.size()/2 ; ++i) {
-		SpeechSegment *segmentAux = vSpeechSegment[i];
-		vSpeechSegment[i] = vSpeechSegment[vSpeechSegment.size()-(i+1)];
-		vSpeechSegment[vSpeechSegment.size()-(i+1)] = segmentAux;
+	return (iFrameDisagree == m_iFrameDecided) ? -1 : iFrameDisagree-1;
+}
+
+// decide the frames up to the given one using the path that ends at the given state in the last frame
+void SADModule::decide(int iFrame, unsigned char iStateLast) {
+
+	assert((iFrame >= m_iFrameDecided) && (iFrame < m_iTimeFrame));
+	assert(m_iTimeFrame-1-m_iFrameDecided <= m_iRingFrames);
+
+	// recover the path
+	unsigned char iState = iStateLast;
+	for(int i=m_iTimeFrame-1 ; i >= m_iFrameDecided ; --i) {
+		assert(iState != SAD_STATE_NONE);
+		m_iPath[i-m_iFrameDecided] = iState;
+		if (i > m_iFrameDecided) {
+			iState = getBackpointers(i)[iState];
+		}
 	}
 	
-	//printSegments(*vSpeechSegment);
-	
-	// (4) apply padding to the left and right
-	unsigned int iSegment = 0;
-	SpeechSegment *segmentPrev = NULL;
-	for(VSpeechSegment::iterator it = vSpeechSegment.begin() ; it != vSpeechSegment.end() ; ++it, ++iSegment) {
-		// left padding (IMP: note that the previous segment was already right padded)
-		if (iSegment == 0) {
-			if ((*it)->iFrameStart-m_iFramesPadding > 0) {
-				(*it)->iFrameStart -= m_iFramesPadding;
-			} else {
-				(*it)->iFrameStart = 0;
+	for(int i=m_iFrameDecided ; i <= iFrame ; ++i) {
+		decideFrame(i,(m_iPath[i-m_iFrameDecided] >= HMM_STATES_CLASS) ? AUDIO_SEGMENT_SPEECH : AUDIO_SEGMENT_SILENCE);
+	}
+	m_iFrameDecided = iFrame+1;
+}
+
+// decide the given frame
+void SADModule::decideFrame(int iFrame, unsigned char iType) {
+
+	if (iType == AUDIO_SEGMENT_SPEECH) {
+		
+		// beginning of speech
+		if (m_iTypeLast != AUDIO_SEGMENT_SPEECH) {
+		
+			// right padding of the previous segment (up to half of the silence in between)
+			if (m_iFrameSpeechEnd != -1) {
+				int iFramesSilence = iFrame-m_iFrameSpeechEnd-1;
+				assert(iFramesSilence >= HMM_STATES_CLASS);
+				if (m_iFrameSpeechEnd+m_iFramesPadding < iFrame-(iFramesSilence/2)+1) {
+					endSpeech(m_iFrameSpeechEnd+m_iFramesPadding);
+				} else {
+					endSpeech(m_iFrameSpeechEnd+(iFramesSilence/2)+1);
+				}
 			}
-		} else {
-			if ((*it)->iFrameStart-m_iFramesPadding > segmentPrev->iFrameEnd) {
-				(*it)->iFrameStart -= m_iFramesPadding;
-			} else {
-				(*it)->iFrameStart = segmentPrev->iFrameEnd+1;
+			// left padding (the previous segment was already right padded)
+			int iFrameStart = iFrame-m_iFramesPadding;
+			if (m_iFrameSpeechEndPadded == -1) {
+				iFrameStart = max(iFrameStart,0);
+			} else if (iFrameStart <= m_iFrameSpeechEndPadded) {
+				iFrameStart = m_iFrameSpeechEndPadded+1;
 			}
-			assert((*it)->iFrameStart > segmentPrev->iFrameEnd);	
+			addEvent(SPEECH_EVENT_START,iFrameStart);
 		}
-		// right padding
-		if (iSegment == vSpeechSegment.size()-1) {
-			if ((*it)->iFrameEnd+m_iFramesPadding <= m_iTimeFrame-1) {
-				(*it)->iFrameEnd += m_iFramesPadding;
-			} else {
-				(*it)->iFrameEnd = m_iTimeFrame-1;
-			}
-		} else {
-			// get the next segment
-			VSpeechSegment::iterator jt = it;
-			jt++;
-			// apply padding
-			int iFramesSilence = (*jt)->iFrameStart-(*it)->iFrameEnd-1;
-			assert(iFramesSilence>=HMM_STATES_CLASS);
-			if ((*it)->iFrameEnd+m_iFramesPadding < ((*jt)->iFrameStart-(iFramesSilence/2)+1)) {
-				(*it)->iFrameEnd += m_iFramesPadding;
-			} else {
-				(*it)->iFrameEnd = (*it)->iFrameEnd+(iFramesSilence/2)+1;
+	} else {
+	
+		// end of speech
+		if (m_iTypeLast == AUDIO_SEGMENT_SPEECH) {
+			m_iFrameSpeechEnd = iFrame-1;
+			m_iFramesSilence = 0;
+		}
+		// the right padding is final once the silence is long enough, whatever comes next
+		if (m_iFrameSpeechEnd != -1) {
+			++m_iFramesSilence;
+			if ((m_iFramesPadding <= m_iFramesSilence) && 
+				(m_iFramesPadding < 2+m_iFramesSilence-(m_iFramesSilence/2))) {
+				endSpeech(m_iFrameSpeechEnd+m_iFramesPadding);
 			}
-			assert((*jt)->iFrameStart > (*it)->iFrameEnd);	
 		}
-		segmentPrev = *it;
 	}
+	m_iTypeLast = iType;
 }
 
-// terminates a SAD session
-void SADModule::endSession() {
+// close the last speech segment at the given frame (padding included)
+void SADModule::endSpeech(int iFrame) {
 
-	for(VGridElementSAD::iterator it = m_grid.begin() ; it != m_grid.end() ; ++it) {
-		delete [] *it;
-	}
-	m_grid.clear();
+	addEvent(SPEECH_EVENT_END,iFrame);
+	m_iFrameSpeechEndPadded = iFrame;
+	m_iFrameSpeechEnd = -1;
 }
 
-// print the grid using for dynamic programming
-void SADModule::printGrid() {
+// return the speech events decided since the last call
+void SADModule::getSpeechEvents(VSpeechEvent &vSpeechEvent) {
 
-	for(int j=0 ; j < m_iTimeFrame ; ++j) {	
-		printf("%12d (xx)",j);
+	vSpeechEvent.insert(vSpeechEvent.end(),m_vSpeechEvent.begin(),m_vSpeechEvent.end());
+	m_vSpeechEvent.clear();
+}
+
+// decide the remaining frames and return the speech segments not returned as events yet
+void SADModule::recoverSpeechSegments(VSpeechSegment &vSpeechSegment) {
+
+	// not enough features: return no speech segment
+	if (m_iTimeFrame < HMM_STATES_CLASS) {		
+		BVC_ERROR << "insufficient number of features, minimum number required: " << HMM_STATES_CLASS;
 	}
-	printf("\n");
-	for(unsigned int i=0 ; i < 2*HMM_STATES_CLASS ; ++i) {	
-		for(int j=0 ; j < m_iTimeFrame ; ++j) {	
-			if (m_grid[j][i].fScore == -FLT_MAX) {
-				printf("%12.2f (xx)",0.0);
-			} else {
-				printf("%12.2f (%2d)",m_grid[j][i].fScore,m_grid[j][i].iPrev);
+	
+	if (m_bFinished == false) {
+	
+		// the best path ends at the last state of either silence or speech
+		unsigned char iState = SAD_STATE_NONE;
+		if (m_fScores[HMM_STATES_CLASS-1] > m_fScores[2*HMM_STATES_CLASS-1]) {
+			iState = HMM_STATES_CLASS-1;
+		} else if (m_fScores[2*HMM_STATES_CLASS-1] > -FLT_MAX) {
+			iState = 2*HMM_STATES_CLASS-1;
+		} 
+		// both were pruned to meet the latency: the best state alive
+		else {
+			for(unsigned int j=0 ; j < 2*HMM_STATES_CLASS ; ++j) {
+				if ((m_fScores[j] > -FLT_MAX) && ((iState == SAD_STATE_NONE) || (m_fScores[j] > m_fScores[iState]))) {
+					iState = j;
+				}
+			}
+		}
+		if (m_iFrameDecided < m_iTimeFrame) {
+			decide(m_iTimeFrame-1,iState);
+		}
+		
+		// close the last segment
+		if (m_iTypeLast == AUDIO_SEGMENT_SPEECH) {
+			endSpeech(m_iTimeFrame-1);
+		} else if (m_iFrameSpeechEnd != -1) {
+			endSpeech(min(m_iFrameSpeechEnd+m_iFramesPadding,m_iTimeFrame-1));
+		}
+		m_bFinished = true;
+	}
+	
+	// pair the events (a segment whose start was already returned gets -1 as its start)
+	SpeechSegment *segment = NULL;
+	for(VSpeechEvent::iterator it = m_vSpeechEvent.begin() ; it != m_vSpeechEvent.end() ; ++it) {
+		if (it->iType == SPEECH_EVENT_START) {
+			assert(segment == NULL);
+			segment = newSpeechSegment(it->iFrame,-1);
+		} else {
+			if (segment == NULL) {
+				segment = newSpeechSegment(-1,-1);
 			}
+			segment->iFrameEnd = it->iFrame;
+			assert((segment->iFrameStart == -1) || (segment->iFrameStart <= segment->iFrameEnd));
+			vSpeechSegment.push_back(segment);
+			segment = NULL;
 		}
-		printf("\n");
 	}
+	assert(segment == NULL);
+	m_vSpeechEvent.clear();
 }
 
-};	// end-of-namespace
-
+// terminates a SAD session
+void SADModule::endSession() {
 
+	m_vSpeechEvent.clear();
+}
 
+};	// end-of-namespace
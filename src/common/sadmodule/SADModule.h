@@ -32,12 +32,14 @@ class PhoneSet;
 
 #define HMM_STATES_CLASS		5	// number of HMM-states for Silence/Speech
 
-typedef struct {
-	float fScore;
-	int iPrev;
-} GridElementSAD;
+// initial capacity (in frames) of the ring buffer of back-pointers when the latency is not bounded
+#define SAD_RING_FRAMES_INITIAL	512
+
+// minimum latency (in frames) that can be imposed on the decisions
+#define SAD_LATENCY_MIN				(4*HMM_STATES_CLASS)
 
-typedef vector<GridElementSAD*> VGridElementSAD;
+// back-pointer of a state that cannot be reached
+#define SAD_STATE_NONE				UCHAR_MAX
 
 // types of audio segments
 #define AUDIO_SEGMENT_SILENCE			0
@@ -50,6 +52,17 @@ typedef struct {
 
 typedef vector<SpeechSegment*> VSpeechSegment;
 
+// types of speech events
+#define SPEECH_EVENT_START				0
+#define SPEECH_EVENT_END				1
+
+typedef struct {
+	unsigned char iType;		// start or end of speech
+	int iFrame;					// time frame (padding included)
+} SpeechEvent;
+
+typedef vector<SpeechEvent> VSpeechEvent;
+
 /**
 	@author daniel <dani.bolanos@gmail.com>
 */
@@ -65,10 +78,58 @@ class SADModule {
 		HMMStateDecoding *m_hmmStateSilence;	// silence HMM-state
 		HMMStateDecoding *m_hmmStateSpeech;		// speech HMM-state
 		int m_iFramesPadding;						// # of frames used to pad the beginning and end of the speech segment
-		VGridElementSAD m_grid;						// grid to do the Viterbi search
+		int m_iFramesLatency;						// max # of frames a decision can be delayed (-1: no limit)
 		int m_iTimeFrame;								// current time frame within the session
 		int m_iDim;										// feature dimensionality
 		
+		// Viterbi search: only the scores of the last frame and the back-pointers of the frames not decided 
+		// yet are kept, back-pointers are stored in a ring buffer (one row per frame)
+		float m_fScores[2*HMM_STATES_CLASS];	// scores of the states at the last frame
+		unsigned char *m_iBackpointers;			// ring buffer of back-pointers
+		unsigned char *m_iPath;						// auxiliar buffer to recover the best path
+		int m_iRingFrames;							// capacity of the ring buffer (in frames)
+		int m_iFrameDecided;							// first time frame not decided
+		vector<float> m_vScoresSilence;			// emission scores for a batch of features
+		vector<float> m_vScoresSpeech;			// emission scores for a batch of features
+		bool m_bFinished;								// whether all the frames were decided
+		
+		// decided frames
+		unsigned char m_iTypeLast;					// audio type of the last frame decided
+		int m_iFrameSpeechEnd;						// end of the last speech segment (-1 if its end event was sent)
+		int m_iFrameSpeechEndPadded;				// end of the previous speech segment (padding included)
+		int m_iFramesSilence;						// # of silence frames decided after the last speech segment
+		VSpeechEvent m_vSpeechEvent;				// speech events not delivered yet
+		
+		// return the back-pointers of the given time frame
+		inline unsigned char *getBackpointers(int iFrame) {
+		
+			return m_iBackpointers+(iFrame%m_iRingFrames)*(2*HMM_STATES_CLASS);
+		}
+		
+		// make room in the ring buffer for the back-pointers of the given frame
+		void makeRoom(int iFrame);
+		
+		// return the last frame up to which all the paths alive agree on the type of audio (-1 if none)
+		int getDecisionFrame(unsigned char *iState);
+		
+		// decide the frames up to the given one using the path that ends at the given state in the last frame
+		void decide(int iFrame, unsigned char iStateLast);
+		
+		// decide the given frame
+		void decideFrame(int iFrame, unsigned char iType);
+		
+		// close the last speech segment at the given frame (padding included)
+		void endSpeech(int iFrame);
+		
+		// add a speech event
+		inline void addEvent(unsigned char iType, int iFrame) {
+		
+			SpeechEvent event;
+			event.iType = iType;
+			event.iFrame = iFrame;
+			m_vSpeechEvent.push_back(event);
+		}
+		
 		static SpeechSegment *newSpeechSegment(int iFrameStart, int iFrameEnd) {
 			
 			SpeechSegment *segment = new SpeechSegment;
@@ -77,14 +138,13 @@ class SADModule {
 			return segment;
 		}
 		
-		// print the grid using for dynamic programming
-		 void printGrid();	
 
 	public:
 
 		// constructor
 		SADModule(PhoneSet *phoneSet, HMMManager *hmmManager, int iMaxGaussianComponentsSilence,
-			int iMaxGaussianComponentsSpeech, float fPenaltySilenceToSpeech, int iFramesPadding);
+			int iMaxGaussianComponentsSpeech, float fPenaltySilenceToSpeech, int iFramesPadding, 
+			int iFramesLatency = -1);
 		
 		// destructor
 		~SADModule();
@@ -101,7 +161,11 @@ class SADModule {
 		// proces the given features
 		void processFeatures(MatrixBase<float> &mFeatures);
 		
-		// recover speech segments by doing back-tracking on the grid
+		// return the speech events decided since the last call (frames are decided as soon as all the paths 
+		// alive agree on them or once the maximum latency is reached)
+		void getSpeechEvents(VSpeechEvent &vSpeechEvent);
+		
+		// decide the remaining frames and return the speech segments not returned as events yet
 		void recoverSpeechSegments(VSpeechSegment &vSpeechSegment);	
 		
 		// print the segment information to the standard output
@@ -17,7 +17,11 @@
  *---------------------------------------------------------------------------------------------*/
 
 
+#include <algorithm>
+
+#include "LogMessage.h"
 #include "TextAligner.h"
+#include "TrnFile.h"
 
 namespace Bavieca {
 
@@ -39,6 +43,17 @@ TextAlignment *TextAligner::align(VLexUnit &vLexUnitHyp, VLexUnit &vLexUnitRef,
 	if (vLexUnitRef.empty()) {
 		return NULL;
 	}
+	
+	// banded alignment, the band is doubled until it is guaranteed to contain the best path
+	// note: unpenalized trailing deletions invalidate the bound on the cost of paths leaving the band
+	if (bPenalizeTrailingDeletions) {
+		for(int iBand = TEXT_ALIGNMENT_BAND_WIDTH ; ; iBand *= 2) {
+			TextAlignment *textAlignment = alignBanded(vLexUnitHyp,vLexUnitRef,iBand);
+			if (textAlignment) {
+				return textAlignment;
+			}
+		}
+	}
 
 	TextAlignment *textAlignment = new TextAlignment(m_lexiconManager);
  
@@ -179,6 +194,245 @@ TextAlignment *TextAligner::align(VLexUnit &vLexUnitHyp, VLexUnit &vLexUnitRef,
    return textAlignment;
 }
 
+// align two sequences of lexical units keeping only the cells within a band around the diagonal, 
+// it returns NULL if the band is not wide enough to guarantee the result of the full alignment
+// note: any path leaving the band needs at least |iRef-iHyp|+2*iBand+2 insertions and deletions, if 
+// the best path within the band is cheaper the full alignment (tie-breaking included) follows it
+TextAlignment *TextAligner::alignBanded(VLexUnit &vLexUnitHyp, VLexUnit &vLexUnitRef, int iBand) {
+
+	int iHyp = (int)vLexUnitHyp.size();
+	int iRef = (int)vLexUnitRef.size();
+	int iDiff = iRef-iHyp;
+	
+	// band limits (diagonal = column - row)
+	int iDiagonalLow = min(0,iDiff)-iBand;
+	int iDiagonalHigh = max(0,iDiff)+iBand;
+	int iWidth = iDiagonalHigh-iDiagonalLow+1;
+	bool bComplete = (iDiagonalLow <= -iHyp) && (iDiagonalHigh >= iRef);
+	
+	m_vEvents.resize((iHyp+1)*iWidth);
+	m_vScorePrev.assign(iWidth,TEXT_ALIGNMENT_SCORE_INFINITE);
+	m_vScore.assign(iWidth,TEXT_ALIGNMENT_SCORE_INFINITE);
+	
+	// fill the band row by row (same decisions as the full grid)
+	for(int i=0 ; i <= iHyp ; ++i) {
+		unsigned char *iEvents = &m_vEvents[i*iWidth];
+		for(int c=0 ; c < iWidth ; ++c) {
+			int j = i+iDiagonalLow+c;
+			if ((j < 0) || (j > iRef)) {
+				m_vScore[c] = TEXT_ALIGNMENT_SCORE_INFINITE;
+				continue;
+			}
+			if (i == 0) {
+				m_vScore[c] = j*TEXT_ALIGNMENT_PENALTY_DELETION;
+				iEvents[c] = TEXT_ALIGNMENT_EVENT_DELETION;
+			} else if (j == 0) {
+				m_vScore[c] = i*TEXT_ALIGNMENT_PENALTY_INSERTION;
+				iEvents[c] = TEXT_ALIGNMENT_EVENT_INSERTION;
+			} else {
+				int iDel = ((c > 0) ? m_vScore[c-1] : TEXT_ALIGNMENT_SCORE_INFINITE)+TEXT_ALIGNMENT_PENALTY_DELETION;
+				int iIns = ((c+1 < iWidth) ? m_vScorePrev[c+1] : TEXT_ALIGNMENT_SCORE_INFINITE)+
+					TEXT_ALIGNMENT_PENALTY_INSERTION;
+				bool bCor = (vLexUnitHyp[i-1]->iLexUnit == vLexUnitRef[j-1]->iLexUnit);
+				int iSub = m_vScorePrev[c]+(bCor ? 0 : TEXT_ALIGNMENT_PENALTY_SUBSTITUTION);
+				if ((iSub < iDel) && (iSub < iIns)) {
+					m_vScore[c] = iSub;
+					iEvents[c] = bCor ? TEXT_ALIGNMENT_EVENT_CORRECT : TEXT_ALIGNMENT_EVENT_SUBSTITUTION;
+				} else if (iIns < iDel) {
+					m_vScore[c] = iIns;
+					iEvents[c] = TEXT_ALIGNMENT_EVENT_INSERTION;
+				} else {
+					m_vScore[c] = iDel;
+					iEvents[c] = TEXT_ALIGNMENT_EVENT_DELETION;
+				}
+			}
+		}
+		m_vScorePrev.swap(m_vScore);
+	}
+	
+	// check that the best path cannot leave the band
+	int iScore = m_vScorePrev[iDiff-iDiagonalLow];
+	if ((bComplete == false) && 
+		(iScore >= TEXT_ALIGNMENT_PENALTY_INSERTION*(abs(iDiff)+2*iBand+2))) {
+		return NULL;
+	}
+	
+	// trace back
+	vector<unsigned char> vEvents;
+	for(int i = iHyp, c = iDiff-iDiagonalLow ; (i > 0) || (i+iDiagonalLow+c > 0) ; ) {
+		unsigned char iEvent = m_vEvents[i*iWidth+c];
+		vEvents.push_back(iEvent);
+		if (iEvent == TEXT_ALIGNMENT_EVENT_DELETION) {
+			--c;
+		} else if (iEvent == TEXT_ALIGNMENT_EVENT_INSERTION) {
+			--i;
+			++c;
+		} else {
+			--i;
+		}
+	}
+	
+	TextAlignment *textAlignment = new TextAlignment(m_lexiconManager);
+	textAlignment->setScore(iScore);
+	int iIndexHyp = 0;
+	int iIndexRef = 0;
+	for(vector<unsigned char>::reverse_iterator it = vEvents.rbegin() ; it != vEvents.rend() ; ++it) {
+		if (*it == TEXT_ALIGNMENT_EVENT_DELETION) {
+			addElement(textAlignment,*it,iIndexRef++,-1,vLexUnitHyp,vLexUnitRef);
+		} else if (*it == TEXT_ALIGNMENT_EVENT_INSERTION) {
+			addElement(textAlignment,*it,-1,iIndexHyp++,vLexUnitHyp,vLexUnitRef);
+		} else {
+			addElement(textAlignment,*it,iIndexRef++,iIndexHyp++,vLexUnitHyp,vLexUnitRef);
+		}
+	}
+	
+	return textAlignment;
+}
+
+// add an element to the alignment
+void TextAligner::addElement(TextAlignment *textAlignment, int iEvent, int iRef, int iHyp, 
+	VLexUnit &vLexUnitHyp, VLexUnit &vLexUnitRef) {
+	
+	int iLexUnitRef = (iRef == -1) ? m_lexiconManager->m_lexUnitUnknown->iLexUnit : vLexUnitRef[iRef]->iLexUnit;
+	int iLexUnitHyp = (iHyp == -1) ? m_lexiconManager->m_lexUnitUnknown->iLexUnit : vLexUnitHyp[iHyp]->iLexUnit;
+	textAlignment->addElement(iEvent,iRef,iLexUnitRef,iHyp,iLexUnitHyp);
+}
+
+// compute the error counts of the alignment of two sequences of lexical units without keeping 
+// the alignment (same result as align), it returns false if the reference is empty
+// note: each cell keeps the counts of the path selected to reach it, two rows of cells are needed
+bool TextAligner::computeErrors(VLexUnit &vLexUnitHyp, VLexUnit &vLexUnitRef, TAErrors &errors, 
+	bool bPenalizeTrailingDeletions) {
+
+	reset(errors);
+	if (vLexUnitRef.empty()) {
+		return false;
+	}
+	
+	// lexical unit ids are kept contiguous
+	int iHyp = (int)vLexUnitHyp.size();
+	int iRef = (int)vLexUnitRef.size();
+	m_vLexUnitHyp.resize(iHyp);
+	m_vLexUnitRef.resize(iRef);
+	for(int i=0 ; i < iHyp ; ++i) {
+		m_vLexUnitHyp[i] = vLexUnitHyp[i]->iLexUnit;
+	}
+	for(int j=0 ; j < iRef ; ++j) {
+		m_vLexUnitRef[j] = vLexUnitRef[j]->iLexUnit;
+	}
+	
+	// first row: deletions
+	m_vCellsPrev.resize(iRef+1);
+	m_vCells.resize(iRef+1);
+	for(int j=0 ; j <= iRef ; ++j) {
+		m_vCellsPrev[j].iScore = j*TEXT_ALIGNMENT_PENALTY_DELETION;
+		m_vCellsPrev[j].iSubstitutions = 0;
+		m_vCellsPrev[j].iDeletions = j;
+		m_vCellsPrev[j].iInsertions = 0;
+	}
+	
+	// remaining rows (same decisions as align)
+	for(int i=1 ; i <= iHyp ; ++i) {
+		TACell *cellsPrev = &m_vCellsPrev[0];
+		TACell *cells = &m_vCells[0];
+		cells[0].iScore = i*TEXT_ALIGNMENT_PENALTY_INSERTION;
+		cells[0].iSubstitutions = 0;
+		cells[0].iDeletions = 0;
+		cells[0].iInsertions = i;
+		int iPenaltyDeletion = ((i == iHyp) && (bPenalizeTrailingDeletions == false)) ? 0 : 
+			TEXT_ALIGNMENT_PENALTY_DELETION;
+		int iLexUnitHyp = m_vLexUnitHyp[i-1];
+		for(int j=1 ; j <= iRef ; ++j) {
+			int iDel = cells[j-1].iScore+iPenaltyDeletion;
+			int iIns = cellsPrev[j].iScore+TEXT_ALIGNMENT_PENALTY_INSERTION;
+			bool bCor = (iLexUnitHyp == m_vLexUnitRef[j-1]);
+			int iSub = cellsPrev[j-1].iScore+(bCor ? 0 : TEXT_ALIGNMENT_PENALTY_SUBSTITUTION);
+			if ((iSub < iDel) && (iSub < iIns)) {
+				cells[j] = cellsPrev[j-1];
+				cells[j].iScore = iSub;
+				cells[j].iSubstitutions += (bCor ? 0 : 1);
+			} else if (iIns < iDel) {
+				cells[j] = cellsPrev[j];
+				cells[j].iScore = iIns;
+				++cells[j].iInsertions;
+			} else {
+				cells[j] = cells[j-1];
+				cells[j].iScore = iDel;
+				++cells[j].iDeletions;
+			}
+		}
+		m_vCellsPrev.swap(m_vCells);
+	}
+	
+	TACell &cell = m_vCellsPrev[iRef];
+	errors.iSubstitutions = cell.iSubstitutions;
+	errors.iDeletions = cell.iDeletions;
+	errors.iInsertions = cell.iInsertions;
+	errors.iCorrect = iRef-cell.iSubstitutions-cell.iDeletions;
+	errors.iWordsReference = iRef;
+	
+	return true;
+}
+
+// score a set of hypotheses against the references (utterances are distributed across threads), 
+// errors are accumulated and the number of utterances scored is returned
+unsigned int TextAligner::computeErrors(TrnFile &trnFileHyp, TrnFile &trnFileRef, TAErrors &errors, 
+	int iThreads) {
+
+	// pair each hypothesis with its reference
+	vector<const char*> vHyp;
+	vector<const char*> vRef;
+	for(unsigned int i=0 ; i < trnFileHyp.size() ; ++i) {
+		TrnEntry *trnEntry = trnFileHyp.getEntry(i);
+		const char *strReference = trnFileRef.getTranscription(trnEntry->strUtteranceId.c_str());
+		if (strReference == NULL) {
+			BVC_WARNING << "no reference found for utterance: " << trnEntry->strUtteranceId;
+			continue;
+		}
+		vHyp.push_back(trnEntry->strTranscription.c_str());
+		vRef.push_back(strReference);
+	}
+	
+	int iCorrect = 0;
+	int iSubstitutions = 0;
+	int iDeletions = 0;
+	int iInsertions = 0;
+	int iWordsReference = 0;
+	int iUtterances = (int)vHyp.size();
+	
+	#pragma omp parallel num_threads(iThreads) reduction(+:iCorrect,iSubstitutions,iDeletions,iInsertions,iWordsReference)
+	{
+		TextAligner textAligner(m_lexiconManager);
+		VLexUnit vLexUnitHyp;
+		VLexUnit vLexUnitRef;
+		TAErrors errorsUtterance;
+		bool bAllKnown;
+		
+		#pragma omp for schedule(dynamic,64)
+		for(int i=0 ; i < iUtterances ; ++i) {
+			vLexUnitHyp.clear();
+			vLexUnitRef.clear();
+			m_lexiconManager->getLexUnits(vHyp[i],vLexUnitHyp,bAllKnown);
+			m_lexiconManager->getLexUnits(vRef[i],vLexUnitRef,bAllKnown);
+			if (textAligner.computeErrors(vLexUnitHyp,vLexUnitRef,errorsUtterance)) {
+				iCorrect += errorsUtterance.iCorrect;
+				iSubstitutions += errorsUtterance.iSubstitutions;
+				iDeletions += errorsUtterance.iDeletions;
+				iInsertions += errorsUtterance.iInsertions;
+				iWordsReference += errorsUtterance.iWordsReference;
+			}
+		}
+	}
+	
+	errors.iCorrect += iCorrect;
+	errors.iSubstitutions += iSubstitutions;
+	errors.iDeletions += iDeletions;
+	errors.iInsertions += iInsertions;
+	errors.iWordsReference += iWordsReference;
+	
+	return (unsigned int)iUtterances;
+}
+
 };	// end-of-namespace
 
 
@@ -20,6 +20,10 @@
 #ifndef TEXTALIGNER_H
 #define TEXTALIGNER_H
 
+using namespace std;
+
+#include <vector>
+
 #include "LexiconManager.h"
 #include "TextAlignment.h"
 
@@ -40,6 +44,31 @@ typedef struct _TAGridElement {
 #define TEXT_ALIGNMENT_PENALTY_DELETION				3
 #define TEXT_ALIGNMENT_PENALTY_INSERTION				3
 
+// initial half-width of the band (in words) around the diagonal for banded alignment
+#define TEXT_ALIGNMENT_BAND_WIDTH						8
+
+// score of cells outside the band
+#define TEXT_ALIGNMENT_SCORE_INFINITE				(INT_MAX/4)
+
+// alignment error counts
+typedef struct {
+	int iCorrect;						// correct words
+	int iSubstitutions;				// substitutions
+	int iDeletions;					// deletions
+	int iInsertions;					// insertions
+	int iWordsReference;				// words in the reference
+} TAErrors;
+
+// cell of the count-only alignment (error counts of the best path to the cell)
+typedef struct {
+	int iScore;
+	int iSubstitutions;
+	int iDeletions;
+	int iInsertions;
+} TACell;
+
+class TrnFile;
+
 /**
 	@author daniel <dani.bolanos@gmail.com>
 */
@@ -48,6 +77,22 @@ class TextAligner {
 	private:
 	
 		LexiconManager *m_lexiconManager;
+		// buffers reused across alignments
+		vector<int> m_vLexUnitHyp;
+		vector<int> m_vLexUnitRef;
+		vector<TACell> m_vCellsPrev;
+		vector<TACell> m_vCells;
+		vector<int> m_vScorePrev;
+		vector<int> m_vScore;
+		vector<unsigned char> m_vEvents;
+		
+		// align two sequences of lexical units keeping only the cells within a band around the diagonal, 
+		// it returns NULL if the band is not wide enough to guarantee the result of the full alignment
+		TextAlignment *alignBanded(VLexUnit &vLexUnitHyp, VLexUnit &vLexUnitRef, int iBand);
+		
+		// add an element to the alignment
+		void addElement(TextAlignment *textAlignment, int iEvent, int iRef, int iHyp, 
+			VLexUnit &vLexUnitHyp, VLexUnit &vLexUnitRef);
 	
 	public:
 
@@ -60,6 +105,42 @@ class TextAligner {
 		// align two sequences of lexical units
 		TextAlignment *align(VLexUnit &vLexUnitHyp, VLexUnit &vLexUnitRef, 
 			bool bPenalizeTrailingDeletions = true);
+			
+		// compute the error counts of the alignment of two sequences of lexical units without keeping 
+		// the alignment (same result as align), it returns false if the reference is empty
+		bool computeErrors(VLexUnit &vLexUnitHyp, VLexUnit &vLexUnitRef, TAErrors &errors, 
+			bool bPenalizeTrailingDeletions = true);
+			
+		// score a set of hypotheses against the references (utterances are distributed across threads), 
+		// errors are accumulated and the number of utterances scored is returned
+		unsigned int computeErrors(TrnFile &trnFileHyp, TrnFile &trnFileRef, TAErrors &errors, int iThreads);
+		
+		// reset error counts
+		static void reset(TAErrors &errors) {
+		
+			errors.iCorrect = 0;
+			errors.iSubstitutions = 0;
+			errors.iDeletions = 0;
+			errors.iInsertions = 0;
+			errors.iWordsReference = 0;
+		}
+		
+		// print error counts
+		static void print(TAErrors &errors) {
+		
+			int iErrors = errors.iSubstitutions+errors.iDeletions+errors.iInsertions;
+			float fWER = (errors.iWordsReference > 0) ? (iErrors*100.0f)/((float)errors.iWordsReference) : 0.0f;
+			printf("-- wer stats ------------------\n");
+			printf("events:\n");
+			printf(" -sub:      %8d\n",errors.iSubstitutions);
+			printf(" -del:      %8d\n",errors.iDeletions);
+			printf(" -ins:      %8d\n",errors.iInsertions);
+			printf(" -correct:  %8d\n",errors.iCorrect);
+			printf(" -errors:   %8d\n",iErrors);
+			printf("WER:       %8.2f%%\n",fWER);
+			printf("Accuracy:  %8.2f%%\n",100.0-fWER);
+			printf("-------------------------------\n");
+		}
 
 };
 
@@ -77,6 +77,20 @@ class TextAlignment {
 			return m_iAlignmentEvents[getIndex(TEXT_ALIGNMENT_EVENT_CORRECT)];
 		}
 		
+		// return the number of errors (substitutions, deletions and insertions)
+		inline int getErrors() {
+		
+			return m_iAlignmentEvents[getIndex(TEXT_ALIGNMENT_EVENT_SUBSTITUTION)]+
+				m_iAlignmentEvents[getIndex(TEXT_ALIGNMENT_EVENT_DELETION)]+
+				m_iAlignmentEvents[getIndex(TEXT_ALIGNMENT_EVENT_INSERTION)];
+		}
+		
+		// return the number of words in the reference
+		inline int getWordsReference() {
+		
+			return m_iWordsReference;
+		}
+		
 		// get the event index
 		inline int getIndex(int iEvent) {
 			
@@ -41,10 +41,7 @@ ActiveStateTable::ActiveStateTable(float fPruningLikelihood, int iPruningMaxStat
 	// lattice generation
 	m_bLatticeGeneration = bLatticeGeneration;
 	m_iMaxWordSequencesState = iMaxWordSequencesState;
-	m_iWSHashBuckets = UINT_MAX;
-	m_iWSHashEntries = UINT_MAX;	
-	m_wshashEntries = NULL;
-	m_iWSHashEntryCollisionAvailable = -1;
+	m_wordSequenceTrie = NULL;
 	m_iLexUnitPronSilence = m_lexiconManager->getLexUnitSilence()->iLexUnitPron;
 	m_iLexUnitPronUnknown = m_lexiconManager->m_lexUnitUnknown->iLexUnitPron;
 		
@@ -83,9 +80,8 @@ ActiveStateTable::~ActiveStateTable()
 	if (m_historyItems) {
 		delete [] m_historyItems;
 	}
-	if (m_wshashEntries) {
-		cleanHashWordSequences();	
-		delete [] m_wshashEntries;
+	if (m_wordSequenceTrie) {
+		delete m_wordSequenceTrie;
 	}
 	if (m_wgTokens) {
 		delete [] m_wgTokens;
@@ -131,15 +127,8 @@ void ActiveStateTable::initialize() {
 	
 	// lattice generation
 	if (m_bLatticeGeneration) {
-		// allocate memory for the hash table
-		m_iWSHashBuckets = 100000;
-		m_iWSHashEntries = 2*m_iWSHashBuckets;
-		m_wshashEntries = new WSHashEntry[m_iWSHashEntries];
-		// set all the entries as "old"
-		for(int i=0 ; i < (int)m_iWSHashEntries ; ++i) {
-			m_wshashEntries[i].iTime = -1;
-		}	
-		m_iWSHashEntryCollisionAvailable = m_iWSHashBuckets;	
+		// unique word sequences (grows as needed)
+		m_wordSequenceTrie = new WordSequenceTrie();
 		
 		// lattice token management
 		m_iWGTokens = m_iActiveStatesMax*m_iMaxWordSequencesState; 
@@ -195,26 +184,6 @@ float ActiveStateTable::computeCollisionFactor() {
 	return ((float)iCollisions)/((float)iValid);
 }
 
-// compute the load factor of the hash table containing unque word sequences
-float ActiveStateTable::computeLoadFactorHashWordSequences(int *iBucketsUsed, int *iCollisions) {
-
-	// count 
-	*iBucketsUsed = 0;
-	*iCollisions = 0;
-	for(unsigned int i=0 ; i < m_iWSHashEntries ; ++i) {
-		if (m_wshashEntries[i].iTime > -1) {
-			if (i < m_iWSHashBuckets) {
-				++(*iBucketsUsed);
-			} else {
-				++(*iCollisions);
-			}
-		}
-	}
-
-	// load factor
-	return ((float)(*iBucketsUsed))/((float)m_iWSHashBuckets);
-}
-
 // shows object information
 void ActiveStateTable::printInfo() {
 
@@ -244,6 +213,7 @@ void ActiveStateTable::activateStateInitial(StateX *state) {
 	historyItem->iPrev = -1;
 	historyItem->iActive = -1;
 	historyItem->iWGToken = -1;
+	historyItem->iWordSequence = -1;
 
 	// treat it like an epsilon state
 	m_activeStateEpsilonTail->state = state;	
@@ -265,7 +235,7 @@ void ActiveStateTable::activateStateInitial(StateX *state) {
 }
 
 // process epsilon transitions in topological order
-void ActiveStateTable::processEpsilonTransitions(float *fFeatureVector, float *fScoreBest) {
+void ActiveStateTable::processEpsilonTransitions(float *fFeatureVector, int iTimeEmission, float *fScoreBest) {
 
 	TransitionX *transition = NULL;
 	TransitionX *transitionEnd = NULL;
@@ -384,7 +354,7 @@ void ActiveStateTable::processEpsilonTransitions(float *fFeatureVector, float *f
 					
 						// compute emission probability
 						hmmStateDecoding = &m_hmmStatesDecoding[transitionAux->iSymbol];
-						fScore = hmmStateDecoding->computeEmissionProbability(fFeatureVector,m_iTimeCurrent);	
+						fScore = hmmStateDecoding->computeEmissionProbability(fFeatureVector,iTimeEmission);	
 						
 						// preventive pruning
 						if (m_activeStateEpsilonHead->fScore+transition->fWeight+transitionAux->fWeight+fScore < (*fScoreBest-m_fPruningLikelihood)) {
@@ -408,7 +378,7 @@ void ActiveStateTable::processEpsilonTransitions(float *fFeatureVector, float *f
 			
 				// compute emission probability
 				hmmStateDecoding = &m_hmmStatesDecoding[transition->iSymbol];
-				float fScore = hmmStateDecoding->computeEmissionProbability(fFeatureVector,0);
+				float fScore = hmmStateDecoding->computeEmissionProbability(fFeatureVector,iTimeEmission);
 			
 				// preventive pruning goes here
 				
@@ -531,6 +501,9 @@ void ActiveStateTable::beamPruning(float *fScoreBest) {
 // lattice tokens belonging to the removed elements is lost
 void ActiveStateTable::historyItemGarbageCollection() {
 	
+	BVC_PROFILE_TIMER_BEGIN(iCycles);
+	BVC_PROFILE_COUNT(PROFILE_COUNTER_GC_RUNS,1);
+	
 	unsigned int iItemsActive = 0;
 	unsigned int iTokensActive = 0;
 	
@@ -738,6 +711,7 @@ void ActiveStateTable::historyItemGarbageCollection() {
 	}
 	// (2') there are inactive items: create a linked list with them
 	else {
+		BVC_PROFILE_COUNT(PROFILE_COUNTER_GC_ITEMS_SWEPT,m_iHistoryItems-iItemsActive);
 		int *iHistoryItemAux = &m_iHistoryItemAvailable;
 		for(unsigned int i = 0 ; i < m_iHistoryItems ; ++i) {
 			if (m_historyItems[i].iActive != m_iTimeCurrent) {
@@ -813,6 +787,8 @@ void ActiveStateTable::historyItemGarbageCollection() {
 	delete [] bTokensActive;
 	
 	m_iTimeGarbageCollectionLast = m_iTimeCurrent;
+	
+	BVC_PROFILE_TIMER_END(PROFILE_TIMER_GC,iCycles);
 }
 
 // recovers the best path from the list of active states
@@ -994,13 +970,12 @@ void ActiveStateTable::printHashTableWordSequences() {
 
 	int iBucketsUsed = 0;
 	int iCollisions = 0;
-	float fLoadFactor = computeLoadFactorHashWordSequences(&iBucketsUsed,&iCollisions);
+	float fLoadFactor = m_wordSequenceTrie->computeLoadFactor(&iBucketsUsed,&iCollisions);
 	
 	printf("- hash table containing word-sequences ---\n");
-	printf(" # buckets:      %8d\n",m_iWSHashBuckets);
+	printf(" # word-sequences: %8d\n",m_wordSequenceTrie->size());
 	printf(" # buckets used: %8d\n",iBucketsUsed);
 	printf(" # collisions:   %8d\n",iCollisions);
-	printf(" # elements:     %8d\n",iBucketsUsed+iCollisions);
 	printf(" load factor: %8.4f\n",fLoadFactor);
 	printf("------------------------------------------\n");
 }
@@ -1072,6 +1047,7 @@ HypothesisLattice *ActiveStateTable::getHypothesisLattice() {
 				historyItem->iPrev = activeState->iHistoryItem;
 				historyItem->iActive = m_iTimeCurrent;
 				historyItem->iWGToken = activeState->iWGToken;
+				historyItem->iWordSequence = -1;
 				vHistoryItem.push_back(historyItem);
 			} 
 			assert((transition->iSymbol & EPSILON_TRANSITION) == 0);
@@ -1190,6 +1166,8 @@ HypothesisLattice *ActiveStateTable::getHypothesisLattice() {
 // 2) unique: this is linear too
 bool ActiveStateTable::mergeWordSequences(int iWGToken1, int iWGToken2) {
 
+	BVC_PROFILE_COUNT(PROFILE_COUNTER_LATTICE_MERGES,1);
+
 	WGToken *wgTokenTable = NULL;
 	WGToken *wgToken1 = iWGToken1+m_wgTokens;
 	WGToken *wgToken2 = iWGToken2+m_wgTokens;
@@ -27,6 +27,7 @@
 #include "HMMStateDecoding.h"
 #include "WFSAcceptor.h"
 #include "HypothesisLattice.h"
+#include "WordSequenceTrie.h"
 
 namespace Bavieca {
 
@@ -47,6 +48,7 @@ typedef struct _HistoryItem {
    int iPrev;					// previous element 
    int iActive;				// last time the item was active (part of an active token's history) (garbage collection)
    int iWGToken;				// best N paths that arrive at this word history item (each of them has a backpointer)
+   int iWordSequence;		// word sequence ending at this item (lattice generation, -1 if not computed yet)
 } HistoryItem;
 
 typedef struct vector<HistoryItem*> VHistoryItem;
@@ -93,13 +95,6 @@ typedef struct _HashEntry {
 	int iNext;							// next table entry (to handle collisions)
 } HashEntry;
 
-typedef struct _WSHashEntry {
-	int iTime;					// time frame of last insertion (-1 initially)
-	int iLexUnits;				// number of lexical units in the word sequence
-	int *iLexUnit;				// lexical units in the word-sequence
-	int iNext;					// next table entry (to handle collisions)
-} WSHashEntry;
-
 /**
 	@author daniel <dani.bolanos@gmail.com>
 */
@@ -152,11 +147,8 @@ class ActiveStateTable {
 		bool m_bLatticeGeneration;				// whether to generate a word-graph	
 		int m_iMaxWordSequencesState;			// maximum number of word sequences arriving at any state		
 		
-		// hast table for hashing word sequences
-		unsigned int m_iWSHashBuckets;				// # buckets in the hash table
-		unsigned int m_iWSHashEntries;				//	# entries in the hash table (#entries = #buckets + #unique word sequences)
-		WSHashEntry *m_wshashEntries;					// hash table
-		int m_iWSHashEntryCollisionAvailable;		// next available entry in the hash table to store collisions		
+		// unique word sequences
+		WordSequenceTrie *m_wordSequenceTrie;
 		
 		MWGToken m_mWGTokenDeleted;
 		map<int,bool> m_mWGTokenUsed;
@@ -189,6 +181,12 @@ class ActiveStateTable {
 			return m_activeStatesCurrent;
 		}
 		
+		// set the likelihood beam
+		inline void setPruningLikelihood(float fPruningLikelihood) {
+		
+			m_fPruningLikelihood = fPruningLikelihood;
+		}
+		
 		// return the next active states
 		ActiveState *getActiveStatesNext(unsigned int *iActiveStatesNext) {
 			
@@ -263,12 +261,8 @@ class ActiveStateTable {
 				m_wgTokens[m_iWGTokens-m_iMaxWordSequencesState].iPrev = -1;
 				m_iWGTokenAvailable = 0;	
 				
-				// set all the entries as "old" (hash table of word-sequences)
-				cleanHashWordSequences();
-				//for(int i=0 ; i < m_iWSHashEntries ; ++i) {
-				//	m_wshashEntries[i].iTime = -1;	
-				//}	
-				m_iWSHashEntryCollisionAvailable = m_iWSHashBuckets;
+				// remove the word sequences of the previous utterance
+				m_wordSequenceTrie->reset();
 			}
 		}
 		
@@ -510,17 +504,14 @@ class ActiveStateTable {
 		// compute the collision factor (# collisions / # valid entries in the table)
 		float computeCollisionFactor();
 		
-		// compute the load factor of the hash table containing unque word sequences
-		float computeLoadFactorHashWordSequences(int *iBucketsUsed, int *iCollisions);
-		
 		// print stats connected to the hash table containing unique word-sequences
 		void printHashTableWordSequences();	
 		
 		// shows object information
 		void printInfo();	
 		
-		// process epsilon transitions in topological order
-		void processEpsilonTransitions(float *fFeatureVector, float *fScoreBest);	
+		// process epsilon transitions in topological order (iTimeEmission is the time-stamp for emission probabilities)
+		void processEpsilonTransitions(float *fFeatureVector, int iTimeEmission, float *fScoreBest);	
 		
 		// garbage collection of history items
 		// (1) it starts by marking the active items by traversing back items from the active states
@@ -539,6 +530,7 @@ class ActiveStateTable {
 			}
 		
 			int iReturn = m_iHistoryItemAvailable;
+			m_historyItems[m_iHistoryItemAvailable].iWordSequence = -1;
 			m_iHistoryItemAvailable = m_historyItems[m_iHistoryItemAvailable].iPrev; 
 		
 			return iReturn;
@@ -673,106 +665,34 @@ class ActiveStateTable {
 			}
 		}
 		
-		// hash a word sequence and returns a pointer to the bucket
+		// return the word sequence (interned) of a history item
+		// - ignores silence/filler symbols
+		// - ignores alternative pronunciations
 		inline int hashWordSequence(HistoryItem *historyItem) {
 		
 			assert(historyItem != NULL);
-		
-			// apply the hash function and get the bucket (xor is commutative)
-			int i = 0;
-			int iAux;
-			int iEntry = 0;
-			HistoryItem *historyItemAux = historyItem;
-			do {
-				LexUnit *lexUnit = m_lexiconManager->getLexUnitPron(historyItemAux->iLexUnitPron);
-				iAux = lexUnit->iLexUnit;
-				// ignore silence and filler lexical units
-				if (lexUnit->iType == LEX_UNIT_TYPE_STANDARD) {
-					iAux <<= 8*i;
-					iEntry ^= iAux;
-					++i;
-					i %= sizeof(int);
-				}
-				if (historyItemAux->iPrev == -1) {
-					break;
-				}
-				historyItemAux = m_historyItems+historyItemAux->iPrev;
-			} while(1);
-			iEntry %= m_iWSHashBuckets;	
-			WSHashEntry &entry = m_wshashEntries[iEntry];
 			
-			// old entry
-			if (entry.iTime == -1) {
-				entry.iTime = m_iTimeCurrent;
-				entry.iNext = -1;
-				storeWordSequence(&entry,historyItem);
-				return iEntry;
-			} 
-			// hit
-			else if (compareWordSequencesStandard(&entry,historyItem)) {
-				return iEntry;
-			} 
-			// collision
-			else {
-				// collision: try to find a hit and otherwise append a new entry to the bucket
-				int *iEntryAux = &entry.iNext;
-				while(*iEntryAux != -1) {
-					// hit
-					if (compareWordSequencesStandard(m_wshashEntries+(*iEntryAux),historyItem)) {	
-						assert(*iEntryAux >= 0);
-						assert(*iEntryAux < (int)m_iWSHashEntries);
-						return *iEntryAux;
-					}
-					iEntryAux = &(m_wshashEntries+(*iEntryAux))->iNext;
-				}
-				
-				// the word sequence was not found, create it as a collision
-				*iEntryAux = m_iWSHashEntryCollisionAvailable;
-				assert(*iEntryAux != (int)m_iWSHashEntries);
-				(m_wshashEntries+(*iEntryAux))->iTime = m_iTimeCurrent;
-				storeWordSequence(m_wshashEntries+(*iEntryAux),historyItem); 
-				(m_wshashEntries+(*iEntryAux))->iNext = -1;
-				++m_iWSHashEntryCollisionAvailable;
-				return *iEntryAux;	
+			int iWordSequence = WORD_SEQUENCE_EMPTY;
+			if (historyItem->iPrev != -1) {
+				iWordSequence = getWordSequence(historyItem->iPrev);
+			}
+			if (isStandard(historyItem->iLexUnitPron)) {
+				iWordSequence = m_wordSequenceTrie->extend(iWordSequence,
+					m_lexiconManager->getLexUnitNoPron(historyItem->iLexUnitPron));
 			}
-		}
-		
-		// clean the hash-table
-		void cleanHashWordSequences() {		
 			
-			// set all the entries as "old" and free memory
-			for(int i=0 ; i < (int)m_iWSHashEntries ; ++i) {
-				if (m_wshashEntries[i].iTime != -1) {
-					delete [] m_wshashEntries[i].iLexUnit;
-					m_wshashEntries[i].iTime = -1;
-				}	
-			}	
+			return iWordSequence;
 		}
-				
-		// copy a word sequence from the history-element ot 
-		inline void storeWordSequence(WSHashEntry *entry, HistoryItem *historyItem) {
-		
-			// (a) count lexical-units
-			entry->iLexUnits = 0;
-			int iHistoryItemAux = historyItem-m_historyItems;
-			do {
-				if (isStandard((iHistoryItemAux+m_historyItems)->iLexUnitPron)) {
-					entry->iLexUnits++;
-				}
-				iHistoryItemAux = (iHistoryItemAux+m_historyItems)->iPrev;
-			} while(iHistoryItemAux != -1);
+		
+		// return the word sequence of a history item that is part of the history (it is cached in the item)
+		inline int getWordSequence(int iHistoryItem) {
+		
+			HistoryItem *historyItem = m_historyItems+iHistoryItem;
+			if (historyItem->iWordSequence == -1) {
+				historyItem->iWordSequence = hashWordSequence(historyItem);
+			}
 			
-			// (b) copy lexical units
-			entry->iLexUnit = new int[entry->iLexUnits];
-			int iIndex = 0;
-			iHistoryItemAux = historyItem-m_historyItems;
-			do {
-				if (isStandard((iHistoryItemAux+m_historyItems)->iLexUnitPron)) {
-					entry->iLexUnit[iIndex++] = m_lexiconManager->getLexUnitPron((iHistoryItemAux+m_historyItems)->iLexUnitPron)->iLexUnit;
-				}
-				iHistoryItemAux = (iHistoryItemAux+m_historyItems)->iPrev;
-			} while(iHistoryItemAux != -1);
-			assert(iIndex == entry->iLexUnits);	
+			return historyItem->iWordSequence;
 		}
 		
 		// return whether the lexical unit is a silence or filler
@@ -781,39 +701,7 @@ class ActiveStateTable {
 			return m_lexiconManager->isStandard(m_lexiconManager->getLexUnitPron(iLexUnitPron));
 		}
 		
-		// return whether two word sequences are identical 
-		// - ignores silence/filler symbols
-		// - ignores alternative pronunciations
-		inline bool compareWordSequencesStandard(WSHashEntry *entry, HistoryItem *historyItem) {
-			
-			int iHistoryItem = historyItem-m_historyItems;
-			int iIndex = 0;
-			
-			do {
-			
-				// get the next "real" lexical unit
-				while(iHistoryItem != -1) {
-					if (isStandard((iHistoryItem+m_historyItems)->iLexUnitPron)) {
-						break;
-					}
-					iHistoryItem = (iHistoryItem+m_historyItems)->iPrev;
-				}
-				
-				if (iHistoryItem == -1) {
-					return (iIndex == entry->iLexUnits);	
-				} else if (iIndex == entry->iLexUnits) {
-					return false;
-				} else if (entry->iLexUnit[iIndex++] != 
-					m_lexiconManager->getLexUnitNoPron((iHistoryItem+m_historyItems)->iLexUnitPron)) {
-					return false;
-				}
-				
-				iHistoryItem = (iHistoryItem+m_historyItems)->iPrev;
-				
-			} while(1);
-		}	
 
-		
 		// return whether the lexical unit is a silence or filler
 		inline bool isSilenceFiller(int iLexUnitPron) {
 		
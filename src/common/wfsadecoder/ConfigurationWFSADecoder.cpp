@@ -60,6 +60,16 @@ void ConfigurationWFSADecoder::defineParameters() {
 	
 	// acoustic models
 	defineParameter("acousticModels.file","acoustic models",PARAMETER_TYPE_FILE,false);
+	defineParameter("acousticModels.gaussianSelection.file","Gaussian selection codebook and shortlists (built by hmmx)",
+		PARAMETER_TYPE_FILE,true);
+	defineParameter("acousticModels.gaussianSelection.codewords","codebook size for Gaussian selection (built at load time)",
+		PARAMETER_TYPE_INTEGER,true,"[1|65536]");
+	defineParameter("acousticModels.gaussianSelection.threshold","maximum log-likelihood distance to the best component in a shortlist",
+		PARAMETER_TYPE_FLOAT,true,"[0.0|1000000.0]","10.0");
+	defineParameter("acousticModels.gaussianSelection.floor","minimum number of components in a shortlist",
+		PARAMETER_TYPE_INTEGER,true,"[1|1000]","1");
+	defineParameter("acousticModels.quantization","quantization of the Gaussian parameters used for decoding",
+		PARAMETER_TYPE_STRING,true,"none|int8|int16","none");
 	
 	// lexicon
 	defineParameter("lexicon.file","",PARAMETER_TYPE_FILE,false);
@@ -69,6 +79,22 @@ void ConfigurationWFSADecoder::defineParameters() {
 		PARAMETER_TYPE_INTEGER,false,"[100|1000000]");
 	defineParameter("pruning.likelihoodBeam","likelihood beam used for pruning states",
 		PARAMETER_TYPE_FLOAT,false,"[10.0|1000000.0]");
+	defineParameter("pruning.adaptive.mode","adaptive beam mode (active states or real time factor target)",
+		PARAMETER_TYPE_STRING,true,"none|active|rtf","none");
+	defineParameter("pruning.adaptive.target","target number of active states or real time factor",
+		PARAMETER_TYPE_FLOAT,true);
+	defineParameter("pruning.adaptive.likelihoodBeamMin","minimum likelihood beam for pruning states",
+		PARAMETER_TYPE_FLOAT,true);
+	defineParameter("pruning.adaptive.likelihoodBeamMax","maximum likelihood beam for pruning states",
+		PARAMETER_TYPE_FLOAT,true);
+	
+	// frame skipping
+	defineParameter("frameSkipping.mode","frame skipping mode (emission probabilities are reused on skipped frames)",
+		PARAMETER_TYPE_STRING,true,"none|fixed|adaptive","none");
+	defineParameter("frameSkipping.rate","maximum number of frames sharing the same emission probabilities",
+		PARAMETER_TYPE_INTEGER,true,"[1|10]","2");
+	defineParameter("frameSkipping.threshold","maximum relative change of the features for a frame to be skipped (adaptive)",
+		PARAMETER_TYPE_FLOAT,true,"[0.0|1.0]","0.05");
 	
 	// decoder output
 	defineParameter("output.bestSinglePath","",PARAMETER_TYPE_BOOLEAN,true,"yes|no","yes");
@@ -79,6 +105,8 @@ void ConfigurationWFSADecoder::defineParameters() {
 	defineParameter("output.audio.folder","folder to store the audio",PARAMETER_TYPE_FOLDER,true);
 	defineParameter("output.features.folder","folder to store the features",PARAMETER_TYPE_FOLDER,true);
 	defineParameter("output.alignment.folder","folder to store the alignment",PARAMETER_TYPE_FOLDER,true);
+	defineParameter("output.profile.file","file to store the decoding profile of each utterance (JSON lines)",
+		PARAMETER_TYPE_FILE,true);
 }
 
 // load the configuration parameters
@@ -17,7 +17,9 @@
  *---------------------------------------------------------------------------------------------*/
 
 
+#include "BeamController.h"
 #include "BestPath.h"
+#include "FrameSkipper.h"
 #include "HMMManager.h"
 #include "LexiconManager.h"
 #include "PhoneSet.h"
@@ -39,6 +41,9 @@ WFSADecoder::WFSADecoder(PhoneSet *phoneSet, HMMManager *hmmManager,
 	// pruning
 	m_iPruningMaxActiveStates = iPruningMaxActiveStates;
 	m_fPruningLikelihood = fPruningLikelihood;
+	m_beamController = NULL;
+	m_frameSkipper = NULL;
+	m_profile = NULL;
 	
 	// lattice generation
 	m_bLatticeGeneration = bLatticeGeneration;
@@ -78,6 +83,13 @@ void WFSADecoder::initializeViterbi() {
 void WFSADecoder::viterbi(Matrix<float> &mFeatures) {
 
 	double dTimeBegin = TimeUtils::getTimeMilliseconds();
+	
+	if (m_profile) {
+		m_profile->reset();
+	}
+	BVC_PROFILE_SCOPE(m_profile);
+	BVC_PROFILE_TIMER_BEGIN(iCyclesDecoding);
+	BVC_PROFILE_COUNT(PROFILE_COUNTER_FRAMES,mFeatures.getRows());
 
 	float fScore = 0.0;
 	HMMStateDecoding *hmmStateDecoding;
@@ -88,6 +100,17 @@ void WFSADecoder::viterbi(Matrix<float> &mFeatures) {
 	
 	m_activeStateTable->beginUtterance();	
 	
+	// the adaptive beam carries over from the previous utterance
+	if (m_beamController) {
+		m_beamController->beginUtterance();
+		m_fPruningLikelihood = m_beamController->getBeam();
+		m_activeStateTable->setPruningLikelihood(m_fPruningLikelihood);
+	}
+	
+	if (m_frameSkipper) {
+		m_frameSkipper->beginUtterance();
+	}
+	
 	unsigned int iLexUnitEndSentence = m_lexiconManager->m_lexUnitEndSentence->iLexUnit;
 		
 	// create the initial set of active states (states coming from the initial state and non-epsilon arcs)	
@@ -107,7 +130,13 @@ void WFSADecoder::viterbi(Matrix<float> &mFeatures) {
 	for(unsigned int t=0 ; t < mFeatures.getRows() ; ++t) {
 		
 		m_fScoreBest = -FLT_MAX;
-		VectorStatic<float> vFeatureVector = mFeatures.getRow(t);
+		VectorStatic<float> vFeatureVectorFrame = mFeatures.getRow(t);
+		float *fFeatureVector = vFeatureVectorFrame.getData();
+		int iTimeEmission = t;
+		if (m_frameSkipper) {
+			fFeatureVector = m_frameSkipper->select(fFeatureVector,t,&iTimeEmission);
+		}
+		VectorStatic<float> vFeatureVector(fFeatureVector,mFeatures.getCols());
 		
 		activeStatesCurrent = m_activeStateTable->getActiveStatesCurrent(&iActiveStatesCurrent);
 		
@@ -116,6 +145,7 @@ void WFSADecoder::viterbi(Matrix<float> &mFeatures) {
 		m_activeStateTable->m_iStatesPruned = 0;
 		
 		// (1) process all the active states (these are non-epsilon states)
+		BVC_PROFILE_TIMER_BEGIN(iCyclesExpansion);
 		for(unsigned int i = 0 ; i < iActiveStatesCurrent ; ++i) {
 		
 			// skip pruned states
@@ -132,7 +162,7 @@ void WFSADecoder::viterbi(Matrix<float> &mFeatures) {
 			// (1.1) self-loop (this is a simulated transition)
 			
 			// compute emission probability
-			fScore = activeState.hmmStateDecoding->computeEmissionProbability(vFeatureVector.getData(),t);	
+			fScore = activeState.hmmStateDecoding->computeEmissionProbability(vFeatureVector.getData(),iTimeEmission);	
 			
 			// preventive pruning goes here
 			if (activeState.fScore+fScore < (m_fScoreBest-m_fPruningLikelihood)) {
@@ -264,7 +294,7 @@ void WFSADecoder::viterbi(Matrix<float> &mFeatures) {
 						
 							// compute emission probability
 							hmmStateDecoding = &m_hmmStatesDecoding[transitionAux->iSymbol];
-							fScore = hmmStateDecoding->computeEmissionProbability(vFeatureVector.getData(),t);	
+							fScore = hmmStateDecoding->computeEmissionProbability(vFeatureVector.getData(),iTimeEmission);	
 							
 							// preventive pruning
 							if (activeState.fScore+transition->fWeight+transitionAux->fWeight+fScore < (m_fScoreBest-m_fPruningLikelihood)) {
@@ -290,7 +320,7 @@ void WFSADecoder::viterbi(Matrix<float> &mFeatures) {
 				
 					// compute emission probability
 					hmmStateDecoding = &m_hmmStatesDecoding[transition->iSymbol];	
-					fScore = hmmStateDecoding->computeEmissionProbability(vFeatureVector.getData(),t);
+					fScore = hmmStateDecoding->computeEmissionProbability(vFeatureVector.getData(),iTimeEmission);
 					
 					// preventive pruning goes here
 					if (activeState.fScore+transition->fWeight+fScore < (m_fScoreBest-m_fPruningLikelihood)) {
@@ -344,12 +374,28 @@ void WFSADecoder::viterbi(Matrix<float> &mFeatures) {
 		}
 		
 		// (3) process epsilon transitions in topological order
-		m_activeStateTable->processEpsilonTransitions(vFeatureVector.getData(),&m_fScoreBest);
+		m_activeStateTable->processEpsilonTransitions(vFeatureVector.getData(),iTimeEmission,&m_fScoreBest);
+		BVC_PROFILE_TIMER_END(PROFILE_TIMER_EXPANSION,iCyclesExpansion);
+		BVC_PROFILE_COUNT(PROFILE_COUNTER_TOKENS_EXPANDED,m_activeStateTable->m_iStatesExpanded);
 		
 		if (t != mFeatures.getRows()-1) { 
 		
 			// (4) apply beam pruning
+			BVC_PROFILE_TIMER_BEGIN(iCyclesPruning);
 			m_activeStateTable->beamPruning(&m_fScoreBest);	
+			BVC_PROFILE_TIMER_END(PROFILE_TIMER_PRUNING,iCyclesPruning);
+			BVC_PROFILE_COUNT(PROFILE_COUNTER_TOKENS_PRUNED,m_activeStateTable->m_iStatesPruned);
+			
+			unsigned int iActiveStatesNext = 0;
+			m_activeStateTable->getActiveStatesNext(&iActiveStatesNext);
+			unsigned int iActiveStatesSurvived = iActiveStatesNext-m_activeStateTable->m_iStatesPruned;
+			BVC_PROFILE_COUNT(PROFILE_COUNTER_ARCS_ACTIVE,iActiveStatesSurvived);
+			
+			// adapt the beam to the number of states that survived pruning
+			if (m_beamController) {
+				m_fPruningLikelihood = m_beamController->update(iActiveStatesSurvived);
+				m_activeStateTable->setPruningLikelihood(m_fPruningLikelihood);
+			}
 			
 			// move to the next time frame
 			m_activeStateTable->nextTimeFrame();
@@ -361,6 +407,16 @@ void WFSADecoder::viterbi(Matrix<float> &mFeatures) {
 	//m_activeStateTable->printInfo();
 	m_activeStateTable->endUtterance();
 	
+	if (m_beamController) {
+		m_beamController->endUtterance();
+	}
+	
+	if (m_frameSkipper) {
+		m_frameSkipper->endUtterance();
+	}
+	
+	BVC_PROFILE_TIMER_END(PROFILE_TIMER_DECODING,iCyclesDecoding);
+	
 	double dTimeEnd = TimeUtils::getTimeMilliseconds();
 	double dTimeSeconds = (dTimeEnd-dTimeBegin)/1000.0;
 	
@@ -377,7 +433,15 @@ BestPath *WFSADecoder::getBestPath() {
 // return the hypothesis lattice
 HypothesisLattice *WFSADecoder::getHypothesisLattice() {
 
-	return m_activeStateTable->getHypothesisLattice();
+	BVC_PROFILE_SCOPE(m_profile);
+	BVC_PROFILE_TIMER_BEGIN(iCycles);
+	HypothesisLattice *hypothesisLattice = m_activeStateTable->getHypothesisLattice();
+	BVC_PROFILE_TIMER_END(PROFILE_TIMER_LATTICE,iCycles);
+	if (hypothesisLattice) {
+		BVC_PROFILE_COUNT(PROFILE_COUNTER_LATTICE_EDGES,hypothesisLattice->getEdges());
+	}
+	
+	return hypothesisLattice;
 }
 
 };	// end-of-namespace
@@ -30,10 +30,13 @@ using namespace std;
 #include <vector>
 
 #include "ActiveStateTable.h"
+#include "PerformanceProfile.h"
 
 namespace Bavieca {
 
+class BeamController;
 class BestPath;
+class FrameSkipper;
 class HMMManager;
 class LexiconManager;
 class PhoneSet;
@@ -66,6 +69,13 @@ class WFSADecoder {
 		// pruning
 		float m_fPruningLikelihood;
 		int m_iPruningMaxActiveStates;
+		BeamController *m_beamController;					// adaptive beam (NULL for a fixed beam)
+		
+		// frame skipping (emission probabilities of skipped frames are those of the last evaluated frame)
+		FrameSkipper *m_frameSkipper;
+		
+		// performance counters and timers of the current utterance (NULL if disabled)
+		PerformanceProfile *m_profile;
 		
 		// lattice generation
 		bool m_bLatticeGeneration;								// whether to generate a lattice
@@ -109,6 +119,25 @@ class WFSADecoder {
 		// return the hypothesis lattice
 		HypothesisLattice *getHypothesisLattice();
 		
+		// set the controller that adapts the beam after each frame (NULL for a fixed beam)
+		inline void setBeamController(BeamController *beamController) {
+		
+			m_beamController = beamController;
+		}
+		
+		// set the object that decides which frames get their emission probabilities evaluated (NULL for all)
+		inline void setFrameSkipper(FrameSkipper *frameSkipper) {
+		
+			m_frameSkipper = frameSkipper;
+		}
+		
+		// set the profile that collects performance counters and timers (NULL to disable)
+		// the profile is reset at the beginning of each utterance
+		inline void setProfile(PerformanceProfile *profile) {
+		
+			m_profile = profile;
+		}
+		
 };
 
 };	// end-of-namespace
@@ -0,0 +1,710 @@
+/*---------------------------------------------------------------------------------------------*
+ * Copyright (C) 2012 Daniel Bolaños - www.bltek.com - Boulder Language Technologies           *
+ *                                                                                             *
+ * www.bavieca.org is the website of the Bavieca Speech Recognition Toolkit                    *
+ *                                                                                             *
+ * Licensed under the Apache License, Version 2.0 (the "License");                             *
+ * you may not use this file except in compliance with the License.                            *
+ * You may obtain a copy of the License at                                                     *
+ *                                                                                             *
+ *         http://www.apache.org/licenses/LICENSE-2.0                                          *
+ *                                                                                             *
+ * Unless required by applicable law or agreed to in writing, software                         *
+ * distributed under the License is distributed on an "AS IS" BASIS,                           *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.                    *
+ * See the License for the specific language governing permissions and                         *
+ * limitations under the License.                                                              *
+ *---------------------------------------------------------------------------------------------*/
+
+
+#include <stdexcept>
+#include <stdlib.h>
+#include <algorithm>
+#include <iomanip>
+#include <new>
+
+#if defined __linux__ || defined __APPLE__
+#include <sys/resource.h>
+#endif
+
+#include "Alignment.h"
+#include "AudioFile.h"
+#include "BatchFile.h"
+#include "BestPath.h"
+#include "CommandLineManager.h"
+#include "ConfigurationFeatures.h"
+#include "DynamicDecoderX.h"
+#include "DynamicNetworkX.h"
+#include "FeatureExtractor.h"
+#include "FileOutput.h"
+#include "ForwardBackwardX.h"
+#include "Global.h"
+#include "HMMManager.h"
+#include "HypothesisLattice.h"
+#include "LexiconManager.h"
+#include "LMLookAhead.h"
+#include "LMFSM.h"
+#include "LMManager.h"
+#include "NetworkBuilderX.h"
+#include "PerformanceProfile.h"
+#include "PhoneSet.h"
+#include "SyntheticTask.h"
+#include "TextAligner.h"
+#include "TimeUtils.h"
+#include "Viterbi.h"
+
+using namespace Bavieca;
+
+// stages of the benchmark (in execution order)
+#define BENCH_STAGES		"features|emission|lmlookahead|decoding|lattice|rescoring|forwardbackward"
+
+// decoder settings (standard values for large vocabulary tasks)
+#define BENCH_MAX_ACTIVE_ARCS				15000
+#define BENCH_MAX_ACTIVE_ARCS_WE				1000
+#define BENCH_MAX_ACTIVE_TOKENS_ARC			20
+#define BENCH_BEAM_ARCS							250.0
+#define BENCH_BEAM_ARCS_WE						150.0
+#define BENCH_BEAM_TOKENS_ARC					100.0
+#define BENCH_INSERTION_PENALTY				-25.0
+#define BENCH_MAX_WORD_SEQUENCES_STATE		5
+
+// allocation counters (this tool replaces the global operator new)
+static long long g_iAllocations = 0;
+static long long g_iAllocationBytes = 0;
+
+void *operator new(size_t iBytes) throw(std::bad_alloc) {
+
+	__sync_fetch_and_add(&g_iAllocations,1LL);
+	__sync_fetch_and_add(&g_iAllocationBytes,(long long)iBytes);
+	void *p = malloc(iBytes == 0 ? 1 : iBytes);
+	if (p == NULL) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void *operator new[](size_t iBytes) throw(std::bad_alloc) {
+
+	return operator new(iBytes);
+}
+
+void operator delete(void *p) throw() {
+
+	free(p);
+}
+
+void operator delete[](void *p) throw() {
+
+	free(p);
+}
+
+// utterance to process
+typedef struct {
+	string strId;							// utterance identifier
+	short *sSamples;						// audio samples
+	int iSamples;							// number of audio samples
+	Matrix<float> *mFeatures;			// feature vectors to decode
+	string strTranscription;			// transcription (synthetic task only)
+	string strHypothesis;				// best path (once decoded)
+	HypothesisLattice *lattice;		// hypothesis lattice (once decoded with lattice generation)
+} BenchUtterance;
+
+typedef vector<BenchUtterance> VBenchUtterance;
+
+// measures of a stage of the benchmark
+typedef struct {
+	string strName;						// stage name
+	int iUtterances;						// utterances processed
+	long long iFrames;					// feature frames processed
+	double dSeconds;						// processing time
+	vector<double> vRTF;					// real time factor of each utterance
+	long long iAllocations;				// allocations during the stage
+	long long iAllocationBytes;		// bytes allocated during the stage
+	long iPeakRSS;							// peak resident set size at the end of the stage (KB)
+	vector<pair<string,double> > vMetrics;	// stage specific metrics
+} BenchStage;
+
+// return the peak resident set size of the process (KB)
+long getPeakRSS() {
+
+#if defined __linux__
+	struct rusage usage;
+	getrusage(RUSAGE_SELF,&usage);
+	return usage.ru_maxrss;
+#elif defined __APPLE__
+	struct rusage usage;
+	getrusage(RUSAGE_SELF,&usage);
+	return usage.ru_maxrss/1024;
+#else
+	return -1;
+#endif
+}
+
+// return the given percentile (nearest rank) of a sorted set of values
+double getPercentile(vector<double> &vValues, double dPercentile) {
+
+	if (vValues.empty()) {
+		return 0.0;
+	}
+	int iIndex = (int)(dPercentile*(vValues.size()-1)+0.5);
+	return vValues[iIndex];
+}
+
+// begin the measurement of a stage
+void beginStage(BenchStage &stage, const char *strName) {
+
+	stage.strName = strName;
+	stage.iUtterances = 0;
+	stage.iFrames = 0;
+	stage.dSeconds = 0.0;
+	stage.vRTF.clear();
+	stage.vMetrics.clear();
+	stage.iAllocations = g_iAllocations;
+	stage.iAllocationBytes = g_iAllocationBytes;
+	BVC_VERB << "running stage: " << strName;
+}
+
+// account for an utterance processed within a stage
+void addUtterance(BenchStage &stage, int iFrames, double dMilliseconds) {
+
+	stage.iUtterances++;
+	stage.iFrames += iFrames;
+	stage.dSeconds += dMilliseconds/1000.0;
+	stage.vRTF.push_back((dMilliseconds/1000.0)/(std::max(iFrames,1)/100.0));
+}
+
+// end the measurement of a stage
+void endStage(BenchStage &stage, vector<BenchStage> &vStages) {
+
+	stage.iAllocations = g_iAllocations-stage.iAllocations;
+	stage.iAllocationBytes = g_iAllocationBytes-stage.iAllocationBytes;
+	stage.iPeakRSS = getPeakRSS();
+	sort(stage.vRTF.begin(),stage.vRTF.end());
+	vStages.push_back(stage);
+	BVC_VERB << "stage: " << stage.strName << " utterances: " << stage.iUtterances << " time: " << 
+		FLT(8,4) << stage.dSeconds << "s RTF: " << FLT(8,4) << 
+		stage.dSeconds/(std::max(stage.iFrames,1LL)/100.0);
+}
+
+// write the results in JSON format
+void writeJSON(ostream &os, const char *strMode, unsigned int iSeed, int iRepetitions, 
+	VBenchUtterance &vUtterance, double dSecondsSetup, long iPeakRSSSetup, vector<BenchStage> &vStages) {
+
+	long long iFrames = 0;
+	for(VBenchUtterance::iterator it = vUtterance.begin() ; it != vUtterance.end() ; ++it) {
+		iFrames += it->mFeatures->getRows();
+	}
+
+	os << fixed;
+	os << "{" << endl;
+	os << "  \"tool\": \"bench\"," << endl;
+	os << "  \"version\": \"" << SYSTEM_VERSION << "\"," << endl;
+	os << "  \"mode\": \"" << strMode << "\"," << endl;
+	os << "  \"seed\": " << iSeed << "," << endl;
+	os << "  \"repetitions\": " << iRepetitions << "," << endl;
+	os << "  \"utterances\": " << vUtterance.size() << "," << endl;
+	os << "  \"frames\": " << iFrames << "," << endl;
+	os << "  \"setup\": {\"seconds\": " << setprecision(4) << dSecondsSetup << ", \"peakRSSKB\": " << 
+		iPeakRSSSetup << "}," << endl;
+	os << "  \"stages\": [" << endl;
+	for(unsigned int i=0 ; i < vStages.size() ; ++i) {
+		BenchStage &stage = vStages[i];
+		double dRTFMean = stage.dSeconds/(std::max(stage.iFrames,1LL)/100.0);
+		double dFramesPerSecond = (stage.dSeconds > 0.0) ? stage.iFrames/stage.dSeconds : 0.0;
+		os << "    {" << endl;
+		os << "      \"name\": \"" << stage.strName << "\"," << endl;
+		os << "      \"utterances\": " << stage.iUtterances << "," << endl;
+		os << "      \"frames\": " << stage.iFrames << "," << endl;
+		os << "      \"seconds\": " << setprecision(6) << stage.dSeconds << "," << endl;
+		os << "      \"framesPerSecond\": " << setprecision(2) << dFramesPerSecond << "," << endl;
+		os << "      \"rtf\": {\"mean\": " << setprecision(6) << dRTFMean << 
+			", \"p50\": " << setprecision(6) << getPercentile(stage.vRTF,0.50) << 
+			", \"p90\": " << setprecision(6) << getPercentile(stage.vRTF,0.90) << 
+			", \"p99\": " << setprecision(6) << getPercentile(stage.vRTF,0.99) << 
+			", \"max\": " << setprecision(6) << getPercentile(stage.vRTF,1.0) << "}," << endl;
+		os << "      \"allocations\": " << stage.iAllocations << "," << endl;
+		os << "      \"allocatedBytes\": " << stage.iAllocationBytes << "," << endl;
+		os << "      \"peakRSSKB\": " << stage.iPeakRSS << "," << endl;
+		os << "      \"metrics\": {";
+		for(unsigned int j=0 ; j < stage.vMetrics.size() ; ++j) {
+			os << ((j > 0) ? ", " : "") << "\"" << stage.vMetrics[j].first << "\": " << 
+				setprecision(6) << stage.vMetrics[j].second;
+		}
+		os << "}" << endl;
+		os << "    }" << ((i+1 < vStages.size()) ? "," : "") << endl;
+	}
+	os << "  ]" << endl;
+	os << "}" << endl;
+}
+
+// return the standard lexical units in a best path as a string
+string getHypothesis(BestPath *bestPath, LexiconManager *lexiconManager) {
+
+	ostringstream oss;
+	if (bestPath) {
+		VLexUnit vLexUnit;
+		bestPath->getLexUnits(vLexUnit);
+		for(VLexUnit::iterator it = vLexUnit.begin() ; it != vLexUnit.end() ; ++it) {
+			if (lexiconManager->isStandard(*it)) {
+				oss << ((oss.str().empty()) ? "" : " ") << lexiconManager->getStrLexUnit((*it)->iLexUnit);
+			}
+		}
+	}
+	return oss.str();
+}
+
+// decode the utterances (optionally generating lattices) and measure the accuracy against the transcriptions
+void decode(DynamicDecoderX *decoder, LexiconManager *lexiconManager, VBenchUtterance &vUtterance, 
+	int iRepetitions, bool bLattice, BenchStage &stage) {
+	
+	TextAligner textAligner(lexiconManager);
+	int iErrors = 0;
+	int iWords = 0;
+	int iEdges = 0;
+	PerformanceProfile profile;
+	PerformanceProfile profileTotal;
+	decoder->setProfile(&profile);
+	for(int r=0 ; r < iRepetitions ; ++r) {
+		for(VBenchUtterance::iterator it = vUtterance.begin() ; it != vUtterance.end() ; ++it) {
+			double dTimeBegin = TimeUtils::getTimeMilliseconds();
+			decoder->beginUtterance();
+			decoder->process(*it->mFeatures);
+			BestPath *bestPath = decoder->getBestPath();
+			HypothesisLattice *lattice = NULL;
+			if (bLattice) {
+				lattice = decoder->getHypothesisLattice();
+			}
+			decoder->endUtterance();
+			addUtterance(stage,it->mFeatures->getRows(),TimeUtils::getTimeMilliseconds()-dTimeBegin);
+			profileTotal.add(profile);
+			
+			// keep the outcome of the last repetition
+			if (r == iRepetitions-1) {
+				it->strHypothesis = getHypothesis(bestPath,lexiconManager);
+				if (lattice) {
+					iEdges += lattice->getEdges();
+					it->lattice = lattice;
+					lattice = NULL;
+				}
+				if (!it->strTranscription.empty()) {
+					VLexUnit vLexUnitRef,vLexUnitHyp;
+					bool bAllKnown;
+					lexiconManager->getLexUnits(it->strTranscription.c_str(),vLexUnitRef,bAllKnown);
+					lexiconManager->getLexUnits(it->strHypothesis.c_str(),vLexUnitHyp,bAllKnown);
+					TAErrors errors;
+					if (textAligner.computeErrors(vLexUnitHyp,vLexUnitRef,errors)) {
+						iErrors += errors.iSubstitutions+errors.iDeletions+errors.iInsertions;
+						iWords += errors.iWordsReference;
+					}
+				}
+			}
+			if (bestPath) {
+				delete bestPath;
+			}
+			if (lattice) {
+				delete lattice;
+			}
+		}
+	}
+	if (iWords > 0) {
+		stage.vMetrics.push_back(pair<string,double>("wer",100.0*((double)iErrors)/((double)iWords)));
+	}
+	if (bLattice) {
+		stage.vMetrics.push_back(pair<string,double>("latticeEdges",((double)iEdges)/vUtterance.size()));
+	}
+	decoder->setProfile(NULL);
+	
+	// decoding profile (per frame)
+	double dFrames = std::max((double)profileTotal.getCounter(PROFILE_COUNTER_FRAMES),1.0);
+	for(int i=0 ; i < PROFILE_COUNTERS ; ++i) {
+		if (i != PROFILE_COUNTER_FRAMES) {
+			stage.vMetrics.push_back(pair<string,double>(string(PerformanceProfile::getCounterName(i))+"PerFrame",
+				profileTotal.getCounter(i)/dFrames));
+		}
+	}
+	for(int i=0 ; i < PROFILE_TIMERS ; ++i) {
+		stage.vMetrics.push_back(pair<string,double>(string(PerformanceProfile::getTimerName(i))+"CyclesPerFrame",
+			profileTotal.getCycles(i)/dFrames));
+	}
+}
+
+// main for the tool "bench"
+int main(int argc, char *argv[]) {
+
+	try {
+
+		// (1) define command line parameters
+		CommandLineManager commandLineManager("bench",SYSTEM_VERSION,SYSTEM_AUTHOR,SYSTEM_DATE);
+		commandLineManager.defineParameter("-dir","folder to create the synthetic task",PARAMETER_TYPE_FOLDER,true,NULL,"bench");
+		commandLineManager.defineParameter("-utt","number of utterances (synthetic task)",PARAMETER_TYPE_INTEGER,true,"[1|100000]","20");
+		commandLineManager.defineParameter("-wrd","words per utterance (synthetic task)",PARAMETER_TYPE_INTEGER,true,"[1|1000]","12");
+		commandLineManager.defineParameter("-voc","vocabulary size (synthetic task)",PARAMETER_TYPE_INTEGER,true,"[10|1000000]","5000");
+		commandLineManager.defineParameter("-gau","Gaussian components per HMM-state (synthetic task)",PARAMETER_TYPE_INTEGER,true,"[1|256]","16");
+		commandLineManager.defineParameter("-seed","random seed (synthetic task)",PARAMETER_TYPE_INTEGER,true,NULL,"1");
+		commandLineManager.defineParameter("-pho","phonetic symbol set",PARAMETER_TYPE_FILE,true);
+		commandLineManager.defineParameter("-lex","pronunciation dictionary (lexicon)",PARAMETER_TYPE_FILE,true);
+		commandLineManager.defineParameter("-mod","acoustic models",PARAMETER_TYPE_FILE,true);
+		commandLineManager.defineParameter("-lm","language model",PARAMETER_TYPE_FILE,true);
+		commandLineManager.defineParameter("-lmf","language model format",PARAMETER_TYPE_STRING,true,"ARPA|FSM","ARPA");
+		commandLineManager.defineParameter("-cfg","feature configuration",PARAMETER_TYPE_FILE,true);
+		commandLineManager.defineParameter("-bat","batch file with the raw audio files to process",PARAMETER_TYPE_FILE,true);
+		commandLineManager.defineParameter("-lms","language model scaling factor",PARAMETER_TYPE_FLOAT,true,NULL,"27.0");
+		commandLineManager.defineParameter("-rep","repetitions of each stage",PARAMETER_TYPE_INTEGER,true,"[1|1000]","1");
+		commandLineManager.defineParameter("-sta","stages to run (comma separated) or all",PARAMETER_TYPE_STRING,true,NULL,"all");
+		commandLineManager.defineParameter("-out","output file (JSON), standard output if not set",PARAMETER_TYPE_FILE,true);
+		commandLineManager.defineParameter("-log","logging level",PARAMETER_TYPE_STRING,true,"error|warning|information|verbose","warning");
+		
+		// parse the command line parameters
+		if (commandLineManager.parseParameters(argc,argv) == false) {
+			return -1;
+		}
+		
+		// get the values
+		bool bSynthetic = (commandLineManager.isParameterSet("-mod") == false);
+		int iUtterances = atoi(commandLineManager.getParameterValue("-utt"));
+		int iWords = atoi(commandLineManager.getParameterValue("-wrd"));
+		unsigned int iSeed = (unsigned int)atoi(commandLineManager.getParameterValue("-seed"));
+		float fLMScalingFactor = atof(commandLineManager.getParameterValue("-lms"));
+		int iRepetitions = atoi(commandLineManager.getParameterValue("-rep"));
+		const char *strStages = commandLineManager.getParameterValue("-sta");
+		LogMessage::setLevel(commandLineManager.getParameterValue("-log"));
+		
+		// stages to run
+		map<string,bool> mStage;
+		string strStagesAll = BENCH_STAGES;
+		string strStagesRun = (strcmp(strStages,"all") == 0) ? strStagesAll : strStages;
+		for(unsigned int i=0 ; i < strStagesRun.length() ; ++i) {
+			if (strStagesRun[i] == ',') {
+				strStagesRun[i] = '|';
+			}
+		}
+		std::stringstream ssStages(strStagesRun);
+		string strStage;
+		while(std::getline(ssStages,strStage,'|')) {
+			if (("|"+strStagesAll+"|").find("|"+strStage+"|") == string::npos) {
+				BVC_ERROR << "unknown stage: \"" << strStage << "\", valid stages: " << BENCH_STAGES;
+			}
+			mStage[strStage] = true;
+		}
+		
+		double dTimeSetupBegin = TimeUtils::getTimeMilliseconds();
+		
+		// (2) get the task: synthetic or user supplied
+		string strFilePhoneSet,strFileLexicon,strFileModels,strFileLM,strFileFeatureConfiguration;
+		const char *strLMFormat = LM_FILE_FORMAT_ARPA;
+		SyntheticTask *syntheticTask = NULL;
+		if (bSynthetic) {
+			syntheticTask = new SyntheticTask(commandLineManager.getParameterValue("-dir"),SYNTHETIC_TASK_PHONES_DEFAULT,
+				atoi(commandLineManager.getParameterValue("-voc")),atoi(commandLineManager.getParameterValue("-gau")),iSeed);
+			syntheticTask->create();
+			strFilePhoneSet = syntheticTask->getFilePhoneSet();
+			strFileLexicon = syntheticTask->getFileLexicon();
+			strFileModels = syntheticTask->getFileAcousticModels();
+			strFileLM = syntheticTask->getFileLanguageModel();
+			strFileFeatureConfiguration = syntheticTask->getFileFeatureConfiguration();
+		} else {
+			const char *strParameters[] = {"-pho","-lex","-lm","-cfg","-bat"};
+			for(int i=0 ; i < 5 ; ++i) {
+				if (commandLineManager.isParameterSet(strParameters[i]) == false) {
+					BVC_ERROR << "parameter " << strParameters[i] << " is needed when acoustic models are given";
+				}
+			}
+			strFilePhoneSet = commandLineManager.getParameterValue("-pho");
+			strFileLexicon = commandLineManager.getParameterValue("-lex");
+			strFileModels = commandLineManager.getParameterValue("-mod");
+			strFileLM = commandLineManager.getParameterValue("-lm");
+			strLMFormat = commandLineManager.getParameterValue("-lmf");
+			strFileFeatureConfiguration = commandLineManager.getParameterValue("-cfg");
+		}
+		
+		// load the phone set and the lexicon
+		PhoneSet phoneSet(strFilePhoneSet.c_str());
+		phoneSet.load();
+		LexiconManager lexiconManager(strFileLexicon.c_str(),&phoneSet); 
+		lexiconManager.load();
+		lexiconManager.attachLexUnitPenalties(BENCH_INSERTION_PENALTY,0.0);
+		
+		// feature extraction
+		ConfigurationFeatures configurationFeatures(strFileFeatureConfiguration.c_str());
+		configurationFeatures.load();
+		FeatureExtractor featureExtractor(&configurationFeatures,1.0,1000000,
+			CEPSTRAL_NORMALIZATION_MODE_UTTERANCE,CEPSTRAL_NORMALIZATION_METHOD_CMN);
+		featureExtractor.initialize();
+		
+		// (3) get the utterances
+		VBenchUtterance vUtterance;
+		if (bSynthetic) {
+			for(int i=0 ; i < iUtterances ; ++i) {
+				BenchUtterance utterance;
+				ostringstream oss;
+				oss << "utterance" << setw(5) << setfill('0') << i;
+				utterance.strId = oss.str();
+				utterance.mFeatures = syntheticTask->generateUtterance(iWords,utterance.strTranscription);
+				utterance.iSamples = utterance.mFeatures->getRows()*160;
+				utterance.sSamples = syntheticTask->generateAudio(utterance.iSamples);
+				utterance.lattice = NULL;
+				vUtterance.push_back(utterance);
+			}
+		} else {
+			BatchFile batchFile(commandLineManager.getParameterValue("-bat"),"audio");
+			batchFile.load();
+			for(unsigned int i=0 ; i < batchFile.size() ; ++i) {
+				BenchUtterance utterance;
+				utterance.strId = batchFile.getField(i,"audio");
+				utterance.sSamples = AudioFile::load(batchFile.getField(i,"audio"),&utterance.iSamples);
+				utterance.mFeatures = featureExtractor.extractFeatures(utterance.sSamples,utterance.iSamples);
+				if (utterance.mFeatures == NULL) {
+					BVC_ERROR << "unable to extract features from: " << utterance.strId;
+				}
+				utterance.lattice = NULL;
+				vUtterance.push_back(utterance);
+			}
+		}
+		if (vUtterance.empty()) {
+			BVC_ERROR << "no utterances to process";
+		}
+		
+		// (4) load the acoustic models, the language model and build the decoding network
+		HMMManager hmmManager(&phoneSet,HMM_PURPOSE_EVALUATION);
+		hmmManager.load(strFileModels.c_str());
+		hmmManager.initializeDecoding();
+		if (hmmManager.getFeatureDim() != vUtterance.front().mFeatures->getCols()) {
+			BVC_ERROR << "inconsistent feature dimensionality, HMMs: " << hmmManager.getFeatureDim() 
+				<< ", features: " << vUtterance.front().mFeatures->getCols();
+		}
+		LMManager lmManager(&lexiconManager,strFileLM.c_str(),strLMFormat,"ngram"); 
+		lmManager.load();
+		NetworkBuilderX networkBuilder(&phoneSet,&hmmManager,&lexiconManager);
+		DynamicNetworkX *network = networkBuilder.build();
+		if (!network) {
+			BVC_ERROR << "unable to build the decoding network";
+		}
+		DynamicDecoderX decoder(&phoneSet,&hmmManager,&lexiconManager,&lmManager,fLMScalingFactor,network,
+			BENCH_MAX_ACTIVE_ARCS,BENCH_MAX_ACTIVE_ARCS_WE,BENCH_MAX_ACTIVE_TOKENS_ARC,
+			BENCH_BEAM_ARCS,BENCH_BEAM_ARCS_WE,BENCH_BEAM_TOKENS_ARC,false,-1);
+		decoder.initialize();
+		
+		double dSecondsSetup = (TimeUtils::getTimeMilliseconds()-dTimeSetupBegin)/1000.0;
+		long iPeakRSSSetup = getPeakRSS();
+		
+		// (5) run the stages
+		vector<BenchStage> vStages;
+		BenchStage stage;
+		
+		// feature extraction
+		if (mStage.find("features") != mStage.end()) {
+			beginStage(stage,"features");
+			for(int r=0 ; r < iRepetitions ; ++r) {
+				for(VBenchUtterance::iterator it = vUtterance.begin() ; it != vUtterance.end() ; ++it) {
+					double dTimeBegin = TimeUtils::getTimeMilliseconds();
+					Matrix<float> *mFeatures = featureExtractor.extractFeatures(it->sSamples,it->iSamples);
+					double dTime = TimeUtils::getTimeMilliseconds()-dTimeBegin;
+					addUtterance(stage,mFeatures ? mFeatures->getRows() : 0,dTime);
+					if (mFeatures) {
+						delete mFeatures;
+					}
+				}
+			}
+			endStage(stage,vStages);
+		}
+		
+		// emission probability computation (all the HMM-states at every frame)
+		if (mStage.find("emission") != mStage.end()) {
+			beginStage(stage,"emission");
+			int iHMMStates = -1;
+			HMMStateDecoding *hmmStatesDecoding = hmmManager.getHMMStatesDecoding(&iHMMStates);
+			double dScoreTotal = 0.0;
+			for(int r=0 ; r < iRepetitions ; ++r) {
+				for(VBenchUtterance::iterator it = vUtterance.begin() ; it != vUtterance.end() ; ++it) {
+					double dTimeBegin = TimeUtils::getTimeMilliseconds();
+					hmmManager.resetHMMEmissionProbabilityComputation();
+					for(unsigned int t=0 ; t < it->mFeatures->getRows() ; ++t) {
+						float *fFeatures = it->mFeatures->getRowData(t);
+						for(int i=0 ; i < iHMMStates ; ++i) {
+							dScoreTotal += hmmStatesDecoding[i].computeEmissionProbability(fFeatures,t);
+						}
+					}
+					addUtterance(stage,it->mFeatures->getRows(),TimeUtils::getTimeMilliseconds()-dTimeBegin);
+				}
+			}
+			stage.vMetrics.push_back(pair<string,double>("hmmStates",iHMMStates));
+			stage.vMetrics.push_back(pair<string,double>("gaussians",hmmManager.getNumberGaussianComponents()));
+			stage.vMetrics.push_back(pair<string,double>("averageScore",dScoreTotal/((double)stage.iFrames*iHMMStates)));
+			endStage(stage,vStages);
+		}
+		
+		// language model look-ahead: look-ahead trees along random word sequences
+		// (for each word the successor states of a few competing words are also looked up)
+		if (mStage.find("lmlookahead") != mStage.end()) {
+			LMLookAhead lmLookAhead(&lexiconManager,&lmManager,network,&decoder,BENCH_MAX_ACTIVE_ARCS*10);
+			lmLookAhead.initialize();
+			LMFSM *lmFSM = lmManager.getFSM();
+			VLexUnit *vLexUnit = lexiconManager.getLexiconReference();
+			VLexUnit vLexUnitStandard;
+			for(VLexUnit::iterator it = vLexUnit->begin() ; it != vLexUnit->end() ; ++it) {
+				if (lexiconManager.isStandard(*it)) {
+					vLexUnitStandard.push_back(*it);
+				}
+			}
+			unsigned int iRandom = iSeed;
+			long long iLookUps = 0;
+			beginStage(stage,"lmlookahead");
+			for(int r=0 ; r < iRepetitions ; ++r) {
+				for(VBenchUtterance::iterator it = vUtterance.begin() ; it != vUtterance.end() ; ++it) {
+					double dTimeBegin = TimeUtils::getTimeMilliseconds();
+					// one word every 30 frames
+					int iLMState = lmFSM->getInitialState();
+					for(unsigned int t=0 ; t < it->mFeatures->getRows() ; t += 30) {
+						float fScore = 0.0;
+						for(int j=0 ; j < 10 ; ++j) {
+							iRandom = iRandom*1664525u+1013904223u;
+							LexUnit *lexUnit = vLexUnitStandard[(iRandom >> 8)%vLexUnitStandard.size()];
+							int iLMStateNext = lmFSM->updateLMState(iLMState,lexUnit->iLexUnit,&fScore);
+							lmLookAhead.getLAScores(iLMStateNext);
+							++iLookUps;
+							if (j == 0) {
+								iLMState = iLMStateNext;
+							}
+						}
+					}
+					addUtterance(stage,it->mFeatures->getRows(),TimeUtils::getTimeMilliseconds()-dTimeBegin);
+				}
+			}
+			stage.vMetrics.push_back(pair<string,double>("lookUps",(double)iLookUps));
+			stage.vMetrics.push_back(pair<string,double>("lookUpsPerSecond",iLookUps/std::max(stage.dSeconds,1.0e-9)));
+			endStage(stage,vStages);
+		}
+		
+		// decoding (best path)
+		if (mStage.find("decoding") != mStage.end()) {
+			beginStage(stage,"decoding");
+			decode(&decoder,&lexiconManager,vUtterance,iRepetitions,false,stage);
+			endStage(stage,vStages);
+		}
+		
+		// decoding (lattice generation)
+		if (mStage.find("lattice") != mStage.end()) {
+			DynamicDecoderX decoderLattice(&phoneSet,&hmmManager,&lexiconManager,&lmManager,fLMScalingFactor,network,
+				BENCH_MAX_ACTIVE_ARCS,BENCH_MAX_ACTIVE_ARCS_WE,BENCH_MAX_ACTIVE_TOKENS_ARC,
+				BENCH_BEAM_ARCS,BENCH_BEAM_ARCS_WE,BENCH_BEAM_TOKENS_ARC,true,BENCH_MAX_WORD_SEQUENCES_STATE);
+			decoderLattice.initialize();
+			beginStage(stage,"lattice");
+			decode(&decoderLattice,&lexiconManager,vUtterance,iRepetitions,true,stage);
+			endStage(stage,vStages);
+			decoderLattice.uninitialize();
+		}
+		
+		// lattice rescoring: acoustic alignment, language model expansion and likelihood based rescoring
+		if (mStage.find("rescoring") != mStage.end()) {
+			if (mStage.find("lattice") == mStage.end()) {
+				BVC_WARNING << "lattice rescoring skipped, it needs the lattice stage";
+			} else {
+				// lattice marking needs context dependent models (not available for the synthetic task),
+				// otherwise edges keep the null acoustic score assigned during decoding
+				bool bAlign = (hmmManager.getContextSizeHMMCW() > 0);
+				if (bAlign == false) {
+					BVC_WARNING << "monophone acoustic models, lattices will be rescored without acoustic alignment";
+				}
+				Viterbi viterbi(&phoneSet,&hmmManager,&lexiconManager,2000.0);
+				beginStage(stage,"rescoring");
+				double dEdges = 0.0;
+				for(VBenchUtterance::iterator it = vUtterance.begin() ; it != vUtterance.end() ; ++it) {
+					if (it->lattice == NULL) {
+						continue;
+					}
+					double dTimeBegin = TimeUtils::getTimeMilliseconds();
+					if (bAlign) {
+						hmmManager.resetHMMEmissionProbabilityComputation();
+						it->lattice->hmmMarking(&hmmManager);
+						if (viterbi.align(*it->mFeatures,it->lattice) == false) {
+							BVC_ERROR << "unable to generate phone-level alignments for the lattice";
+						}
+					} else {
+						it->lattice->setProperty(LATTICE_PROPERTY_AM_PROB,"yes");
+					}
+					it->lattice->attachLMProbabilities(lmManager.getFSM());
+					it->lattice->attachInsertionPenalty(&lexiconManager);
+					it->lattice->setScalingFactors(1.0,fLMScalingFactor);
+					BestPath *bestPath = it->lattice->rescore(RESCORING_METHOD_LIKELIHOOD);
+					addUtterance(stage,it->mFeatures->getRows(),TimeUtils::getTimeMilliseconds()-dTimeBegin);
+					dEdges += it->lattice->getEdges();
+					if (bestPath) {
+						delete bestPath;
+					}
+				}
+				stage.vMetrics.push_back(pair<string,double>("acousticAlignment",bAlign ? 1.0 : 0.0));
+				stage.vMetrics.push_back(pair<string,double>("latticeEdgesExpanded",dEdges/std::max(stage.iUtterances,1)));
+				endStage(stage,vStages);
+			}
+		}
+		
+		// forward-backward: state occupation against the transcription (or the best path if not known)
+		if (mStage.find("forwardbackward") != mStage.end()) {
+			HMMManager hmmManagerEstimation(&phoneSet,HMM_PURPOSE_ESTIMATION);
+			hmmManagerEstimation.load(strFileModels.c_str());
+			hmmManagerEstimation.initializeEstimation(ACCUMULATOR_TYPE_PHYSICAL,UCHAR_MAX,UCHAR_MAX);
+			ForwardBackwardX forwardBackwardX(&phoneSet,&lexiconManager,&hmmManagerEstimation,&hmmManagerEstimation,
+				-20.0,800.0,500,true,500);
+			VLexUnit vLexUnitOptional;
+			vLexUnitOptional.push_back(lexiconManager.getLexUnitSilence());
+			int iFailed = 0;
+			beginStage(stage,"forwardbackward");
+			for(int r=0 ; r < iRepetitions ; ++r) {
+				for(VBenchUtterance::iterator it = vUtterance.begin() ; it != vUtterance.end() ; ++it) {
+					const string &strText = it->strTranscription.empty() ? it->strHypothesis : it->strTranscription;
+					VLexUnit vLexUnitTranscription;
+					bool bAllKnown;
+					if (strText.empty() || 
+						(lexiconManager.getLexUnits(strText.c_str(),vLexUnitTranscription,bAllKnown) == false)) {
+						continue;
+					}
+					double dTimeBegin = TimeUtils::getTimeMilliseconds();
+					double dLikelihood = 0.0;
+					const char *strReturnCode = NULL;
+					Alignment *alignment = forwardBackwardX.processUtterance(vLexUnitTranscription,false,
+						vLexUnitOptional,*it->mFeatures,*it->mFeatures,&dLikelihood,&strReturnCode);
+					addUtterance(stage,it->mFeatures->getRows(),TimeUtils::getTimeMilliseconds()-dTimeBegin);
+					if (alignment) {
+						delete alignment;
+					} else {
+						++iFailed;
+					}
+				}
+			}
+			stage.vMetrics.push_back(pair<string,double>("failed",iFailed));
+			endStage(stage,vStages);
+		}
+		
+		// (6) output the results
+		const char *strMode = bSynthetic ? "synthetic" : "models";
+		if (commandLineManager.isParameterSet("-out")) {
+			FileOutput fileOutput(commandLineManager.getParameterValue("-out"),false);
+			fileOutput.open();
+			writeJSON(fileOutput.getStream(),strMode,iSeed,iRepetitions,vUtterance,dSecondsSetup,iPeakRSSSetup,vStages);
+			fileOutput.close();
+		} else {
+			writeJSON(cout,strMode,iSeed,iRepetitions,vUtterance,dSecondsSetup,iPeakRSSSetup,vStages);
+		}
+		
+		// clean-up
+		for(VBenchUtterance::iterator it = vUtterance.begin() ; it != vUtterance.end() ; ++it) {
+			delete [] it->sSamples;
+			delete it->mFeatures;
+			if (it->lattice) {
+				delete it->lattice;
+			}
+		}
+		decoder.uninitialize();
+		delete network;
+		if (syntheticTask) {
+			delete syntheticTask;
+		}
+	
+	} catch (std::runtime_error &e) {
+	
+		std::cerr << e.what() << std::endl;
+		return -1;
+	}
+
+	return 0;
+}
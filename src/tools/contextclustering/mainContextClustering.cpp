@@ -50,6 +50,7 @@ int main(int argc, char *argv[]) {
 		commandLineManager.defineParameter("-occ","minimum cluster occupation",PARAMETER_TYPE_FLOAT,true,NULL,"200");
 		commandLineManager.defineParameter("-gan","minimum likelihood gain",PARAMETER_TYPE_FLOAT,true,NULL,"2000");
 		commandLineManager.defineParameter("-out","output acoustic models",PARAMETER_TYPE_FILE,false);
+		commandLineManager.defineParameter("-thr","number of threads (0 for all available)",PARAMETER_TYPE_INTEGER,true,NULL,"0");
 		
 		// parse the parameters
 		if (commandLineManager.parseParameters(argc,argv) == false) {
@@ -80,6 +81,19 @@ int main(int argc, char *argv[]) {
 		float fMinimumClusterOccupation = atof(commandLineManager.getParameterValue("-occ"));
 		float fMinimumLikelihoodGain = atof(commandLineManager.getParameterValue("-gan"));
 		const char *strFileModelsOutput = commandLineManager.getParameterValue("-out");
+		int iThreads = atoi(commandLineManager.getParameterValue("-thr"));
+		if (iThreads < 0) {
+			BVC_ERROR << "wrong number of threads: " << iThreads;
+		}
+#ifdef _OPENMP
+		if (iThreads > 0) {
+			omp_set_num_threads(iThreads);
+		}
+#else
+		if (iThreads > 1) {
+			BVC_WARNING << "multi-threading is not available (binaries built without OpenMP), using a single thread";
+		}
+#endif
 		
 		// load the phonetic symbol set
 		PhoneSet phoneSet(strFilePhoneSet);
@@ -47,6 +47,8 @@ int main(int argc, char *argv[]) {
 		commandLineManager.defineParameter("-fwd","forward pruning",PARAMETER_TYPE_FLOAT,true,"[-100.0|-10.0]","-20");
 		commandLineManager.defineParameter("-bwd","backward pruning",PARAMETER_TYPE_FLOAT,true,"[100.0|10000.0]","800");
 		commandLineManager.defineParameter("-tre","maximum trellis size (MB)",PARAMETER_TYPE_INTEGER,true,NULL,"500");
+		commandLineManager.defineParameter("-mar","time margin (frames) around lattice phone boundaries",
+			PARAMETER_TYPE_INTEGER,true,NULL,"0");
 		commandLineManager.defineParameter("-dAccNum","file to dump accumulators (numerator)",
 			PARAMETER_TYPE_FILE,false);	
 		commandLineManager.defineParameter("-dAccDen","file to dump accumulators (denominator)",
@@ -77,6 +79,7 @@ int main(int argc, char *argv[]) {
 		int iTrellisMaxSize = atoi(commandLineManager.getParameterValue("-tre")); 
 		bool bTrellisCache = true;
 		int iTrellisCacheMaxSize = atoi(commandLineManager.getParameterValue("-tre"));	
+		int iTimeMargin = atoi(commandLineManager.getParameterValue("-mar"));
 		const char *strFileAccumulatorsNum = commandLineManager.getParameterValue("-dAccNum");
 		const char *strFileAccumulatorsDen = commandLineManager.getParameterValue("-dAccDen");
 		const char *strObjectiveFunction = commandLineManager.getParameterValue("-obj");
@@ -88,7 +91,7 @@ int main(int argc, char *argv[]) {
 			strFolderFeatures,strFileModels,strFileOptionalSymbols,bMultiplePronunciations,strFileLexicon,strFileMLF,
 			strFolderLattices,fScaleAM,fScaleLM,strFileAccumulatorsNum,strFileAccumulatorsDen,strObjectiveFunction,
 			fBoostingFactor,bStatisticsCancelation,fForwardPruningBeam,fBackwardPruningBeam,iTrellisMaxSize,bTrellisCache,
-			iTrellisCacheMaxSize);
+			iTrellisCacheMaxSize,iTimeMargin);
 				
 		dtAccumulator.initialize();
 		dtAccumulator.accumulate();
@@ -21,9 +21,11 @@
 #include <cstdlib>
 
 #include "Viterbi.h"
+#include "AcousticLookAhead.h"
 #include "AlignmentFile.h"
 #include "AudioFile.h"
 #include "BatchFile.h"
+#include "BeamController.h"
 #include "BestPath.h"
 #include "CommandLineManager.h"
 #include "ConfigurationDynamicDecoder.h"
@@ -35,16 +37,25 @@
 #include "FeatureFile.h"
 #include "FileUtils.h"
 #include "FillerManager.h"
+#include "EmissionCache.h"
+#include "FrameSkipper.h"
+#include "GaussianQuantizer.h"
+#include "GaussianSelector.h"
 #include "HMMManager.h"
 #include "LexiconManager.h"
 #include "LexUnitsFile.h"
 #include "LMManager.h"
+#include "PerformanceProfile.h"
 #include "PhoneSet.h"
+#include "TextAligner.h"
+#include "TextAlignment.h"
 #include "TimeUtils.h"
+#include "TrnFile.h"
 
 using namespace std;
 
 #include <string>
+#include <sstream>
 
 using namespace Bavieca;
 
@@ -59,6 +70,10 @@ int main(int argc, char *argv[]) {
 		commandLineManager.defineParameter("-hyp","hypothesis file",PARAMETER_TYPE_FILE,false);
 		commandLineManager.defineParameter("-bat","batch file with entries [rawFile/featureFile utteranceId]",
 			PARAMETER_TYPE_FILE,false);
+		commandLineManager.defineParameter("-ref","reference file (trn format) used to compute the WER",
+			PARAMETER_TYPE_FILE,true);
+		commandLineManager.defineParameter("-tgt","comma-separated adaptive beam targets, the batch is decoded once per target",
+			PARAMETER_TYPE_STRING,true);
 			
 		// (2) process command line parameters
 		if (commandLineManager.parseParameters(argc,argv) == false) {
@@ -69,6 +84,14 @@ int main(int argc, char *argv[]) {
 		const char *strFileConfiguration = commandLineManager.getParameterValue("-cfg");
 		const char *strFileControl = commandLineManager.getParameterValue("-bat");
 		const char *strFileHypothesis = commandLineManager.getParameterValue("-hyp");
+		const char *strFileReference = NULL;
+		if (commandLineManager.isParameterSet("-ref")) {
+			strFileReference = commandLineManager.getParameterValue("-ref");
+		}
+		const char *strTargets = NULL;
+		if (commandLineManager.isParameterSet("-tgt")) {
+			strTargets = commandLineManager.getParameterValue("-tgt");
+		}
 		
 		// load the configuration file
 		ConfigurationDynamicDecoder configuration(strFileConfiguration);
@@ -136,6 +159,46 @@ int main(int argc, char *argv[]) {
 		float fBeamWidthArcsWE = configuration.getFloatParameterValue("pruning.likelihoodBeamWE");
 		float fBeamWidthTokensArc = configuration.getFloatParameterValue("pruning.likelihoodBeamTokensArc");
 		
+		// adaptive beam
+		int iAdaptiveBeamMode = BeamController::getMode(configuration.getStrParameterValue("pruning.adaptive.mode"));
+		vector<float> vAdaptiveBeamTarget;
+		float fBeamWidthArcsMin = fBeamWidthArcs;
+		float fBeamWidthArcsMax = fBeamWidthArcs;
+		if (iAdaptiveBeamMode != ADAPTIVE_BEAM_MODE_NONE) {
+			if ((configuration.isParameterSet("pruning.adaptive.target") == false) || 
+				(configuration.isParameterSet("pruning.adaptive.likelihoodBeamMin") == false) ||
+				(configuration.isParameterSet("pruning.adaptive.likelihoodBeamMax") == false)) {
+				BVC_ERROR << "adaptive beam requires a target and the minimum and maximum likelihood beams";
+			}
+			fBeamWidthArcsMin = configuration.getFloatParameterValue("pruning.adaptive.likelihoodBeamMin");
+			fBeamWidthArcsMax = configuration.getFloatParameterValue("pruning.adaptive.likelihoodBeamMax");
+			if ((fBeamWidthArcsMin <= 0.0) || (fBeamWidthArcsMin > fBeamWidthArcsMax)) {
+				BVC_ERROR << "wrong adaptive beam range: [" << fBeamWidthArcsMin << "," << fBeamWidthArcsMax << "]";
+			}
+			// evaluation mode: one decoding pass per target
+			if (strTargets) {
+				istringstream iss(strTargets);
+				string strTarget;
+				while(getline(iss,strTarget,',')) {
+					vAdaptiveBeamTarget.push_back((float)atof(strTarget.c_str()));
+					if (vAdaptiveBeamTarget.back() <= 0.0) {
+						BVC_ERROR << "wrong adaptive beam target: \"" << strTarget << "\"";
+					}
+				}
+			} else {
+				vAdaptiveBeamTarget.push_back(configuration.getFloatParameterValue("pruning.adaptive.target"));
+			}
+		} else if (strTargets) {
+			BVC_ERROR << "adaptive beam targets given but adaptive beam is not enabled (pruning.adaptive.mode)";
+		} else {
+			vAdaptiveBeamTarget.push_back(-1.0);
+		}
+		
+		// frame skipping
+		int iFrameSkippingMode = FrameSkipper::getMode(configuration.getStrParameterValue("frameSkipping.mode"));
+		int iFrameSkippingRate = configuration.getIntParameterValue("frameSkipping.rate");
+		float fFrameSkippingThreshold = configuration.getFloatParameterValue("frameSkipping.threshold");
+		
 		// output lattice?
 		bool bLatticeGeneration = configuration.isParameterSet("output.lattice.folder");	
 		const char *strFolderLattices = NULL;
@@ -160,6 +223,13 @@ int main(int argc, char *argv[]) {
 			strFolderAlignments = configuration.getStrParameterValue("output.alignment.folder"); ;
 		}
 	
+		// output decoding profile?
+		bool bOutputProfile = configuration.isParameterSet("output.profile.file");
+		const char *strFileProfile = NULL;
+		if (bOutputProfile) {
+			strFileProfile = configuration.getStrParameterValue("output.profile.file");
+		}
+		
 		// output audio?
 		bool bOutputAudio = configuration.isParameterSet("output.audio.folder");
 		const char *strFolderAudio = NULL;
@@ -210,6 +280,32 @@ int main(int argc, char *argv[]) {
 		hmmManager.load(strFileAcousticModels);
 		hmmManager.initializeDecoding();
 		
+		// Gaussian selection
+		GaussianSelector *gaussianSelector = NULL;
+		if (configuration.isParameterSet("acousticModels.gaussianSelection.file")) {
+			gaussianSelector = new GaussianSelector(&hmmManager);
+			gaussianSelector->load(configuration.getStrParameterValue("acousticModels.gaussianSelection.file"));
+		} else if (configuration.isParameterSet("acousticModels.gaussianSelection.codewords")) {
+			gaussianSelector = new GaussianSelector(&hmmManager);
+			gaussianSelector->build(configuration.getIntParameterValue("acousticModels.gaussianSelection.codewords"),
+				configuration.getFloatParameterValue("acousticModels.gaussianSelection.threshold"),
+				configuration.getIntParameterValue("acousticModels.gaussianSelection.floor"));
+		}
+		if (gaussianSelector) {
+			gaussianSelector->print();
+			hmmManager.setGaussianSelector(gaussianSelector);
+		}
+		
+		// quantization of the Gaussian parameters
+		GaussianQuantizer *gaussianQuantizer = NULL;
+		int iQuantization = GaussianQuantizer::getType(configuration.getStrParameterValue("acousticModels.quantization"));
+		if (iQuantization != GAUSSIAN_QUANTIZATION_NONE) {
+			gaussianQuantizer = new GaussianQuantizer(&hmmManager,iQuantization);
+			gaussianQuantizer->build();
+			gaussianQuantizer->print();
+			hmmManager.setGaussianQuantizer(gaussianQuantizer);
+		}
+		
 		// create the aligner object?
 		Viterbi *viterbi = NULL;
 		if (bOutputAlignment) {
@@ -239,10 +335,63 @@ int main(int argc, char *argv[]) {
 		// initialize the decoder
 		decoder.initialize();
 		
-		double dTimeBegin = TimeUtils::getTimeMilliseconds();	
+		// adaptive beam
+		BeamController *beamController = NULL;
+		if (iAdaptiveBeamMode != ADAPTIVE_BEAM_MODE_NONE) {
+			beamController = new BeamController(iAdaptiveBeamMode,vAdaptiveBeamTarget.front(),fBeamWidthArcs,
+				fBeamWidthArcsMin,fBeamWidthArcsMax);
+			decoder.setBeamController(beamController);
+		}
+		
+		// frame skipping
+		FrameSkipper *frameSkipper = NULL;
+		if (iFrameSkippingMode != FRAME_SKIPPING_MODE_NONE) {
+			frameSkipper = new FrameSkipper(iFrameSkippingMode,iFrameSkippingRate,fFrameSkippingThreshold,
+				hmmManager.getFeatureDim());
+			decoder.setFrameSkipper(frameSkipper);
+		}
 		
-		double dLikelihoodTotal = 0.0;
-		int iFeatureVectorsTotal = 0;
+		// performance counters and timers
+		PerformanceProfile profile;
+		FileOutput *fileProfile = NULL;
+		if (bOutputProfile) {
+			decoder.setProfile(&profile);
+			fileProfile = new FileOutput(strFileProfile,false);
+			fileProfile->open();
+		}
+		
+		// emission probabilities computed ahead of time
+		EmissionCache *emissionCache = NULL;
+		int iEmissionCacheFrames = configuration.getIntParameterValue("emissionCache.frames");
+		if (iEmissionCacheFrames > 1) {
+			if (gaussianSelector || gaussianQuantizer) {
+				BVC_WARNING << "emission cache disabled, not compatible with Gaussian selection or quantization";
+			} else {
+				emissionCache = new EmissionCache(&hmmManager,iEmissionCacheFrames);
+				decoder.setEmissionCache(emissionCache);
+			}
+		}
+		
+		// acoustic look-ahead
+		AcousticLookAhead *acousticLookAhead = NULL;
+		int iAcousticLookAheadFrames = configuration.getIntParameterValue("acousticLookAhead.frames");
+		if (iAcousticLookAheadFrames > 0) {
+			acousticLookAhead = new AcousticLookAhead(&phoneSet,&hmmManager,
+				configuration.getIntParameterValue("acousticLookAhead.components"),iAcousticLookAheadFrames,
+				configuration.getFloatParameterValue("acousticLookAhead.weight"));
+			acousticLookAhead->build();
+			acousticLookAhead->print();
+			decoder.setAcousticLookAhead(acousticLookAhead);
+		}
+		
+		// load the reference
+		TrnFile *trnFile = NULL;
+		TextAligner *textAligner = NULL;
+		if (strFileReference) {
+			trnFile = new TrnFile(strFileReference);
+			trnFile->load();
+			textAligner = new TextAligner(&lexiconManager);
+		}
 		
 		// load the batch file
 		BatchFile batchFile(strFileControl,"audio|id");
@@ -277,103 +426,246 @@ int main(int argc, char *argv[]) {
 			}
 		}
 		
-		FileOutput fileHypothesis(strFileHypothesis,false);
-		fileHypothesis.open();
-		int iUtterance = 0;
-		for(VUtteranceData::iterator it = vUtteranceData.begin() ; it != vUtteranceData.end() ; ++it, ++iUtterance) {
+		// results of each decoding pass (one per adaptive beam target)
+		vector<float> vRTF;
+		vector<float> vWER;
+		vector<float> vBeamAverage;
 		
-			const char *strUtteranceId = batchFile.getField(iUtterance,"id");
+		for(unsigned int iPass = 0 ; iPass < vAdaptiveBeamTarget.size() ; ++iPass) {
 		
-			cout << "processing utterance: " << strUtteranceId << endl;
+			// the beam starts from the configured value on each pass
+			if (beamController) {
+				beamController->setTarget(vAdaptiveBeamTarget[iPass]);
+				beamController->reset(fBeamWidthArcs);
+			}
 			
-			iFeatureVectorsTotal += it->mFeatures->getRows();
-			Matrix<float> *mFeatures = it->mFeatures;
+			// each target writes its own hypothesis file
+			ostringstream ossFileHypothesis;
+			ossFileHypothesis << strFileHypothesis;
+			if (strTargets) {
+				ossFileHypothesis << "." << vAdaptiveBeamTarget[iPass];
+			}
+		
+			double dTimeBegin = TimeUtils::getTimeMilliseconds();	
+			double dTimeDecoding = 0.0;
 			
-			if (hmmManager.getFeatureDim() != mFeatures->getCols()) {
-				BVC_ERROR << "inconsistent feature dimensionality, HMMs: " << hmmManager.getFeatureDim() 
-					<< ", features: " << mFeatures->getCols();
-			}	
+			double dLikelihoodTotal = 0.0;
+			int iFeatureVectorsTotal = 0;
+			int iWordsReference = 0;
+			int iErrors = 0;
 			
-			decoder.beginUtterance();
-			decoder.process(*mFeatures);
+			FileOutput fileHypothesis(ossFileHypothesis.str().c_str(),false);
+			fileHypothesis.open();
+			int iUtterance = 0;
+			for(VUtteranceData::iterator it = vUtteranceData.begin() ; it != vUtteranceData.end() ; ++it, ++iUtterance) {
 			
-			// best path
-			BestPath *bestPath = decoder.getBestPath();
-			if (bestPath) {	
-				// append the best path to a file (trn format)
-				bestPath->write(fileHypothesis.getStream(),strUtteranceId);	
-				bestPath->print(true);
-				dLikelihoodTotal += bestPath->getPathScore();
-			} else {
-				cout << "no best path!!\n";
-			}
+				const char *strUtteranceId = batchFile.getField(iUtterance,"id");
 			
-			// hypothesis lattice
-			if (bLatticeGeneration) {
-				HypothesisLattice *hypothesisLattice = decoder.getHypothesisLattice();
-				if (hypothesisLattice) {
-					ostringstream ossText,ossBin;
-					ossText << strFolderLattices << PATH_SEPARATOR << strUtteranceId << ".txt";
-					hypothesisLattice->store(ossText.str().c_str(),FILE_FORMAT_TEXT);
-					ossBin << strFolderLattices << PATH_SEPARATOR << strUtteranceId << ".bin";
-					hypothesisLattice->store(ossBin.str().c_str(),FILE_FORMAT_BINARY);
-					delete hypothesisLattice;
+				cout << "processing utterance: " << strUtteranceId << endl;
+				
+				iFeatureVectorsTotal += it->mFeatures->getRows();
+				Matrix<float> *mFeatures = it->mFeatures;
+				
+				if (hmmManager.getFeatureDim() != mFeatures->getCols()) {
+					BVC_ERROR << "inconsistent feature dimensionality, HMMs: " << hmmManager.getFeatureDim() 
+						<< ", features: " << mFeatures->getCols();
+				}	
+				
+				double dTimeUtteranceBegin = TimeUtils::getTimeMilliseconds();
+				
+				decoder.beginUtterance();
+				decoder.process(*mFeatures);
+				
+				// best path
+				BestPath *bestPath = decoder.getBestPath();
+				
+				dTimeDecoding += TimeUtils::getTimeMilliseconds()-dTimeUtteranceBegin;
+				
+				if (bestPath) {	
+					// append the best path to a file (trn format)
+					bestPath->write(fileHypothesis.getStream(),strUtteranceId);	
+					bestPath->print(true);
+					dLikelihoodTotal += bestPath->getPathScore();
 				} else {
-					cout << "no hypothesis lattice!!\n";
+					cout << "no best path!!\n";
+				}
+				
+				// align the best path to the reference
+				if (trnFile) {
+					const char *strReference = trnFile->getTranscription(strUtteranceId);
+					VLexUnit vLexUnitRef;
+					bool bAllKnown;
+					if ((strReference == NULL) || 
+						(lexiconManager.getLexUnits(strReference,vLexUnitRef,bAllKnown) == false)) {
+						BVC_WARNING << "unable to get the reference for utterance: " << strUtteranceId;
+					} else {
+						VLexUnit vLexUnitHyp;
+						if (bestPath) {
+							VLexUnit vLexUnitBestPath;
+							bestPath->getLexUnits(vLexUnitBestPath);
+							for(VLexUnit::iterator jt = vLexUnitBestPath.begin() ; jt != vLexUnitBestPath.end() ; ++jt) {
+								if (lexiconManager.isStandard(*jt)) {
+									vLexUnitHyp.push_back(*jt);
+								}
+							}
+						}
+						TAErrors errors;
+						if (textAligner->computeErrors(vLexUnitHyp,vLexUnitRef,errors)) {
+							iErrors += errors.iSubstitutions+errors.iDeletions+errors.iInsertions;
+							iWordsReference += errors.iWordsReference;
+						}
+					}
+				}
+				
+				// hypothesis lattice
+				if (bLatticeGeneration) {
+					HypothesisLattice *hypothesisLattice = decoder.getHypothesisLattice();
+					if (hypothesisLattice) {
+						ostringstream ossText,ossBin;
+						ossText << strFolderLattices << PATH_SEPARATOR << strUtteranceId << ".txt";
+						hypothesisLattice->store(ossText.str().c_str(),FILE_FORMAT_TEXT);
+						ossBin << strFolderLattices << PATH_SEPARATOR << strUtteranceId << ".bin";
+						hypothesisLattice->store(ossBin.str().c_str(),FILE_FORMAT_BINARY);
+						delete hypothesisLattice;
+					} else {
+						cout << "no hypothesis lattice!!\n";
+					}
+				}
+				
+				// output decoding profile?
+				if (fileProfile) {
+					fileProfile->getStream() << "{\"utterance\": \"" << strUtteranceId << "\", \"pass\": " 
+						<< iPass << ", \"frames\": " << mFeatures->getRows() << ", \"profile\": ";
+					profile.printJSON(fileProfile->getStream());
+					fileProfile->getStream() << "}" << endl;
+				}
+				
+				decoder.endUtterance();	
+				
+				// output features?
+				if (bOutputFeatures) {
+					ostringstream ossFileFeatures;
+					ossFileFeatures << strFolderFeatures << PATH_SEPARATOR << strUtteranceId << ".fea"; 
+					FeatureFile featureFile(ossFileFeatures.str().c_str(),MODE_WRITE);
+					featureFile.store(*mFeatures);
 				}
+				
+				// output alignment?
+				if (bOutputAlignment && bestPath) {
+				
+					// create the state-level alignment and dump it to disk
+					VPhoneAlignment *vPhoneAlignment = viterbi->align(*mFeatures,bestPath);
+					if (vPhoneAlignment) {
+						AlignmentFile alignmentFile(&phoneSet,&lexiconManager);
+						ostringstream ossFileAlignment;
+						ossFileAlignment << strFolderAlignments << PATH_SEPARATOR << strUtteranceId << ".ali";
+						alignmentFile.store(*vPhoneAlignment,ossFileAlignment.str().c_str());
+						AlignmentFile::destroyPhoneAlignment(vPhoneAlignment);
+					} else {
+						BVC_WARNING << "unable to perform the best-path alignment";
+					}			
+				}
+				
+				// clean-up
+				if (bestPath) {
+					delete bestPath;
+				}	
 			}
+			fileHypothesis.close();
 			
-			decoder.endUtterance();	
+			double dTimeEnd = TimeUtils::getTimeMilliseconds();
+			double dTimeSeconds = (dTimeEnd-dTimeBegin)/1000.0;
+			double dRTF = dTimeSeconds/(((float)iFeatureVectorsTotal)/100.0);
+			double dRTFDecoding = (dTimeDecoding/1000.0)/(((float)iFeatureVectorsTotal)/100.0);
+			double dWER = (iWordsReference > 0) ? 100.0*((double)iErrors)/((double)iWordsReference) : 0.0;
 			
-			// output features?
-			if (bOutputFeatures) {
-				ostringstream ossFileFeatures;
-				ossFileFeatures << strFolderFeatures << PATH_SEPARATOR << strUtteranceId << ".fea"; 
-				FeatureFile featureFile(ossFileFeatures.str().c_str(),MODE_WRITE);
-				featureFile.store(*mFeatures);
+			BVC_INFORMATION << "- summary ------------------------------------";
+			if (beamController) {
+				BVC_INFORMATION << "adaptive beam: " << BeamController::getStrMode(iAdaptiveBeamMode) << 
+					" target: " << vAdaptiveBeamTarget[iPass] << " average beam: " << FLT(8,2) << 
+					beamController->getBeamAverageSession();
 			}
+			if (frameSkipper) {
+				BVC_INFORMATION << "frame skipping: " << FrameSkipper::getStrMode(iFrameSkippingMode) << 
+					" rate: " << iFrameSkippingRate << " frames evaluated (cumulative): " << FLT(6,2) << 
+					100.0*frameSkipper->getEvaluatedRatioSession() << "%";
+			}
+			if (emissionCache) {
+				emissionCache->print();
+			}
+			BVC_INFORMATION << "# utterances: " << iUtterance << " speech time: " << FLT(8,2) << 
+				((float)iFeatureVectorsTotal)/100.0 << " seconds";
+			BVC_INFORMATION << "decoding time: " << FLT(8,2) << dTimeSeconds << " seconds (RTF: " << 
+				FLT(5,2) << dRTF << ", search only: " << FLT(5,2) << dRTFDecoding << ")";
+			BVC_INFORMATION << "likelihood: " << FLT(12,4) << dLikelihoodTotal << " (per frame: " << 
+				FLT(8,4) << dLikelihoodTotal/((float)iFeatureVectorsTotal) << ")";
+			if (trnFile) {
+				BVC_INFORMATION << "WER: " << FLT(6,2) << dWER << "% (" << iErrors << " errors / " << 
+					iWordsReference << " reference words)";
+			}
+			BVC_INFORMATION << "----------------------------------------------";
 			
-			// output alignment?
-			if (bOutputAlignment && bestPath) {
-			
-				// create the state-level alignment and dump it to disk
-				VPhoneAlignment *vPhoneAlignment = viterbi->align(*mFeatures,bestPath);
-				if (vPhoneAlignment) {
-					AlignmentFile alignmentFile(&phoneSet,&lexiconManager);
-					ostringstream ossFileAlignment;
-					ossFileAlignment << strFolderAlignments << PATH_SEPARATOR << strUtteranceId << ".ali";
-					alignmentFile.store(*vPhoneAlignment,ossFileAlignment.str().c_str());
-					AlignmentFile::destroyPhoneAlignment(vPhoneAlignment);
+			vRTF.push_back((float)dRTFDecoding);
+			vWER.push_back((float)dWER);
+			vBeamAverage.push_back(beamController ? beamController->getBeamAverageSession() : fBeamWidthArcs);
+		}
+		
+		// evaluation mode: WER vs RTF for each target
+		if (strTargets) {
+			BVC_INFORMATION << "- adaptive beam evaluation (" << BeamController::getStrMode(iAdaptiveBeamMode) << 
+				") ---------";
+			BVC_INFORMATION << "    target       RTF       WER      beam";
+			for(unsigned int i=0 ; i < vAdaptiveBeamTarget.size() ; ++i) {
+				ostringstream oss;
+				oss << FLT(10,2) << vAdaptiveBeamTarget[i] << FLT(10,2) << vRTF[i];
+				if (trnFile) {
+					oss << FLT(9,2) << vWER[i] << "%";
 				} else {
-					BVC_WARNING << "unable to perform the best-path alignment";
-				}			
+					oss << "         -";
+				}
+				oss << FLT(10,2) << vBeamAverage[i];
+				BVC_INFORMATION << oss.str();
 			}
-			
-			// clean-up
-			if (bestPath) {
-				delete bestPath;
-			}	
+			BVC_INFORMATION << "----------------------------------------------";
+		}
+		
+		// clean-up
+		for(VUtteranceData::iterator it = vUtteranceData.begin() ; it != vUtteranceData.end() ; ++it) {
 			delete [] it->samples.sSamples;
 			delete it->mFeatures;
 		}
-		fileHypothesis.close();
-		
-		double dTimeEnd = TimeUtils::getTimeMilliseconds();
-		double dTimeSeconds = (dTimeEnd-dTimeBegin)/1000.0;
-		double dRTF = dTimeSeconds/(((float)iFeatureVectorsTotal)/100.0);
-		
-		BVC_INFORMATION << "- summary ------------------------------------";
-		BVC_INFORMATION << "# utterances: " << iUtterance << " speech time: " << FLT(8,2) << 
-			((float)iFeatureVectorsTotal)/100.0 << " seconds";
-		BVC_INFORMATION << "decoding time: " << FLT(8,2) << dTimeSeconds << " seconds (RTF: " << 
-			FLT(5,2) << dRTF << ")";
-		BVC_INFORMATION << "likelihood: " << FLT(12,4) << dLikelihoodTotal << " (per frame: " << 
-			FLT(8,4) << dLikelihoodTotal/((float)iFeatureVectorsTotal) << ")";
-		BVC_INFORMATION << "----------------------------------------------";
+		if (trnFile) {
+			delete trnFile;
+			delete textAligner;
+		}
 		
 		// uninitialize the decoder
 		decoder.uninitialize();
 		
+		if (fileProfile) {
+			fileProfile->close();
+			delete fileProfile;
+		}
+		if (beamController) {
+			delete beamController;
+		}
+		if (frameSkipper) {
+			delete frameSkipper;
+		}
+		if (emissionCache) {
+			delete emissionCache;
+		}
+		if (acousticLookAhead) {
+			delete acousticLookAhead;
+		}
+		if (gaussianSelector) {
+			hmmManager.setGaussianSelector(NULL);
+			delete gaussianSelector;
+		}
+		if (gaussianQuantizer) {
+			hmmManager.setGaussianQuantizer(NULL);
+			delete gaussianQuantizer;
+		}
 		delete network;
 		if (bOutputAlignment) {
 			delete viterbi;
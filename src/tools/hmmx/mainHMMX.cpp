@@ -26,8 +26,10 @@
 #include <cstdlib>
 
 #include "CommandLineManager.h"
+#include "GaussianSelector.h"
 #include "HMMManager.h"
 #include "HLDAEstimator.h"
+#include "LogMessage.h"
 #include "PhoneSet.h"
 #include "RegressionTree.h"
 #include "Transform.h"
@@ -50,7 +52,14 @@ int main(int argc, char *argv[])
 		commandLineManager.defineParameter("-tra","model transform",PARAMETER_TYPE_FILE,true);
 		commandLineManager.defineParameter("-rgt","regression-tree",PARAMETER_TYPE_FILE,true);
 		commandLineManager.defineParameter("-in","inout acoustic models",PARAMETER_TYPE_FILE,false);
-		commandLineManager.defineParameter("-out","output acoustic models",PARAMETER_TYPE_FILE,false);
+		commandLineManager.defineParameter("-out","output acoustic models",PARAMETER_TYPE_FILE,true);
+		commandLineManager.defineParameter("-gsk","codebook size for Gaussian selection",PARAMETER_TYPE_INTEGER,true);
+		commandLineManager.defineParameter("-gst","maximum log-likelihood distance to the best component in a shortlist",
+			PARAMETER_TYPE_FLOAT,true,NULL,"10.0");
+		commandLineManager.defineParameter("-gsf","minimum number of components in a shortlist",
+			PARAMETER_TYPE_INTEGER,true,NULL,"1");
+		commandLineManager.defineParameter("-gso","output Gaussian selection codebook and shortlists",
+			PARAMETER_TYPE_FILE,true);
 		
 		// (2) process command line parameters
 		if (commandLineManager.parseParameters(argc,argv) == false) {
@@ -63,13 +72,40 @@ int main(int argc, char *argv[])
 		const char *strFileRegressionTree = commandLineManager.getParameterValue("-rgt");
 		const char *strFileModelsInput = commandLineManager.getParameterValue("-in");
 		const char *strFileModelsOutput = commandLineManager.getParameterValue("-out");
+		const char *strFileGaussianSelection = commandLineManager.getParameterValue("-gso");
 		
 		// load the phone set
 		PhoneSet phoneSet(strFilePhoneSet);
 		phoneSet.load();
 		
+		// model transforms need the transform and the output models
+		if ((strFileGaussianSelection == NULL) && ((strFileTransform == NULL) || (strFileModelsOutput == NULL))) {
+			BVC_ERROR << "a model transform (-tra) and output acoustic models (-out) are needed";
+		}
+		
+		// Gaussian selection: build the codebook and the shortlists for the input models
+		if (strFileGaussianSelection != NULL) {
+		
+			if (commandLineManager.isParameterSet("-gsk") == false) {
+				BVC_ERROR << "the codebook size (-gsk) is needed to build the Gaussian selection shortlists";
+			}
+			int iCodewords = atoi(commandLineManager.getParameterValue("-gsk"));
+			float fThreshold = (float)atof(commandLineManager.getParameterValue("-gst"));
+			int iFloor = atoi(commandLineManager.getParameterValue("-gsf"));
+		
+			// load the acoustic models
+			HMMManager hmmManager(&phoneSet,HMM_PURPOSE_EVALUATION);
+			hmmManager.load(strFileModelsInput);
+			hmmManager.initializeDecoding();
+			
+			// build the shortlists and store them alongside the models
+			GaussianSelector gaussianSelector(&hmmManager);
+			gaussianSelector.build(iCodewords,fThreshold,iFloor);
+			gaussianSelector.print();
+			gaussianSelector.store(strFileGaussianSelection);
+		}
 		// regression tree based transform?	
-		if (strFileRegressionTree != NULL) {
+		else if (strFileRegressionTree != NULL) {
 		
 			// load the acoustic models
 			HMMManager hmmManager(&phoneSet,HMM_PURPOSE_EVALUATION);
@@ -21,6 +21,7 @@
 #include "BatchFile.h"
 #include "BestPath.h"
 #include "CommandLineManager.h"
+#include "ConfusionNetwork.h"
 #include "FeatureFile.h"
 #include "FileUtils.h"
 #include "FillerManager.h"
@@ -29,6 +30,7 @@
 #include "HypothesisLattice.h"
 #include "LMManager.h"
 #include "Mappings.h"
+#include "TextAligner.h"
 #include "NBestList.h"
 #include "TimeUtils.h"
 #include "TrnFile.h"
@@ -48,9 +50,9 @@ int main(int argc, char *argv[]) {
 		commandLineManager.defineParameter("-lex","pronunciation dictionary (lexicon)",PARAMETER_TYPE_FILE,false);
 		commandLineManager.defineParameter("-mod","acoustic models",PARAMETER_TYPE_FILE,true);
 		commandLineManager.defineParameter("-lm","language model",PARAMETER_TYPE_FILE,true);
-		commandLineManager.defineParameter("-bat","lattices to process",PARAMETER_TYPE_FILE,false);
+		commandLineManager.defineParameter("-bat","lattices to process",PARAMETER_TYPE_FILE,true);
 		commandLineManager.defineParameter("-act","action to perform",PARAMETER_TYPE_FOLDER,
-			false,"wer|pp|align|compact|rescore|lm|addpath|nbest");
+			false,"wer|pp|align|compact|rescore|lm|addpath|nbest|cn|score");
 		//commandLineManager.defineParameter("-for","output format",PARAMETER_TYPE_STRING,true,"binary|text","binary");
 		commandLineManager.defineParameter("-trn","transcription file",PARAMETER_TYPE_FILE,true);
 		commandLineManager.defineParameter("-hyp","hypotheses file",PARAMETER_TYPE_FILE,true);
@@ -63,6 +65,13 @@ int main(int argc, char *argv[]) {
 		commandLineManager.defineParameter("-conf","confidence annotation method",PARAMETER_TYPE_STRING,true,"posteriors|accumulated|maximum","maximum");
 		commandLineManager.defineParameter("-map","file containing word mappings for WER computation",PARAMETER_TYPE_FILE,true);	
 		commandLineManager.defineParameter("-nbest","maximum number of entries in the n-best lists",PARAMETER_TYPE_INTEGER,true);	
+		commandLineManager.defineParameter("-beam","likelihood beam for on-the-fly lattice expansion (no pruning if not set)",
+			PARAMETER_TYPE_FLOAT,true);	
+		commandLineManager.defineParameter("-lmst","maximum number of lm-states per lattice node (on-the-fly lattice expansion)",
+			PARAMETER_TYPE_INTEGER,true,"[1|100000]","100");	
+		commandLineManager.defineParameter("-cnpp","minimum posterior probability of an edge to be clustered into the confusion network",
+			PARAMETER_TYPE_FLOAT,true,"[0.0|1.0]","0.001");	
+		commandLineManager.defineParameter("-thr","number of threads (lattice WER computation and hypotheses scoring)",PARAMETER_TYPE_INTEGER,true,"[1|128]","1");	
 		
 		// parse the parameters
 		if (commandLineManager.parseParameters(argc,argv) == false) {
@@ -98,8 +107,13 @@ int main(int argc, char *argv[]) {
 			}
 		}
 		
-		assert(commandLineManager.isParameterSet("-bat"));
-		strFileBatch = commandLineManager.getParameterValue("-bat");
+		// all the actions but hypotheses scoring process a batch of lattices
+		if (strcmp(strAction,"score") != 0) {
+			if (!commandLineManager.isParameterSet("-bat")) {
+				BVC_ERROR << "a batch file is needed for the action: \"" << strAction << "\"";
+			}
+			strFileBatch = commandLineManager.getParameterValue("-bat");
+		}
 		
 		LMManager *lmManager = NULL;
 		if (commandLineManager.isParameterSet("-lm")) {
@@ -155,67 +169,98 @@ int main(int argc, char *argv[]) {
 			TrnFile trnFile(strFileTrn);
 			trnFile.load();
 			
-			LatticeWER latticeWERAll;
-			LatticeDepth latticeDepthAll;
-			HypothesisLattice::reset(&latticeWERAll);
-			HypothesisLattice::reset(&latticeDepthAll);
+			// extract lexical units from the transcriptions
+			int iLattices = (int)batchFile.size();
+			vector<VLexUnit> vLexUnitsTranscription(iLattices);
+			for(int i=0 ; i < iLattices ; ++i) {
 			
-			for(unsigned int i=0 ; i<batchFile.size() ; ++i) {
-				
-				const char *strFileLatticeInput = batchFile.getField(i,"lattice");
 				const char *strUtteranceId = batchFile.getField(i,"utteranceId");
-				if (bTrn == false) {
-					strFileHypothesis = batchFile.getField(i,"hypothesis");
-				}	
-				
-				// load the lattice
-				HypothesisLattice hypothesisLattice(&phoneSet,&lexiconManager);
-				hypothesisLattice.load(strFileLatticeInput);	
-				hypothesisLattice.check();
-				
-				// compacting the lattice speeds-up the WER computation
-				hypothesisLattice.forwardEdgeMerge();
-				hypothesisLattice.backwardEdgeMerge();
-					
-				// get the transcription
 				const char *strTranscription = trnFile.getTranscription(strUtteranceId);
 				if (strTranscription == NULL) {
 					BVC_ERROR << "no transcription for utterance: \"" << strUtteranceId << "\" was found";
 				}
-				
-				// extract lexical units from the transcription
-				VLexUnit vLexUnitsTranscription;
 				bool bAllKnown;
-				lexiconManager.getLexUnits(strTranscription,vLexUnitsTranscription,bAllKnown);
-				//lexiconManager->print(vLexUnitsTranscription);		
+				lexiconManager.getLexUnits(strTranscription,vLexUnitsTranscription[i],bAllKnown);
+			}
+			
+			// compute the WER and depth of each lattice (lattices are processed in parallel)
+			int iThreads = commandLineManager.getIntParameterValue("-thr");
+			vector<LatticeWER*> vLatticeWER(iLattices,(LatticeWER*)NULL);
+			vector<LatticeDepth*> vLatticeDepth(iLattices,(LatticeDepth*)NULL);
+			vector<BestPath*> vBestPath(iLattices,(BestPath*)NULL);
+			string strError;
+			
+			#pragma omp parallel num_threads(iThreads)
+			{
+				#pragma omp for schedule(dynamic)
+				for(int i=0 ; i < iLattices ; ++i) {
 				
-				// compute the lattice WER
-				BestPath *bestPath = NULL;
-				LatticeWER *latticeWER = hypothesisLattice.computeWER(vLexUnitsTranscription,&bestPath,mappings);
-				if (latticeWER == NULL) {
-					BVC_ERROR << "unable to compute the WER for the utterance \"" << strUtteranceId << "\"";
+					const char *strFileLatticeInput = batchFile.getField(i,"lattice");
+					const char *strUtteranceId = batchFile.getField(i,"utteranceId");
+					
+					try {
+					
+						// load the lattice
+						HypothesisLattice hypothesisLattice(&phoneSet,&lexiconManager);
+						hypothesisLattice.load(strFileLatticeInput);	
+						hypothesisLattice.check();
+						
+						// compacting the lattice speeds-up the WER computation
+						hypothesisLattice.forwardEdgeMerge();
+						hypothesisLattice.backwardEdgeMerge();
+						
+						// compute the lattice WER
+						vLatticeWER[i] = hypothesisLattice.computeWER(vLexUnitsTranscription[i],&vBestPath[i],mappings);
+						if (vLatticeWER[i] == NULL) {
+							BVC_ERROR << "unable to compute the WER for the utterance \"" << strUtteranceId << "\"";
+						}
+						
+						// compute the lattice depth
+						vLatticeDepth[i] = hypothesisLattice.computeDepth();
+						
+					} catch (std::runtime_error &e) {
+					
+						// exceptions cannot leave the parallel region, keep the first error
+						#pragma omp critical
+						{
+							if (strError.empty()) {
+								strError = e.what();
+							}
+						}
+					}
 				}
-				HypothesisLattice::add(&latticeWERAll,latticeWER);
+			}
+			if (strError.empty() == false) {
+				BVC_ERROR << strError;
+			}
+			
+			// accumulate the results and write the hypotheses in the batch order
+			LatticeWER latticeWERAll;
+			LatticeDepth latticeDepthAll;
+			HypothesisLattice::reset(&latticeWERAll);
+			HypothesisLattice::reset(&latticeDepthAll);
+			for(int i=0 ; i < iLattices ; ++i) {
+			
+				const char *strUtteranceId = batchFile.getField(i,"utteranceId");
+				
+				HypothesisLattice::add(&latticeWERAll,vLatticeWER[i]);
+				HypothesisLattice::add(&latticeDepthAll,vLatticeDepth[i]);
 				
 				// hypothesis
-				if (bestPath != NULL) {
+				if (vBestPath[i] != NULL) {
 					if (bTrn) {
-						bestPath->write(fileHyp->getStream(),strUtteranceId);
+						vBestPath[i]->write(fileHyp->getStream(),strUtteranceId);
 					} else {	
-						FileOutput fileHyp(strFileHypothesis,false);
+						FileOutput fileHyp(batchFile.getField(i,"hypothesis"),false);
 						fileHyp.open();	
-						bestPath->write(fileHyp.getStream(),strUtteranceId,strUtteranceId,0.0,false,true,true);
+						vBestPath[i]->write(fileHyp.getStream(),strUtteranceId,strUtteranceId,0.0,false,true,true);
 						fileHyp.close();
 					}
-					delete bestPath;
-				}	
+					delete vBestPath[i];
+				}
 				
-				// compute the lattice depth
-				LatticeDepth *latticeDepth = hypothesisLattice.computeDepth();
-				HypothesisLattice::add(&latticeDepthAll,latticeDepth);
-					
-				delete latticeWER;
-				delete latticeDepth;
+				delete vLatticeWER[i];
+				delete vLatticeDepth[i];
 			}
 			if (bTrn) {
 				fileHyp->close();
@@ -294,6 +339,22 @@ int main(int argc, char *argv[]) {
 		// attach language model log-likelihoods and insertion penalties
 		else if (strcmp(strAction,"lm") == 0) {
 		
+			// on-the-fly expansion: paths are pruned using the likelihood beam
+			bool bPruning = commandLineManager.isParameterSet("-beam");
+			float fBeam = 0.0;
+			float fScaleAM = 0.0;
+			float fScaleLM = 0.0;
+			int iMaxLMStatesNode = -1;
+			if (bPruning) {
+				if (!commandLineManager.isParameterSet("-ams") || !commandLineManager.isParameterSet("-lms")) {
+					BVC_ERROR << "scaling factors are needed for on-the-fly lattice expansion";
+				}
+				fBeam = atof(commandLineManager.getParameterValue("-beam"));
+				fScaleAM = atof(commandLineManager.getParameterValue("-ams"));
+				fScaleLM = atof(commandLineManager.getParameterValue("-lms"));
+				iMaxLMStatesNode = commandLineManager.getIntParameterValue("-lmst");
+			}
+		
 			// load the batch file
 			BatchFile batchFile(strFileBatch,"latticeIn|latticeOut");
 			batchFile.load();
@@ -310,14 +371,19 @@ int main(int argc, char *argv[]) {
 				HypothesisLattice hypothesisLattice(&phoneSet,&lexiconManager);
 				hypothesisLattice.load(strFileLatticeInput);
 				
-				// attach language model scores to the edges in the lattice
-				hypothesisLattice.attachLMProbabilities(lmManager->getFSM());
-				
 				// attach insertion penalties
 				if (commandLineManager.isParameterSet("-ip")) {
 					hypothesisLattice.attachInsertionPenalty(&lexiconManager);
 				}
 				
+				// attach language model scores to the edges in the lattice
+				if (bPruning) {
+					hypothesisLattice.attachLMProbabilitiesPruned(lmManager->getFSM(),fScaleAM,fScaleLM,fBeam,
+						iMaxLMStatesNode);
+				} else {
+					hypothesisLattice.attachLMProbabilities(lmManager->getFSM());
+				}
+				
 				// write the lattice to disk
 				hypothesisLattice.store(strFileLatticeOutput);
 		
@@ -629,6 +695,117 @@ int main(int argc, char *argv[]) {
 					<< "s (RTF= " << FLT(5,4) << dRTF << ") frames: " << hypothesisLattice.getFrames();	
 			}	
 		}
+		// confusion network generation and minimum Bayes risk decoding
+		else if (strcmp(strAction,"cn") == 0) {
+		
+			float fMinPosterior = atof(commandLineManager.getParameterValue("-cnpp"));
+			
+			// get the hypothesis format
+			const char *strFileHypFormat = commandLineManager.getParameterValue("-hypf");
+			const char *strFileHypothesis = NULL;
+			bool bTrn = true;
+			const char *strBatchType = "lattice|utteranceId|cn";
+			FileOutput *fileHyp = NULL;
+			if ((!strFileHypFormat) || strcmp(strFileHypFormat,"trn") == 0) {	
+				strFileHypothesis = commandLineManager.getParameterValue("-hyp");
+				fileHyp = new FileOutput(strFileHypothesis,false);
+				fileHyp->open();	
+			} else {
+				assert(strcmp(strFileHypFormat,"ctm") == 0);
+				strBatchType = "lattice|utteranceId|cn|hypothesis";
+				bTrn = false;
+			}
+				
+			// load the batch file
+			BatchFile batchFile(strFileBatch,strBatchType);
+			batchFile.load();
+			
+			// process the batch file	
+			for(unsigned int i=0 ; i < batchFile.size() ; ++i) {	
+				
+				const char *strFileLatticeInput = batchFile.getField(i,"lattice");
+				const char *strUtteranceId = batchFile.getField(i,"utteranceId");
+				const char *strFileConfusionNetwork = batchFile.getField(i,"cn");
+				if (bTrn == false) {
+					strFileHypothesis = batchFile.getField(i,"hypothesis");
+				}
+		
+				double dTimeBegin = TimeUtils::getTimeMilliseconds();
+				
+				// load the lattice
+				HypothesisLattice hypothesisLattice(&phoneSet,&lexiconManager);
+				hypothesisLattice.load(strFileLatticeInput);
+				
+				// compute posterior probabilities if not available
+				if (!hypothesisLattice.isProperty(LATTICE_PROPERTY_PP)) {
+				
+					assert(commandLineManager.isParameterSet("-ams"));
+					assert(commandLineManager.isParameterSet("-lms"));
+					
+					// attach insertion penalties
+					if (commandLineManager.isParameterSet("-ip")) {
+						hypothesisLattice.attachInsertionPenalty(&lexiconManager);
+					}
+				
+					hypothesisLattice.computeForwardBackwardScores(atof(commandLineManager.getParameterValue("-ams")),
+						atof(commandLineManager.getParameterValue("-lms")));
+					hypothesisLattice.computePosteriorProbabilities();
+				}
+				
+				// build the confusion network and write it to disk
+				ConfusionNetwork *confusionNetwork = hypothesisLattice.createConfusionNetwork(fMinPosterior);
+				confusionNetwork->store(strFileConfusionNetwork);
+				
+				// minimum Bayes risk hypothesis
+				BestPath *bestPath = confusionNetwork->getBestPath();
+				if (bTrn) {
+					bestPath->write(fileHyp->getStream(),strUtteranceId);
+				} else {	
+					FileOutput fileHyp(strFileHypothesis,false);
+					fileHyp.open();	
+					bestPath->write(fileHyp.getStream(),strUtteranceId,strUtteranceId,0.0,false,true,true);
+					fileHyp.close();
+				}
+				delete bestPath;
+				delete confusionNetwork;
+				
+				double dTimeEnd = TimeUtils::getTimeMilliseconds();
+				double dTime = (dTimeEnd-dTimeBegin)/1000.0;
+				double dRTF = dTime/(hypothesisLattice.getFrames()/100.0);
+				
+				BVC_VERB << "Lattice processing time: " << FLT(8,4) << dTime 
+					<< "s (RTF= " << FLT(5,4) << dRTF << ") frames: " << hypothesisLattice.getFrames();
+			}
+			if (bTrn) {
+				fileHyp->close();
+				delete fileHyp;
+			}
+		}
+		// score hypotheses against the reference transcriptions
+		else if (strcmp(strAction,"score") == 0) {
+		
+			assert(commandLineManager.isParameterSet("-trn"));
+			assert(commandLineManager.isParameterSet("-hyp"));
+			int iThreads = commandLineManager.getIntParameterValue("-thr");
+			
+			// load the transcriptions and the hypotheses
+			TrnFile trnFileRef(commandLineManager.getParameterValue("-trn"));
+			trnFileRef.load();
+			TrnFile trnFileHyp(commandLineManager.getParameterValue("-hyp"));
+			trnFileHyp.load();
+			
+			double dTimeBegin = TimeUtils::getTimeMilliseconds();
+			
+			TAErrors errors;
+			TextAligner::reset(errors);
+			TextAligner textAligner(&lexiconManager);
+			unsigned int iUtterances = textAligner.computeErrors(trnFileHyp,trnFileRef,errors,iThreads);
+			
+			double dTimeEnd = TimeUtils::getTimeMilliseconds();
+			
+			BVC_VERB << "utterances scored: " << iUtterances << " (" << FLT(8,4) << (dTimeEnd-dTimeBegin)/1000.0 << "s)";
+			TextAligner::print(errors);
+		}
 		// unsupported action
 		else {
 			BVC_ERROR << "action: \"" << strAction << "\" not supported";
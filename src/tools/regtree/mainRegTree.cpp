@@ -39,6 +39,7 @@ int main(int argc, char *argv[]) {
 		commandLineManager.defineParameter("-rgc","number of regression classes (base-classes)",PARAMETER_TYPE_INTEGER,true,"[1|1000]","50");
 		commandLineManager.defineParameter("-gau","minimum number of Gaussian components per base-class",PARAMETER_TYPE_INTEGER,true,NULL,"50");
 		commandLineManager.defineParameter("-out","file to store the regression tree",PARAMETER_TYPE_FILE,false);
+		commandLineManager.defineParameter("-thr","number of threads (0 for all available)",PARAMETER_TYPE_INTEGER,true,NULL,"0");
 		
 		// (2) parse command line parameters
 		if (commandLineManager.parseParameters(argc,argv) == false) {
@@ -57,6 +58,23 @@ int main(int argc, char *argv[]) {
 		int iRegressionClasses = atoi(commandLineManager.getParameterValue("-rgc"));
 		int iMinimumGaussianComponentsBaseClass = atoi(commandLineManager.getParameterValue("-gau"));
 		const char *strFileRegressionTree = commandLineManager.getParameterValue("-out");
+		int iThreads = atoi(commandLineManager.getParameterValue("-thr"));
+		if (iThreads < 0) {
+			BVC_ERROR << "wrong number of threads: " << iThreads;
+		}
+#ifdef _OPENMP
+		if (iThreads > 0) {
+			omp_set_num_threads(iThreads);
+		}
+		iThreads = omp_get_max_threads();
+#else
+		if (iThreads > 1) {
+			BVC_WARNING << "multi-threading is not available (binaries built without OpenMP), using a single thread";
+		}
+		iThreads = 1;
+#endif
+		
+		double dTimeStart = TimeUtils::getTimeMilliseconds();
 	
 		// load the phone set
 		PhoneSet phoneSet(strFilePhoneSet);
@@ -67,6 +85,8 @@ int main(int argc, char *argv[]) {
 		hmmManager.load(strFileModels);
 		hmmManager.initializeDecoding();
 		
+		double dTimeEndLoading = TimeUtils::getTimeMilliseconds();
+		
 		// build the regression tree
 		RegressionTree regressionTree(&hmmManager);
 		regressionTree.build(iRegressionClasses,iClusteringMethod,
@@ -75,6 +95,12 @@ int main(int argc, char *argv[]) {
 		// store the regression tree to disk
 		regressionTree.store(strFileRegressionTree);
 		
+		double dTimeEnd = TimeUtils::getTimeMilliseconds();
+		
+		printf("threads:      %d\n",iThreads);
+		printf("loading time: %.2f seconds\n",(dTimeEndLoading-dTimeStart)/1000.0);
+		printf("total time:   %.2f seconds\n",(dTimeEnd-dTimeStart)/1000.0);
+		
 	} catch (std::runtime_error &e) {
 	
 		std::cerr << e.what() << std::endl;
@@ -50,6 +50,8 @@ int main(int argc, char *argv[]) {
 			PARAMETER_TYPE_INTEGER,false);
 		commandLineManager.defineParameter("-pad","speech padding (# frames)",PARAMETER_TYPE_INTEGER,true,NULL,"10");	
 		commandLineManager.defineParameter("-pen","speech insertion penalty",PARAMETER_TYPE_FLOAT,false);	
+		commandLineManager.defineParameter("-lat","maximum latency (# frames) of the decisions (-1: no limit)",
+			PARAMETER_TYPE_INTEGER,true,NULL,"-1");
 		commandLineManager.defineParameter("-out","speech segmentation output",PARAMETER_TYPE_FILE,false);
 		
 		// (2) parse command line parameters
@@ -65,6 +67,7 @@ int main(int argc, char *argv[]) {
 		int iMaxGaussianComponentsSpeech = atoi(commandLineManager.getParameterValue("-sph"));	
 		int iFramesPadding = atoi(commandLineManager.getParameterValue("-pad"));	
 		float fPenaltySilenceToSpeech = atof(commandLineManager.getParameterValue("-pen"));	
+		int iFramesLatency = atoi(commandLineManager.getParameterValue("-lat"));
 		const char *strFileOutput = commandLineManager.getParameterValue("-out");	
 		
 		// load the phone set
@@ -83,7 +86,7 @@ int main(int argc, char *argv[]) {
 		
 		// create the SAD module
 		SADModule sadModule(&phoneSet,&hmmManager,iMaxGaussianComponentsSilence,
-			iMaxGaussianComponentsSpeech,fPenaltySilenceToSpeech,iFramesPadding);
+			iMaxGaussianComponentsSpeech,fPenaltySilenceToSpeech,iFramesPadding,iFramesLatency);
 		sadModule.initialize();
 		
 		double dTimeBegin = TimeUtils::getTimeMilliseconds();
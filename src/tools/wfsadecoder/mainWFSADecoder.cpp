@@ -20,6 +20,7 @@
 
 #include "AudioFile.h"
 #include "BatchFile.h"
+#include "BeamController.h"
 #include "BestPath.h"
 #include "ConfigurationFeatures.h"
 #include "ConfigurationWFSADecoder.h"
@@ -27,7 +28,11 @@
 #include "FeatureExtractor.h"
 #include "FeatureFile.h"
 #include "FileUtils.h"
+#include "FrameSkipper.h"
+#include "GaussianQuantizer.h"
+#include "GaussianSelector.h"
 #include "LogMessage.h"
+#include "PerformanceProfile.h"
 #include "SADModule.h"
 #include "Transform.h"
 #include "TimeUtils.h"
@@ -98,6 +103,23 @@ int main(int argc, char *argv[]) {
 		// pruning
 		int iMaxActiveStates = configuration->getIntParameterValue("pruning.maxActiveStates");
 		float fLikelihoodBeam = configuration->getFloatParameterValue("pruning.likelihoodBeam");	
+		int iAdaptiveBeamMode = BeamController::getMode(configuration->getStrParameterValue("pruning.adaptive.mode"));
+		BeamController *beamController = NULL;
+		if (iAdaptiveBeamMode != ADAPTIVE_BEAM_MODE_NONE) {
+			if ((configuration->isParameterSet("pruning.adaptive.target") == false) || 
+				(configuration->isParameterSet("pruning.adaptive.likelihoodBeamMin") == false) ||
+				(configuration->isParameterSet("pruning.adaptive.likelihoodBeamMax") == false)) {
+				BVC_ERROR << "adaptive beam requires a target and the minimum and maximum likelihood beams";
+			}
+			float fLikelihoodBeamMin = configuration->getFloatParameterValue("pruning.adaptive.likelihoodBeamMin");
+			float fLikelihoodBeamMax = configuration->getFloatParameterValue("pruning.adaptive.likelihoodBeamMax");
+			if ((fLikelihoodBeamMin <= 0.0) || (fLikelihoodBeamMin > fLikelihoodBeamMax)) {
+				BVC_ERROR << "wrong adaptive beam range: [" << fLikelihoodBeamMin << "," << fLikelihoodBeamMax << "]";
+			}
+			beamController = new BeamController(iAdaptiveBeamMode,
+				configuration->getFloatParameterValue("pruning.adaptive.target"),fLikelihoodBeam,
+				fLikelihoodBeamMin,fLikelihoodBeamMax);
+		}
 		
 		// output lattice?
 		bool bLatticeGeneration = configuration->isParameterSet("output.lattice.folder");	
@@ -123,6 +145,13 @@ int main(int argc, char *argv[]) {
 			strFolderAlignments = configuration->getStrParameterValue("output.alignment.folder"); ;
 		}
 	
+		// output decoding profile?
+		bool bOutputProfile = configuration->isParameterSet("output.profile.file");
+		const char *strFileProfile = NULL;
+		if (bOutputProfile) {
+			strFileProfile = configuration->getStrParameterValue("output.profile.file");
+		}
+		
 		// output audio?
 		bool bOutputAudio = configuration->isParameterSet("output.audio.folder");
 		const char *strFolderAudio = NULL;
@@ -153,6 +182,32 @@ int main(int argc, char *argv[]) {
 		hmmManager.load(strFileModels);
 		hmmManager.initializeDecoding();	
 		
+		// Gaussian selection
+		GaussianSelector *gaussianSelector = NULL;
+		if (configuration->isParameterSet("acousticModels.gaussianSelection.file")) {
+			gaussianSelector = new GaussianSelector(&hmmManager);
+			gaussianSelector->load(configuration->getStrParameterValue("acousticModels.gaussianSelection.file"));
+		} else if (configuration->isParameterSet("acousticModels.gaussianSelection.codewords")) {
+			gaussianSelector = new GaussianSelector(&hmmManager);
+			gaussianSelector->build(configuration->getIntParameterValue("acousticModels.gaussianSelection.codewords"),
+				configuration->getFloatParameterValue("acousticModels.gaussianSelection.threshold"),
+				configuration->getIntParameterValue("acousticModels.gaussianSelection.floor"));
+		}
+		if (gaussianSelector) {
+			gaussianSelector->print();
+			hmmManager.setGaussianSelector(gaussianSelector);
+		}
+		
+		// quantization of the Gaussian parameters
+		GaussianQuantizer *gaussianQuantizer = NULL;
+		int iQuantization = GaussianQuantizer::getType(configuration->getStrParameterValue("acousticModels.quantization"));
+		if (iQuantization != GAUSSIAN_QUANTIZATION_NONE) {
+			gaussianQuantizer = new GaussianQuantizer(&hmmManager,iQuantization);
+			gaussianQuantizer->build();
+			gaussianQuantizer->print();
+			hmmManager.setGaussianQuantizer(gaussianQuantizer);
+		}
+		
 		// load the lexicon
 		LexiconManager lexiconManager(strFileLexicon,&phoneSet);
 		lexiconManager.load();
@@ -185,6 +240,26 @@ int main(int argc, char *argv[]) {
 		WFSADecoder wfsaDecoder(&phoneSet,&hmmManager,&lexiconManager,
 			wfsAcceptor,iMaxActiveStates,fLikelihoodBeam,bLatticeGeneration,iMaxWordSequencesState);
 		wfsaDecoder.initialize();
+		wfsaDecoder.setBeamController(beamController);
+		
+		// frame skipping
+		int iFrameSkippingMode = FrameSkipper::getMode(configuration->getStrParameterValue("frameSkipping.mode"));
+		FrameSkipper *frameSkipper = NULL;
+		if (iFrameSkippingMode != FRAME_SKIPPING_MODE_NONE) {
+			frameSkipper = new FrameSkipper(iFrameSkippingMode,
+				configuration->getIntParameterValue("frameSkipping.rate"),
+				configuration->getFloatParameterValue("frameSkipping.threshold"),hmmManager.getFeatureDim());
+			wfsaDecoder.setFrameSkipper(frameSkipper);
+		}
+		
+		// performance counters and timers
+		PerformanceProfile profile;
+		FileOutput *fileProfile = NULL;
+		if (bOutputProfile) {
+			wfsaDecoder.setProfile(&profile);
+			fileProfile = new FileOutput(strFileProfile,false);
+			fileProfile->open();
+		}
 		
 		string strFileHypothesis = commandLineManager.getParameterValue("-hyp");
 		
@@ -313,6 +388,14 @@ int main(int argc, char *argv[]) {
 					delete bestPathUtterance;
 				}
 				
+				// decoding profile
+				if (fileProfile) {
+					fileProfile->getStream() << "{\"utterance\": \"" << strUtteranceId << "\", \"frames\": " 
+						<< vUtteranceFeatures[iUtterance]->getRows() << ", \"profile\": ";
+					profile.printJSON(fileProfile->getStream());
+					fileProfile->getStream() << "}" << endl;
+				}
+				
 				// clean-up
 				if (vUtteranceFeatures[iUtterance]) {
 					delete vUtteranceFeatures[iUtterance];	
@@ -330,6 +413,14 @@ int main(int argc, char *argv[]) {
 		printf("# utterances: %d speech time: %.2f seconds\n",iUtterances,((float)iFeatureVectorsTotal)/100.0);
 		printf("decoding time: %.2f seconds (RTF: %5.2f)\n",dTimeSeconds,dRTF);
 		printf("likelihood: %.4f (per frame: %8.4f)\n",dLikelihoodTotal,dLikelihoodTotal/((float)iFeatureVectorsTotal));
+		if (beamController) {
+			printf("adaptive beam: %s target: %.2f average beam: %.2f\n",BeamController::getStrMode(iAdaptiveBeamMode),
+				beamController->getTarget(),beamController->getBeamAverageSession());
+		}
+		if (frameSkipper) {
+			printf("frame skipping: %s frames evaluated: %.2f%%\n",FrameSkipper::getStrMode(iFrameSkippingMode),
+				100.0*frameSkipper->getEvaluatedRatioSession());
+		}
 		printf("----------------------------------------------\n");	
 	
 		// clean up
@@ -337,6 +428,24 @@ int main(int argc, char *argv[]) {
 			delete viterbi;
 		}
 		delete wfsAcceptor;
+		if (beamController) {
+			delete beamController;
+		}
+		if (frameSkipper) {
+			delete frameSkipper;
+		}
+		if (fileProfile) {
+			fileProfile->close();
+			delete fileProfile;
+		}
+		if (gaussianSelector) {
+			hmmManager.setGaussianSelector(NULL);
+			delete gaussianSelector;
+		}
+		if (gaussianQuantizer) {
+			hmmManager.setGaussianQuantizer(NULL);
+			delete gaussianQuantizer;
+		}
 		
 	} catch (std::runtime_error &e) {
 	